@@ -60,11 +60,26 @@ LOCAL_C_INCLUDES := \
 LOCAL_SRC_FILES := \
     src/waffle/core/wcore_tinfo.c \
     src/waffle/core/wcore_config_attrs.c \
+    src/waffle/core/wcore_debug_stats.c \
     src/waffle/core/wcore_error.c \
     src/waffle/core/wcore_util.c \
     src/waffle/core/wcore_display.c \
+    src/waffle/core/wcore_disk_cache.c \
+    src/waffle/core/wcore_env.c \
     src/waffle/core/wcore_attrib_list.c \
+    src/waffle/core/wcore_block_pool.c \
+    src/waffle/core/wcore_slab.c \
+    src/waffle/core/wcore_ext_set.c \
+    src/waffle/core/wcore_frame_stats.c \
+    src/waffle/core/wcore_gl_stats.c \
+    src/waffle/core/wcore_gpu_timer.c \
+    src/waffle/core/wcore_memory.c \
+    src/waffle/core/wcore_platform_auto.c \
+    src/waffle/core/wcore_stats.c \
+    src/waffle/core/wcore_trace.c \
+    src/waffle/core/wcore_trace_writer.c \
     src/waffle/api/api_priv.c \
+    src/waffle/api/waffle_async.c \
     src/waffle/api/waffle_attrib_list.c \
     src/waffle/api/waffle_config.c \
     src/waffle/api/waffle_context.c \
@@ -73,9 +88,12 @@ LOCAL_SRC_FILES := \
     src/waffle/api/waffle_error.c \
     src/waffle/api/waffle_gl_misc.c \
     src/waffle/api/waffle_init.c \
+    src/waffle/api/waffle_stats.c \
+    src/waffle/api/waffle_trace.c \
     src/waffle/api/waffle_window.c \
     src/waffle/api/waffle_dl.c \
     src/waffle/linux/linux_dl.c \
+    src/waffle/linux/linux_driver_id.c \
     src/waffle/linux/linux_platform.c \
     src/waffle/egl/wegl_config.c \
     src/waffle/egl/wegl_context.c \
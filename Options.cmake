@@ -30,6 +30,11 @@ if(waffle_on_linux)
     option(waffle_has_gbm "Build support for GBM" ${gbm_default})
     option(waffle_has_nacl "Build support for NaCl" OFF)
 
+    # Build for exactly one platform and dispatch to it directly, rather than
+    # through the platform vtbl. Overrides the waffle_has_* options above.
+    set(waffle_single_platform "" CACHE STRING
+        "Build support for only this platform: glx, wayland, x11_egl or gbm")
+
     # NaCl specific settings.
     set(nacl_sdk_path "" CACHE STRING "Set nacl_sdk path here")
     set(nacl_version "pepper_39" CACHE STRING "Set NaCl bundle here")
@@ -24,6 +24,7 @@
 # OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
 
 include(CheckCCompilerFlag)
+include(CheckIncludeFile)
 include(WaffleCheckThreadLocalStorage)
 
 function(waffle_add_c_flag flag var)
@@ -122,6 +123,16 @@ if(waffle_on_linux)
         add_definitions(-DWAFFLE_HAS_GBM)
     endif()
 
+    if(waffle_single_platform STREQUAL "glx")
+        add_definitions(-DWAFFLE_SINGLE_PLATFORM_VTBL=glx_platform_vtbl)
+    elseif(waffle_single_platform STREQUAL "wayland")
+        add_definitions(-DWAFFLE_SINGLE_PLATFORM_VTBL=wayland_platform_vtbl)
+    elseif(waffle_single_platform STREQUAL "x11_egl")
+        add_definitions(-DWAFFLE_SINGLE_PLATFORM_VTBL=xegl_platform_vtbl)
+    elseif(waffle_single_platform STREQUAL "gbm")
+        add_definitions(-DWAFFLE_SINGLE_PLATFORM_VTBL=wgbm_platform_vtbl)
+    endif()
+
     if(waffle_has_tls)
         add_definitions(-DWAFFLE_HAS_TLS)
     endif()
@@ -130,6 +141,12 @@ if(waffle_on_linux)
         add_definitions(-DWAFFLE_HAS_TLS_MODEL_INITIAL_EXEC)
     endif()
 
+    # USDT probes for bpftrace, perf and SystemTap. See wcore_probe.h.
+    check_include_file(sys/sdt.h waffle_has_sdt)
+    if(waffle_has_sdt)
+        add_definitions(-DWAFFLE_HAS_SDT)
+    endif()
+
     add_definitions(-D_XOPEN_SOURCE=600)
 endif()
 
@@ -50,6 +50,10 @@ endif()
 if(waffle_on_windows)
     message("    wgl")
 endif()
+if(waffle_single_platform)
+    message("")
+    message("Single-platform build with direct dispatch: ${waffle_single_platform}")
+endif()
 message("")
 message("Dependencies:")
 if(waffle_has_egl)
@@ -69,6 +73,10 @@ endif()
 if(waffle_has_gbm)
     message("    gbm_INCLUDE_DIRS: ${gbm_INCLUDE_DIRS}")
 endif()
+if(waffle_has_sdt)
+    message("")
+    message("USDT probes: enabled (sys/sdt.h)")
+endif()
 message("")
 message("Build type:")
 message("    ${CMAKE_BUILD_TYPE}")
@@ -45,6 +45,29 @@ if(DEFINED waffle_install_docdir)
 endif()
 
 if(waffle_on_linux)
+    if(waffle_single_platform)
+        if(NOT waffle_single_platform MATCHES "^(glx|wayland|x11_egl|gbm)$")
+            message(FATAL_ERROR "waffle_single_platform has bad value "
+                    "\"${waffle_single_platform}\". Must be one of: "
+                    "glx, wayland, x11_egl, gbm.")
+        endif()
+        if(waffle_has_nacl)
+            message(FATAL_ERROR "waffle_single_platform cannot be combined "
+                    "with waffle_has_nacl.")
+        endif()
+
+        foreach(platform glx wayland x11_egl gbm)
+            if(platform STREQUAL waffle_single_platform)
+                set(waffle_has_${platform} ON)
+            else()
+                set(waffle_has_${platform} OFF)
+            endif()
+        endforeach()
+
+        # WaffleDefineInternalOptions derived waffle_has_egl and
+        # waffle_has_x11 from the flags as they were before the override.
+        include(WaffleDefineInternalOptions)
+    endif()
     if(NOT waffle_has_glx AND NOT waffle_has_wayland AND
        NOT waffle_has_x11_egl AND NOT waffle_has_gbm AND
        NOT waffle_has_nacl)
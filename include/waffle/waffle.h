@@ -50,6 +50,8 @@ extern "C" {
 #    define WAFFLE_DEPRECATED_1_06
 #endif
 
+struct waffle_instance;
+struct waffle_async;
 struct waffle_display;
 struct waffle_config;
 struct waffle_context;
@@ -119,6 +121,13 @@ enum waffle_enum {
         WAFFLE_PLATFORM_GBM                                     = 0x0016,
         WAFFLE_PLATFORM_WGL                                     = 0x0017,
         WAFFLE_PLATFORM_NACL                                    = 0x0018,
+        WAFFLE_PLATFORM_AUTO                                    = 0x0019,
+
+    WAFFLE_FAST_START                                           = 0x0020,
+        WAFFLE_FAST_START_LAZY                                  = 0x0021,
+        WAFFLE_FAST_START_PREFETCH                              = 0x0022,
+
+    WAFFLE_CAPABILITY_CACHE                                     = 0x0023,
 
     // ------------------------------------------------------------------
     // For waffle_config_choose()
@@ -131,6 +140,7 @@ enum waffle_enum {
         WAFFLE_CONTEXT_OPENGL_ES3                               = 0x0214,
 
     WAFFLE_CONTEXT_MAJOR_VERSION                                = 0x020e,
+        WAFFLE_CONTEXT_VERSION_MAX                              = 0x0218,
     WAFFLE_CONTEXT_MINOR_VERSION                                = 0x020f,
 
     WAFFLE_CONTEXT_PROFILE                                      = 0x0210,
@@ -140,6 +150,7 @@ enum waffle_enum {
     WAFFLE_CONTEXT_FORWARD_COMPATIBLE                           = 0x0215,
     WAFFLE_CONTEXT_DEBUG                                        = 0x0216,
     WAFFLE_CONTEXT_ROBUST_ACCESS                                = 0x0217,
+    WAFFLE_CONTEXT_DEBUG_STATS                                  = 0x0219,
 
     WAFFLE_RED_SIZE                                             = 0x0201,
     WAFFLE_GREEN_SIZE                                           = 0x0202,
@@ -172,6 +183,7 @@ enum waffle_enum {
     WAFFLE_WINDOW_WIDTH                                         = 0x0310,
     WAFFLE_WINDOW_HEIGHT                                        = 0x0311,
     WAFFLE_WINDOW_FULLSCREEN                                    = 0x0312,
+    WAFFLE_WINDOW_GPU_TIMING                                    = 0x0313,
 };
 
 const char*
@@ -185,6 +197,9 @@ waffle_init(const int32_t *attrib_list);
 #if WAFFLE_API_VERSION >= 0x0106
 bool
 waffle_teardown(void);
+
+bool
+waffle_get_platform(int32_t *platform, const char **reason);
 #endif
 
 bool
@@ -199,6 +214,39 @@ bool
 waffle_is_extension_in_string(const char *extension_string,
                               const char *extension_name);
 
+// ---------------------------------------------------------------------------
+// waffle_instance
+// ---------------------------------------------------------------------------
+
+#if WAFFLE_API_VERSION >= 0x0106
+struct waffle_instance*
+waffle_instance_create(const int32_t *attrib_list);
+
+bool
+waffle_instance_destroy(struct waffle_instance *self);
+
+struct waffle_display*
+waffle_instance_display_connect(struct waffle_instance *self,
+                                const char *name);
+
+void*
+waffle_instance_get_proc_address(struct waffle_instance *self,
+                                 const char *name);
+
+bool
+waffle_instance_dl_can_open(struct waffle_instance *self, int32_t dl);
+
+void*
+waffle_instance_dl_sym(struct waffle_instance *self,
+                       int32_t dl,
+                       const char *name);
+
+bool
+waffle_instance_get_platform(struct waffle_instance *self,
+                             int32_t *platform,
+                             const char **reason);
+#endif
+
 // ---------------------------------------------------------------------------
 // waffle_display
 // ---------------------------------------------------------------------------
@@ -216,6 +264,54 @@ waffle_display_supports_context_api(struct waffle_display *self,
 union waffle_native_display*
 waffle_display_get_native(struct waffle_display *self);
 
+#if WAFFLE_API_VERSION >= 0x0106
+const union waffle_native_display*
+waffle_display_get_native_cached(struct waffle_display *self);
+
+bool
+waffle_display_destroy_all(struct waffle_display *self);
+
+bool
+waffle_display_get_live_counts(struct waffle_display *self,
+                               size_t *num_configs,
+                               size_t *num_contexts,
+                               size_t *num_windows);
+
+struct waffle_alloc_stats {
+    uint64_t object_allocs;
+    uint64_t object_frees;
+    uint64_t heap_allocs;
+    uint64_t live_objects;
+    uint64_t reserved_objects;
+};
+
+bool
+waffle_display_get_alloc_stats(struct waffle_display *self,
+                               struct waffle_alloc_stats *stats);
+
+struct waffle_round_trip_stats {
+    uint64_t count;
+    uint64_t wait_ns;
+};
+
+bool
+waffle_display_get_round_trip_stats(struct waffle_display *self,
+                                    struct waffle_round_trip_stats *stats);
+
+struct waffle_memory_stats {
+    uint64_t heap_bytes;
+    uint64_t buffer_bytes;
+};
+
+bool
+waffle_display_get_memory_stats(struct waffle_display *self,
+                                struct waffle_memory_stats *stats);
+
+bool
+waffle_display_has_extension(struct waffle_display *self,
+                             const char *name);
+#endif
+
 // ---------------------------------------------------------------------------
 // waffle_config
 // ---------------------------------------------------------------------------
@@ -230,6 +326,11 @@ waffle_config_destroy(struct waffle_config *self);
 union waffle_native_config*
 waffle_config_get_native(struct waffle_config *self);
 
+#if WAFFLE_API_VERSION >= 0x0106
+const union waffle_native_config*
+waffle_config_get_native_cached(struct waffle_config *self);
+#endif
+
 // ---------------------------------------------------------------------------
 // waffle_context
 // ---------------------------------------------------------------------------
@@ -244,6 +345,56 @@ waffle_context_destroy(struct waffle_context *self);
 union waffle_native_context*
 waffle_context_get_native(struct waffle_context *self);
 
+#if WAFFLE_API_VERSION >= 0x0106
+const union waffle_native_context*
+waffle_context_get_native_cached(struct waffle_context *self);
+
+bool
+waffle_context_has_extension(struct waffle_context *self,
+                             const char *name);
+
+bool
+waffle_context_create_many(struct waffle_config *config,
+                           struct waffle_context *shared_ctx,
+                           int32_t count,
+                           struct waffle_context *contexts[]);
+
+#define WAFFLE_DEBUG_STATS_MAX_COUNTS 64
+#define WAFFLE_DEBUG_STATS_MAX_SAMPLES 16
+#define WAFFLE_DEBUG_SAMPLE_MAX_LENGTH 256
+
+struct waffle_debug_message_count {
+    uint32_t source;
+    uint32_t type;
+    uint32_t id;
+    uint32_t severity;
+    uint64_t count;
+};
+
+struct waffle_debug_sample {
+    uint32_t source;
+    uint32_t type;
+    uint32_t id;
+    uint32_t severity;
+    uint64_t timestamp_ns;
+    char message[WAFFLE_DEBUG_SAMPLE_MAX_LENGTH];
+};
+
+struct waffle_debug_stats {
+    uint64_t total_messages;
+    uint64_t performance_messages;
+    uint64_t dropped_messages;
+    uint32_t num_counts;
+    struct waffle_debug_message_count counts[WAFFLE_DEBUG_STATS_MAX_COUNTS];
+    uint32_t num_samples;
+    struct waffle_debug_sample samples[WAFFLE_DEBUG_STATS_MAX_SAMPLES];
+};
+
+bool
+waffle_context_get_debug_stats(struct waffle_context *self,
+                               struct waffle_debug_stats *stats);
+#endif
+
 // ---------------------------------------------------------------------------
 // waffle_window
 // ---------------------------------------------------------------------------
@@ -273,6 +424,47 @@ waffle_window_swap_buffers(struct waffle_window *self);
 union waffle_native_window*
 waffle_window_get_native(struct waffle_window *self);
 
+#if WAFFLE_API_VERSION >= 0x0106
+const union waffle_native_window*
+waffle_window_get_native_cached(struct waffle_window *self);
+
+bool
+waffle_window_swap_buffers_many(struct waffle_window *windows[],
+                                int32_t count,
+                                bool results[]);
+
+#define WAFFLE_FRAME_STATS_MAX_FRAMES 128
+
+struct waffle_frame_timing {
+    uint64_t swap_ns;
+    uint64_t interval_ns;
+    uint64_t blocked_ns;
+    uint64_t gpu_ns;
+};
+
+struct waffle_frame_percentiles {
+    uint64_t p50_ns;
+    uint64_t p95_ns;
+    uint64_t p99_ns;
+    uint64_t max_ns;
+};
+
+struct waffle_frame_stats {
+    uint64_t total_frames;
+    uint32_t num_frames;
+    struct waffle_frame_timing frames[WAFFLE_FRAME_STATS_MAX_FRAMES];
+    struct waffle_frame_percentiles swap;
+    struct waffle_frame_percentiles interval;
+    struct waffle_frame_percentiles blocked;
+    struct waffle_frame_percentiles gpu;
+    uint64_t interval_jitter_ns;
+};
+
+bool
+waffle_window_get_frame_stats(struct waffle_window *self,
+                              struct waffle_frame_stats *stats);
+#endif
+
 #if defined(WAFFLE_API_EXPERIMENTAL) && WAFFLE_API_VERSION >= 0x0103
 bool
 waffle_window_resize(
@@ -281,6 +473,46 @@ waffle_window_resize(
         int32_t height);
 #endif
 
+// ---------------------------------------------------------------------------
+// waffle_async
+// ---------------------------------------------------------------------------
+
+#if WAFFLE_API_VERSION >= 0x0106
+struct waffle_async*
+waffle_display_connect_async(const char *name);
+
+struct waffle_async*
+waffle_instance_display_connect_async(struct waffle_instance *instance,
+                                      const char *name);
+
+struct waffle_async*
+waffle_config_choose_async(struct waffle_display *dpy,
+                           const int32_t attrib_list[]);
+
+struct waffle_async*
+waffle_context_create_async(struct waffle_config *config,
+                            struct waffle_context *shared_ctx);
+
+struct waffle_async*
+waffle_window_create2_async(struct waffle_config *config,
+                            const intptr_t attrib_list[]);
+
+bool
+waffle_async_poll(struct waffle_async *self);
+
+bool
+waffle_async_wait(struct waffle_async *self);
+
+int
+waffle_async_get_fd(struct waffle_async *self);
+
+void*
+waffle_async_finish(struct waffle_async *self);
+
+bool
+waffle_async_cancel(struct waffle_async *self);
+#endif
+
 // ---------------------------------------------------------------------------
 // waffle_dl
 // ---------------------------------------------------------------------------
@@ -291,6 +523,65 @@ waffle_dl_can_open(int32_t dl);
 void*
 waffle_dl_sym(int32_t dl, const char *name);
 
+// ---------------------------------------------------------------------------
+// waffle_stats
+// ---------------------------------------------------------------------------
+
+#if WAFFLE_API_VERSION >= 0x0106
+#define WAFFLE_STATS_NUM_BUCKETS 32
+
+struct waffle_stats_entry {
+    const char *name;
+    uint64_t calls;
+    uint64_t total_ns;
+    uint64_t max_ns;
+    uint64_t histogram[WAFFLE_STATS_NUM_BUCKETS];
+};
+
+bool
+waffle_stats_enable(bool enable);
+
+size_t
+waffle_stats_snapshot(struct waffle_stats_entry *entries, size_t max_entries);
+
+char*
+waffle_stats_dump_json(void);
+
+struct waffle_gl_call_stats {
+    const char *name;
+    uint64_t calls;
+    uint64_t total_ns;
+    uint64_t max_ns;
+};
+
+bool
+waffle_gl_stats_enable(bool enable);
+
+size_t
+waffle_gl_stats_snapshot(struct waffle_gl_call_stats *entries,
+                         size_t max_entries);
+#endif
+
+// ---------------------------------------------------------------------------
+// waffle_trace
+// ---------------------------------------------------------------------------
+
+#if WAFFLE_API_VERSION >= 0x0106
+struct waffle_trace_event {
+    const char *name;
+    const void *object;
+    uint64_t timestamp_ns;
+    uint64_t duration_ns;
+    bool native;
+};
+
+bool
+waffle_set_trace_callbacks(
+        void (*begin)(const struct waffle_trace_event *event, void *user_data),
+        void (*end)(const struct waffle_trace_event *event, void *user_data),
+        void *user_data);
+#endif
+
 // ---------------------------------------------------------------------------
 // waffle_native
 // ---------------------------------------------------------------------------
@@ -29,6 +29,7 @@ file(MAKE_DIRECTORY ${html_out_dir})
 
 set(html_outputs
     ${html_out_dir}/wflinfo.1.html
+    ${html_out_dir}/waffle_async.3.html
     ${html_out_dir}/waffle_attrib_list.3.html
     ${html_out_dir}/waffle_config.3.html
     ${html_out_dir}/waffle_context.3.html
@@ -40,9 +41,12 @@ set(html_outputs
     ${html_out_dir}/waffle_get_proc_address.3.html
     ${html_out_dir}/waffle_glx.3.html
     ${html_out_dir}/waffle_init.3.html
+    ${html_out_dir}/waffle_instance.3.html
     ${html_out_dir}/waffle_is_extension_in_string.3.html
     ${html_out_dir}/waffle_make_current.3.html
     ${html_out_dir}/waffle_native.3.html
+    ${html_out_dir}/waffle_stats.3.html
+    ${html_out_dir}/waffle_trace.3.html
     ${html_out_dir}/waffle_teardown.3.html
     ${html_out_dir}/waffle_wayland.3.html
     ${html_out_dir}/waffle_window.3.html
@@ -68,6 +72,7 @@ function(waffle_add_html vol title)
 endfunction()
 
 waffle_add_html(1 wflinfo)
+waffle_add_html(3 waffle_async)
 waffle_add_html(3 waffle_attrib_list)
 waffle_add_html(3 waffle_config)
 waffle_add_html(3 waffle_context)
@@ -79,9 +84,12 @@ waffle_add_html(3 waffle_gbm)
 waffle_add_html(3 waffle_get_proc_address)
 waffle_add_html(3 waffle_glx)
 waffle_add_html(3 waffle_init)
+waffle_add_html(3 waffle_instance)
 waffle_add_html(3 waffle_is_extension_in_string)
 waffle_add_html(3 waffle_make_current)
 waffle_add_html(3 waffle_native)
+waffle_add_html(3 waffle_stats)
+waffle_add_html(3 waffle_trace)
 waffle_add_html(3 waffle_teardown)
 waffle_add_html(3 waffle_wayland)
 waffle_add_html(3 waffle_window)
@@ -31,6 +31,7 @@ file(MAKE_DIRECTORY ${man_out_dir}/man7)
 
 set(man_outputs
     ${man_out_dir}/man1/wflinfo.1
+    ${man_out_dir}/man3/waffle_async.3
     ${man_out_dir}/man3/waffle_attrib_list.3
     ${man_out_dir}/man3/waffle_config.3
     ${man_out_dir}/man3/waffle_context.3
@@ -42,9 +43,12 @@ set(man_outputs
     ${man_out_dir}/man3/waffle_get_proc_address.3
     ${man_out_dir}/man3/waffle_glx.3
     ${man_out_dir}/man3/waffle_init.3
+    ${man_out_dir}/man3/waffle_instance.3
     ${man_out_dir}/man3/waffle_is_extension_in_string.3
     ${man_out_dir}/man3/waffle_make_current.3
     ${man_out_dir}/man3/waffle_native.3
+    ${man_out_dir}/man3/waffle_stats.3
+    ${man_out_dir}/man3/waffle_trace.3
     ${man_out_dir}/man3/waffle_teardown.3
     ${man_out_dir}/man3/waffle_wayland.3
     ${man_out_dir}/man3/waffle_window.3
@@ -68,6 +72,7 @@ function(waffle_add_manpage vol title)
 endfunction()
 
 waffle_add_manpage(1 wflinfo)
+waffle_add_manpage(3 waffle_async)
 waffle_add_manpage(3 waffle_attrib_list)
 waffle_add_manpage(3 waffle_config)
 waffle_add_manpage(3 waffle_context)
@@ -79,9 +84,12 @@ waffle_add_manpage(3 waffle_gbm)
 waffle_add_manpage(3 waffle_get_proc_address)
 waffle_add_manpage(3 waffle_glx)
 waffle_add_manpage(3 waffle_init)
+waffle_add_manpage(3 waffle_instance)
 waffle_add_manpage(3 waffle_is_extension_in_string)
 waffle_add_manpage(3 waffle_make_current)
 waffle_add_manpage(3 waffle_native)
+waffle_add_manpage(3 waffle_stats)
+waffle_add_manpage(3 waffle_trace)
 waffle_add_manpage(3 waffle_teardown)
 waffle_add_manpage(3 waffle_wayland)
 waffle_add_manpage(3 waffle_window)
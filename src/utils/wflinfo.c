@@ -88,6 +88,10 @@ static const char *usage_message =
     "    -f, --format <format>\n"
     "        One of: original (default) or json.\n"
     "\n"
+    "    --capability-cache\n"
+    "        Cache the display's capabilities on disk, which speeds up later\n"
+    "        runs on the same driver.\n"
+    "\n"
     "    -h, --help\n"
     "        Print wflinfo usage information.\n"
     "\n"
@@ -108,6 +112,7 @@ enum {
     OPT_DEBUG_CONTEXT,
     OPT_FORWARD_COMPATIBLE,
     OPT_FORMAT = 'f',
+    OPT_CAPABILITY_CACHE,
     OPT_HELP = 'h',
 };
 
@@ -120,6 +125,7 @@ static const struct option get_opts[] = {
     { .name = "debug-context",  .has_arg = no_argument,           .val = OPT_DEBUG_CONTEXT },
     { .name = "forward-compatible", .has_arg = no_argument,       .val = OPT_FORWARD_COMPATIBLE },
     { .name = "format",         .has_arg = required_argument,     .val = OPT_FORMAT },
+    { .name = "capability-cache", .has_arg = no_argument,         .val = OPT_CAPABILITY_CACHE },
     { .name = "help",           .has_arg = no_argument,           .val = OPT_HELP },
     { 0 },
 };
@@ -272,6 +278,8 @@ struct options {
     bool context_forward_compatible;
     bool context_debug;
 
+    bool capability_cache;
+
     /// @brief One of `WAFFLE_DL_*`.
     int dl;
 };
@@ -422,6 +430,9 @@ parse_args(int argc, char *argv[], struct options *opts)
             case OPT_DEBUG_CONTEXT:
                 opts->context_debug = true;
                 break;
+            case OPT_CAPABILITY_CACHE:
+                opts->capability_cache = true;
+                break;
             case OPT_HELP:
                 write_usage_and_exit(stdout, EXIT_SUCCESS);
                 break;
@@ -853,7 +864,10 @@ wflinfo_try_create_context(struct waffle_display *dpy,
         config_attrib_list[i++] = attrs.profile;
     }
 
-    if (attrs.major != WAFFLE_DONT_CARE && attrs.minor != WAFFLE_DONT_CARE) {
+    if (attrs.major == WAFFLE_CONTEXT_VERSION_MAX) {
+        config_attrib_list[i++] = WAFFLE_CONTEXT_MAJOR_VERSION;
+        config_attrib_list[i++] = WAFFLE_CONTEXT_VERSION_MAX;
+    } else if (attrs.major != WAFFLE_DONT_CARE && attrs.minor != WAFFLE_DONT_CARE) {
         config_attrib_list[i++] = WAFFLE_CONTEXT_MAJOR_VERSION;
         config_attrib_list[i++] = attrs.major;
         config_attrib_list[i++] = WAFFLE_CONTEXT_MINOR_VERSION;
@@ -1118,20 +1132,13 @@ wflinfo_create_context(struct waffle_display *dpy,
         attrs.major == WAFFLE_DONT_CARE) {
 
         // If the user requested OpenGL and a CORE or COMPAT profile,
-        // but they didn't specify a version, then we'll try a set
-        // of known versions from highest to lowest.
-
-        static int known_gl_profile_versions[] =
-            { 32, 33, 40, 41, 42, 43, 44 };
-
-        for (int i = ARRAY_SIZE(known_gl_profile_versions) - 1; i >= 0; i--) {
-            attrs.major = known_gl_profile_versions[i] / 10;
-            attrs.minor = known_gl_profile_versions[i] % 10;
-            ok = wflinfo_try_create_context(dpy, attrs,
-                                            out_ctx, out_config, false);
-            if (ok) {
-                return;
-            }
+        // but they didn't specify a version, then let waffle find the
+        // highest version that the display supports.
+        attrs.major = WAFFLE_CONTEXT_VERSION_MAX;
+        ok = wflinfo_try_create_context(dpy, attrs,
+                                        out_ctx, out_config, false);
+        if (ok) {
+            return;
         }
 
         // Handle OpenGL 3.1 separately because profiles are weird in 3.1.
@@ -1187,7 +1194,7 @@ main(int argc, char **argv)
 
     struct options opts = {0};
 
-    int32_t init_attrib_list[3];
+    int32_t init_attrib_list[5];
 
     struct waffle_display *dpy;
     struct waffle_config *config;
@@ -1205,6 +1212,10 @@ main(int argc, char **argv)
     i = 0;
     init_attrib_list[i++] = WAFFLE_PLATFORM;
     init_attrib_list[i++] = opts.platform;
+    if (opts.capability_cache) {
+        init_attrib_list[i++] = WAFFLE_CAPABILITY_CACHE;
+        init_attrib_list[i++] = true;
+    }
     init_attrib_list[i++] = WAFFLE_NONE;
 
     ok = waffle_init(init_attrib_list);
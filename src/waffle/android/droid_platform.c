@@ -127,6 +127,7 @@ static const struct wcore_platform_vtbl droid_platform_vtbl = {
         .create = wegl_context_create,
         .destroy = wegl_context_destroy,
         .get_native = NULL,
+        .create_many = wegl_context_create_many,
     },
 
     .window = {
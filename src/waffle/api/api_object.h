@@ -34,11 +34,35 @@ extern "C" {
 // This header is so sad and lonely... but there is no other appropriate place
 // to define this struct.
 
+struct wcore_platform;
+
 struct api_object {
     /// @brief Display to which object belongs.
     ///
     /// For consistency, a `waffle_display` belongs to itself.
     size_t display_id;
+
+    /// @brief Platform instance to which the object belongs.
+    ///
+    /// API entry points dispatch through this platform rather than through
+    /// the global default instance, which allows objects from several
+    /// instances to coexist in one process.
+    struct wcore_platform *platform;
+
+    /// @brief Links the object into its display's registry.
+    ///
+    /// See wcore_display_register(). Unused by a `waffle_display`.
+    struct api_object *registry_prev;
+    struct api_object *registry_next;
+
+    /// @brief Native union returned by waffle_*_get_native_cached().
+    ///
+    /// Built on first use and freed with the object. See
+    /// api_object_cache_native().
+    void *native;
+
+    /// @brief Size of @a native, for memory accounting.
+    uint64_t native_size;
 };
 
 #ifdef __cplusplus
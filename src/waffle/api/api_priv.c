@@ -23,15 +23,21 @@
 // OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
 // OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
 
+#include <ctype.h>
 #include <stdio.h>
 #include <stdlib.h>
 
 #include "api_object.h"
 #include "api_priv.h"
 
+#include "wcore_atomic.h"
 #include "wcore_error.h"
 #include "wcore_platform.h"
 
+#define GL_VERSION 0x1F02
+
+typedef const unsigned char* (*glGetString_func)(unsigned int name);
+
 struct wcore_platform *api_platform = 0;
 
 bool
@@ -39,7 +45,7 @@ api_check_entry(const struct api_object *obj_list[], int length)
 {
     wcore_error_reset();
 
-    if (!api_platform) {
+    if (length == 0 && !wcore_atomic_load_ptr((void**) &api_platform)) {
         wcore_error(WAFFLE_ERROR_NOT_INITIALIZED);
         return false;
     }
@@ -58,3 +64,94 @@ api_check_entry(const struct api_object *obj_list[], int length)
 
     return true;
 }
+
+bool
+api_check_instance(const struct wcore_platform *instance)
+{
+    wcore_error_reset();
+
+    if (instance == NULL) {
+        wcore_errorf(WAFFLE_ERROR_BAD_PARAMETER, "null pointer");
+        return false;
+    }
+
+    return true;
+}
+
+void*
+api_object_cache_native(struct api_object *obj, void *native, size_t size)
+{
+    if (wcore_atomic_cas_ptr(&obj->native, NULL, native)) {
+        wcore_atomic_store_u64_relaxed(&obj->native_size, size);
+    }
+    else {
+        free(native);
+        native = wcore_atomic_load_ptr(&obj->native);
+    }
+
+    return native;
+}
+
+void
+api_object_release_native(struct api_object *obj)
+{
+    free(obj->native);
+    obj->native = NULL;
+    obj->native_size = 0;
+}
+
+static int32_t
+get_dl_for_context_api(int32_t context_api)
+{
+    switch (context_api) {
+        case WAFFLE_CONTEXT_OPENGL:     return WAFFLE_DL_OPENGL;
+        case WAFFLE_CONTEXT_OPENGL_ES1: return WAFFLE_DL_OPENGL_ES1;
+        case WAFFLE_CONTEXT_OPENGL_ES2: return WAFFLE_DL_OPENGL_ES2;
+        case WAFFLE_CONTEXT_OPENGL_ES3: return WAFFLE_DL_OPENGL_ES3;
+        default:                        return 0;
+    }
+}
+
+void*
+api_get_gl_proc(struct wcore_platform *platform,
+                int32_t context_api,
+                const char *name)
+{
+    const struct wcore_platform_vtbl *vtbl = wcore_vtbl(platform);
+    int32_t dl = get_dl_for_context_api(context_api);
+    void *proc = NULL;
+
+    if (vtbl->dl_can_open && vtbl->dl_can_open(platform, dl))
+        proc = vtbl->dl_sym(platform, dl, name);
+    if (!proc)
+        proc = vtbl->get_proc_address(platform, name);
+
+    return proc;
+}
+
+int
+api_get_current_gl_version(struct wcore_platform *platform,
+                           int32_t context_api)
+{
+    glGetString_func get_string;
+    const char *version;
+    int major, minor;
+
+    get_string = (glGetString_func) api_get_gl_proc(platform, context_api,
+                                                    "glGetString");
+    if (!get_string)
+        return 0;
+
+    version = (const char*) get_string(GL_VERSION);
+    if (!version)
+        return 0;
+
+    // OpenGL ES prefixes the version with "OpenGL ES ".
+    while (*version && !isdigit((unsigned char) *version))
+        ++version;
+
+    if (sscanf(version, "%d.%d", &major, &minor) != 2 || major < 1 || minor < 0)
+        return 0;
+
+    return 10 * major + (minor > 9 ? 9 : minor);
+}
@@ -48,22 +48,83 @@
 #endif
 
 struct api_object;
+struct wcore_context;
+struct wcore_debug_stats_gl;
+struct wcore_gpu_timer_gl;
 struct wcore_platform;
 
-/// @brief Managed by waffle_init() and waffle_teardown().
+/// @brief The default instance, managed by waffle_init() and waffle_teardown().
 ///
 /// This is null if waffle has not been initialized with waffle_init() or
 /// it has been torn down with waffle_teardown().
+///
+/// Entry points that take no waffle object, such as waffle_display_connect(),
+/// operate on this instance. Entry points that take an object dispatch
+/// through the object's own instance, `api_object::platform`.
 extern struct wcore_platform *api_platform;
 
 /// @brief Used to validate most API entry points.
 ///
 /// The objects that the user passed into the API entry point are listed in
-/// @a obj_list. If its @a length is 0, then the objects are not validated.
+/// @a obj_list. If its @a length is 0, then the entry point operates on the
+/// default instance.
 ///
 /// Emit an error and return false if any of the following:
-///     - waffle is not initialized
+///     - @a length is 0 and waffle is not initialized
 ///     - an object pointer is null
 ///     - two objects belong to different displays
 bool
 api_check_entry(const struct api_object *obj_list[], int length);
+
+/// @brief Used to validate the waffle_instance_* entry points.
+///
+/// Emit an error and return false if @a instance is null.
+bool
+api_check_instance(const struct wcore_platform *instance);
+
+/// @brief Store @a native, of @a size bytes, as the cached native union of
+/// @a obj.
+///
+/// If another thread won the race to fill the cache, then free @a native.
+/// Return the cached union. The cache owns it; the caller must not free it.
+void*
+api_object_cache_native(struct api_object *obj, void *native, size_t size);
+
+/// @brief Free the cached native union of @a obj, if any.
+///
+/// Called on every path that destroys the object.
+void
+api_object_release_native(struct api_object *obj);
+
+/// @brief Look up a GL function for contexts of @a context_api.
+///
+/// Try the api's library first, then the platform's get_proc_address.
+void*
+api_get_gl_proc(struct wcore_platform *platform,
+                int32_t context_api,
+                const char *name);
+
+/// @brief Version of the calling thread's current context, as reported by
+/// glGetString(GL_VERSION).
+///
+/// The version is merged, e.g. 45 for 4.5. Return 0 if it is unavailable.
+int
+api_get_current_gl_version(struct wcore_platform *platform,
+                           int32_t context_api);
+
+/// @brief Look up the timer query functions of @a ctx, which is current in
+/// the calling thread.
+///
+/// Return false if the context does not support timestamp queries.
+bool
+api_get_gpu_timer_gl(struct wcore_context *ctx,
+                     struct wcore_gpu_timer_gl *gl);
+
+/// @brief Look up the debug output functions of @a ctx, which is current in
+/// the calling thread.
+///
+/// Return false if the context supports neither GL_KHR_debug nor
+/// GL_ARB_debug_output.
+bool
+api_get_debug_stats_gl(struct wcore_context *ctx,
+                       struct wcore_debug_stats_gl *gl);
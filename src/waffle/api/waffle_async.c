@@ -0,0 +1,607 @@
+// Copyright 2016 Intel Corporation
+//
+// All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+//
+// - Redistributions of source code must retain the above copyright notice, this
+//   list of conditions and the following disclaimer.
+//
+// - Redistributions in binary form must reproduce the above copyright notice,
+//   this list of conditions and the following disclaimer in the documentation
+//   and/or other materials provided with the distribution.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+// DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+// FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+// DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+// SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+// CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+// OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+// OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+/// @file
+/// @brief Asynchronous creation of waffle objects.
+///
+/// Each waffle_*_async() call validates its arguments immediately, then
+/// queues a task. Tasks run in FIFO order on a single worker thread, which
+/// calls the ordinary synchronous entry point. The worker thread is started on
+/// demand and exits once the queue is empty, so no thread lingers after the
+/// last task completes.
+///
+/// Errors are thread-local. The worker saves the error emitted by the task,
+/// and waffle_async_finish() re-emits it on the caller's thread.
+///
+/// A handle is released by waffle_async_finish() or waffle_async_cancel().
+/// A task cancelled while it runs is marked, and the worker destroys its
+/// object and the handle when it completes.
+
+#include <assert.h>
+#include <stdlib.h>
+#include <string.h>
+
+#ifdef __linux__
+#include <sys/eventfd.h>
+#include <unistd.h>
+#endif
+
+#include "threads.h"
+
+#include "api_object.h"
+#include "api_priv.h"
+
+#include "wcore_attrib_list.h"
+#include "wcore_config.h"
+#include "wcore_context.h"
+#include "wcore_display.h"
+#include "wcore_error.h"
+#include "wcore_platform.h"
+#include "wcore_util.h"
+
+enum waffle_async_kind {
+    WAFFLE_ASYNC_DISPLAY_CONNECT,
+    WAFFLE_ASYNC_CONFIG_CHOOSE,
+    WAFFLE_ASYNC_CONTEXT_CREATE,
+    WAFFLE_ASYNC_WINDOW_CREATE,
+};
+
+struct waffle_async {
+    enum waffle_async_kind kind;
+
+    union {
+        struct {
+            struct waffle_instance *instance;
+            char *name;
+        } display_connect;
+
+        struct {
+            struct waffle_display *dpy;
+            int32_t *attrib_list;
+        } config_choose;
+
+        struct {
+            struct waffle_config *config;
+            struct waffle_context *shared_ctx;
+        } context_create;
+
+        struct {
+            struct waffle_config *config;
+            intptr_t *attrib_list;
+        } window_create;
+    } args;
+
+    /// The created object. Protected by async_mutex until @a done.
+    void *result;
+    enum waffle_error error_code;
+    char *error_message;
+    bool done;
+
+    /// Set by waffle_async_cancel() while the task runs. Protected by
+    /// async_mutex.
+    bool cancelled;
+
+    /// An eventfd, created on demand by waffle_async_get_fd(). Or -1.
+    int fd;
+
+    struct waffle_async *next;
+};
+
+static once_flag async_once = ONCE_FLAG_INIT;
+static mtx_t async_mutex;
+
+/// Broadcast whenever any task completes.
+static cnd_t async_cond;
+
+// Protected by async_mutex.
+static struct waffle_async *async_head;
+static struct waffle_async *async_tail;
+static bool async_worker_running;
+
+static void
+waffle_async_init_once(void)
+{
+    mtx_init(&async_mutex, mtx_plain);
+    cnd_init(&async_cond);
+}
+
+static void*
+waffle_async_run_task(struct waffle_async *task)
+{
+    switch (task->kind) {
+        case WAFFLE_ASYNC_DISPLAY_CONNECT:
+            if (task->args.display_connect.instance)
+                return waffle_instance_display_connect(
+                            task->args.display_connect.instance,
+                            task->args.display_connect.name);
+            else
+                return waffle_display_connect(task->args.display_connect.name);
+        case WAFFLE_ASYNC_CONFIG_CHOOSE:
+            return waffle_config_choose(task->args.config_choose.dpy,
+                                        task->args.config_choose.attrib_list);
+        case WAFFLE_ASYNC_CONTEXT_CREATE:
+            return waffle_context_create(task->args.context_create.config,
+                                         task->args.context_create.shared_ctx);
+        case WAFFLE_ASYNC_WINDOW_CREATE:
+            return waffle_window_create2(task->args.window_create.config,
+                                         task->args.window_create.attrib_list);
+    }
+
+    assert(false);
+    return NULL;
+}
+
+static void
+waffle_async_destroy(struct waffle_async *self)
+{
+    switch (self->kind) {
+        case WAFFLE_ASYNC_DISPLAY_CONNECT:
+            free(self->args.display_connect.name);
+            break;
+        case WAFFLE_ASYNC_CONFIG_CHOOSE:
+            free(self->args.config_choose.attrib_list);
+            break;
+        case WAFFLE_ASYNC_CONTEXT_CREATE:
+            break;
+        case WAFFLE_ASYNC_WINDOW_CREATE:
+            free(self->args.window_create.attrib_list);
+            break;
+    }
+
+#ifdef __linux__
+    if (self->fd >= 0)
+        close(self->fd);
+#endif
+
+    free(self->error_message);
+    free(self);
+}
+
+/// Destroy the object created by a cancelled task, if any.
+static bool
+waffle_async_destroy_result(struct waffle_async *task)
+{
+    void *result = task->result;
+
+    task->result = NULL;
+    if (!result)
+        return true;
+
+    switch (task->kind) {
+        case WAFFLE_ASYNC_DISPLAY_CONNECT:
+            return waffle_display_disconnect(result);
+        case WAFFLE_ASYNC_CONFIG_CHOOSE:
+            return waffle_config_destroy(result);
+        case WAFFLE_ASYNC_CONTEXT_CREATE:
+            return waffle_context_destroy(result);
+        case WAFFLE_ASYNC_WINDOW_CREATE:
+            return waffle_window_destroy(result);
+    }
+
+    assert(false);
+    return false;
+}
+
+static void
+waffle_async_signal_fd(struct waffle_async *task)
+{
+#ifdef __linux__
+    if (task->fd >= 0) {
+        uint64_t one = 1;
+        ssize_t ret = write(task->fd, &one, sizeof(one));
+        (void) ret;
+    }
+#else
+    (void) task;
+#endif
+}
+
+static int
+waffle_async_worker_main(void *arg)
+{
+    (void) arg;
+
+    mtx_lock(&async_mutex);
+
+    while (async_head) {
+        struct waffle_async *task = async_head;
+        const struct waffle_error_info *info;
+        void *result;
+
+        async_head = task->next;
+        if (!async_head)
+            async_tail = NULL;
+
+        mtx_unlock(&async_mutex);
+
+        result = waffle_async_run_task(task);
+
+        info = wcore_error_get_info();
+        task->error_code = info->code;
+        if (info->message_length > 0)
+            task->error_message = strdup(info->message);
+
+        mtx_lock(&async_mutex);
+        task->result = result;
+        task->done = true;
+
+        if (task->cancelled) {
+            // Nobody holds the handle any more.
+            mtx_unlock(&async_mutex);
+            waffle_async_destroy_result(task);
+            waffle_async_destroy(task);
+            mtx_lock(&async_mutex);
+            continue;
+        }
+
+        waffle_async_signal_fd(task);
+        cnd_broadcast(&async_cond);
+    }
+
+    async_worker_running = false;
+    mtx_unlock(&async_mutex);
+    return 0;
+}
+
+static struct waffle_async*
+waffle_async_create(enum waffle_async_kind kind)
+{
+    struct waffle_async *self = wcore_calloc(sizeof(*self));
+    if (!self)
+        return NULL;
+
+    self->kind = kind;
+    self->fd = -1;
+    return self;
+}
+
+static struct waffle_async*
+waffle_async_submit(struct waffle_async *self)
+{
+    bool ok = true;
+
+    call_once(&async_once, waffle_async_init_once);
+
+    mtx_lock(&async_mutex);
+
+    if (async_tail)
+        async_tail->next = self;
+    else
+        async_head = self;
+    async_tail = self;
+
+    if (!async_worker_running) {
+        thrd_t thread;
+
+        if (thrd_create(&thread, waffle_async_worker_main, NULL)
+                == thrd_success) {
+            thrd_detach(thread);
+            async_worker_running = true;
+        } else {
+            // Nobody will ever run the task. Take it back out of the queue,
+            // which contains no other task because no worker is running.
+            async_head = async_tail = NULL;
+            ok = false;
+        }
+    }
+
+    mtx_unlock(&async_mutex);
+
+    if (!ok) {
+        wcore_errorf(WAFFLE_ERROR_UNKNOWN, "thrd_create failed");
+        waffle_async_destroy(self);
+        return NULL;
+    }
+
+    return self;
+}
+
+WAFFLE_API struct waffle_async*
+waffle_display_connect_async(const char *name)
+{
+    struct waffle_async *self;
+
+    if (!api_check_entry(NULL, 0))
+        return NULL;
+
+    self = waffle_async_create(WAFFLE_ASYNC_DISPLAY_CONNECT);
+    if (!self)
+        return NULL;
+
+    if (name) {
+        self->args.display_connect.name = strdup(name);
+        if (!self->args.display_connect.name) {
+            wcore_error(WAFFLE_ERROR_BAD_ALLOC);
+            waffle_async_destroy(self);
+            return NULL;
+        }
+    }
+
+    return waffle_async_submit(self);
+}
+
+WAFFLE_API struct waffle_async*
+waffle_instance_display_connect_async(struct waffle_instance *instance,
+                                      const char *name)
+{
+    struct waffle_async *self;
+
+    if (!api_check_instance(wcore_platform(instance)))
+        return NULL;
+
+    self = waffle_async_create(WAFFLE_ASYNC_DISPLAY_CONNECT);
+    if (!self)
+        return NULL;
+
+    self->args.display_connect.instance = instance;
+
+    if (name) {
+        self->args.display_connect.name = strdup(name);
+        if (!self->args.display_connect.name) {
+            wcore_error(WAFFLE_ERROR_BAD_ALLOC);
+            waffle_async_destroy(self);
+            return NULL;
+        }
+    }
+
+    return waffle_async_submit(self);
+}
+
+WAFFLE_API struct waffle_async*
+waffle_config_choose_async(struct waffle_display *dpy,
+                           const int32_t attrib_list[])
+{
+    struct wcore_display *wc_dpy = wcore_display(dpy);
+    struct waffle_async *self;
+
+    const struct api_object *obj_list[] = {
+        wc_dpy ? &wc_dpy->api : NULL,
+    };
+
+    if (!api_check_entry(obj_list, 1))
+        return NULL;
+
+    self = waffle_async_create(WAFFLE_ASYNC_CONFIG_CHOOSE);
+    if (!self)
+        return NULL;
+
+    self->args.config_choose.dpy = dpy;
+
+    if (attrib_list) {
+        size_t len = wcore_attrib_list32_length(attrib_list);
+        size_t size = (2 * len + 1) * sizeof(attrib_list[0]);
+
+        self->args.config_choose.attrib_list = wcore_malloc(size);
+        if (!self->args.config_choose.attrib_list) {
+            waffle_async_destroy(self);
+            return NULL;
+        }
+
+        memcpy(self->args.config_choose.attrib_list, attrib_list, size);
+    }
+
+    return waffle_async_submit(self);
+}
+
+WAFFLE_API struct waffle_async*
+waffle_context_create_async(struct waffle_config *config,
+                            struct waffle_context *shared_ctx)
+{
+    struct wcore_config *wc_config = wcore_config(config);
+    struct wcore_context *wc_shared_ctx = wcore_context(shared_ctx);
+    struct waffle_async *self;
+
+    const struct api_object *obj_list[2];
+    int len = 0;
+
+    obj_list[len++] = wc_config ? &wc_config->api : NULL;
+    if (wc_shared_ctx)
+        obj_list[len++] = &wc_shared_ctx->api;
+
+    if (!api_check_entry(obj_list, len))
+        return NULL;
+
+    self = waffle_async_create(WAFFLE_ASYNC_CONTEXT_CREATE);
+    if (!self)
+        return NULL;
+
+    self->args.context_create.config = config;
+    self->args.context_create.shared_ctx = shared_ctx;
+
+    return waffle_async_submit(self);
+}
+
+WAFFLE_API struct waffle_async*
+waffle_window_create2_async(struct waffle_config *config,
+                            const intptr_t attrib_list[])
+{
+    struct wcore_config *wc_config = wcore_config(config);
+    struct waffle_async *self;
+
+    const struct api_object *obj_list[] = {
+        wc_config ? &wc_config->api : NULL,
+    };
+
+    if (!api_check_entry(obj_list, 1))
+        return NULL;
+
+    self = waffle_async_create(WAFFLE_ASYNC_WINDOW_CREATE);
+    if (!self)
+        return NULL;
+
+    self->args.window_create.config = config;
+
+    if (attrib_list) {
+        self->args.window_create.attrib_list =
+            wcore_attrib_list_copy(attrib_list);
+        if (!self->args.window_create.attrib_list) {
+            waffle_async_destroy(self);
+            return NULL;
+        }
+    }
+
+    return waffle_async_submit(self);
+}
+
+WAFFLE_API bool
+waffle_async_poll(struct waffle_async *self)
+{
+    bool done;
+
+    wcore_error_reset();
+
+    if (!self) {
+        wcore_errorf(WAFFLE_ERROR_BAD_PARAMETER, "null pointer");
+        return false;
+    }
+
+    mtx_lock(&async_mutex);
+    done = self->done;
+    mtx_unlock(&async_mutex);
+
+    return done;
+}
+
+WAFFLE_API bool
+waffle_async_wait(struct waffle_async *self)
+{
+    wcore_error_reset();
+
+    if (!self) {
+        wcore_errorf(WAFFLE_ERROR_BAD_PARAMETER, "null pointer");
+        return false;
+    }
+
+    mtx_lock(&async_mutex);
+    while (!self->done)
+        cnd_wait(&async_cond, &async_mutex);
+    mtx_unlock(&async_mutex);
+
+    return true;
+}
+
+WAFFLE_API int
+waffle_async_get_fd(struct waffle_async *self)
+{
+    int fd = -1;
+
+    wcore_error_reset();
+
+    if (!self) {
+        wcore_errorf(WAFFLE_ERROR_BAD_PARAMETER, "null pointer");
+        return -1;
+    }
+
+#ifdef __linux__
+    mtx_lock(&async_mutex);
+
+    if (self->fd < 0) {
+        self->fd = eventfd(0, EFD_CLOEXEC | EFD_NONBLOCK);
+        if (self->fd < 0) {
+            mtx_unlock(&async_mutex);
+            wcore_error_errno("eventfd");
+            return -1;
+        }
+
+        // The task may have completed before anyone asked for the fd.
+        if (self->done)
+            waffle_async_signal_fd(self);
+    }
+
+    fd = self->fd;
+    mtx_unlock(&async_mutex);
+#else
+    wcore_error(WAFFLE_ERROR_UNSUPPORTED_ON_PLATFORM);
+#endif
+
+    return fd;
+}
+
+WAFFLE_API void*
+waffle_async_finish(struct waffle_async *self)
+{
+    void *result;
+
+    if (!waffle_async_wait(self))
+        return NULL;
+
+    result = self->result;
+
+    if (self->error_code != WAFFLE_NO_ERROR) {
+        if (self->error_message)
+            wcore_errorf(self->error_code, "%s", self->error_message);
+        else
+            wcore_error(self->error_code);
+    }
+
+    waffle_async_destroy(self);
+    return result;
+}
+
+WAFFLE_API bool
+waffle_async_cancel(struct waffle_async *self)
+{
+    struct waffle_async **link;
+    struct waffle_async *prev = NULL;
+    bool done;
+    bool ok = true;
+
+    wcore_error_reset();
+
+    if (!self) {
+        wcore_errorf(WAFFLE_ERROR_BAD_PARAMETER, "null pointer");
+        return false;
+    }
+
+    mtx_lock(&async_mutex);
+
+    // A task still in the queue never runs.
+    for (link = &async_head; *link; prev = *link, link = &(*link)->next) {
+        if (*link == self) {
+            *link = self->next;
+            if (async_tail == self)
+                async_tail = prev;
+
+            mtx_unlock(&async_mutex);
+            waffle_async_destroy(self);
+            return true;
+        }
+    }
+
+    // Otherwise the worker has taken it. If it is still running, the worker
+    // cleans up when it completes.
+    done = self->done;
+    if (!done)
+        self->cancelled = true;
+
+    mtx_unlock(&async_mutex);
+
+    if (done) {
+        ok = waffle_async_destroy_result(self);
+        waffle_async_destroy(self);
+    }
+
+    return ok;
+}
@@ -0,0 +1,312 @@
+// Copyright 2016 Intel Corporation
+//
+// All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+//
+// - Redistributions of source code must retain the above copyright notice, this
+//   list of conditions and the following disclaimer.
+//
+// - Redistributions in binary form must reproduce the above copyright notice,
+//   this list of conditions and the following disclaimer in the documentation
+//   and/or other materials provided with the distribution.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+// DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+// FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+// DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+// SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+// CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+// OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+// OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+/// @file
+/// @brief Tests for the task queue of waffle_async.c.
+///
+/// The test links waffle_async.c against stubs of the synchronous entry points
+/// that its tasks call, so that it controls when each task completes.
+
+#include <setjmp.h>
+#include <stdarg.h>
+#include <stddef.h>
+#include <stdint.h>
+#include <string.h>
+
+#include <cmocka.h>
+
+#include "threads.h"
+
+#include "waffle.h"
+
+#include "api_priv.h"
+
+#define MAX_TASKS 8
+
+static struct waffle_display *fake_displays[MAX_TASKS];
+
+static mtx_t stub_mutex;
+static cnd_t stub_cond;
+
+// Protected by stub_mutex.
+static bool gate_open;
+static char started[MAX_TASKS];
+static int num_started;
+static struct waffle_display *disconnected[MAX_TASKS];
+static int num_disconnected;
+
+bool
+api_check_entry(const struct api_object *obj_list[], int length)
+{
+    (void) obj_list;
+    (void) length;
+    return true;
+}
+
+bool
+api_check_instance(const struct wcore_platform *instance)
+{
+    (void) instance;
+    return true;
+}
+
+/// Record the task as started, then block until the gate opens. The result is
+/// a fake display named by the single letter @a name.
+struct waffle_display*
+waffle_display_connect(const char *name)
+{
+    struct waffle_display *dpy;
+
+    mtx_lock(&stub_mutex);
+    dpy = (struct waffle_display*) &fake_displays[num_started];
+    started[num_started++] = name[0];
+    cnd_broadcast(&stub_cond);
+    while (!gate_open)
+        cnd_wait(&stub_cond, &stub_mutex);
+    mtx_unlock(&stub_mutex);
+
+    return dpy;
+}
+
+bool
+waffle_display_disconnect(struct waffle_display *dpy)
+{
+    mtx_lock(&stub_mutex);
+    disconnected[num_disconnected++] = dpy;
+    cnd_broadcast(&stub_cond);
+    mtx_unlock(&stub_mutex);
+    return true;
+}
+
+// The tests only connect displays.
+
+struct waffle_display*
+waffle_instance_display_connect(struct waffle_instance *instance,
+                                const char *name)
+{
+    (void) instance;
+    return waffle_display_connect(name);
+}
+
+struct waffle_config*
+waffle_config_choose(struct waffle_display *dpy, const int32_t attrib_list[])
+{
+    (void) dpy;
+    (void) attrib_list;
+    return NULL;
+}
+
+bool
+waffle_config_destroy(struct waffle_config *self)
+{
+    (void) self;
+    return true;
+}
+
+struct waffle_context*
+waffle_context_create(struct waffle_config *config,
+                      struct waffle_context *shared_ctx)
+{
+    (void) config;
+    (void) shared_ctx;
+    return NULL;
+}
+
+bool
+waffle_context_destroy(struct waffle_context *self)
+{
+    (void) self;
+    return true;
+}
+
+struct waffle_window*
+waffle_window_create2(struct waffle_config *config,
+                      const intptr_t attrib_list[])
+{
+    (void) config;
+    (void) attrib_list;
+    return NULL;
+}
+
+bool
+waffle_window_destroy(struct waffle_window *self)
+{
+    (void) self;
+    return true;
+}
+
+static void
+open_gate(void)
+{
+    mtx_lock(&stub_mutex);
+    gate_open = true;
+    cnd_broadcast(&stub_cond);
+    mtx_unlock(&stub_mutex);
+}
+
+static void
+wait_started(int n)
+{
+    mtx_lock(&stub_mutex);
+    while (num_started < n)
+        cnd_wait(&stub_cond, &stub_mutex);
+    mtx_unlock(&stub_mutex);
+}
+
+static void
+wait_disconnected(int n)
+{
+    mtx_lock(&stub_mutex);
+    while (num_disconnected < n)
+        cnd_wait(&stub_cond, &stub_mutex);
+    mtx_unlock(&stub_mutex);
+}
+
+static void
+setup(void **state) {
+    mtx_lock(&stub_mutex);
+    gate_open = false;
+    memset(started, 0, sizeof(started));
+    num_started = 0;
+    num_disconnected = 0;
+    mtx_unlock(&stub_mutex);
+}
+
+static void
+teardown(void **state) {
+    // Let any task still blocked in the stub complete.
+    open_gate();
+}
+
+static void
+test_waffle_async_completes_in_order(void **state) {
+    struct waffle_async *a, *b, *c;
+
+    a = waffle_display_connect_async("a");
+    b = waffle_display_connect_async("b");
+    c = waffle_display_connect_async("c");
+    assert_non_null(a);
+    assert_non_null(b);
+    assert_non_null(c);
+
+    // The single worker holds the first task, so the others wait behind it.
+    wait_started(1);
+    assert_false(waffle_async_poll(b));
+    assert_false(waffle_async_poll(c));
+
+    open_gate();
+
+    // By the time the last completes, all have, in submission order.
+    assert_true(waffle_async_wait(c));
+    assert_true(waffle_async_poll(a));
+    assert_true(waffle_async_poll(b));
+    assert_int_equal(num_started, 3);
+    assert_memory_equal(started, "abc", 3);
+
+    assert_true(waffle_async_finish(a) == (void*) &fake_displays[0]);
+    assert_true(waffle_async_finish(b) == (void*) &fake_displays[1]);
+    assert_true(waffle_async_finish(c) == (void*) &fake_displays[2]);
+    assert_int_equal(waffle_error_get_code(), WAFFLE_NO_ERROR);
+}
+
+static void
+test_waffle_async_cancel_pending(void **state) {
+    struct waffle_async *a, *b, *c;
+
+    a = waffle_display_connect_async("a");
+    b = waffle_display_connect_async("b");
+    c = waffle_display_connect_async("c");
+    wait_started(1);
+
+    // b is still queued behind a. Cancelling it drops it from the queue.
+    assert_true(waffle_async_cancel(b));
+
+    open_gate();
+    assert_non_null(waffle_async_finish(a));
+    assert_non_null(waffle_async_finish(c));
+
+    // b never ran, so there was nothing to destroy.
+    assert_int_equal(num_started, 2);
+    assert_memory_equal(started, "ac", 2);
+    assert_int_equal(num_disconnected, 0);
+}
+
+static void
+test_waffle_async_cancel_completed(void **state) {
+    struct waffle_async *a;
+
+    open_gate();
+    a = waffle_display_connect_async("a");
+    assert_true(waffle_async_wait(a));
+
+    // The handle is released and the display it created is disconnected.
+    assert_true(waffle_async_cancel(a));
+    assert_int_equal(num_disconnected, 1);
+    assert_true(disconnected[0] == (void*) &fake_displays[0]);
+}
+
+static void
+test_waffle_async_cancel_running(void **state) {
+    struct waffle_async *a;
+
+    a = waffle_display_connect_async("a");
+    wait_started(1);
+
+    // The worker cleans up once the task completes.
+    assert_true(waffle_async_cancel(a));
+    assert_int_equal(num_disconnected, 0);
+
+    open_gate();
+    wait_disconnected(1);
+    assert_true(disconnected[0] == (void*) &fake_displays[0]);
+}
+
+static void
+test_waffle_async_null(void **state) {
+    assert_false(waffle_async_poll(NULL));
+    assert_int_equal(waffle_error_get_code(), WAFFLE_ERROR_BAD_PARAMETER);
+    assert_false(waffle_async_cancel(NULL));
+    assert_int_equal(waffle_error_get_code(), WAFFLE_ERROR_BAD_PARAMETER);
+}
+
+int
+main(void) {
+    const UnitTest tests[] = {
+        unit_test_setup_teardown(test_waffle_async_completes_in_order,
+                                 setup, teardown),
+        unit_test_setup_teardown(test_waffle_async_cancel_pending,
+                                 setup, teardown),
+        unit_test_setup_teardown(test_waffle_async_cancel_completed,
+                                 setup, teardown),
+        unit_test_setup_teardown(test_waffle_async_cancel_running,
+                                 setup, teardown),
+        unit_test(test_waffle_async_null),
+    };
+
+    mtx_init(&stub_mutex, mtx_plain);
+    cnd_init(&stub_cond);
+
+    return run_tests(tests);
+}
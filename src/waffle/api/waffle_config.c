@@ -23,13 +23,222 @@
 // OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
 // OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
 
+#include "threads.h"
+
 #include "api_priv.h"
 
+#include "wcore_atomic.h"
 #include "wcore_config_attrs.h"
 #include "wcore_config.h"
+#include "wcore_context.h"
 #include "wcore_display.h"
 #include "wcore_error.h"
 #include "wcore_platform.h"
+#include "wcore_probe.h"
+#include "wcore_trace.h"
+
+/// @brief State shared with the thread that resolves WAFFLE_CONTEXT_VERSION_MAX.
+///
+/// The probe makes a context current, so it runs on its own thread to leave
+/// the caller's current context untouched. Errors are thread-local, so the
+/// probe thread saves its error for the caller to re-emit.
+struct version_probe {
+    struct wcore_display *display;
+    struct wcore_config_attrs attrs;
+
+    int merged_version;
+    struct wcore_error_saved error;
+};
+
+static void
+set_merged_version(struct wcore_config_attrs *attrs, int merged_version)
+{
+    attrs->context_major_version = merged_version / 10;
+    attrs->context_minor_version = merged_version % 10;
+}
+
+/// Restrict the version reported by a context to what may be requested with
+/// the api and profile of @a attrs. Return 0 if none can be.
+static int
+clamp_version(const struct wcore_config_attrs *attrs, int merged_version)
+{
+    switch (attrs->context_api) {
+        case WAFFLE_CONTEXT_OPENGL:
+            // Contexts without a profile end at 3.1. A driver may still
+            // report a higher version for them.
+            if (attrs->context_profile == WAFFLE_NONE)
+                return merged_version > 31 ? 31 : merged_version;
+            return merged_version >= 32 ? merged_version : 0;
+        case WAFFLE_CONTEXT_OPENGL_ES1:
+            return merged_version > 11 ? 11 : merged_version;
+        case WAFFLE_CONTEXT_OPENGL_ES2:
+            return merged_version >= 20 ? 20 : 0;
+        case WAFFLE_CONTEXT_OPENGL_ES3:
+            if (merged_version < 30)
+                return 0;
+            return merged_version > 39 ? 39 : merged_version;
+        default:
+            return 0;
+    }
+}
+
+/// Choose a config and create a context for @a attrs. If @a merged_version is
+/// not null, also make the context current without a surface and query its
+/// version, setting @a merged_version to 0 if that fails.
+static bool
+try_create_context(struct wcore_display *dpy,
+                   const struct wcore_config_attrs *attrs,
+                   int *merged_version)
+{
+    struct wcore_platform *platform = dpy->platform;
+    const struct wcore_platform_vtbl *vtbl = wcore_vtbl(platform);
+    struct wcore_config *config;
+    struct wcore_context *ctx;
+
+    config = vtbl->config.choose(platform, dpy, attrs);
+    if (!config)
+        return false;
+
+    ctx = vtbl->context.create(platform, config, NULL);
+    if (!ctx) {
+        vtbl->config.destroy(config);
+        return false;
+    }
+
+    if (merged_version) {
+        *merged_version = 0;
+        if (vtbl->make_current(platform, dpy, NULL, ctx)) {
+            *merged_version = api_get_current_gl_version(platform,
+                                                         attrs->context_api);
+            vtbl->make_current(platform, dpy, NULL, NULL);
+        }
+    }
+
+    vtbl->context.destroy(ctx);
+    vtbl->config.destroy(config);
+    return true;
+}
+
+/// Find the highest version the display supports for the api and profile of
+/// @a probe->attrs, whose version fields hold the lowest acceptable version.
+///
+/// A context at the lowest version reports the highest version the driver
+/// supports, which a second context confirms. If the driver cannot make a
+/// context current without a surface, or the confirmation fails, then fall
+/// back to trying each known version from the highest down.
+static int
+version_probe_main(void *arg)
+{
+    static const int gl_profile_versions[] = {
+        46, 45, 44, 43, 42, 41, 40, 33, 32, 0,
+    };
+    static const int gl_versions[] = {
+        31, 30, 21, 20, 15, 14, 13, 12, 11, 10, 0,
+    };
+    static const int gles1_versions[] = { 11, 10, 0 };
+    static const int gles2_versions[] = { 20, 0 };
+    static const int gles3_versions[] = { 32, 31, 30, 0 };
+
+    struct version_probe *probe = arg;
+    struct wcore_config_attrs attrs = probe->attrs;
+    const int *candidates;
+    int floor, reported;
+
+    attrs.context_version_max = false;
+    floor = 10 * attrs.context_major_version + attrs.context_minor_version;
+
+    switch (attrs.context_api) {
+        case WAFFLE_CONTEXT_OPENGL:
+            if (attrs.context_profile == WAFFLE_NONE)
+                candidates = gl_versions;
+            else
+                candidates = gl_profile_versions;
+            break;
+        case WAFFLE_CONTEXT_OPENGL_ES1: candidates = gles1_versions; break;
+        case WAFFLE_CONTEXT_OPENGL_ES2: candidates = gles2_versions; break;
+        case WAFFLE_CONTEXT_OPENGL_ES3: candidates = gles3_versions; break;
+        default:
+            wcore_error_internal("attrs->context_api has bad value 0x%x",
+                                 attrs.context_api);
+            goto fail;
+    }
+
+    if (!try_create_context(probe->display, &attrs, &reported))
+        goto fail;
+
+    reported = clamp_version(&attrs, reported);
+    if (reported == floor) {
+        probe->merged_version = floor;
+        return 0;
+    }
+    else if (reported > floor) {
+        set_merged_version(&attrs, reported);
+        if (try_create_context(probe->display, &attrs, NULL)) {
+            probe->merged_version = reported;
+            return 0;
+        }
+    }
+
+    for (const int *v = candidates; *v > floor; ++v) {
+        if (reported && *v >= reported)
+            continue;
+
+        set_merged_version(&attrs, *v);
+        if (try_create_context(probe->display, &attrs, NULL)) {
+            probe->merged_version = *v;
+            return 0;
+        }
+    }
+
+    probe->merged_version = floor;
+    return 0;
+
+fail:
+    wcore_error_save(&probe->error);
+    return 0;
+}
+
+/// If the user requested WAFFLE_CONTEXT_VERSION_MAX, replace the version in
+/// @a attrs with the highest one the display supports. The result is cached
+/// in the display.
+static bool
+resolve_version_max(struct wcore_display *dpy,
+                    struct wcore_config_attrs *attrs)
+{
+    struct version_probe probe = {
+        .display = dpy,
+        .attrs = *attrs,
+    };
+    int merged_version;
+    thrd_t thread;
+
+    if (!attrs->context_version_max)
+        return true;
+
+    if (!wcore_display_get_max_version(dpy, attrs->context_api,
+                                       attrs->context_profile,
+                                       &merged_version)) {
+        if (thrd_create(&thread, version_probe_main, &probe) != thrd_success) {
+            wcore_errorf(WAFFLE_ERROR_UNKNOWN, "thrd_create failed");
+            return false;
+        }
+
+        thrd_join(thread, NULL);
+
+        if (!probe.merged_version) {
+            wcore_error_restore(&probe.error);
+            return false;
+        }
+
+        merged_version = probe.merged_version;
+        wcore_display_set_max_version(dpy, attrs->context_api,
+                                      attrs->context_profile, merged_version);
+    }
+
+    set_merged_version(attrs, merged_version);
+    attrs->context_version_max = false;
+    return true;
+}
 
 WAFFLE_API struct waffle_config*
 waffle_config_choose(
@@ -40,6 +249,7 @@ waffle_config_choose(
     struct wcore_display *wc_dpy = wcore_display(dpy);
     struct wcore_config_attrs attrs;
     bool ok = true;
+    uint64_t t0;
 
     const struct api_object *obj_list[] = {
         wc_dpy ? &wc_dpy->api : NULL,
@@ -52,10 +262,22 @@ waffle_config_choose(
     if (!ok)
         return NULL;
 
-    wc_self = api_platform->vtbl->config.choose(api_platform, wc_dpy, &attrs);
+    ok = resolve_version_max(wc_dpy, &attrs);
+    if (!ok)
+        return NULL;
+
+    WCORE_PROBE(config_choose_entry, wc_dpy->api.display_id,
+                attrs.context_api, attrs.samples);
+    t0 = wcore_trace_begin(WCORE_STATS_CONFIG_CHOOSE, wc_dpy);
+    wc_self = wcore_vtbl(wc_dpy->api.platform)->config.choose(
+                    wc_dpy->api.platform, wc_dpy, &attrs);
+    wcore_trace_end(WCORE_STATS_CONFIG_CHOOSE, wc_dpy, t0);
+    WCORE_PROBE(config_choose_return, wc_dpy->api.display_id, wc_self);
     if (!wc_self)
         return NULL;
 
+    wcore_display_register(wc_dpy, WCORE_OBJECT_CONFIG, &wc_self->api);
+
     return waffle_config(wc_self);
 }
 
@@ -63,6 +285,8 @@ WAFFLE_API bool
 waffle_config_destroy(struct waffle_config *self)
 {
     struct wcore_config *wc_self = wcore_config(self);
+    uint64_t t0;
+    bool ok;
 
     const struct api_object *obj_list[] = {
         wc_self ? &wc_self->api : NULL,
@@ -71,7 +295,13 @@ waffle_config_destroy(struct waffle_config *self)
     if (!api_check_entry(obj_list, 1))
         return false;
 
-    return api_platform->vtbl->config.destroy(wc_self);
+    wcore_display_unregister(wc_self->display, WCORE_OBJECT_CONFIG,
+                             &wc_self->api);
+    api_object_release_native(&wc_self->api);
+    t0 = wcore_trace_begin(WCORE_STATS_CONFIG_DESTROY, wc_self);
+    ok = wcore_vtbl(wc_self->api.platform)->config.destroy(wc_self);
+    wcore_trace_end(WCORE_STATS_CONFIG_DESTROY, wc_self, t0);
+    return ok;
 }
 
 WAFFLE_API union waffle_native_config*
@@ -86,11 +316,42 @@ waffle_config_get_native(struct waffle_config *self)
     if (!api_check_entry(obj_list, 1))
         return NULL;
 
-    if (api_platform->vtbl->config.get_native) {
-        return api_platform->vtbl->config.get_native(wc_self);
+    if (wcore_vtbl(wc_self->api.platform)->config.get_native) {
+        return wcore_vtbl(wc_self->api.platform)->config.get_native(wc_self);
     }
     else {
         wcore_error(WAFFLE_ERROR_UNSUPPORTED_ON_PLATFORM);
         return NULL;
     }
 }
+
+WAFFLE_API const union waffle_native_config*
+waffle_config_get_native_cached(struct waffle_config *self)
+{
+    struct wcore_config *wc_self = wcore_config(self);
+    union waffle_native_config *n;
+
+    const struct api_object *obj_list[] = {
+        wc_self ? &wc_self->api : NULL,
+    };
+
+    if (!api_check_entry(obj_list, 1))
+        return NULL;
+
+    n = wcore_atomic_load_ptr(&wc_self->api.native);
+    if (n)
+        return n;
+
+    if (!wcore_vtbl(wc_self->api.platform)->config.get_native) {
+        wcore_error(WAFFLE_ERROR_UNSUPPORTED_ON_PLATFORM);
+        return NULL;
+    }
+
+    n = wcore_vtbl(wc_self->api.platform)->config.get_native(wc_self);
+    if (!n)
+        return NULL;
+
+    return api_object_cache_native(
+            &wc_self->api, n,
+            wcore_vtbl(wc_self->api.platform)->config.native_size);
+}
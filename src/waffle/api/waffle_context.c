@@ -23,11 +23,193 @@
 // OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
 // OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
 
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
 #include "api_priv.h"
 
+#include "wcore_atomic.h"
 #include "wcore_context.h"
+#include "wcore_debug_stats.h"
+#include "wcore_display.h"
 #include "wcore_error.h"
+#include "wcore_ext_set.h"
+#include "wcore_gpu_timer.h"
 #include "wcore_platform.h"
+#include "wcore_probe.h"
+#include "wcore_tinfo.h"
+#include "wcore_trace.h"
+
+#define GL_EXTENSIONS           0x1F03
+#define GL_NUM_EXTENSIONS       0x821D
+#define GL_QUERY_COUNTER_BITS   0x8864
+#define GL_TIMESTAMP            0x8E28
+
+typedef const unsigned char* (*glGetString_func)(unsigned int name);
+typedef const unsigned char* (*glGetStringi_func)(unsigned int name,
+                                                  unsigned int index);
+typedef void (*glGetIntegerv_func)(unsigned int pname, int *data);
+typedef void (*glGenQueries_func)(int n, unsigned int *ids);
+typedef void (*glDeleteQueries_func)(int n, const unsigned int *ids);
+typedef void (*glQueryCounter_func)(unsigned int id, unsigned int target);
+typedef void (*glGetQueryiv_func)(unsigned int target, unsigned int pname,
+                                  int *params);
+typedef void (*glGetQueryObjectiv_func)(unsigned int id, unsigned int pname,
+                                        int *params);
+typedef void (*glGetQueryObjectui64v_func)(unsigned int id, unsigned int pname,
+                                           uint64_t *params);
+typedef void (WCORE_GL_CALLBACK *glDebugMessageCallback_func)(
+        wcore_debug_proc callback, const void *user_param);
+typedef void (WCORE_GL_CALLBACK *glDebugMessageControl_func)(
+        unsigned int source, unsigned int type, unsigned int severity,
+        int count, const unsigned int *ids, unsigned char enabled);
+
+/// Join the extensions that glGetStringi() lists into one string.
+///
+/// Core profiles removed glGetString(GL_EXTENSIONS), so contexts of version
+/// 3.0 or later are queried this way.
+static char*
+join_indexed_extensions(struct wcore_context *ctx)
+{
+    struct wcore_platform *platform = ctx->api.platform;
+    glGetIntegerv_func get_integerv;
+    glGetStringi_func get_stringi;
+    size_t len = 0, pos = 0;
+    char *joined;
+    int n = 0;
+
+    get_integerv = (glGetIntegerv_func)
+        api_get_gl_proc(platform, ctx->context_api, "glGetIntegerv");
+    get_stringi = (glGetStringi_func)
+        api_get_gl_proc(platform, ctx->context_api, "glGetStringi");
+    if (!get_integerv || !get_stringi) {
+        wcore_errorf(WAFFLE_ERROR_UNKNOWN,
+                     "failed to find glGetIntegerv or glGetStringi");
+        return NULL;
+    }
+
+    get_integerv(GL_NUM_EXTENSIONS, &n);
+
+    for (int i = 0; i < n; ++i) {
+        const char *e = (const char*) get_stringi(GL_EXTENSIONS, i);
+        if (e)
+            len += strlen(e) + 1;
+    }
+
+    joined = malloc(len + 1);
+    if (!joined) {
+        wcore_error(WAFFLE_ERROR_BAD_ALLOC);
+        return NULL;
+    }
+
+    for (int i = 0; i < n; ++i) {
+        const char *e = (const char*) get_stringi(GL_EXTENSIONS, i);
+        size_t e_len;
+
+        if (!e)
+            continue;
+
+        e_len = strlen(e);
+        if (pos + e_len + 1 > len)
+            break;
+
+        memcpy(joined + pos, e, e_len);
+        pos += e_len;
+        joined[pos++] = ' ';
+    }
+
+    joined[pos] = '\0';
+    return joined;
+}
+
+/// Build the extension set of @a ctx, which is current in the calling thread.
+static struct wcore_ext_set*
+create_extension_set(struct wcore_context *ctx)
+{
+    struct wcore_platform *platform = ctx->api.platform;
+    struct wcore_ext_set *set;
+    char *joined = NULL;
+    const char *extensions;
+    bool ok;
+
+    if (ctx->context_api != WAFFLE_CONTEXT_OPENGL_ES1 &&
+        api_get_current_gl_version(platform, ctx->context_api) >= 30) {
+        joined = join_indexed_extensions(ctx);
+        if (!joined)
+            return NULL;
+        extensions = joined;
+    }
+    else {
+        glGetString_func get_string = (glGetString_func)
+            api_get_gl_proc(platform, ctx->context_api, "glGetString");
+
+        extensions = get_string
+                   ? (const char*) get_string(GL_EXTENSIONS)
+                   : NULL;
+        if (!extensions) {
+            wcore_errorf(WAFFLE_ERROR_UNKNOWN,
+                         "glGetString(GL_EXTENSIONS) failed");
+            return NULL;
+        }
+    }
+
+    set = wcore_calloc(sizeof(*set));
+    ok = set && wcore_ext_set_init(set, extensions);
+    free(joined);
+
+    if (!ok) {
+        free(set);
+        return NULL;
+    }
+
+    return set;
+}
+
+/// Return the extension set of @a ctx, built if it is current in the calling
+/// thread.
+static struct wcore_ext_set*
+get_extension_set(struct wcore_context *ctx)
+{
+    struct wcore_ext_set *set;
+
+    set = wcore_atomic_load_ptr((void**) &ctx->extensions);
+    if (set)
+        return set;
+
+    set = create_extension_set(ctx);
+    if (!set)
+        return NULL;
+
+    if (!wcore_atomic_cas_ptr((void**) &ctx->extensions, NULL, set)) {
+        wcore_ext_set_finish(set);
+        free(set);
+        set = wcore_atomic_load_ptr((void**) &ctx->extensions);
+    }
+
+    return set;
+}
+
+/// Number the new context @a ctx and register it with its display.
+static void
+register_context(struct wcore_context *ctx)
+{
+    static size_t serial_counter = 0;
+
+    ctx->serial = wcore_atomic_inc_size(&serial_counter);
+    wcore_display_register(ctx->display, WCORE_OBJECT_CONTEXT, &ctx->api);
+}
+
+/// Give @a ctx its debug stats, if @a config asks for them.
+static bool
+create_debug_stats(struct wcore_context *ctx, struct wcore_config *config)
+{
+    if (!config->attrs.debug_stats)
+        return true;
+
+    ctx->debug_stats = wcore_debug_stats_create();
+    return ctx->debug_stats != NULL;
+}
 
 WAFFLE_API struct waffle_context*
 waffle_context_create(
@@ -37,6 +219,7 @@ waffle_context_create(
     struct wcore_context *wc_self;
     struct wcore_config *wc_config = wcore_config(config);
     struct wcore_context *wc_shared_ctx = wcore_context(shared_ctx);
+    uint64_t t0;
 
     const struct api_object *obj_list[2];
     int len = 0;
@@ -48,19 +231,119 @@ waffle_context_create(
     if (!api_check_entry(obj_list, len))
         return NULL;
 
-    wc_self = api_platform->vtbl->context.create(api_platform,
-                                                 wc_config,
-                                                 wc_shared_ctx);
+    WCORE_PROBE(context_create_entry, wc_config->api.display_id, wc_config,
+                wc_shared_ctx);
+    t0 = wcore_trace_begin(WCORE_STATS_CONTEXT_CREATE, wc_config);
+    wc_self = wcore_vtbl(wc_config->api.platform)->context.create(
+                    wc_config->api.platform,
+                    wc_config,
+                    wc_shared_ctx);
+    wcore_trace_end(WCORE_STATS_CONTEXT_CREATE, wc_config, t0);
+    WCORE_PROBE(context_create_return, wc_config->api.display_id, wc_self);
     if (!wc_self)
         return NULL;
 
+    if (!create_debug_stats(wc_self, wc_config)) {
+        wcore_vtbl(wc_config->api.platform)->context.destroy(wc_self);
+        return NULL;
+    }
+
+    register_context(wc_self);
+
     return waffle_context(wc_self);
 }
 
+WAFFLE_API bool
+waffle_context_create_many(
+        struct waffle_config *config,
+        struct waffle_context *shared_ctx,
+        int32_t count,
+        struct waffle_context *contexts[])
+{
+    struct wcore_config *wc_config = wcore_config(config);
+    struct wcore_context *wc_shared_ctx = wcore_context(shared_ctx);
+    struct wcore_context **wc_contexts = (struct wcore_context**) contexts;
+    const struct wcore_platform_vtbl *vtbl;
+
+    const struct api_object *obj_list[2];
+    int len = 0;
+
+    obj_list[len++] = wc_config ? &wc_config->api : NULL;
+    if (wc_shared_ctx)
+        obj_list[len++] = &wc_shared_ctx->api;
+
+    if (!api_check_entry(obj_list, len))
+        return false;
+
+    if (count < 1 || !contexts) {
+        wcore_errorf(WAFFLE_ERROR_BAD_PARAMETER,
+                     "count must be positive and contexts non-null");
+        return false;
+    }
+
+    vtbl = wcore_vtbl(wc_config->api.platform);
+
+    if (vtbl->context.create_many) {
+        uint64_t t0;
+        bool ok;
+
+        WCORE_PROBE(context_create_many_entry, wc_config->api.display_id,
+                    wc_config, wc_shared_ctx, count);
+        t0 = wcore_trace_begin(WCORE_STATS_CONTEXT_CREATE_MANY, wc_config);
+        ok = vtbl->context.create_many(wc_config->api.platform, wc_config,
+                                       wc_shared_ctx, count, wc_contexts);
+        wcore_trace_end(WCORE_STATS_CONTEXT_CREATE_MANY, wc_config, t0);
+        WCORE_PROBE(context_create_many_return, wc_config->api.display_id,
+                    ok);
+        if (!ok)
+            return false;
+    }
+    else {
+        for (int32_t i = 0; i < count; ++i) {
+            struct wcore_context *share = i == 0 ? wc_shared_ctx
+                                                 : wc_contexts[0];
+            uint64_t t0;
+
+            WCORE_PROBE(context_create_entry, wc_config->api.display_id,
+                        wc_config, share);
+            t0 = wcore_trace_begin(WCORE_STATS_CONTEXT_CREATE, wc_config);
+            wc_contexts[i] = vtbl->context.create(wc_config->api.platform,
+                                                  wc_config, share);
+            wcore_trace_end(WCORE_STATS_CONTEXT_CREATE, wc_config, t0);
+            WCORE_PROBE(context_create_return, wc_config->api.display_id,
+                        wc_contexts[i]);
+            if (!wc_contexts[i]) {
+                while (i-- > 0) {
+                    vtbl->context.destroy(wc_contexts[i]);
+                    wc_contexts[i] = NULL;
+                }
+                return false;
+            }
+        }
+    }
+
+    for (int32_t i = 0; i < count; ++i) {
+        if (!create_debug_stats(wc_contexts[i], wc_config)) {
+            for (int32_t j = 0; j < count; ++j) {
+                vtbl->context.destroy(wc_contexts[j]);
+                wc_contexts[j] = NULL;
+            }
+            return false;
+        }
+    }
+
+    for (int32_t i = 0; i < count; ++i)
+        register_context(wc_contexts[i]);
+
+    return true;
+}
+
 WAFFLE_API bool
 waffle_context_destroy(struct waffle_context *self)
 {
     struct wcore_context *wc_self = wcore_context(self);
+    uint64_t t0;
+    bool ok;
 
     const struct api_object *obj_list[] = {
         wc_self ? &wc_self->api : NULL,
@@ -69,7 +352,22 @@ waffle_context_destroy(struct waffle_context *self)
     if (!api_check_entry(obj_list, 1))
         return false;
 
-    return api_platform->vtbl->context.destroy(wc_self);
+    wcore_display_unregister(wc_self->display, WCORE_OBJECT_CONTEXT,
+                             &wc_self->api);
+    api_object_release_native(&wc_self->api);
+
+    if (wcore_tinfo_get()->current_context == wc_self) {
+        // The context outlives its destruction while it is current. Where
+        // it is current elsewhere, the callback stays, but finds no stats
+        // once they are freed.
+        wcore_debug_stats_uninstall(wc_self->debug_stats);
+        wcore_tinfo_get()->current_context = NULL;
+    }
+
+    t0 = wcore_trace_begin(WCORE_STATS_CONTEXT_DESTROY, wc_self);
+    ok = wcore_vtbl(wc_self->api.platform)->context.destroy(wc_self);
+    wcore_trace_end(WCORE_STATS_CONTEXT_DESTROY, wc_self, t0);
+    return ok;
 }
 
 WAFFLE_API union waffle_native_context*
@@ -84,11 +382,233 @@ waffle_context_get_native(struct waffle_context *self)
     if (!api_check_entry(obj_list, 1))
         return NULL;
 
-    if (api_platform->vtbl->context.get_native) {
-        return api_platform->vtbl->context.get_native(wc_self);
+    if (wcore_vtbl(wc_self->api.platform)->context.get_native) {
+        return wcore_vtbl(wc_self->api.platform)->context.get_native(wc_self);
     }
     else {
         wcore_error(WAFFLE_ERROR_UNSUPPORTED_ON_PLATFORM);
         return NULL;
     }
 }
+
+WAFFLE_API const union waffle_native_context*
+waffle_context_get_native_cached(struct waffle_context *self)
+{
+    struct wcore_context *wc_self = wcore_context(self);
+    union waffle_native_context *n;
+
+    const struct api_object *obj_list[] = {
+        wc_self ? &wc_self->api : NULL,
+    };
+
+    if (!api_check_entry(obj_list, 1))
+        return NULL;
+
+    n = wcore_atomic_load_ptr(&wc_self->api.native);
+    if (n)
+        return n;
+
+    if (!wcore_vtbl(wc_self->api.platform)->context.get_native) {
+        wcore_error(WAFFLE_ERROR_UNSUPPORTED_ON_PLATFORM);
+        return NULL;
+    }
+
+    n = wcore_vtbl(wc_self->api.platform)->context.get_native(wc_self);
+    if (!n)
+        return NULL;
+
+    return api_object_cache_native(
+            &wc_self->api, n,
+            wcore_vtbl(wc_self->api.platform)->context.native_size);
+}
+
+WAFFLE_API bool
+waffle_context_has_extension(struct waffle_context *self, const char *name)
+{
+    struct wcore_context *wc_self = wcore_context(self);
+    struct wcore_ext_set *set;
+
+    const struct api_object *obj_list[] = {
+        wc_self ? &wc_self->api : NULL,
+    };
+
+    if (!api_check_entry(obj_list, 1))
+        return false;
+
+    if (!name) {
+        wcore_errorf(WAFFLE_ERROR_BAD_PARAMETER, "name is null");
+        return false;
+    }
+
+    if (!wcore_atomic_load_ptr((void**) &wc_self->extensions) &&
+        wcore_tinfo_get()->current_context != wc_self) {
+        wcore_errorf(WAFFLE_ERROR_BAD_PARAMETER,
+                     "the first query of a context's extensions requires "
+                     "the context to be current in the calling thread");
+        return false;
+    }
+
+    set = get_extension_set(wc_self);
+    if (!set)
+        return false;
+
+    return wcore_ext_set_has(set, name);
+}
+
+WAFFLE_API bool
+waffle_context_get_debug_stats(struct waffle_context *self,
+                               struct waffle_debug_stats *stats)
+{
+    struct wcore_context *wc_self = wcore_context(self);
+
+    const struct api_object *obj_list[] = {
+        wc_self ? &wc_self->api : NULL,
+    };
+
+    if (!api_check_entry(obj_list, 1))
+        return false;
+
+    if (!stats) {
+        wcore_errorf(WAFFLE_ERROR_BAD_PARAMETER, "stats is null");
+        return false;
+    }
+
+    if (!wc_self->debug_stats) {
+        wcore_errorf(WAFFLE_ERROR_BAD_PARAMETER,
+                     "the context's config lacks WAFFLE_CONTEXT_DEBUG_STATS");
+        return false;
+    }
+
+    if (wc_self->debug_stats->unsupported) {
+        wcore_errorf(WAFFLE_ERROR_UNSUPPORTED_ON_PLATFORM,
+                     "the context supports neither GL_KHR_debug nor "
+                     "GL_ARB_debug_output");
+        return false;
+    }
+
+    wcore_debug_stats_get(wc_self->debug_stats, stats);
+    return true;
+}
+
+/// Look up @a func, with @a suffix appended, for contexts like @a ctx.
+static void*
+get_suffixed_proc(struct wcore_context *ctx, const char *func,
+                  const char *suffix)
+{
+    char name[64];
+
+    snprintf(name, sizeof(name), "%s%s", func, suffix);
+    return api_get_gl_proc(ctx->api.platform, ctx->context_api, name);
+}
+
+bool
+api_get_gpu_timer_gl(struct wcore_context *ctx,
+                     struct wcore_gpu_timer_gl *gl)
+{
+    struct wcore_platform *platform = ctx->api.platform;
+    struct wcore_ext_set *set;
+    const char *suffix;
+
+    switch (ctx->context_api) {
+        case WAFFLE_CONTEXT_OPENGL:
+            suffix = "";
+            if (api_get_current_gl_version(platform, ctx->context_api) < 33) {
+                set = get_extension_set(ctx);
+                if (!set || !wcore_ext_set_has(set, "GL_ARB_timer_query"))
+                    return false;
+            }
+            gl->get_integerv = NULL;
+            break;
+        case WAFFLE_CONTEXT_OPENGL_ES2:
+        case WAFFLE_CONTEXT_OPENGL_ES3:
+            suffix = "EXT";
+            set = get_extension_set(ctx);
+            if (!set || !wcore_ext_set_has(set, "GL_EXT_disjoint_timer_query"))
+                return false;
+            gl->get_integerv = (glGetIntegerv_func)
+                api_get_gl_proc(platform, ctx->context_api, "glGetIntegerv");
+            if (!gl->get_integerv)
+                return false;
+            break;
+        default:
+            return false;
+    }
+
+    gl->gen_queries = (glGenQueries_func)
+        get_suffixed_proc(ctx, "glGenQueries", suffix);
+    gl->delete_queries = (glDeleteQueries_func)
+        get_suffixed_proc(ctx, "glDeleteQueries", suffix);
+    gl->query_counter = (glQueryCounter_func)
+        get_suffixed_proc(ctx, "glQueryCounter", suffix);
+    gl->get_query_objectiv = (glGetQueryObjectiv_func)
+        get_suffixed_proc(ctx, "glGetQueryObjectiv", suffix);
+    gl->get_query_objectui64v = (glGetQueryObjectui64v_func)
+        get_suffixed_proc(ctx, "glGetQueryObjectui64v", suffix);
+
+    if (!gl->gen_queries || !gl->delete_queries || !gl->query_counter ||
+        !gl->get_query_objectiv || !gl->get_query_objectui64v)
+        return false;
+
+    // An OpenGL ES implementation may expose the extension with timestamps
+    // of zero bits, that is, without timestamps.
+    if (ctx->context_api != WAFFLE_CONTEXT_OPENGL) {
+        glGetQueryiv_func get_queryiv = (glGetQueryiv_func)
+            get_suffixed_proc(ctx, "glGetQueryiv", suffix);
+        int bits = 0;
+
+        if (!get_queryiv)
+            return false;
+
+        get_queryiv(GL_TIMESTAMP, GL_QUERY_COUNTER_BITS, &bits);
+        if (bits == 0)
+            return false;
+    }
+
+    return true;
+}
+
+bool
+api_get_debug_stats_gl(struct wcore_context *ctx,
+                       struct wcore_debug_stats_gl *gl)
+{
+    struct wcore_platform *platform = ctx->api.platform;
+    int version = api_get_current_gl_version(platform, ctx->context_api);
+    struct wcore_ext_set *set;
+    const char *suffix;
+
+    switch (ctx->context_api) {
+        case WAFFLE_CONTEXT_OPENGL:
+            suffix = "";
+            if (version >= 43)
+                break;
+            set = get_extension_set(ctx);
+            if (!set)
+                return false;
+            if (wcore_ext_set_has(set, "GL_KHR_debug"))
+                break;
+            if (!wcore_ext_set_has(set, "GL_ARB_debug_output"))
+                return false;
+            suffix = "ARB";
+            break;
+        case WAFFLE_CONTEXT_OPENGL_ES2:
+        case WAFFLE_CONTEXT_OPENGL_ES3:
+            // OpenGL ES suffixes the functions of GL_KHR_debug.
+            suffix = "";
+            if (version >= 32)
+                break;
+            set = get_extension_set(ctx);
+            if (!set || !wcore_ext_set_has(set, "GL_KHR_debug"))
+                return false;
+            suffix = "KHR";
+            break;
+        default:
+            return false;
+    }
+
+    gl->debug_message_callback = (glDebugMessageCallback_func)
+        get_suffixed_proc(ctx, "glDebugMessageCallback", suffix);
+    gl->debug_message_control = (glDebugMessageControl_func)
+        get_suffixed_proc(ctx, "glDebugMessageControl", suffix);
+
+    return gl->debug_message_callback && gl->debug_message_control;
+}
@@ -23,30 +23,216 @@
 // OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
 // OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
 
+#include <stdio.h>
+#include <stdlib.h>
+
 #include "api_priv.h"
 
+#include "wcore_atomic.h"
+#include "wcore_config.h"
+#include "wcore_context.h"
+#include "wcore_disk_cache.h"
 #include "wcore_error.h"
 #include "wcore_display.h"
+#include "wcore_memory.h"
 #include "wcore_platform.h"
+#include "wcore_probe.h"
+#include "wcore_tinfo.h"
+#include "wcore_trace.h"
+#include "wcore_window.h"
 #include "wcore_util.h"
 
-WAFFLE_API struct waffle_display*
-waffle_display_connect(const char *name)
+/// Open the display's capability cache, if the platform enables one.
+///
+/// Failure leaves the display without a cache and is not an error.
+static void
+waffle_display_open_disk_cache(struct wcore_display *wc_self)
+{
+    struct wcore_platform *platform = wc_self->platform;
+    char driver_id[512];
+    char key[640];
+    char *dir;
+
+    if (!platform->capability_cache ||
+        !wcore_vtbl(platform)->display.get_driver_id)
+        return;
+
+    if (!wcore_vtbl(platform)->display.get_driver_id(wc_self, driver_id,
+                                                     sizeof(driver_id)))
+        return;
+
+    snprintf(key, sizeof(key), "platform=%#x %s",
+             platform->waffle_platform, driver_id);
+
+    dir = wcore_disk_cache_default_dir();
+    if (!dir)
+        return;
+
+    wc_self->disk_cache = wcore_disk_cache_open(dir, key);
+    free(dir);
+}
+
+static struct waffle_display*
+waffle_display_connect_platform(struct wcore_platform *platform,
+                                const char *name)
 {
     struct wcore_display *wc_self;
+    uint64_t t0;
 
+    WCORE_PROBE(display_connect_entry, platform->waffle_platform, name);
+    t0 = wcore_trace_begin(WCORE_STATS_DISPLAY_CONNECT, platform);
+    wc_self = wcore_vtbl(platform)->display.connect(platform, name);
+    wcore_trace_end(WCORE_STATS_DISPLAY_CONNECT, platform, t0);
+    WCORE_PROBE(display_connect_return,
+                wc_self ? wc_self->api.display_id : 0, wc_self);
+    if (!wc_self)
+        return NULL;
+
+    wcore_trace_object("display", wc_self, true);
+    waffle_display_open_disk_cache(wc_self);
+    return waffle_display(wc_self);
+}
+
+WAFFLE_API struct waffle_display*
+waffle_display_connect(const char *name)
+{
     if (!api_check_entry(NULL, 0))
         return NULL;
 
-    wc_self = api_platform->vtbl->display.connect(api_platform, name);
-    if (!wc_self)
+    return waffle_display_connect_platform(api_platform, name);
+}
+
+WAFFLE_API struct waffle_display*
+waffle_instance_display_connect(struct waffle_instance *instance,
+                                const char *name)
+{
+    struct wcore_platform *wc_instance = wcore_platform(instance);
+
+    if (!api_check_instance(wc_instance))
         return NULL;
 
-    return waffle_display(wc_self);
+    return waffle_display_connect_platform(wc_instance, name);
+}
+
+/// Destroy all registered objects of the display, children before parents.
+static bool
+waffle_display_destroy_children(struct wcore_display *wc_self)
+{
+    const struct wcore_platform_vtbl *vtbl = wcore_vtbl(wc_self->api.platform);
+    struct wcore_tinfo *tinfo = wcore_tinfo_get();
+    struct api_object *obj, *next;
+    uint64_t t0, t1;
+    bool ok = true;
+
+    if (wcore_display_count(wc_self, WCORE_OBJECT_CONFIG) == 0 &&
+        wcore_display_count(wc_self, WCORE_OBJECT_CONTEXT) == 0 &&
+        wcore_display_count(wc_self, WCORE_OBJECT_WINDOW) == 0)
+        return true;
+
+    // A context cannot be destroyed while current. Other threads are
+    // responsible for releasing their own contexts.
+    if (tinfo->current_display_id == wc_self->api.display_id) {
+        wcore_debug_stats_uninstall(tinfo->current_context->debug_stats);
+        t0 = wcore_trace_begin(WCORE_STATS_MAKE_CURRENT, wc_self);
+        ok &= vtbl->make_current(wc_self->api.platform, wc_self, NULL, NULL);
+        wcore_trace_end(WCORE_STATS_MAKE_CURRENT, wc_self, t0);
+        tinfo->current_display_id = 0;
+        tinfo->current_context = NULL;
+        tinfo->current_window = NULL;
+    }
+
+    // The bulk teardown, from begin_teardown to end_teardown, is one call.
+    t0 = wcore_trace_begin(WCORE_STATS_DISPLAY_DESTROY_ALL, wc_self);
+
+    if (vtbl->display.begin_teardown)
+        vtbl->display.begin_teardown(wc_self);
+
+    for (obj = wcore_display_unregister_all(wc_self, WCORE_OBJECT_WINDOW);
+         obj; obj = next) {
+        struct wcore_window *window =
+            container_of(obj, struct wcore_window, api);
+
+        next = obj->registry_next;
+        api_object_release_native(obj);
+        t1 = wcore_trace_begin(WCORE_STATS_WINDOW_DESTROY, window);
+        ok &= vtbl->window.destroy(window);
+        wcore_trace_end(WCORE_STATS_WINDOW_DESTROY, window, t1);
+    }
+
+    for (obj = wcore_display_unregister_all(wc_self, WCORE_OBJECT_CONTEXT);
+         obj; obj = next) {
+        struct wcore_context *ctx =
+            container_of(obj, struct wcore_context, api);
+
+        next = obj->registry_next;
+        api_object_release_native(obj);
+        t1 = wcore_trace_begin(WCORE_STATS_CONTEXT_DESTROY, ctx);
+        ok &= vtbl->context.destroy(ctx);
+        wcore_trace_end(WCORE_STATS_CONTEXT_DESTROY, ctx, t1);
+    }
+
+    for (obj = wcore_display_unregister_all(wc_self, WCORE_OBJECT_CONFIG);
+         obj; obj = next) {
+        struct wcore_config *config =
+            container_of(obj, struct wcore_config, api);
+
+        next = obj->registry_next;
+        api_object_release_native(obj);
+        t1 = wcore_trace_begin(WCORE_STATS_CONFIG_DESTROY, config);
+        ok &= vtbl->config.destroy(config);
+        wcore_trace_end(WCORE_STATS_CONFIG_DESTROY, config, t1);
+    }
+
+    if (vtbl->display.end_teardown)
+        ok &= vtbl->display.end_teardown(wc_self);
+
+    wcore_trace_end(WCORE_STATS_DISPLAY_DESTROY_ALL, wc_self, t0);
+    return ok;
 }
 
 WAFFLE_API bool
 waffle_display_disconnect(struct waffle_display *self)
+{
+    struct wcore_display *wc_self = wcore_display(self);
+    bool ok = true;
+    uint64_t t0;
+
+    const struct api_object *obj_list[] = {
+        wc_self ? &wc_self->api : NULL,
+    };
+
+    if (!api_check_entry(obj_list, 1))
+        return false;
+
+    ok &= waffle_display_destroy_children(wc_self);
+    api_object_release_native(&wc_self->api);
+    wcore_trace_object("display", wc_self, false);
+    t0 = wcore_trace_begin(WCORE_STATS_DISPLAY_DISCONNECT, wc_self);
+    ok &= wcore_vtbl(wc_self->api.platform)->display.destroy(wc_self);
+    wcore_trace_end(WCORE_STATS_DISPLAY_DISCONNECT, wc_self, t0);
+    return ok;
+}
+
+WAFFLE_API bool
+waffle_display_destroy_all(struct waffle_display *self)
+{
+    struct wcore_display *wc_self = wcore_display(self);
+
+    const struct api_object *obj_list[] = {
+        wc_self ? &wc_self->api : NULL,
+    };
+
+    if (!api_check_entry(obj_list, 1))
+        return false;
+
+    return waffle_display_destroy_children(wc_self);
+}
+
+WAFFLE_API bool
+waffle_display_get_live_counts(struct waffle_display *self,
+                               size_t *num_configs,
+                               size_t *num_contexts,
+                               size_t *num_windows)
 {
     struct wcore_display *wc_self = wcore_display(self);
 
@@ -57,7 +243,90 @@ waffle_display_disconnect(struct waffle_display *self)
     if (!api_check_entry(obj_list, 1))
         return false;
 
-    return api_platform->vtbl->display.destroy(wc_self);
+    if (num_configs)
+        *num_configs = wcore_display_count(wc_self, WCORE_OBJECT_CONFIG);
+    if (num_contexts)
+        *num_contexts = wcore_display_count(wc_self, WCORE_OBJECT_CONTEXT);
+    if (num_windows)
+        *num_windows = wcore_display_count(wc_self, WCORE_OBJECT_WINDOW);
+
+    return true;
+}
+
+WAFFLE_API bool
+waffle_display_get_alloc_stats(struct waffle_display *self,
+                               struct waffle_alloc_stats *stats)
+{
+    struct wcore_display *wc_self = wcore_display(self);
+    struct wcore_slab_stats s;
+
+    const struct api_object *obj_list[] = {
+        wc_self ? &wc_self->api : NULL,
+    };
+
+    if (!api_check_entry(obj_list, 1))
+        return false;
+
+    if (!stats) {
+        wcore_errorf(WAFFLE_ERROR_BAD_PARAMETER, "stats is null");
+        return false;
+    }
+
+    wcore_display_get_alloc_stats(wc_self, &s);
+    stats->object_allocs = s.allocs;
+    stats->object_frees = s.frees;
+    stats->heap_allocs = s.heap_allocs;
+    stats->live_objects = s.live;
+    stats->reserved_objects = s.capacity;
+
+    return true;
+}
+
+WAFFLE_API bool
+waffle_display_get_round_trip_stats(struct waffle_display *self,
+                                    struct waffle_round_trip_stats *stats)
+{
+    struct wcore_display *wc_self = wcore_display(self);
+
+    const struct api_object *obj_list[] = {
+        wc_self ? &wc_self->api : NULL,
+    };
+
+    if (!api_check_entry(obj_list, 1))
+        return false;
+
+    if (!stats) {
+        wcore_errorf(WAFFLE_ERROR_BAD_PARAMETER, "stats is null");
+        return false;
+    }
+
+    stats->count = wcore_atomic_load_u64_relaxed(&wc_self->round_trips.count);
+    stats->wait_ns =
+        wcore_atomic_load_u64_relaxed(&wc_self->round_trips.wait_ns);
+
+    return true;
+}
+
+WAFFLE_API bool
+waffle_display_get_memory_stats(struct waffle_display *self,
+                                struct waffle_memory_stats *stats)
+{
+    struct wcore_display *wc_self = wcore_display(self);
+
+    const struct api_object *obj_list[] = {
+        wc_self ? &wc_self->api : NULL,
+    };
+
+    if (!api_check_entry(obj_list, 1))
+        return false;
+
+    if (!stats) {
+        wcore_errorf(WAFFLE_ERROR_BAD_PARAMETER, "stats is null");
+        return false;
+    }
+
+    wcore_memory_get_display_stats(wc_self, stats);
+    return true;
 }
 
 WAFFLE_API bool
@@ -66,6 +335,10 @@ waffle_display_supports_context_api(
         int32_t context_api)
 {
     struct wcore_display *wc_self = wcore_display(self);
+    char name[48];
+    int32_t cached;
+    bool supported;
+    uint64_t t0;
 
     const struct api_object *obj_list[] = {
         wc_self ? &wc_self->api : NULL,
@@ -86,8 +359,25 @@ waffle_display_supports_context_api(
             return false;
     }
 
-    return api_platform->vtbl->display.supports_context_api(wc_self,
-                                                            context_api);
+    // Only positive answers are cached. A negative one may come from a
+    // missing library, such as libGLESv2, whose installation the cache key
+    // does not see.
+    snprintf(name, sizeof(name), "supports_context_api.%#x", context_api);
+    if (wcore_disk_cache_get(wc_self->disk_cache, name, &cached) && cached)
+        return true;
+
+    t0 = wcore_trace_begin(WCORE_STATS_DISPLAY_SUPPORTS_CONTEXT_API,
+                           wc_self);
+    supported = wcore_vtbl(wc_self->api.platform)->display.supports_context_api(
+                    wc_self, context_api);
+    wcore_trace_end(WCORE_STATS_DISPLAY_SUPPORTS_CONTEXT_API,
+                    wc_self, t0);
+
+    // Don't cache a failure to answer.
+    if (supported && wcore_error_get_code() == WAFFLE_NO_ERROR)
+        wcore_disk_cache_set(wc_self->disk_cache, name, supported);
+
+    return supported;
 }
 
 WAFFLE_API union waffle_native_display*
@@ -102,11 +392,62 @@ waffle_display_get_native(struct waffle_display *self)
     if (!api_check_entry(obj_list, 1))
         return NULL;
 
-    if (api_platform->vtbl->display.get_native) {
-        return api_platform->vtbl->display.get_native(wc_self);
+    if (wcore_vtbl(wc_self->api.platform)->display.get_native) {
+        return wcore_vtbl(wc_self->api.platform)->display.get_native(wc_self);
     }
     else {
         wcore_error(WAFFLE_ERROR_UNSUPPORTED_ON_PLATFORM);
         return NULL;
     }
 }
+
+WAFFLE_API const union waffle_native_display*
+waffle_display_get_native_cached(struct waffle_display *self)
+{
+    struct wcore_display *wc_self = wcore_display(self);
+    union waffle_native_display *n;
+
+    const struct api_object *obj_list[] = {
+        wc_self ? &wc_self->api : NULL,
+    };
+
+    if (!api_check_entry(obj_list, 1))
+        return NULL;
+
+    n = wcore_atomic_load_ptr(&wc_self->api.native);
+    if (n)
+        return n;
+
+    if (!wcore_vtbl(wc_self->api.platform)->display.get_native) {
+        wcore_error(WAFFLE_ERROR_UNSUPPORTED_ON_PLATFORM);
+        return NULL;
+    }
+
+    n = wcore_vtbl(wc_self->api.platform)->display.get_native(wc_self);
+    if (!n)
+        return NULL;
+
+    return api_object_cache_native(
+            &wc_self->api, n,
+            wcore_vtbl(wc_self->api.platform)->display.native_size);
+}
+
+WAFFLE_API bool
+waffle_display_has_extension(struct waffle_display *self, const char *name)
+{
+    struct wcore_display *wc_self = wcore_display(self);
+
+    const struct api_object *obj_list[] = {
+        wc_self ? &wc_self->api : NULL,
+    };
+
+    if (!api_check_entry(obj_list, 1))
+        return false;
+
+    if (!name) {
+        wcore_errorf(WAFFLE_ERROR_BAD_PARAMETER, "name is null");
+        return false;
+    }
+
+    return wcore_ext_set_has(&wc_self->extensions, name);
+}
@@ -26,7 +26,9 @@
 #include "api_priv.h"
 
 #include "wcore_error.h"
+#include "wcore_gl_stats.h"
 #include "wcore_platform.h"
+#include "wcore_trace.h"
 
 static bool
 waffle_dl_check_enum(int32_t dl)
@@ -46,23 +48,75 @@ waffle_dl_check_enum(int32_t dl)
 WAFFLE_API bool
 waffle_dl_can_open(int32_t dl)
 {
+    uint64_t t0;
+    bool ok;
+
     if (!api_check_entry(NULL, 0))
          return false;
 
      if (!waffle_dl_check_enum(dl))
          return false;
 
-     return api_platform->vtbl->dl_can_open(api_platform, dl);
+     t0 = wcore_trace_begin(WCORE_STATS_DL_CAN_OPEN, api_platform);
+     ok = wcore_vtbl(api_platform)->dl_can_open(api_platform, dl);
+     wcore_trace_end(WCORE_STATS_DL_CAN_OPEN, api_platform, t0);
+     return ok;
 }
 
 WAFFLE_API void*
 waffle_dl_sym(int32_t dl, const char *name)
 {
+    uint64_t t0;
+    void *sym;
+
     if (!api_check_entry(NULL, 0))
         return NULL;
 
     if (!waffle_dl_check_enum(dl))
         return NULL;
 
-    return api_platform->vtbl->dl_sym(api_platform, dl, name);
+    t0 = wcore_trace_begin(WCORE_STATS_DL_SYM, api_platform);
+    sym = wcore_vtbl(api_platform)->dl_sym(api_platform, dl, name);
+    wcore_trace_end(WCORE_STATS_DL_SYM, api_platform, t0);
+    return wcore_gl_stats_wrap(name, sym);
+}
+
+WAFFLE_API bool
+waffle_instance_dl_can_open(struct waffle_instance *instance, int32_t dl)
+{
+    struct wcore_platform *wc_instance = wcore_platform(instance);
+    uint64_t t0;
+    bool ok;
+
+    if (!api_check_instance(wc_instance))
+        return false;
+
+    if (!waffle_dl_check_enum(dl))
+        return false;
+
+    t0 = wcore_trace_begin(WCORE_STATS_DL_CAN_OPEN, wc_instance);
+    ok = wcore_vtbl(wc_instance)->dl_can_open(wc_instance, dl);
+    wcore_trace_end(WCORE_STATS_DL_CAN_OPEN, wc_instance, t0);
+    return ok;
+}
+
+WAFFLE_API void*
+waffle_instance_dl_sym(struct waffle_instance *instance,
+                       int32_t dl,
+                       const char *name)
+{
+    struct wcore_platform *wc_instance = wcore_platform(instance);
+    uint64_t t0;
+    void *sym;
+
+    if (!api_check_instance(wc_instance))
+        return NULL;
+
+    if (!waffle_dl_check_enum(dl))
+        return NULL;
+
+    t0 = wcore_trace_begin(WCORE_STATS_DL_SYM, wc_instance);
+    sym = wcore_vtbl(wc_instance)->dl_sym(wc_instance, dl, name);
+    wcore_trace_end(WCORE_STATS_DL_SYM, wc_instance, t0);
+    return wcore_gl_stats_wrap(name, sym);
 }
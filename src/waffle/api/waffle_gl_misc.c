@@ -30,9 +30,15 @@
 #include "api_priv.h"
 
 #include "wcore_context.h"
+#include "wcore_debug_stats.h"
 #include "wcore_display.h"
 #include "wcore_error.h"
+#include "wcore_gl_stats.h"
+#include "wcore_gpu_timer.h"
 #include "wcore_platform.h"
+#include "wcore_probe.h"
+#include "wcore_tinfo.h"
+#include "wcore_trace.h"
 #include "wcore_window.h"
 
 WAFFLE_API bool
@@ -81,6 +87,8 @@ waffle_make_current(
     struct wcore_display *wc_dpy = wcore_display(dpy);
     struct wcore_window *wc_window = wcore_window(window);
     struct wcore_context *wc_ctx = wcore_context(ctx);
+    uint64_t t0;
+    bool ok;
 
     const struct api_object *obj_list[3];
     int len = 0;
@@ -94,17 +102,76 @@ waffle_make_current(
     if (!api_check_entry(obj_list, len))
         return false;
 
-    return api_platform->vtbl->make_current(api_platform,
-                                            wc_dpy,
-                                            wc_window,
-                                            wc_ctx);
+    WCORE_PROBE(make_current_entry, wc_dpy->api.display_id, wc_window, wc_ctx);
+    t0 = wcore_trace_begin(WCORE_STATS_MAKE_CURRENT, wc_dpy);
+    ok = wcore_vtbl(wc_dpy->api.platform)->make_current(wc_dpy->api.platform,
+                                                        wc_dpy,
+                                                        wc_window,
+                                                        wc_ctx);
+    wcore_trace_end(WCORE_STATS_MAKE_CURRENT, wc_dpy, t0);
+    WCORE_PROBE(make_current_return, wc_dpy->api.display_id, ok);
+    if (!ok)
+        return false;
+
+    wcore_tinfo_get()->current_display_id =
+        wc_ctx ? wc_dpy->api.display_id : 0;
+    wcore_tinfo_get()->current_context = wc_ctx;
+    wcore_tinfo_get()->current_window = wc_ctx ? wc_window : NULL;
+
+    if (wc_ctx)
+        wcore_gpu_timer_delete_retired(wc_ctx);
+
+    if (wc_window && wc_window->gpu_timer && wc_ctx) {
+        if (!wcore_gpu_timer_is_bound(wc_window->gpu_timer, wc_ctx->serial)) {
+            struct wcore_gpu_timer_gl gl;
+            bool supported = api_get_gpu_timer_gl(wc_ctx, &gl);
+
+            wcore_gpu_timer_bind(wc_window, wc_ctx->serial,
+                                 supported ? &gl : NULL);
+        }
+        wcore_gpu_timer_make_current(wc_window);
+    }
+
+    if (wc_ctx && wc_ctx->debug_stats && !wc_ctx->debug_stats->installed &&
+        !wc_ctx->debug_stats->unsupported) {
+        struct wcore_debug_stats_gl gl;
+        bool supported = api_get_debug_stats_gl(wc_ctx, &gl);
+
+        wcore_debug_stats_install(wc_ctx->debug_stats,
+                                  supported ? &gl : NULL);
+    }
+
+    return true;
 }
 
 WAFFLE_API void*
 waffle_get_proc_address(const char *name)
 {
+    uint64_t t0;
+    void *proc;
+
     if (!api_check_entry(NULL, 0))
         return NULL;
 
-    return api_platform->vtbl->get_proc_address(api_platform, name);
+    t0 = wcore_trace_begin(WCORE_STATS_GET_PROC_ADDRESS, api_platform);
+    proc = wcore_vtbl(api_platform)->get_proc_address(api_platform, name);
+    wcore_trace_end(WCORE_STATS_GET_PROC_ADDRESS, api_platform, t0);
+    return wcore_gl_stats_wrap(name, proc);
+}
+
+WAFFLE_API void*
+waffle_instance_get_proc_address(struct waffle_instance *instance,
+                                 const char *name)
+{
+    struct wcore_platform *wc_instance = wcore_platform(instance);
+    uint64_t t0;
+    void *proc;
+
+    if (!api_check_instance(wc_instance))
+        return NULL;
+
+    t0 = wcore_trace_begin(WCORE_STATS_GET_PROC_ADDRESS, wc_instance);
+    proc = wcore_vtbl(wc_instance)->get_proc_address(wc_instance, name);
+    wcore_trace_end(WCORE_STATS_GET_PROC_ADDRESS, wc_instance, t0);
+    return wcore_gl_stats_wrap(name, proc);
 }
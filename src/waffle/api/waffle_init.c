@@ -23,24 +23,39 @@
 // OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
 // OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
 
+#include <stdio.h>
+#include <stdlib.h>
+
 #include "api_priv.h"
 
+#include "wcore_atomic.h"
 #include "wcore_error.h"
 #include "wcore_platform.h"
+#include "wcore_platform_auto.h"
+#include "wcore_trace_writer.h"
+
+// WAFFLE_PLATFORM_AUTO chooses among the Linux platforms by probing.
+#if defined(WAFFLE_HAS_GBM) || defined(WAFFLE_HAS_GLX) || \
+    defined(WAFFLE_HAS_WAYLAND) || defined(WAFFLE_HAS_X11_EGL)
+#define API_HAS_LINUX_PROBE
+#include "linux_platform_probe.h"
+#endif
 
 struct wcore_platform* cgl_platform_create(void);
 struct wcore_platform* droid_platform_create(void);
 struct wcore_platform* glx_platform_create(void);
-struct wcore_platform* wayland_platform_create(void);
-struct wcore_platform* xegl_platform_create(void);
-struct wcore_platform* wgbm_platform_create(void);
+struct wcore_platform* wayland_platform_create(int32_t fast_start);
+struct wcore_platform* xegl_platform_create(int32_t fast_start);
+struct wcore_platform* wgbm_platform_create(int32_t fast_start);
 struct wcore_platform* wgl_platform_create(void);
 struct wcore_platform* nacl_platform_create(void);
 
 static bool
 waffle_init_parse_attrib_list(
         const int32_t attrib_list[],
-        int *platform)
+        int *platform,
+        int32_t *fast_start,
+        bool *capability_cache)
 {
     bool found_platform = false;
 
@@ -111,6 +126,11 @@ waffle_init_parse_attrib_list(
                     CASE_UNDEFINED_PLATFORM(NACL)
 #endif
 
+                    case WAFFLE_PLATFORM_AUTO:
+                        found_platform = true;
+                        *platform = value;
+                        break;
+
                     default:
                         wcore_errorf(WAFFLE_ERROR_BAD_ATTRIBUTE,
                                      "WAFFLE_PLATFORM has bad value 0x%x",
@@ -121,6 +141,31 @@ waffle_init_parse_attrib_list(
                     #undef CASE_UNDEFINED_PLATFORM
                 }
 
+                break;
+            case WAFFLE_FAST_START:
+                switch (value) {
+                    case WAFFLE_NONE:
+                    case WAFFLE_FAST_START_LAZY:
+                    case WAFFLE_FAST_START_PREFETCH:
+                        *fast_start = value;
+                        break;
+                    default:
+                        wcore_errorf(WAFFLE_ERROR_BAD_ATTRIBUTE,
+                                     "WAFFLE_FAST_START has bad value 0x%x",
+                                     value);
+                        return false;
+                }
+
+                break;
+            case WAFFLE_CAPABILITY_CACHE:
+                if (value != true && value != false) {
+                    wcore_errorf(WAFFLE_ERROR_BAD_ATTRIBUTE,
+                                 "WAFFLE_CAPABILITY_CACHE has bad value 0x%x",
+                                 value);
+                    return false;
+                }
+
+                *capability_cache = value;
                 break;
             default:
                 wcore_errorf(WAFFLE_ERROR_BAD_ATTRIBUTE,
@@ -139,8 +184,9 @@ waffle_init_parse_attrib_list(
     return true;
 }
 
+/// Platforms that cannot defer loading their libraries ignore @a fast_start.
 static struct wcore_platform*
-waffle_init_create_platform(int32_t waffle_platform)
+waffle_init_create_platform(int32_t waffle_platform, int32_t fast_start)
 {
     switch (waffle_platform) {
 #ifdef WAFFLE_HAS_ANDROID
@@ -157,15 +203,15 @@ waffle_init_create_platform(int32_t waffle_platform)
 #endif
 #ifdef WAFFLE_HAS_WAYLAND
         case  WAFFLE_PLATFORM_WAYLAND:
-            return wayland_platform_create();
+            return wayland_platform_create(fast_start);
 #endif
 #ifdef WAFFLE_HAS_X11_EGL
         case WAFFLE_PLATFORM_X11_EGL:
-            return xegl_platform_create();
+            return xegl_platform_create(fast_start);
 #endif
 #ifdef WAFFLE_HAS_GBM
         case WAFFLE_PLATFORM_GBM:
-            return wgbm_platform_create();
+            return wgbm_platform_create(fast_start);
 #endif
 #ifdef WAFFLE_HAS_WGL
         case WAFFLE_PLATFORM_WGL:
@@ -181,26 +227,178 @@ waffle_init_create_platform(int32_t waffle_platform)
     }
 }
 
+/// Probe for WAFFLE_PLATFORM_AUTO and rank the candidates.
+static size_t
+waffle_init_rank_platforms(struct wcore_platform_candidate out[])
+{
+    struct wcore_platform_probe probe = {
+#ifdef WAFFLE_HAS_GBM
+        .built_gbm = true,
+#endif
+#ifdef WAFFLE_HAS_WAYLAND
+        .built_wayland = true,
+#endif
+#ifdef WAFFLE_HAS_X11_EGL
+        .built_x11_egl = true,
+#endif
+#ifdef WAFFLE_HAS_GLX
+        .built_glx = true,
+#endif
+    };
+
+#ifdef API_HAS_LINUX_PROBE
+    linux_platform_probe(&probe);
+    return wcore_platform_auto_rank(&probe, out);
+#else
+    (void) probe;
+
+    // Elsewhere, waffle supports a single platform.
+    #define RETURN_ONLY_PLATFORM(name, why) \
+        out[0].platform = WAFFLE_PLATFORM_##name; \
+        out[0].reason = why; \
+        return 1;
+
+#if defined(WAFFLE_HAS_ANDROID)
+    RETURN_ONLY_PLATFORM(ANDROID, "the only platform on Android")
+#elif defined(WAFFLE_HAS_CGL)
+    RETURN_ONLY_PLATFORM(CGL, "the only platform on MacOS")
+#elif defined(WAFFLE_HAS_WGL)
+    RETURN_ONLY_PLATFORM(WGL, "the only platform on Windows")
+#elif defined(WAFFLE_HAS_NACL)
+    RETURN_ONLY_PLATFORM(NACL, "the only platform on Native Client")
+#else
+    return 0;
+#endif
+
+    #undef RETURN_ONLY_PLATFORM
+#endif
+}
+
+/// Create the first of the ranked candidates that succeeds.
+static struct wcore_platform*
+waffle_init_create_auto(int32_t fast_start)
+{
+    struct wcore_platform_candidate candidates[WCORE_PLATFORM_AUTO_MAX];
+    struct wcore_platform *platform;
+    size_t n;
+
+    n = waffle_init_rank_platforms(candidates);
+    if (n == 0) {
+        wcore_errorf(WAFFLE_ERROR_UNKNOWN,
+                     "WAFFLE_PLATFORM_AUTO found no usable platform");
+        return NULL;
+    }
+
+    // Report the error of the last candidate if all fail.
+    for (size_t i = 0; i < n; ++i) {
+        const struct wcore_platform_vtbl *vtbl;
+
+        wcore_error_reset();
+
+        platform = waffle_init_create_platform(candidates[i].platform,
+                                               fast_start);
+        if (!platform)
+            continue;
+
+        // With fast start, create succeeds without loading anything. Load
+        // now if there is another candidate to fall back to, and keep the
+        // deferred load only for the last one.
+        vtbl = wcore_vtbl(platform);
+        if (i + 1 < n && vtbl->load && !vtbl->load(platform)) {
+            vtbl->destroy(platform);
+            continue;
+        }
+
+        platform->waffle_platform = candidates[i].platform;
+        platform->reason = candidates[i].reason;
+        return platform;
+    }
+
+    return NULL;
+}
+
+/// If WAFFLE_TRACE names a file, trace the instance into it.
+static void
+waffle_init_open_trace(struct wcore_platform *wc_platform)
+{
+    const char *path = getenv("WAFFLE_TRACE");
+
+    if (!path || !path[0])
+        return;
+
+    wc_platform->trace_writer = wcore_trace_writer_acquire(path);
+    if (!wc_platform->trace_writer)
+        fprintf(stderr, "waffle: warning: failed to open WAFFLE_TRACE "
+                "file %s\n", path);
+}
+
+static struct wcore_platform*
+waffle_init_create_instance(const int32_t *attrib_list)
+{
+    struct wcore_platform *wc_platform;
+    int platform;
+    int32_t fast_start = WAFFLE_NONE;
+    bool capability_cache = false;
+
+    if (!waffle_init_parse_attrib_list(attrib_list, &platform, &fast_start,
+                                       &capability_cache))
+        return NULL;
+
+    if (platform == WAFFLE_PLATFORM_AUTO) {
+        wc_platform = waffle_init_create_auto(fast_start);
+    } else {
+        wc_platform = waffle_init_create_platform(platform, fast_start);
+        if (wc_platform) {
+            wc_platform->waffle_platform = platform;
+            wc_platform->reason = "requested with WAFFLE_PLATFORM";
+        }
+    }
+
+    if (wc_platform) {
+        wc_platform->capability_cache = capability_cache;
+        waffle_init_open_trace(wc_platform);
+    }
+
+    return wc_platform;
+}
+
+/// Destroy an instance and drop its reference to the trace file, which the
+/// last instance flushes.
+static bool
+waffle_init_destroy_instance(struct wcore_platform *wc_platform)
+{
+    bool trace_writer = wc_platform->trace_writer;
+    bool ok;
+
+    ok = wcore_vtbl(wc_platform)->destroy(wc_platform);
+    if (trace_writer)
+        wcore_trace_writer_release();
+
+    return ok;
+}
+
 WAFFLE_API bool
 waffle_init(const int32_t *attrib_list)
 {
-    bool ok = true;
-    int platform;
+    struct wcore_platform *platform;
 
     wcore_error_reset();
 
-    if (api_platform) {
+    if (wcore_atomic_load_ptr((void**) &api_platform)) {
         wcore_error(WAFFLE_ERROR_ALREADY_INITIALIZED);
         return false;
     }
 
-    ok &= waffle_init_parse_attrib_list(attrib_list, &platform);
-    if (!ok)
+    platform = waffle_init_create_instance(attrib_list);
+    if (!platform)
         return false;
 
-    api_platform = waffle_init_create_platform(platform);
-    if (!api_platform)
+    // Another thread may have won the race to initialize.
+    if (!wcore_atomic_cas_ptr((void**) &api_platform, NULL, platform)) {
+        waffle_init_destroy_instance(platform);
+        wcore_error(WAFFLE_ERROR_ALREADY_INITIALIZED);
         return false;
+    }
 
     return true;
 }
@@ -208,19 +406,71 @@ waffle_init(const int32_t *attrib_list)
 WAFFLE_API bool
 waffle_teardown(void)
 {
-    bool ok = true;
+    struct wcore_platform *platform;
 
     wcore_error_reset();
 
-    if (!api_platform) {
+    // Unpublish the default instance before destroying it, so that two
+    // racing calls cannot both destroy it.
+    platform = wcore_atomic_load_ptr((void**) &api_platform);
+    if (!platform ||
+        !wcore_atomic_cas_ptr((void**) &api_platform, platform, NULL)) {
         wcore_error(WAFFLE_ERROR_NOT_INITIALIZED);
         return false;
     }
 
-    ok &= api_platform->vtbl->destroy(api_platform);
-    if (!ok)
+    return waffle_init_destroy_instance(platform);
+}
+
+WAFFLE_API struct waffle_instance*
+waffle_instance_create(const int32_t *attrib_list)
+{
+    struct wcore_platform *wc_self;
+
+    wcore_error_reset();
+
+    wc_self = waffle_init_create_instance(attrib_list);
+    if (!wc_self)
+        return NULL;
+
+    return waffle_instance(wc_self);
+}
+
+WAFFLE_API bool
+waffle_instance_destroy(struct waffle_instance *self)
+{
+    struct wcore_platform *wc_self = wcore_platform(self);
+
+    if (!api_check_instance(wc_self))
         return false;
 
-    api_platform = NULL;
+    return waffle_init_destroy_instance(wc_self);
+}
+
+WAFFLE_API bool
+waffle_get_platform(int32_t *platform, const char **reason)
+{
+    if (!api_check_entry(NULL, 0))
+        return false;
+
+    return waffle_instance_get_platform(waffle_instance(api_platform),
+                                        platform, reason);
+}
+
+WAFFLE_API bool
+waffle_instance_get_platform(struct waffle_instance *self,
+                             int32_t *platform,
+                             const char **reason)
+{
+    struct wcore_platform *wc_self = wcore_platform(self);
+
+    if (!api_check_instance(wc_self))
+        return false;
+
+    if (platform)
+        *platform = wc_self->waffle_platform;
+    if (reason)
+        *reason = wc_self->reason;
+
     return true;
 }
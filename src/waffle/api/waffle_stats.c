@@ -0,0 +1,79 @@
+// Copyright 2016 Intel Corporation
+//
+// All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+//
+// - Redistributions of source code must retain the above copyright notice, this
+//   list of conditions and the following disclaimer.
+//
+// - Redistributions in binary form must reproduce the above copyright notice,
+//   this list of conditions and the following disclaimer in the documentation
+//   and/or other materials provided with the distribution.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+// DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+// FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+// DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+// SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+// CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+// OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+// OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+#include "api_priv.h"
+
+#include "wcore_error.h"
+#include "wcore_gl_stats.h"
+#include "wcore_stats.h"
+
+WAFFLE_API bool
+waffle_stats_enable(bool enable)
+{
+    wcore_error_reset();
+    wcore_stats_enable(enable);
+    return true;
+}
+
+WAFFLE_API size_t
+waffle_stats_snapshot(struct waffle_stats_entry *entries, size_t max_entries)
+{
+    wcore_error_reset();
+
+    if (!entries && max_entries) {
+        wcore_errorf(WAFFLE_ERROR_BAD_PARAMETER, "entries is null");
+        return 0;
+    }
+
+    return wcore_stats_snapshot(entries, max_entries);
+}
+
+WAFFLE_API char*
+waffle_stats_dump_json(void)
+{
+    wcore_error_reset();
+    return wcore_stats_to_json();
+}
+
+WAFFLE_API bool
+waffle_gl_stats_enable(bool enable)
+{
+    wcore_error_reset();
+    return wcore_gl_stats_enable(enable);
+}
+
+WAFFLE_API size_t
+waffle_gl_stats_snapshot(struct waffle_gl_call_stats *entries,
+                         size_t max_entries)
+{
+    wcore_error_reset();
+
+    if (!entries && max_entries) {
+        wcore_errorf(WAFFLE_ERROR_BAD_PARAMETER, "entries is null");
+        return 0;
+    }
+
+    return wcore_gl_stats_snapshot(entries, max_entries);
+}
@@ -27,10 +27,18 @@
 
 #include "api_priv.h"
 
+#include "wcore_atomic.h"
 #include "wcore_attrib_list.h"
 #include "wcore_config.h"
+#include "wcore_display.h"
 #include "wcore_error.h"
+#include "wcore_frame_stats.h"
+#include "wcore_gpu_timer.h"
+#include "wcore_memory.h"
 #include "wcore_platform.h"
+#include "wcore_probe.h"
+#include "wcore_tinfo.h"
+#include "wcore_trace.h"
 #include "wcore_window.h"
 
 WAFFLE_API struct waffle_window*
@@ -40,10 +48,13 @@ waffle_window_create2(
 {
     struct wcore_window *wc_self = NULL;
     struct wcore_config *wc_config = wcore_config(config);
+    intptr_t attrib_buf[32];
     intptr_t *attrib_list_filtered = NULL;
     intptr_t width = 1, height = 1;
     bool need_size = true;
     intptr_t fullscreen = WAFFLE_DONT_CARE;
+    intptr_t gpu_timing = WAFFLE_DONT_CARE;
+    uint64_t t0;
 
     const struct api_object *obj_list[] = {
         wc_config ? &wc_config->api : NULL,
@@ -53,7 +64,11 @@ waffle_window_create2(
         goto done;
     }
 
-    attrib_list_filtered = wcore_attrib_list_copy(attrib_list);
+    attrib_list_filtered = wcore_attrib_list_copy_buf(
+                                attrib_list, attrib_buf,
+                                sizeof(attrib_buf) / sizeof(attrib_buf[0]));
+    if (!attrib_list_filtered)
+        goto done;
 
     wcore_attrib_list_pop(attrib_list_filtered,
                           WAFFLE_WINDOW_FULLSCREEN, &fullscreen);
@@ -71,6 +86,19 @@ waffle_window_create2(
         goto done;
     }
 
+    wcore_attrib_list_pop(attrib_list_filtered,
+                          WAFFLE_WINDOW_GPU_TIMING, &gpu_timing);
+    if (gpu_timing == WAFFLE_DONT_CARE)
+        gpu_timing = 0; // default
+
+    if (gpu_timing != 0 && gpu_timing != 1) {
+        wcore_errorf(WAFFLE_ERROR_BAD_ATTRIBUTE,
+                     "WAFFLE_WINDOW_GPU_TIMING has bad value 0x%x. "
+                     "Must be true(1), false(0), or WAFFLE_DONT_CARE(-1)",
+                     gpu_timing);
+        goto done;
+    }
+
     if (!wcore_attrib_list_pop(attrib_list_filtered,
                                WAFFLE_WINDOW_WIDTH, &width) && need_size) {
         wcore_errorf(WAFFLE_ERROR_BAD_ATTRIBUTE,
@@ -108,19 +136,39 @@ waffle_window_create2(
     if (fullscreen)
         width = height = -1;
 
-    wc_self = api_platform->vtbl->window.create(api_platform,
-                                                wc_config,
-                                                (int32_t) width,
-                                                (int32_t) height,
-                                                attrib_list_filtered);
+    WCORE_PROBE(window_create_entry, wc_config->api.display_id,
+                (int32_t) width, (int32_t) height);
+    t0 = wcore_trace_begin(WCORE_STATS_WINDOW_CREATE, wc_config);
+    wc_self = wcore_vtbl(wc_config->api.platform)->window.create(
+                    wc_config->api.platform,
+                    wc_config,
+                    (int32_t) width,
+                    (int32_t) height,
+                    attrib_list_filtered);
+    wcore_trace_end(WCORE_STATS_WINDOW_CREATE, wc_config, t0);
+    WCORE_PROBE(window_create_return, wc_config->api.display_id, wc_self);
 
 done:
-    free(attrib_list_filtered);
+    wcore_attrib_list_free_buf(attrib_list_filtered, attrib_buf);
 
     if (!wc_self) {
         return NULL;
     }
 
+    wcore_atomic_store_u64_relaxed(&wc_self->buffer_bytes,
+        wcore_memory_estimate_buffers(&wc_self->memory_layout,
+                                      (int32_t) width, (int32_t) height, 0));
+
+    if (gpu_timing) {
+        wc_self->gpu_timer = wcore_gpu_timer_create();
+        if (!wc_self->gpu_timer) {
+            wcore_vtbl(wc_self->api.platform)->window.destroy(wc_self);
+            return NULL;
+        }
+    }
+
+    wcore_display_register(wc_config->display, WCORE_OBJECT_WINDOW,
+                           &wc_self->api);
     return waffle_window(wc_self);
 }
 
@@ -142,6 +190,8 @@ WAFFLE_API bool
 waffle_window_destroy(struct waffle_window *self)
 {
     struct wcore_window *wc_self = wcore_window(self);
+    uint64_t t0;
+    bool ok;
 
     const struct api_object *obj_list[] = {
         wc_self ? &wc_self->api : NULL,
@@ -150,13 +200,24 @@ waffle_window_destroy(struct waffle_window *self)
     if (!api_check_entry(obj_list, 1))
         return false;
 
-    return api_platform->vtbl->window.destroy(wc_self);
+    wcore_display_unregister(wc_self->display, WCORE_OBJECT_WINDOW,
+                             &wc_self->api);
+    api_object_release_native(&wc_self->api);
+
+    if (wcore_tinfo_get()->current_window == wc_self)
+        wcore_tinfo_get()->current_window = NULL;
+    t0 = wcore_trace_begin(WCORE_STATS_WINDOW_DESTROY, wc_self);
+    ok = wcore_vtbl(wc_self->api.platform)->window.destroy(wc_self);
+    wcore_trace_end(WCORE_STATS_WINDOW_DESTROY, wc_self, t0);
+    return ok;
 }
 
 WAFFLE_API bool
 waffle_window_show(struct waffle_window *self)
 {
     struct wcore_window *wc_self = wcore_window(self);
+    uint64_t t0;
+    bool ok;
 
     const struct api_object *obj_list[] = {
         wc_self ? &wc_self->api : NULL,
@@ -165,7 +226,10 @@ waffle_window_show(struct waffle_window *self)
     if (!api_check_entry(obj_list, 1))
         return false;
 
-    return api_platform->vtbl->window.show(wc_self);
+    t0 = wcore_trace_begin(WCORE_STATS_WINDOW_SHOW, wc_self);
+    ok = wcore_vtbl(wc_self->api.platform)->window.show(wc_self);
+    wcore_trace_end(WCORE_STATS_WINDOW_SHOW, wc_self, t0);
+    return ok;
 }
 
 WAFFLE_API bool
@@ -183,8 +247,16 @@ waffle_window_resize(
     if (!api_check_entry(obj_list, 1))
         return false;
 
-    if (api_platform->vtbl->window.resize) {
-        return api_platform->vtbl->window.resize(wc_self, width, height);
+    if (wcore_vtbl(wc_self->api.platform)->window.resize) {
+        uint64_t t0 = wcore_trace_begin(WCORE_STATS_WINDOW_RESIZE, wc_self);
+        bool ok = wcore_vtbl(wc_self->api.platform)->window.resize(wc_self, width, height);
+        wcore_trace_end(WCORE_STATS_WINDOW_RESIZE, wc_self, t0);
+        if (ok) {
+            wcore_atomic_store_u64_relaxed(&wc_self->buffer_bytes,
+                wcore_memory_estimate_buffers(&wc_self->memory_layout,
+                                              width, height, 0));
+        }
+        return ok;
     }
     else {
         wcore_error(WAFFLE_ERROR_UNSUPPORTED_ON_PLATFORM);
@@ -196,6 +268,9 @@ WAFFLE_API bool
 waffle_window_swap_buffers(struct waffle_window *self)
 {
     struct wcore_window *wc_self = wcore_window(self);
+    uint64_t swap_begin;
+    uint64_t t0;
+    bool ok;
 
     const struct api_object *obj_list[] = {
         wc_self ? &wc_self->api : NULL,
@@ -204,7 +279,149 @@ waffle_window_swap_buffers(struct waffle_window *self)
     if (!api_check_entry(obj_list, 1))
         return false;
 
-    return api_platform->vtbl->window.swap_buffers(wc_self);
+    WCORE_PROBE(window_swap_buffers_entry, wc_self->api.display_id, wc_self);
+    wcore_gpu_timer_swap(wc_self);
+    swap_begin = wcore_frame_stats_swap_begin();
+    t0 = wcore_trace_begin(WCORE_STATS_WINDOW_SWAP_BUFFERS, wc_self);
+    ok = wcore_vtbl(wc_self->api.platform)->window.swap_buffers(wc_self);
+    wcore_trace_end(WCORE_STATS_WINDOW_SWAP_BUFFERS, wc_self, t0);
+    wcore_frame_stats_swap_end(&wc_self, 1, swap_begin);
+    WCORE_PROBE(window_swap_buffers_return, wc_self->api.display_id, wc_self,
+                ok);
+    wcore_trace_frame(wc_self, &wc_self->trace_last_swap);
+    return ok;
+}
+
+/// Largest batch passed to wcore_window_vtbl::swap_buffers_many().
+#define SWAP_BATCH_SIZE 64
+
+/// Swap @a count windows of one display. Store their results at the indices
+/// given by @a index, and save the first error in @a error.
+static bool
+swap_batch(struct wcore_window *windows[],
+           const int32_t index[],
+           int32_t count,
+           bool results[],
+           struct wcore_error_saved *error)
+{
+    const struct wcore_platform_vtbl *vtbl =
+        wcore_vtbl(windows[0]->api.platform);
+    bool batch_results[SWAP_BATCH_SIZE];
+    bool ok = true;
+    uint64_t swap_begin;
+
+    for (int32_t i = 0; i < count; ++i)
+        wcore_gpu_timer_swap(windows[i]);
+
+    swap_begin = wcore_frame_stats_swap_begin();
+
+    if (vtbl->window.swap_buffers_many) {
+        uint64_t t0;
+        bool batch_ok;
+
+        WCORE_PROBE(window_swap_buffers_many_entry,
+                    windows[0]->api.display_id, count);
+        t0 = wcore_trace_begin(WCORE_STATS_WINDOW_SWAP_BUFFERS_MANY,
+                               windows[0]->display);
+        batch_ok = vtbl->window.swap_buffers_many(windows, count,
+                                                  batch_results);
+        wcore_trace_end(WCORE_STATS_WINDOW_SWAP_BUFFERS_MANY,
+                        windows[0]->display, t0);
+        WCORE_PROBE(window_swap_buffers_many_return,
+                    windows[0]->api.display_id, count, batch_ok);
+        if (!batch_ok)
+            wcore_error_save(error);
+    }
+    else {
+        for (int32_t i = 0; i < count; ++i) {
+            struct wcore_window *w = windows[i];
+            uint64_t t0;
+
+            WCORE_PROBE(window_swap_buffers_entry, w->api.display_id, w);
+            t0 = wcore_trace_begin(WCORE_STATS_WINDOW_SWAP_BUFFERS, w);
+            batch_results[i] = vtbl->window.swap_buffers(w);
+            wcore_trace_end(WCORE_STATS_WINDOW_SWAP_BUFFERS, w, t0);
+            WCORE_PROBE(window_swap_buffers_return, w->api.display_id, w,
+                        batch_results[i]);
+            if (!batch_results[i])
+                wcore_error_save(error);
+        }
+    }
+
+    // Each window of the batch is charged the time of the whole batch.
+    wcore_frame_stats_swap_end(windows, count, swap_begin);
+
+    for (int32_t i = 0; i < count; ++i) {
+        wcore_trace_frame(windows[i], &windows[i]->trace_last_swap);
+        ok &= batch_results[i];
+        if (results)
+            results[index[i]] = batch_results[i];
+    }
+
+    return ok;
+}
+
+WAFFLE_API bool
+waffle_window_swap_buffers_many(
+        struct waffle_window *windows[],
+        int32_t count,
+        bool results[])
+{
+    struct wcore_window **wc_windows = (struct wcore_window**) windows;
+    struct wcore_window *batch[SWAP_BATCH_SIZE];
+    int32_t batch_index[SWAP_BATCH_SIZE];
+    struct wcore_error_saved error = {0};
+    bool ok = true;
+
+    if (count < 0 || (count > 0 && !windows)) {
+        wcore_error_reset();
+        wcore_errorf(WAFFLE_ERROR_BAD_PARAMETER,
+                     "count must be non-negative and windows non-null");
+        return false;
+    }
+
+    for (int32_t i = 0; i < count; ++i) {
+        const struct api_object *obj_list[] = {
+            wc_windows[i] ? &wc_windows[i]->api : NULL,
+        };
+
+        if (!api_check_entry(obj_list, 1))
+            return false;
+    }
+
+    // Swap the windows display by display, so that backends can wait on each
+    // display connection once rather than once per window.
+    for (int32_t i = 0; i < count; ++i) {
+        struct wcore_display *dpy = wc_windows[i]->display;
+        int32_t n = 0;
+        bool seen = false;
+
+        for (int32_t j = 0; j < i && !seen; ++j)
+            seen = wc_windows[j]->display == dpy;
+        if (seen)
+            continue;
+
+        for (int32_t j = i; j < count; ++j) {
+            if (wc_windows[j]->display != dpy)
+                continue;
+
+            batch[n] = wc_windows[j];
+            batch_index[n] = j;
+            if (++n == SWAP_BATCH_SIZE) {
+                ok &= swap_batch(batch, batch_index, n, results, &error);
+                n = 0;
+            }
+        }
+
+        if (n > 0)
+            ok &= swap_batch(batch, batch_index, n, results, &error);
+    }
+
+    wcore_error_reset();
+    if (!ok)
+        wcore_error_restore(&error);
+
+    return ok;
 }
 
 WAFFLE_API union waffle_native_window*
@@ -219,11 +436,65 @@ waffle_window_get_native(struct waffle_window *self)
     if (!api_check_entry(obj_list, 1))
         return NULL;
 
-    if (api_platform->vtbl->window.get_native) {
-        return api_platform->vtbl->window.get_native(wc_self);
+    if (wcore_vtbl(wc_self->api.platform)->window.get_native) {
+        return wcore_vtbl(wc_self->api.platform)->window.get_native(wc_self);
     }
     else {
         wcore_error(WAFFLE_ERROR_UNSUPPORTED_ON_PLATFORM);
         return NULL;
     }
 }
+
+WAFFLE_API const union waffle_native_window*
+waffle_window_get_native_cached(struct waffle_window *self)
+{
+    struct wcore_window *wc_self = wcore_window(self);
+    union waffle_native_window *n;
+
+    const struct api_object *obj_list[] = {
+        wc_self ? &wc_self->api : NULL,
+    };
+
+    if (!api_check_entry(obj_list, 1))
+        return NULL;
+
+    n = wcore_atomic_load_ptr(&wc_self->api.native);
+    if (n)
+        return n;
+
+    if (!wcore_vtbl(wc_self->api.platform)->window.get_native) {
+        wcore_error(WAFFLE_ERROR_UNSUPPORTED_ON_PLATFORM);
+        return NULL;
+    }
+
+    n = wcore_vtbl(wc_self->api.platform)->window.get_native(wc_self);
+    if (!n)
+        return NULL;
+
+    return api_object_cache_native(
+            &wc_self->api, n,
+            wcore_vtbl(wc_self->api.platform)->window.native_size);
+}
+
+WAFFLE_API bool
+waffle_window_get_frame_stats(struct waffle_window *self,
+                              struct waffle_frame_stats *stats)
+{
+    struct wcore_window *wc_self = wcore_window(self);
+
+    const struct api_object *obj_list[] = {
+        wc_self ? &wc_self->api : NULL,
+    };
+
+    if (!api_check_entry(obj_list, 1))
+        return false;
+
+    if (!stats) {
+        wcore_errorf(WAFFLE_ERROR_BAD_PARAMETER, "stats is null");
+        return false;
+    }
+
+    wcore_frame_stats_get(wcore_atomic_load_ptr((void**) &wc_self->frame_stats),
+                          stats);
+    return true;
+}
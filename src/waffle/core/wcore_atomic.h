@@ -0,0 +1,247 @@
+// Copyright 2016 Intel Corporation
+//
+// All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+//
+// - Redistributions of source code must retain the above copyright notice, this
+//   list of conditions and the following disclaimer.
+//
+// - Redistributions in binary form must reproduce the above copyright notice,
+//   this list of conditions and the following disclaimer in the documentation
+//   and/or other materials provided with the distribution.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+// DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+// FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+// DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+// SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+// CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+// OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+// OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+/// @file
+/// @brief Minimal atomic operations.
+///
+/// Waffle is built as C99, so <stdatomic.h> is unavailable. These wrap the
+/// GCC __atomic builtins (also provided by clang) and the MSVC Interlocked
+/// intrinsics. All operations are sequentially consistent, except those named
+/// _relaxed, which only guarantee that the access is not torn.
+
+#pragma once
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+#if defined(_MSC_VER)
+#include <intrin.h>
+#endif
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/// @brief Atomically increment @a *p and return the new value.
+static inline size_t
+wcore_atomic_inc_size(size_t *p)
+{
+#if defined(__GNUC__)
+    return __atomic_add_fetch(p, 1, __ATOMIC_SEQ_CST);
+#elif defined(_MSC_VER) && defined(_WIN64)
+    return (size_t) _InterlockedIncrement64((volatile __int64*) p);
+#elif defined(_MSC_VER)
+    return (size_t) _InterlockedIncrement((volatile long*) p);
+#else
+#error "wcore_atomic: unsupported compiler"
+#endif
+}
+
+/// @brief Atomically add @a v to @a *p and return the new value.
+static inline uint64_t
+wcore_atomic_add_u64(uint64_t *p, uint64_t v)
+{
+#if defined(__GNUC__)
+    return __atomic_add_fetch(p, v, __ATOMIC_SEQ_CST);
+#elif defined(_MSC_VER)
+    return (uint64_t) _InterlockedExchangeAdd64((volatile __int64*) p,
+                                                (__int64) v) + v;
+#else
+#error "wcore_atomic: unsupported compiler"
+#endif
+}
+
+/// @brief Atomically OR @a v into @a *p.
+static inline void
+wcore_atomic_or_u32(uint32_t *p, uint32_t v)
+{
+#if defined(__GNUC__)
+    __atomic_or_fetch(p, v, __ATOMIC_SEQ_CST);
+#elif defined(_MSC_VER)
+    _InterlockedOr((volatile long*) p, (long) v);
+#else
+#error "wcore_atomic: unsupported compiler"
+#endif
+}
+
+/// @brief Atomically AND @a v into @a *p.
+static inline void
+wcore_atomic_and_u32(uint32_t *p, uint32_t v)
+{
+#if defined(__GNUC__)
+    __atomic_and_fetch(p, v, __ATOMIC_SEQ_CST);
+#elif defined(_MSC_VER)
+    _InterlockedAnd((volatile long*) p, (long) v);
+#else
+#error "wcore_atomic: unsupported compiler"
+#endif
+}
+
+/// @brief Load a 32-bit word without ordering.
+static inline uint32_t
+wcore_atomic_load_u32_relaxed(uint32_t *p)
+{
+#if defined(__GNUC__)
+    return __atomic_load_n(p, __ATOMIC_RELAXED);
+#elif defined(_MSC_VER)
+    return *(volatile uint32_t*) p;
+#else
+#error "wcore_atomic: unsupported compiler"
+#endif
+}
+
+/// @brief Load a 64-bit counter without ordering.
+static inline uint64_t
+wcore_atomic_load_u64_relaxed(uint64_t *p)
+{
+#if defined(__GNUC__)
+    return __atomic_load_n(p, __ATOMIC_RELAXED);
+#elif defined(_MSC_VER) && defined(_WIN64)
+    return *(volatile uint64_t*) p;
+#elif defined(_MSC_VER)
+    return (uint64_t) _InterlockedCompareExchange64((volatile __int64*) p, 0, 0);
+#else
+#error "wcore_atomic: unsupported compiler"
+#endif
+}
+
+/// @brief Store a 64-bit counter without ordering.
+///
+/// With wcore_atomic_load_u64_relaxed(), this lets a counter that has a single
+/// writer be updated without a locked instruction and read by other threads.
+static inline void
+wcore_atomic_store_u64_relaxed(uint64_t *p, uint64_t v)
+{
+#if defined(__GNUC__)
+    __atomic_store_n(p, v, __ATOMIC_RELAXED);
+#elif defined(_MSC_VER) && defined(_WIN64)
+    *(volatile uint64_t*) p = v;
+#elif defined(_MSC_VER)
+    _InterlockedExchange64((volatile __int64*) p, (__int64) v);
+#else
+#error "wcore_atomic: unsupported compiler"
+#endif
+}
+
+/// @brief Load a 64-bit index published by wcore_atomic_store_u64_release().
+///
+/// Writes made before the store are visible after the load.
+static inline uint64_t
+wcore_atomic_load_u64_acquire(uint64_t *p)
+{
+#if defined(__GNUC__)
+    return __atomic_load_n(p, __ATOMIC_ACQUIRE);
+#elif defined(_MSC_VER)
+    return (uint64_t) _InterlockedCompareExchange64((volatile __int64*) p, 0, 0);
+#else
+#error "wcore_atomic: unsupported compiler"
+#endif
+}
+
+/// @brief Store a 64-bit index, publishing the writes made before it.
+static inline void
+wcore_atomic_store_u64_release(uint64_t *p, uint64_t v)
+{
+#if defined(__GNUC__)
+    __atomic_store_n(p, v, __ATOMIC_RELEASE);
+#elif defined(_MSC_VER)
+    _InterlockedExchange64((volatile __int64*) p, (__int64) v);
+#else
+#error "wcore_atomic: unsupported compiler"
+#endif
+}
+
+/// @brief Atomically load a pointer.
+static inline void*
+wcore_atomic_load_ptr(void **p)
+{
+#if defined(__GNUC__)
+    return __atomic_load_n(p, __ATOMIC_SEQ_CST);
+#elif defined(_MSC_VER)
+    return _InterlockedCompareExchangePointer(p, NULL, NULL);
+#else
+#error "wcore_atomic: unsupported compiler"
+#endif
+}
+
+/// @brief Atomically store a pointer.
+static inline void
+wcore_atomic_store_ptr(void **p, void *v)
+{
+#if defined(__GNUC__)
+    __atomic_store_n(p, v, __ATOMIC_SEQ_CST);
+#elif defined(_MSC_VER)
+    _InterlockedExchangePointer(p, v);
+#else
+#error "wcore_atomic: unsupported compiler"
+#endif
+}
+
+/// @brief Atomically load a bool.
+static inline bool
+wcore_atomic_load_bool(bool *p)
+{
+#if defined(__GNUC__)
+    return __atomic_load_n(p, __ATOMIC_SEQ_CST);
+#elif defined(_MSC_VER)
+    return _InterlockedOr8((volatile char*) p, 0) != 0;
+#else
+#error "wcore_atomic: unsupported compiler"
+#endif
+}
+
+/// @brief Atomically store a bool.
+static inline void
+wcore_atomic_store_bool(bool *p, bool v)
+{
+#if defined(__GNUC__)
+    __atomic_store_n(p, v, __ATOMIC_SEQ_CST);
+#elif defined(_MSC_VER)
+    _InterlockedExchange8((volatile char*) p, v);
+#else
+#error "wcore_atomic: unsupported compiler"
+#endif
+}
+
+/// @brief If @a *p equals @a expected, replace it with @a desired.
+///
+/// Return true if the exchange happened.
+static inline bool
+wcore_atomic_cas_ptr(void **p, void *expected, void *desired)
+{
+#if defined(__GNUC__)
+    return __atomic_compare_exchange_n(p, &expected, desired, false,
+                                       __ATOMIC_SEQ_CST, __ATOMIC_SEQ_CST);
+#elif defined(_MSC_VER)
+    return _InterlockedCompareExchangePointer(p, desired, expected) == expected;
+#else
+#error "wcore_atomic: unsupported compiler"
+#endif
+}
+
+#ifdef __cplusplus
+}
+#endif
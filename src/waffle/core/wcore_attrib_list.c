@@ -205,6 +205,22 @@ wcore_attrib_list_copy(const intptr_t attrib_list[])
     return copy;
 }
 
+intptr_t*
+wcore_attrib_list_copy_buf(const intptr_t attrib_list[],
+                           intptr_t buf[], size_t buf_len)
+{
+    size_t len = wcore_attrib_list_length(attrib_list);
+
+    if (2 * len + 1 > buf_len)
+        return wcore_attrib_list_copy(attrib_list);
+
+    if (len > 0)
+        memcpy(buf, attrib_list, 2 * len * sizeof(intptr_t));
+
+    buf[2 * len] = 0;
+    return buf;
+}
+
 bool
 wcore_attrib_list_pop(
         intptr_t attrib_list[],
@@ -40,6 +40,22 @@ wcore_attrib_list_length(const intptr_t attrib_list[]);
 intptr_t*
 wcore_attrib_list_copy(const intptr_t attrib_list[]);
 
+/// @brief Copy @a attrib_list into @a buf if it fits, else into the heap.
+///
+/// @a buf has room for @a buf_len elements, including the terminal 0. Release
+/// the result with wcore_attrib_list_free_buf(), which frees it only if it is
+/// not @a buf.
+intptr_t*
+wcore_attrib_list_copy_buf(const intptr_t attrib_list[],
+                           intptr_t buf[], size_t buf_len);
+
+static inline void
+wcore_attrib_list_free_buf(intptr_t *attrib_list, intptr_t buf[])
+{
+    if (attrib_list != buf)
+        free(attrib_list);
+}
+
 bool
 wcore_attrib_list_get(
         const intptr_t *attrib_list,
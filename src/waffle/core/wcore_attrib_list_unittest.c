@@ -226,6 +226,49 @@ test_wcore_attrib_list32_update_missing_key(void **state) {
     assert_false(wcore_attrib_list32_update(attrib_list, 50, 99));
 }
 
+static void
+test_wcore_attrib_list_copy_buf_null(void **state) {
+    intptr_t buf[3] = { 7, 7, 7 };
+    intptr_t *copy;
+
+    copy = wcore_attrib_list_copy_buf(NULL, buf, 3);
+    assert_true(copy == buf);
+    assert_int_equal(buf[0], 0);
+}
+
+static void
+test_wcore_attrib_list_copy_buf_fits(void **state) {
+    const intptr_t attrib_list[] = {
+        10, 11,
+        20, 21,
+        0,
+    };
+    intptr_t buf[5];
+    intptr_t *copy;
+
+    copy = wcore_attrib_list_copy_buf(attrib_list, buf, 5);
+    assert_true(copy == buf);
+    assert_memory_equal(buf, attrib_list, sizeof(attrib_list));
+    wcore_attrib_list_free_buf(copy, buf);
+}
+
+static void
+test_wcore_attrib_list_copy_buf_too_long(void **state) {
+    const intptr_t attrib_list[] = {
+        10, 11,
+        20, 21,
+        0,
+    };
+    intptr_t buf[4];
+    intptr_t *copy;
+
+    copy = wcore_attrib_list_copy_buf(attrib_list, buf, 4);
+    assert_non_null(copy);
+    assert_true(copy != buf);
+    assert_memory_equal(copy, attrib_list, sizeof(attrib_list));
+    wcore_attrib_list_free_buf(copy, buf);
+}
+
 int
 main(void) {
     const UnitTest tests[] = {
@@ -247,6 +290,9 @@ main(void) {
         unit_test(test_wcore_attrib_list32_update_at_0),
         unit_test(test_wcore_attrib_list32_update_at_1),
         unit_test(test_wcore_attrib_list32_update_missing_key),
+        unit_test(test_wcore_attrib_list_copy_buf_null),
+        unit_test(test_wcore_attrib_list_copy_buf_fits),
+        unit_test(test_wcore_attrib_list_copy_buf_too_long),
     };
 
     return run_tests(tests);
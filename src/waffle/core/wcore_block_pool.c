@@ -0,0 +1,67 @@
+// Copyright 2016 Intel Corporation
+//
+// All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+//
+// - Redistributions of source code must retain the above copyright notice, this
+//   list of conditions and the following disclaimer.
+//
+// - Redistributions in binary form must reproduce the above copyright notice,
+//   this list of conditions and the following disclaimer in the documentation
+//   and/or other materials provided with the distribution.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+// DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+// FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+// DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+// SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+// CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+// OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+// OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+#include <stdlib.h>
+
+#include "wcore_atomic.h"
+#include "wcore_block_pool.h"
+
+struct wcore_block_pool_link*
+wcore_block_pool_acquire(struct wcore_block_pool *pool, size_t size,
+                         void *owner)
+{
+    struct wcore_block_pool_link *link, *head;
+
+    for (link = wcore_block_pool_first(pool); link; link = link->next) {
+        if (!wcore_atomic_load_ptr(&link->owner) &&
+            wcore_atomic_cas_ptr(&link->owner, NULL, owner))
+            return link;
+    }
+
+    link = calloc(1, size);
+    if (!link)
+        return NULL;
+
+    link->owner = owner;
+    do {
+        head = wcore_block_pool_first(pool);
+        link->next = head;
+    } while (!wcore_atomic_cas_ptr((void**) &pool->head, head, link));
+
+    return link;
+}
+
+void
+wcore_block_pool_release(struct wcore_block_pool_link *link)
+{
+    if (link)
+        wcore_atomic_store_ptr(&link->owner, NULL);
+}
+
+struct wcore_block_pool_link*
+wcore_block_pool_first(struct wcore_block_pool *pool)
+{
+    return wcore_atomic_load_ptr((void**) &pool->head);
+}
@@ -0,0 +1,77 @@
+// Copyright 2016 Intel Corporation
+//
+// All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+//
+// - Redistributions of source code must retain the above copyright notice, this
+//   list of conditions and the following disclaimer.
+//
+// - Redistributions in binary form must reproduce the above copyright notice,
+//   this list of conditions and the following disclaimer in the documentation
+//   and/or other materials provided with the distribution.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+// DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+// FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+// DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+// SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+// CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+// OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+// OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+/// @file
+/// @brief Lock-free pool of per-thread blocks.
+///
+/// The call statistics, the GL call statistics and the trace writer each give
+/// every thread a block that only that thread writes, while any thread may
+/// read all of them. A thread claims a block on first use and releases it
+/// when it exits, so that a later thread can reuse it. Blocks are never
+/// freed, so readers can walk the list without a lock.
+
+#pragma once
+
+#include <stddef.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/// @brief The first member of every block in a pool.
+struct wcore_block_pool_link {
+    /// The wcore_tinfo of the thread that owns the block, or null if the
+    /// block is free. Only the owner writes the block.
+    void *owner;
+
+    /// The list only grows, at its head.
+    struct wcore_block_pool_link *next;
+};
+
+/// @brief Zero-initialize.
+struct wcore_block_pool {
+    struct wcore_block_pool_link *head;
+};
+
+/// @brief Claim a free block for @a owner, or allocate one.
+///
+/// A new block has @a size bytes, all zero, and begins with a struct
+/// wcore_block_pool_link. A reused block keeps the contents its previous
+/// owner left. Return null if out of memory.
+struct wcore_block_pool_link*
+wcore_block_pool_acquire(struct wcore_block_pool *pool, size_t size,
+                         void *owner);
+
+/// @brief Return a block to its pool. @a link may be null.
+void
+wcore_block_pool_release(struct wcore_block_pool_link *link);
+
+/// @brief Return the most recently allocated block, for walking the list.
+struct wcore_block_pool_link*
+wcore_block_pool_first(struct wcore_block_pool *pool);
+
+#ifdef __cplusplus
+}
+#endif
@@ -0,0 +1,101 @@
+// Copyright 2016 Intel Corporation
+//
+// All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+//
+// - Redistributions of source code must retain the above copyright notice, this
+//   list of conditions and the following disclaimer.
+//
+// - Redistributions in binary form must reproduce the above copyright notice,
+//   this list of conditions and the following disclaimer in the documentation
+//   and/or other materials provided with the distribution.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+// DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+// FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+// DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+// SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+// CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+// OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+// OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+#include <setjmp.h>
+#include <stdarg.h>
+#include <stddef.h>
+#include <stdint.h>
+#include <stdlib.h>
+
+#include <cmocka.h>
+
+#include "wcore_block_pool.h"
+
+struct block {
+    struct wcore_block_pool_link link;
+    int value;
+};
+
+static void
+test_wcore_block_pool_one_block_per_owner(void **state) {
+    struct wcore_block_pool pool = { 0 };
+    int owner_a, owner_b;
+    struct wcore_block_pool_link *a, *b;
+
+    a = wcore_block_pool_acquire(&pool, sizeof(struct block), &owner_a);
+    b = wcore_block_pool_acquire(&pool, sizeof(struct block), &owner_b);
+    assert_non_null(a);
+    assert_non_null(b);
+    assert_true(a != b);
+    assert_true(a->owner == &owner_a);
+    assert_true(b->owner == &owner_b);
+
+    // The list holds both, newest first.
+    assert_true(wcore_block_pool_first(&pool) == b);
+    assert_true(b->next == a);
+    assert_null(a->next);
+
+    // Pools never free their blocks. Do it here for valgrind.
+    free(a);
+    free(b);
+}
+
+static void
+test_wcore_block_pool_reuse(void **state) {
+    struct wcore_block_pool pool = { 0 };
+    int owner_a, owner_b;
+    struct wcore_block_pool_link *a, *b;
+
+    a = wcore_block_pool_acquire(&pool, sizeof(struct block), &owner_a);
+    assert_non_null(a);
+    ((struct block*) a)->value = 42;
+    wcore_block_pool_release(a);
+    assert_null(a->owner);
+
+    // The next owner gets the released block, with its contents.
+    b = wcore_block_pool_acquire(&pool, sizeof(struct block), &owner_b);
+    assert_true(b == a);
+    assert_true(b->owner == &owner_b);
+    assert_int_equal(((struct block*) b)->value, 42);
+    assert_null(b->next);
+
+    free(b);
+}
+
+static void
+test_wcore_block_pool_release_null(void **state) {
+    wcore_block_pool_release(NULL);
+}
+
+int
+main(void) {
+    const UnitTest tests[] = {
+        unit_test(test_wcore_block_pool_one_block_per_owner),
+        unit_test(test_wcore_block_pool_reuse),
+        unit_test(test_wcore_block_pool_release_null),
+    };
+
+    return run_tests(tests);
+}
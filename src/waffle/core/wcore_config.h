@@ -68,6 +68,7 @@ wcore_config_init(struct wcore_config *self,
     assert(display);
 
     self->api.display_id = display->api.display_id;
+    self->api.platform = display->api.platform;
     self->display = display;
     memcpy(&self->attrs, attrs, sizeof(*attrs));
 
@@ -55,6 +55,7 @@ check_keys(const int32_t attrib_list[])
             case WAFFLE_CONTEXT_FORWARD_COMPATIBLE:
             case WAFFLE_CONTEXT_DEBUG:
             case WAFFLE_CONTEXT_ROBUST_ACCESS:
+            case WAFFLE_CONTEXT_DEBUG_STATS:
             case WAFFLE_RED_SIZE:
             case WAFFLE_GREEN_SIZE:
             case WAFFLE_BLUE_SIZE:
@@ -160,12 +161,48 @@ set_context_version_default(struct wcore_config_attrs *attrs)
     }
 }
 
+/// Set the version to the lowest that WAFFLE_CONTEXT_VERSION_MAX may resolve
+/// to. For OpenGL, that depends on whether the user requested a profile.
+static bool
+parse_context_version_max(struct wcore_config_attrs *attrs,
+                          const int32_t attrib_list[])
+{
+    int32_t minor = WAFFLE_DONT_CARE;
+    int32_t profile = WAFFLE_DONT_CARE;
+
+    wcore_attrib_list32_get(attrib_list, WAFFLE_CONTEXT_MINOR_VERSION, &minor);
+    if (minor != WAFFLE_DONT_CARE) {
+        wcore_errorf(WAFFLE_ERROR_BAD_ATTRIBUTE,
+                     "if WAFFLE_CONTEXT_MAJOR_VERSION is "
+                     "WAFFLE_CONTEXT_VERSION_MAX, then "
+                     "WAFFLE_CONTEXT_MINOR_VERSION must be absent or "
+                     "WAFFLE_DONT_CARE");
+        return false;
+    }
+
+    attrs->context_version_max = true;
+
+    if (!set_context_version_default(attrs))
+        return false;
+
+    wcore_attrib_list32_get(attrib_list, WAFFLE_CONTEXT_PROFILE, &profile);
+    if (attrs->context_api == WAFFLE_CONTEXT_OPENGL && profile != WAFFLE_NONE) {
+        attrs->context_major_version = 3;
+        attrs->context_minor_version = 2;
+    }
+
+    return true;
+}
+
 static bool
 parse_context_version(struct wcore_config_attrs *attrs,
                       const int32_t attrib_list[])
 {
     wcore_attrib_list32_get(attrib_list, WAFFLE_CONTEXT_MAJOR_VERSION,
                             &attrs->context_major_version);
+
+    if (attrs->context_major_version == WAFFLE_CONTEXT_VERSION_MAX)
+        return parse_context_version_max(attrs, attrib_list);
     wcore_attrib_list32_get(attrib_list, WAFFLE_CONTEXT_MINOR_VERSION,
                             &attrs->context_minor_version);
 
@@ -341,6 +378,7 @@ set_misc_defaults(struct wcore_config_attrs *attrs)
 
     attrs->context_debug        = false;
     attrs->context_robust       = false;
+    attrs->debug_stats          = false;
 
     attrs->rgba_size            = 0;
     attrs->red_size             = 0;
@@ -417,6 +455,7 @@ parse_misc(struct wcore_config_attrs *attrs,
 
             CASE_BOOL(WAFFLE_CONTEXT_DEBUG, context_debug, false);
             CASE_BOOL(WAFFLE_CONTEXT_ROBUST_ACCESS, context_robust, false);
+            CASE_BOOL(WAFFLE_CONTEXT_DEBUG_STATS, debug_stats, false);
             CASE_BOOL(WAFFLE_SAMPLE_BUFFERS, sample_buffers, DEFAULT_SAMPLE_BUFFERS);
             CASE_BOOL(WAFFLE_DOUBLE_BUFFERED, double_buffered, DEFAULT_DOUBLE_BUFFERED);
             CASE_BOOL(WAFFLE_ACCUM_BUFFER, accum_buffer, DEFAULT_ACCUM_BUFFER);
@@ -462,6 +501,13 @@ check_final(struct wcore_config_attrs *attrs)
         return false;
     }
 
+    if (attrs->debug_stats && !attrs->context_debug) {
+        wcore_errorf(WAFFLE_ERROR_BAD_ATTRIBUTE,
+                     "%s", "WAFFLE_CONTEXT_DEBUG_STATS requires "
+                     "WAFFLE_CONTEXT_DEBUG");
+        return false;
+    }
+
     return true;
 }
 
@@ -52,9 +52,18 @@ struct wcore_config_attrs {
 
     int32_t samples;
 
+    /// The user requested WAFFLE_CONTEXT_VERSION_MAX. The version fields hold
+    /// the lowest version that satisfies the other attributes, and the api
+    /// layer replaces them with the highest version the display supports.
+    bool context_version_max;
+
     bool context_forward_compatible;
     bool context_debug;
     bool context_robust;
+
+    /// Count the messages of the debug context, see @ref wcore_debug_stats.
+    bool debug_stats;
+
     bool double_buffered;
     bool sample_buffers;
     bool accum_buffer;
@@ -1143,6 +1143,126 @@ test_wcore_config_attrs_debug_gles3(void **state) {
     assert_memory_equal(&ts->actual_attrs, &ts->expect_attrs, sizeof(ts->expect_attrs));
 }
 
+static void
+test_wcore_config_attrs_debug_stats(void **state) {
+    struct test_state_wcore_config_attrs *ts = *state;
+
+    const int32_t attrib_list[] = {
+        WAFFLE_CONTEXT_API,                     WAFFLE_CONTEXT_OPENGL,
+        WAFFLE_CONTEXT_DEBUG,                   true,
+        WAFFLE_CONTEXT_DEBUG_STATS,             true,
+        0,
+    };
+
+    ts->expect_attrs.context_api = WAFFLE_CONTEXT_OPENGL;
+    ts->expect_attrs.context_debug = true;
+    ts->expect_attrs.debug_stats = true;
+
+    assert_true(wcore_config_attrs_parse(attrib_list, &ts->actual_attrs));
+    assert_int_equal(wcore_error_get_code(), WAFFLE_NO_ERROR);
+    assert_memory_equal(&ts->actual_attrs, &ts->expect_attrs, sizeof(ts->expect_attrs));
+}
+
+static void
+test_wcore_config_attrs_debug_stats_without_debug(void **state) {
+    struct test_state_wcore_config_attrs *ts = *state;
+
+    const int32_t attrib_list[] = {
+        WAFFLE_CONTEXT_API,                     WAFFLE_CONTEXT_OPENGL,
+        WAFFLE_CONTEXT_DEBUG_STATS,             true,
+        0,
+    };
+
+    assert_false(wcore_config_attrs_parse(attrib_list, &ts->actual_attrs));
+    assert_int_equal(wcore_error_get_code(), WAFFLE_ERROR_BAD_ATTRIBUTE);
+    assert_true(strstr(wcore_error_get_info()->message, "WAFFLE_CONTEXT_DEBUG"));
+}
+
+static void
+test_wcore_config_attrs_version_max_gl_default_profile(void **state) {
+    struct test_state_wcore_config_attrs *ts = *state;
+
+    const int32_t attrib_list[] = {
+        WAFFLE_CONTEXT_API,             WAFFLE_CONTEXT_OPENGL,
+        WAFFLE_CONTEXT_MAJOR_VERSION,   WAFFLE_CONTEXT_VERSION_MAX,
+        0,
+    };
+
+    assert_true(wcore_config_attrs_parse(attrib_list, &ts->actual_attrs));
+    assert_true(ts->actual_attrs.context_version_max);
+    assert_int_equal(ts->actual_attrs.context_major_version, 3);
+    assert_int_equal(ts->actual_attrs.context_minor_version, 2);
+    assert_int_equal(ts->actual_attrs.context_profile, WAFFLE_CONTEXT_CORE_PROFILE);
+}
+
+static void
+test_wcore_config_attrs_version_max_gl_compat(void **state) {
+    struct test_state_wcore_config_attrs *ts = *state;
+
+    const int32_t attrib_list[] = {
+        WAFFLE_CONTEXT_API,             WAFFLE_CONTEXT_OPENGL,
+        WAFFLE_CONTEXT_MAJOR_VERSION,   WAFFLE_CONTEXT_VERSION_MAX,
+        WAFFLE_CONTEXT_MINOR_VERSION,   WAFFLE_DONT_CARE,
+        WAFFLE_CONTEXT_PROFILE,         WAFFLE_CONTEXT_COMPATIBILITY_PROFILE,
+        0,
+    };
+
+    assert_true(wcore_config_attrs_parse(attrib_list, &ts->actual_attrs));
+    assert_true(ts->actual_attrs.context_version_max);
+    assert_int_equal(ts->actual_attrs.context_major_version, 3);
+    assert_int_equal(ts->actual_attrs.context_minor_version, 2);
+    assert_int_equal(ts->actual_attrs.context_profile, WAFFLE_CONTEXT_COMPATIBILITY_PROFILE);
+}
+
+static void
+test_wcore_config_attrs_version_max_gl_none_profile(void **state) {
+    struct test_state_wcore_config_attrs *ts = *state;
+
+    const int32_t attrib_list[] = {
+        WAFFLE_CONTEXT_API,             WAFFLE_CONTEXT_OPENGL,
+        WAFFLE_CONTEXT_MAJOR_VERSION,   WAFFLE_CONTEXT_VERSION_MAX,
+        WAFFLE_CONTEXT_PROFILE,         WAFFLE_NONE,
+        0,
+    };
+
+    assert_true(wcore_config_attrs_parse(attrib_list, &ts->actual_attrs));
+    assert_true(ts->actual_attrs.context_version_max);
+    assert_int_equal(ts->actual_attrs.context_major_version, 1);
+    assert_int_equal(ts->actual_attrs.context_minor_version, 0);
+    assert_int_equal(ts->actual_attrs.context_profile, WAFFLE_NONE);
+}
+
+static void
+test_wcore_config_attrs_version_max_gles3(void **state) {
+    struct test_state_wcore_config_attrs *ts = *state;
+
+    const int32_t attrib_list[] = {
+        WAFFLE_CONTEXT_API,             WAFFLE_CONTEXT_OPENGL_ES3,
+        WAFFLE_CONTEXT_MAJOR_VERSION,   WAFFLE_CONTEXT_VERSION_MAX,
+        0,
+    };
+
+    assert_true(wcore_config_attrs_parse(attrib_list, &ts->actual_attrs));
+    assert_true(ts->actual_attrs.context_version_max);
+    assert_int_equal(ts->actual_attrs.context_major_version, 3);
+    assert_int_equal(ts->actual_attrs.context_minor_version, 0);
+}
+
+static void
+test_wcore_config_attrs_version_max_with_minor_is_bad(void **state) {
+    struct test_state_wcore_config_attrs *ts = *state;
+
+    const int32_t attrib_list[] = {
+        WAFFLE_CONTEXT_API,             WAFFLE_CONTEXT_OPENGL,
+        WAFFLE_CONTEXT_MAJOR_VERSION,   WAFFLE_CONTEXT_VERSION_MAX,
+        WAFFLE_CONTEXT_MINOR_VERSION,   1,
+        0,
+    };
+
+    assert_false(wcore_config_attrs_parse(attrib_list, &ts->actual_attrs));
+    assert_int_equal(wcore_error_get_code(), WAFFLE_ERROR_BAD_ATTRIBUTE);
+}
+
 int
 main(void) {
     const UnitTest tests[] = {
@@ -1209,6 +1329,13 @@ main(void) {
         unit_test_make(test_wcore_config_attrs_debug_gles1),
         unit_test_make(test_wcore_config_attrs_debug_gles2),
         unit_test_make(test_wcore_config_attrs_debug_gles3),
+        unit_test_make(test_wcore_config_attrs_debug_stats),
+        unit_test_make(test_wcore_config_attrs_debug_stats_without_debug),
+        unit_test_make(test_wcore_config_attrs_version_max_gl_default_profile),
+        unit_test_make(test_wcore_config_attrs_version_max_gl_compat),
+        unit_test_make(test_wcore_config_attrs_version_max_gl_none_profile),
+        unit_test_make(test_wcore_config_attrs_version_max_gles3),
+        unit_test_make(test_wcore_config_attrs_version_max_with_minor_is_bad),
 
         #undef unit_test_make
     };
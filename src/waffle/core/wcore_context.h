@@ -32,6 +32,9 @@
 #include "api_object.h"
 
 #include "wcore_config.h"
+#include "wcore_debug_stats.h"
+#include "wcore_ext_set.h"
+#include "wcore_gpu_timer.h"
 #include "wcore_util.h"
 
 struct wcore_context;
@@ -41,6 +44,35 @@ union waffle_native_context;
 struct wcore_context {
     struct api_object api;
     struct wcore_display *display;
+    int32_t context_api;
+
+    /// @brief Unique among all contexts ever created, unlike their address.
+    ///
+    /// Set by waffle_context_create().
+    size_t serial;
+
+    /// @brief GL extensions of the context.
+    ///
+    /// Built by the first call to waffle_context_has_extension(), which
+    /// requires the context to be current, and freed by
+    /// wcore_context_teardown().
+    struct wcore_ext_set *extensions;
+
+    /// @brief Messages of the debug context, if its config has
+    /// WAFFLE_CONTEXT_DEBUG_STATS.
+    ///
+    /// Freed by wcore_context_teardown(), after the backend has destroyed the
+    /// native context, which no longer calls the callback.
+    struct wcore_debug_stats *debug_stats;
+
+    /// @brief Queries of GPU timers that were bound to the context, and left
+    /// it while it was not current.
+    ///
+    /// A lock-free stack, pushed by any thread and emptied by
+    /// wcore_gpu_timer_delete_retired() when the context is made current.
+    /// What remains is freed by wcore_context_teardown(); the queries
+    /// themselves went with the native context.
+    struct wcore_gpu_timer_retired *retired_queries;
 };
 
 static inline struct waffle_context*
@@ -61,7 +93,9 @@ wcore_context_init(struct wcore_context *self,
     assert(config);
 
     self->api.display_id = config->display->api.display_id;
+    self->api.platform = config->display->api.platform;
     self->display = config->display;
+    self->context_api = config->attrs.context_api;
 
     return true;
 }
@@ -69,7 +103,19 @@ wcore_context_init(struct wcore_context *self,
 static inline bool
 wcore_context_teardown(struct wcore_context *self)
 {
-    (void) self;
     assert(self);
+
+    if (self->extensions) {
+        wcore_ext_set_finish(self->extensions);
+        free(self->extensions);
+        self->extensions = NULL;
+    }
+
+    wcore_debug_stats_destroy(self->debug_stats);
+    self->debug_stats = NULL;
+
+    wcore_gpu_timer_free_retired(self->retired_queries);
+    self->retired_queries = NULL;
+
     return true;
 }
@@ -0,0 +1,282 @@
+// Copyright 2016 Intel Corporation
+//
+// All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+//
+// - Redistributions of source code must retain the above copyright notice, this
+//   list of conditions and the following disclaimer.
+//
+// - Redistributions in binary form must reproduce the above copyright notice,
+//   this list of conditions and the following disclaimer in the documentation
+//   and/or other materials provided with the distribution.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+// DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+// FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+// DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+// SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+// CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+// OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+// OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+#include <stdlib.h>
+#include <string.h>
+
+#include "wcore_atomic.h"
+#include "wcore_debug_stats.h"
+#include "wcore_trace.h"
+#include "wcore_util.h"
+
+#define GL_DONT_CARE                0x1100
+#define GL_DEBUG_TYPE_PERFORMANCE   0x8250
+
+/// The live stats, which the callback searches for its id.
+static struct {
+    mtx_t mutex;
+    struct wcore_debug_stats *head;
+} live;
+
+static once_flag live_once = ONCE_FLAG_INIT;
+
+static void
+live_init_once(void)
+{
+    mtx_init(&live.mutex, mtx_plain);
+}
+
+struct wcore_debug_stats*
+wcore_debug_stats_create(void)
+{
+    static size_t id_counter = 0;
+    struct wcore_debug_stats *self;
+
+    self = wcore_calloc(sizeof(*self));
+    if (!self)
+        return NULL;
+
+    mtx_init(&self->mutex, mtx_plain);
+    self->id = wcore_atomic_inc_size(&id_counter);
+
+    call_once(&live_once, live_init_once);
+    mtx_lock(&live.mutex);
+    self->next = live.head;
+    live.head = self;
+    mtx_unlock(&live.mutex);
+
+    return self;
+}
+
+void
+wcore_debug_stats_destroy(struct wcore_debug_stats *self)
+{
+    struct wcore_debug_stats **p;
+
+    if (!self)
+        return;
+
+    mtx_lock(&live.mutex);
+    for (p = &live.head; *p; p = &(*p)->next) {
+        if (*p == self) {
+            *p = self->next;
+            break;
+        }
+    }
+    mtx_unlock(&live.mutex);
+
+    // A callback that found the stats before they were unlinked holds
+    // their mutex until it is done with them.
+    mtx_lock(&self->mutex);
+    mtx_unlock(&self->mutex);
+
+    mtx_destroy(&self->mutex);
+    free(self);
+}
+
+void
+wcore_debug_stats_install(struct wcore_debug_stats *self,
+                          const struct wcore_debug_stats_gl *gl)
+{
+    if (!gl) {
+        self->unsupported = true;
+        return;
+    }
+
+    self->gl = *gl;
+
+    // Drivers report most performance warnings at GL_DEBUG_SEVERITY_LOW,
+    // which is disabled by default.
+    self->gl.debug_message_control(GL_DONT_CARE, GL_DEBUG_TYPE_PERFORMANCE,
+                                   GL_DONT_CARE, 0, NULL, 1);
+    self->gl.debug_message_callback(wcore_debug_stats_callback,
+                                    (const void*) (uintptr_t) self->id);
+    self->installed = true;
+}
+
+void
+wcore_debug_stats_uninstall(struct wcore_debug_stats *self)
+{
+    if (!self || !self->installed)
+        return;
+
+    self->gl.debug_message_callback(NULL, NULL);
+    self->installed = false;
+}
+
+static uint32_t
+hash_key(unsigned int source, unsigned int type, unsigned int id)
+{
+    uint32_t h = id;
+
+    h ^= (source << 16) ^ type;
+    h *= 0x9e3779b1u;
+    return h >> 16;
+}
+
+/// Count a message. Return false if the table is full.
+static bool
+count_message(struct wcore_debug_stats *self,
+              unsigned int source, unsigned int type,
+              unsigned int id, unsigned int severity)
+{
+    uint32_t i = hash_key(source, type, id) % WCORE_DEBUG_STATS_SLOTS;
+
+    for (uint32_t n = 0; n < WCORE_DEBUG_STATS_SLOTS; ++n) {
+        struct waffle_debug_message_count *slot = &self->slots[i];
+
+        if (slot->count == 0) {
+            if (self->num_counts == WAFFLE_DEBUG_STATS_MAX_COUNTS)
+                return false;
+
+            slot->source = source;
+            slot->type = type;
+            slot->id = id;
+            self->num_counts++;
+        }
+
+        if (slot->source == source && slot->type == type && slot->id == id) {
+            slot->severity = severity;
+            slot->count++;
+            return true;
+        }
+
+        i = (i + 1) % WCORE_DEBUG_STATS_SLOTS;
+    }
+
+    return false;
+}
+
+static void
+add_sample(struct wcore_debug_stats *self,
+           unsigned int source, unsigned int type,
+           unsigned int id, unsigned int severity,
+           int length, const char *message, uint64_t now)
+{
+    struct waffle_debug_sample *sample;
+    size_t len;
+    uint32_t i;
+
+    if (self->num_samples < WAFFLE_DEBUG_STATS_MAX_SAMPLES) {
+        i = (self->first_sample + self->num_samples++)
+          % WAFFLE_DEBUG_STATS_MAX_SAMPLES;
+    }
+    else {
+        i = self->first_sample;
+        self->first_sample = (i + 1) % WAFFLE_DEBUG_STATS_MAX_SAMPLES;
+    }
+
+    sample = &self->samples[i];
+    sample->source = source;
+    sample->type = type;
+    sample->id = id;
+    sample->severity = severity;
+    sample->timestamp_ns = now;
+
+    // GL_ARB_debug_output allows a negative length for null-terminated
+    // messages.
+    len = message ? (length >= 0 ? (size_t) length : strlen(message)) : 0;
+    if (len > WAFFLE_DEBUG_SAMPLE_MAX_LENGTH - 1)
+        len = WAFFLE_DEBUG_SAMPLE_MAX_LENGTH - 1;
+
+    if (len)
+        memcpy(sample->message, message, len);
+    sample->message[len] = '\0';
+}
+
+void WCORE_GL_CALLBACK
+wcore_debug_stats_callback(unsigned int source, unsigned int type,
+                           unsigned int id, unsigned int severity,
+                           int length, const char *message,
+                           const void *user_param)
+{
+    size_t stats_id = (size_t) (uintptr_t) user_param;
+    struct wcore_debug_stats *self;
+    uint64_t now = wcore_trace_now();
+
+    mtx_lock(&live.mutex);
+    for (self = live.head; self; self = self->next) {
+        if (self->id == stats_id)
+            break;
+    }
+    if (self)
+        mtx_lock(&self->mutex);
+    mtx_unlock(&live.mutex);
+
+    // The context was destroyed while current elsewhere.
+    if (!self)
+        return;
+
+    self->total_messages++;
+    if (type == GL_DEBUG_TYPE_PERFORMANCE)
+        self->performance_messages++;
+
+    if (!count_message(self, source, type, id, severity))
+        self->dropped_messages++;
+
+    add_sample(self, source, type, id, severity, length, message, now);
+
+    mtx_unlock(&self->mutex);
+}
+
+static int
+compare_counts(const void *a, const void *b)
+{
+    const struct waffle_debug_message_count *x = a;
+    const struct waffle_debug_message_count *y = b;
+
+    return (x->count < y->count) - (x->count > y->count);
+}
+
+void
+wcore_debug_stats_get(struct wcore_debug_stats *self,
+                      struct waffle_debug_stats *stats)
+{
+    uint32_t n = 0;
+
+    memset(stats, 0, sizeof(*stats));
+
+    mtx_lock(&self->mutex);
+
+    stats->total_messages = self->total_messages;
+    stats->performance_messages = self->performance_messages;
+    stats->dropped_messages = self->dropped_messages;
+
+    for (uint32_t i = 0; i < WCORE_DEBUG_STATS_SLOTS; ++i) {
+        if (self->slots[i].count)
+            stats->counts[n++] = self->slots[i];
+    }
+    stats->num_counts = n;
+
+    for (uint32_t i = 0; i < self->num_samples; ++i) {
+        uint32_t j = (self->first_sample + i) % WAFFLE_DEBUG_STATS_MAX_SAMPLES;
+        stats->samples[i] = self->samples[j];
+    }
+    stats->num_samples = self->num_samples;
+
+    mtx_unlock(&self->mutex);
+
+    qsort(stats->counts, stats->num_counts, sizeof(stats->counts[0]),
+          compare_counts);
+}
@@ -0,0 +1,162 @@
+// Copyright 2016 Intel Corporation
+//
+// All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+//
+// - Redistributions of source code must retain the above copyright notice, this
+//   list of conditions and the following disclaimer.
+//
+// - Redistributions in binary form must reproduce the above copyright notice,
+//   this list of conditions and the following disclaimer in the documentation
+//   and/or other materials provided with the distribution.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+// DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+// FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+// DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+// SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+// CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+// OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+// OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+/// @file
+/// @brief Messages a debug context reports through GL_KHR_debug.
+///
+/// A context created from a config with WAFFLE_CONTEXT_DEBUG_STATS owns a
+/// @ref wcore_debug_stats. At the context's first make-current, the api
+/// layer installs wcore_debug_stats_callback() with glDebugMessageCallback()
+/// and enables GL_DEBUG_TYPE_PERFORMANCE messages of every severity, which
+/// drivers use to report recompiles, stalls and slow paths.
+///
+/// Messages are counted by source, type and id, in a table of at most
+/// WAFFLE_DEBUG_STATS_MAX_COUNTS entries. The last
+/// WAFFLE_DEBUG_STATS_MAX_SAMPLES messages are kept, truncated, in a ring.
+///
+/// The driver may call the callback from any thread, so the stats are
+/// guarded by a mutex. It is held only to update a counter and copy one
+/// message.
+///
+/// If the application installs its own callback, it replaces waffle's, and
+/// the stats stop counting.
+///
+/// The callback is given an id, rather than the address of the stats, and
+/// looks the stats up among the live ones. A context destroyed while it is
+/// current in another thread lives on until released there, because EGL and
+/// GLX defer its destruction, and so does one destroyed by
+/// waffle_display_destroy_all() from a thread where it is not current. The
+/// callback cannot be removed from it, but its calls then find nothing.
+
+#pragma once
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+#include "threads.h"
+#include "waffle.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#ifdef _WIN32
+#   define WCORE_GL_CALLBACK __stdcall
+#else
+#   define WCORE_GL_CALLBACK
+#endif
+
+/// Size of the hash table of counters. Twice the number of counters, so
+/// that probes stay short.
+#define WCORE_DEBUG_STATS_SLOTS (2 * WAFFLE_DEBUG_STATS_MAX_COUNTS)
+
+typedef void (WCORE_GL_CALLBACK *wcore_debug_proc)(
+        unsigned int source, unsigned int type, unsigned int id,
+        unsigned int severity, int length, const char *message,
+        const void *user_param);
+
+/// @brief The GL functions of GL_KHR_debug, or of GL_ARB_debug_output.
+struct wcore_debug_stats_gl {
+    void (WCORE_GL_CALLBACK *debug_message_callback)(wcore_debug_proc callback,
+                                                     const void *user_param);
+    void (WCORE_GL_CALLBACK *debug_message_control)(unsigned int source,
+                                                    unsigned int type,
+                                                    unsigned int severity,
+                                                    int count,
+                                                    const unsigned int *ids,
+                                                    unsigned char enabled);
+};
+
+struct wcore_debug_stats {
+    mtx_t mutex;
+
+    /// Passed to the callback. Unique among all stats ever created.
+    size_t id;
+
+    /// Next in the list of live stats.
+    struct wcore_debug_stats *next;
+
+    struct wcore_debug_stats_gl gl;
+
+    /// The callback was installed. Set at the context's first make-current.
+    bool installed;
+
+    /// The callback was not installed because the context lacks
+    /// GL_KHR_debug.
+    bool unsupported;
+
+    uint64_t total_messages;
+    uint64_t performance_messages;
+    uint64_t dropped_messages;
+
+    /// Counters, by source, type and id. A slot with a zero count is free.
+    struct waffle_debug_message_count slots[WCORE_DEBUG_STATS_SLOTS];
+    uint32_t num_counts;
+
+    /// The last messages, oldest first, starting at index @a first_sample.
+    struct waffle_debug_sample samples[WAFFLE_DEBUG_STATS_MAX_SAMPLES];
+    uint32_t first_sample;
+    uint32_t num_samples;
+};
+
+struct wcore_debug_stats*
+wcore_debug_stats_create(void);
+
+void
+wcore_debug_stats_destroy(struct wcore_debug_stats *self);
+
+/// @brief Install the callback into the context that owns @a self, current
+/// in the calling thread.
+///
+/// If @a gl is null, the context does not support debug output, and the
+/// stats stay empty.
+void
+wcore_debug_stats_install(struct wcore_debug_stats *self,
+                          const struct wcore_debug_stats_gl *gl);
+
+/// @brief Remove the callback from the context that owns @a self, current in
+/// the calling thread, before the context is destroyed.
+///
+/// Do nothing if the callback was not installed.
+void
+wcore_debug_stats_uninstall(struct wcore_debug_stats *self);
+
+/// @brief The callback given to glDebugMessageCallback(). @a user_param is
+/// the id of the stats.
+void WCORE_GL_CALLBACK
+wcore_debug_stats_callback(unsigned int source, unsigned int type,
+                           unsigned int id, unsigned int severity,
+                           int length, const char *message,
+                           const void *user_param);
+
+/// @brief Copy the stats into @a stats. Counters are ordered by count,
+/// highest first.
+void
+wcore_debug_stats_get(struct wcore_debug_stats *self,
+                      struct waffle_debug_stats *stats);
+
+#ifdef __cplusplus
+}
+#endif
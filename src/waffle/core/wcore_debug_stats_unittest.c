@@ -0,0 +1,224 @@
+// Copyright 2016 Intel Corporation
+//
+// All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+//
+// - Redistributions of source code must retain the above copyright notice, this
+//   list of conditions and the following disclaimer.
+//
+// - Redistributions in binary form must reproduce the above copyright notice,
+//   this list of conditions and the following disclaimer in the documentation
+//   and/or other materials provided with the distribution.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+// DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+// FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+// DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+// SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+// CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+// OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+// OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+#include <setjmp.h>
+#include <stdarg.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include <cmocka.h>
+
+#include "wcore_debug_stats.h"
+
+#define GL_DEBUG_SOURCE_API             0x8246
+#define GL_DEBUG_TYPE_ERROR             0x824C
+#define GL_DEBUG_TYPE_PERFORMANCE       0x8250
+#define GL_DEBUG_SEVERITY_LOW           0x9148
+
+static struct waffle_debug_stats stats;
+
+static void
+message(struct wcore_debug_stats *self, unsigned int type, unsigned int id,
+        const char *text)
+{
+    wcore_debug_stats_callback(GL_DEBUG_SOURCE_API, type, id,
+                               GL_DEBUG_SEVERITY_LOW, (int) strlen(text),
+                               text, (const void*) (uintptr_t) self->id);
+}
+
+static void
+test_wcore_debug_stats_count(void **state) {
+    struct wcore_debug_stats *self = wcore_debug_stats_create();
+
+    assert_non_null(self);
+
+    message(self, GL_DEBUG_TYPE_PERFORMANCE, 7, "recompiled shader");
+    message(self, GL_DEBUG_TYPE_ERROR, 7, "invalid enum");
+    message(self, GL_DEBUG_TYPE_PERFORMANCE, 7, "recompiled shader");
+    message(self, GL_DEBUG_TYPE_PERFORMANCE, 9, "stalled on buffer");
+
+    wcore_debug_stats_get(self, &stats);
+    assert_int_equal(stats.total_messages, 4);
+    assert_int_equal(stats.performance_messages, 3);
+    assert_int_equal(stats.dropped_messages, 0);
+
+    // The same id of another type is another counter.
+    assert_int_equal(stats.num_counts, 3);
+    assert_int_equal(stats.counts[0].type, GL_DEBUG_TYPE_PERFORMANCE);
+    assert_int_equal(stats.counts[0].id, 7);
+    assert_int_equal(stats.counts[0].count, 2);
+    assert_int_equal(stats.counts[0].severity, GL_DEBUG_SEVERITY_LOW);
+    assert_int_equal(stats.counts[1].count, 1);
+    assert_int_equal(stats.counts[2].count, 1);
+
+    assert_int_equal(stats.num_samples, 4);
+    assert_string_equal(stats.samples[0].message, "recompiled shader");
+    assert_string_equal(stats.samples[3].message, "stalled on buffer");
+    assert_true(stats.samples[0].timestamp_ns <= stats.samples[3].timestamp_ns);
+
+    wcore_debug_stats_destroy(self);
+}
+
+static void
+test_wcore_debug_stats_full(void **state) {
+    struct wcore_debug_stats *self = wcore_debug_stats_create();
+
+    assert_non_null(self);
+
+    for (unsigned int id = 0; id < WAFFLE_DEBUG_STATS_MAX_COUNTS + 5; ++id)
+        message(self, GL_DEBUG_TYPE_PERFORMANCE, id, "x");
+
+    // A known id is still counted when the table is full.
+    message(self, GL_DEBUG_TYPE_PERFORMANCE, 0, "x");
+
+    wcore_debug_stats_get(self, &stats);
+    assert_int_equal(stats.total_messages, WAFFLE_DEBUG_STATS_MAX_COUNTS + 6);
+    assert_int_equal(stats.dropped_messages, 5);
+    assert_int_equal(stats.num_counts, WAFFLE_DEBUG_STATS_MAX_COUNTS);
+    assert_int_equal(stats.counts[0].id, 0);
+    assert_int_equal(stats.counts[0].count, 2);
+
+    wcore_debug_stats_destroy(self);
+}
+
+static void
+test_wcore_debug_stats_samples(void **state) {
+    struct wcore_debug_stats *self = wcore_debug_stats_create();
+    char text[2 * WAFFLE_DEBUG_SAMPLE_MAX_LENGTH];
+
+    assert_non_null(self);
+
+    for (int i = 0; i < WAFFLE_DEBUG_STATS_MAX_SAMPLES + 3; ++i) {
+        snprintf(text, sizeof(text), "message %d", i);
+        message(self, GL_DEBUG_TYPE_PERFORMANCE, 1, text);
+    }
+
+    // The ring keeps the last messages, oldest first.
+    wcore_debug_stats_get(self, &stats);
+    assert_int_equal(stats.num_samples, WAFFLE_DEBUG_STATS_MAX_SAMPLES);
+    assert_string_equal(stats.samples[0].message, "message 3");
+    snprintf(text, sizeof(text), "message %d",
+             WAFFLE_DEBUG_STATS_MAX_SAMPLES + 2);
+    assert_string_equal(stats.samples[WAFFLE_DEBUG_STATS_MAX_SAMPLES - 1].message,
+                        text);
+
+    // Long messages are truncated, and a negative length means the message
+    // is null-terminated.
+    memset(text, 'a', sizeof(text) - 1);
+    text[sizeof(text) - 1] = '\0';
+    wcore_debug_stats_callback(GL_DEBUG_SOURCE_API, GL_DEBUG_TYPE_PERFORMANCE,
+                               2, GL_DEBUG_SEVERITY_LOW, -1, text,
+                               (const void*) (uintptr_t) self->id);
+
+    wcore_debug_stats_get(self, &stats);
+    assert_int_equal(strlen(stats.samples[WAFFLE_DEBUG_STATS_MAX_SAMPLES - 1].message),
+                     WAFFLE_DEBUG_SAMPLE_MAX_LENGTH - 1);
+
+    wcore_debug_stats_destroy(self);
+}
+
+static void
+test_wcore_debug_stats_destroyed(void **state) {
+    struct wcore_debug_stats *gone = wcore_debug_stats_create();
+    struct wcore_debug_stats *self = wcore_debug_stats_create();
+    struct wcore_debug_stats stale;
+
+    assert_non_null(gone);
+    assert_non_null(self);
+
+    // A context destroyed while current elsewhere may still call back.
+    stale.id = gone->id;
+    wcore_debug_stats_destroy(gone);
+    message(&stale, GL_DEBUG_TYPE_PERFORMANCE, 1, "late message");
+
+    wcore_debug_stats_get(self, &stats);
+    assert_int_equal(stats.total_messages, 0);
+
+    message(self, GL_DEBUG_TYPE_PERFORMANCE, 1, "message");
+    wcore_debug_stats_get(self, &stats);
+    assert_int_equal(stats.total_messages, 1);
+
+    wcore_debug_stats_destroy(self);
+}
+
+static wcore_debug_proc installed_callback;
+static const void *installed_user_param;
+static unsigned int enabled_type;
+
+static void WCORE_GL_CALLBACK
+fake_debug_message_callback(wcore_debug_proc callback, const void *user_param)
+{
+    installed_callback = callback;
+    installed_user_param = user_param;
+}
+
+static void WCORE_GL_CALLBACK
+fake_debug_message_control(unsigned int source, unsigned int type,
+                           unsigned int severity, int count,
+                           const unsigned int *ids, unsigned char enabled)
+{
+    if (enabled)
+        enabled_type = type;
+}
+
+static void
+test_wcore_debug_stats_install(void **state) {
+    struct wcore_debug_stats *self = wcore_debug_stats_create();
+    const struct wcore_debug_stats_gl gl = {
+        .debug_message_callback = fake_debug_message_callback,
+        .debug_message_control = fake_debug_message_control,
+    };
+
+    assert_non_null(self);
+
+    wcore_debug_stats_install(self, &gl);
+    assert_true(self->installed);
+    assert_true(installed_callback == wcore_debug_stats_callback);
+    assert_true(installed_user_param == (const void*) (uintptr_t) self->id);
+    assert_int_equal(enabled_type, GL_DEBUG_TYPE_PERFORMANCE);
+
+    wcore_debug_stats_uninstall(self);
+    assert_false(self->installed);
+    assert_true(installed_callback == NULL);
+
+    wcore_debug_stats_install(self, NULL);
+    assert_true(self->unsupported);
+
+    wcore_debug_stats_destroy(self);
+}
+
+int
+main(void) {
+    const UnitTest tests[] = {
+        unit_test(test_wcore_debug_stats_count),
+        unit_test(test_wcore_debug_stats_full),
+        unit_test(test_wcore_debug_stats_samples),
+        unit_test(test_wcore_debug_stats_destroyed),
+        unit_test(test_wcore_debug_stats_install),
+    };
+
+    return run_tests(tests);
+}
@@ -0,0 +1,317 @@
+// Copyright 2016 Intel Corporation
+//
+// All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+//
+// - Redistributions of source code must retain the above copyright notice, this
+//   list of conditions and the following disclaimer.
+//
+// - Redistributions in binary form must reproduce the above copyright notice,
+//   this list of conditions and the following disclaimer in the documentation
+//   and/or other materials provided with the distribution.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+// DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+// FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+// DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+// SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+// CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+// OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+// OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+#include <errno.h>
+#include <inttypes.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#ifdef _WIN32
+#include <direct.h>
+#include <process.h>
+#define mkdir(path, mode) _mkdir(path)
+#define getpid _getpid
+#else
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+#include "wcore_atomic.h"
+#include "wcore_disk_cache.h"
+
+/// First line of every cache file. Bump the number if the format changes.
+static const char magic[] = "waffle capability cache 1\n";
+
+/// Keys longer than this are truncated, so that a key always fits in a line.
+#define MAX_KEY_LEN 900
+
+/// 64-bit FNV-1a.
+static uint64_t
+hash_key(const char *key)
+{
+    uint64_t h = 14695981039346656037ull;
+
+    for (const char *p = key; *p; ++p) {
+        h ^= (unsigned char) *p;
+        h *= 1099511628211ull;
+    }
+
+    return h;
+}
+
+char*
+wcore_disk_cache_default_dir(void)
+{
+    const char *xdg = getenv("XDG_CACHE_HOME");
+    const char *home = getenv("HOME");
+    const char *base, *suffix;
+    char *dir;
+    size_t len;
+
+    if (xdg && xdg[0]) {
+        base = xdg;
+        suffix = "/waffle";
+    } else if (home && home[0]) {
+        base = home;
+        suffix = "/.cache/waffle";
+    } else {
+        return NULL;
+    }
+
+    len = strlen(base) + strlen(suffix) + 1;
+    dir = malloc(len);
+    if (dir)
+        snprintf(dir, len, "%s%s", base, suffix);
+
+    return dir;
+}
+
+/// Create @a dir and its parent, if missing.
+static bool
+make_dirs(const char *dir)
+{
+    char *parent = strdup(dir);
+    char *slash;
+
+    if (!parent)
+        return false;
+
+    slash = strrchr(parent, '/');
+    if (slash && slash != parent) {
+        *slash = '\0';
+        mkdir(parent, 0755);
+    }
+
+    free(parent);
+    return mkdir(dir, 0755) == 0 || errno == EEXIST;
+}
+
+/// Read the file's entries. On any mismatch, leave the cache empty.
+static void
+read_file(struct wcore_disk_cache *self)
+{
+    char line[MAX_KEY_LEN + 16];
+    size_t key_len = strlen(self->key);
+    FILE *f;
+
+    f = fopen(self->path, "r");
+    if (!f)
+        return;
+
+    if (!fgets(line, sizeof(line), f) || strcmp(line, magic) != 0)
+        goto done;
+
+    if (!fgets(line, sizeof(line), f) ||
+        strncmp(line, "key ", 4) != 0 ||
+        strncmp(line + 4, self->key, key_len) != 0 ||
+        strcmp(line + 4 + key_len, "\n") != 0)
+        goto done;
+
+    while (self->count < WCORE_DISK_CACHE_MAX_ENTRIES &&
+           fgets(line, sizeof(line), f)) {
+        char name[sizeof(self->entries[0].name)];
+        int32_t value;
+
+        if (sscanf(line, "%47s %" SCNd32, name, &value) != 2) {
+            self->count = 0;
+            goto done;
+        }
+
+        strcpy(self->entries[self->count].name, name);
+        self->entries[self->count].value = value;
+        self->count++;
+    }
+
+done:
+    fclose(f);
+}
+
+/// Bumped for every write, so that two caches in one process never share a
+/// temporary file.
+static size_t tmp_serial;
+
+/// Write all entries to a temporary file and rename it over the cache file.
+static void
+write_file(struct wcore_disk_cache *self, const char *dir)
+{
+    size_t len = strlen(self->path) + 64;
+    char *tmp_path;
+    bool ok;
+    FILE *f;
+
+    if (!make_dirs(dir))
+        return;
+
+    tmp_path = malloc(len);
+    if (!tmp_path)
+        return;
+
+    snprintf(tmp_path, len, "%s.%ld.%lu.tmp", self->path, (long) getpid(),
+             (unsigned long) wcore_atomic_inc_size(&tmp_serial));
+
+    f = fopen(tmp_path, "w");
+    if (!f) {
+        free(tmp_path);
+        return;
+    }
+
+    ok = fputs(magic, f) >= 0 &&
+         fprintf(f, "key %s\n", self->key) > 0;
+
+    for (size_t i = 0; ok && i < self->count; ++i) {
+        ok = fprintf(f, "%s %" PRId32 "\n", self->entries[i].name,
+                     self->entries[i].value) > 0;
+    }
+
+    ok &= fclose(f) == 0;
+
+#ifdef _WIN32
+    // Windows' rename() does not replace an existing file.
+    if (ok)
+        remove(self->path);
+#endif
+
+    if (!ok || rename(tmp_path, self->path) != 0)
+        remove(tmp_path);
+
+    free(tmp_path);
+}
+
+struct wcore_disk_cache*
+wcore_disk_cache_open(const char *dir, const char *key)
+{
+    struct wcore_disk_cache *self;
+    size_t key_len = strlen(key);
+    size_t path_len;
+
+    if (key_len > MAX_KEY_LEN)
+        key_len = MAX_KEY_LEN;
+
+    self = calloc(1, sizeof(*self));
+    if (!self)
+        return NULL;
+
+    self->key = malloc(key_len + 1);
+    path_len = strlen(dir) + 32;
+    self->path = malloc(path_len);
+    if (!self->key || !self->path) {
+        wcore_disk_cache_close(self);
+        return NULL;
+    }
+
+    memcpy(self->key, key, key_len);
+    self->key[key_len] = '\0';
+    for (char *p = self->key; *p; ++p) {
+        if (*p == '\n' || *p == '\r')
+            *p = ' ';
+    }
+
+    snprintf(self->path, path_len, "%s/%016" PRIx64 ".cache", dir,
+             hash_key(self->key));
+
+    mtx_init(&self->mutex, mtx_plain);
+    read_file(self);
+    return self;
+}
+
+void
+wcore_disk_cache_close(struct wcore_disk_cache *self)
+{
+    if (!self)
+        return;
+
+    if (self->key && self->path)
+        mtx_destroy(&self->mutex);
+
+    free(self->key);
+    free(self->path);
+    free(self);
+}
+
+bool
+wcore_disk_cache_get(struct wcore_disk_cache *self,
+                     const char *name,
+                     int32_t *value)
+{
+    bool found = false;
+
+    if (!self)
+        return false;
+
+    mtx_lock(&self->mutex);
+
+    for (size_t i = 0; i < self->count; ++i) {
+        if (strcmp(self->entries[i].name, name) == 0) {
+            *value = self->entries[i].value;
+            found = true;
+            break;
+        }
+    }
+
+    mtx_unlock(&self->mutex);
+    return found;
+}
+
+void
+wcore_disk_cache_set(struct wcore_disk_cache *self,
+                     const char *name,
+                     int32_t value)
+{
+    size_t i;
+    char *dir;
+
+    if (!self || strlen(name) >= sizeof(self->entries[0].name))
+        return;
+
+    mtx_lock(&self->mutex);
+
+    for (i = 0; i < self->count; ++i) {
+        if (strcmp(self->entries[i].name, name) == 0)
+            break;
+    }
+
+    if (i == self->count) {
+        if (i == WCORE_DISK_CACHE_MAX_ENTRIES)
+            goto done;
+        self->count++;
+    } else if (self->entries[i].value == value) {
+        goto done;
+    }
+
+    strcpy(self->entries[i].name, name);
+    self->entries[i].value = value;
+
+    // The directory is the path up to the file name.
+    dir = strdup(self->path);
+    if (dir) {
+        *strrchr(dir, '/') = '\0';
+        write_file(self, dir);
+        free(dir);
+    }
+
+done:
+    mtx_unlock(&self->mutex);
+}
@@ -0,0 +1,101 @@
+// Copyright 2016 Intel Corporation
+//
+// All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+//
+// - Redistributions of source code must retain the above copyright notice, this
+//   list of conditions and the following disclaimer.
+//
+// - Redistributions in binary form must reproduce the above copyright notice,
+//   this list of conditions and the following disclaimer in the documentation
+//   and/or other materials provided with the distribution.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+// DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+// FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+// DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+// SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+// CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+// OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+// OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+/// @file
+/// @brief Persistent cache of display capabilities.
+///
+/// Enabled with the waffle_init() attribute WAFFLE_CAPABILITY_CACHE. Each
+/// display has one small text file, named after a hash of the display's key.
+/// The key names the platform, the device and the driver build, so a driver
+/// update changes the key and the stale file is never read again.
+///
+/// The cache is only an optimization. None of its functions emits an error,
+/// and any failure to read or write the file behaves as an empty cache.
+
+#pragma once
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+#include "threads.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#define WCORE_DISK_CACHE_MAX_ENTRIES 32
+
+struct wcore_disk_cache {
+    mtx_t mutex;
+
+    /// Path of the cache file.
+    char *path;
+
+    /// The key, with any newlines replaced by spaces.
+    char *key;
+
+    size_t count;
+    struct {
+        char name[48];
+        int32_t value;
+    } entries[WCORE_DISK_CACHE_MAX_ENTRIES];
+};
+
+/// @brief Return $XDG_CACHE_HOME/waffle, or else $HOME/.cache/waffle.
+///
+/// Return null if neither variable is set. Free the result with free().
+char*
+wcore_disk_cache_default_dir(void);
+
+/// @brief Open the cache file for @a key in directory @a dir.
+///
+/// Read the file's entries if it exists and was written for the same key.
+/// Return null only if memory is exhausted.
+struct wcore_disk_cache*
+wcore_disk_cache_open(const char *dir, const char *key);
+
+/// @a self may be null.
+void
+wcore_disk_cache_close(struct wcore_disk_cache *self);
+
+/// @brief Look up entry @a name. @a self may be null, which is a miss.
+bool
+wcore_disk_cache_get(struct wcore_disk_cache *self,
+                     const char *name,
+                     int32_t *value);
+
+/// @brief Set entry @a name and rewrite the file.
+///
+/// The file is replaced atomically, so concurrent processes never read a
+/// partial file. @a self may be null, which does nothing.
+void
+wcore_disk_cache_set(struct wcore_disk_cache *self,
+                     const char *name,
+                     int32_t value);
+
+#ifdef __cplusplus
+}
+#endif
@@ -0,0 +1,168 @@
+// Copyright 2016 Intel Corporation
+//
+// All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+//
+// - Redistributions of source code must retain the above copyright notice, this
+//   list of conditions and the following disclaimer.
+//
+// - Redistributions in binary form must reproduce the above copyright notice,
+//   this list of conditions and the following disclaimer in the documentation
+//   and/or other materials provided with the distribution.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+// DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+// FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+// DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+// SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+// CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+// OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+// OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+#define _GNU_SOURCE // mkdtemp()
+
+#include <setjmp.h>
+#include <stdarg.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+
+#include <cmocka.h>
+
+#include "wcore_disk_cache.h"
+
+static char dir[] = "/tmp/wcore_disk_cache_unittest.XXXXXX";
+
+static void
+remove_cache_file(struct wcore_disk_cache *cache)
+{
+    remove(cache->path);
+}
+
+static void
+test_wcore_disk_cache_roundtrip(void **state) {
+    struct wcore_disk_cache *cache;
+    int32_t value = 0;
+
+    cache = wcore_disk_cache_open(dir, "platform=gbm driver=mesa 1");
+    assert_non_null(cache);
+    assert_false(wcore_disk_cache_get(cache, "max_version", &value));
+    wcore_disk_cache_set(cache, "max_version", 46);
+    wcore_disk_cache_set(cache, "supports_context_api.0x020c", 0);
+    wcore_disk_cache_close(cache);
+
+    cache = wcore_disk_cache_open(dir, "platform=gbm driver=mesa 1");
+    assert_non_null(cache);
+    assert_true(wcore_disk_cache_get(cache, "max_version", &value));
+    assert_int_equal(value, 46);
+    assert_true(wcore_disk_cache_get(cache, "supports_context_api.0x020c",
+                                     &value));
+    assert_int_equal(value, 0);
+    remove_cache_file(cache);
+    wcore_disk_cache_close(cache);
+}
+
+static void
+test_wcore_disk_cache_other_key_misses(void **state) {
+    struct wcore_disk_cache *cache;
+    int32_t value;
+
+    cache = wcore_disk_cache_open(dir, "driver=mesa 1");
+    wcore_disk_cache_set(cache, "max_version", 46);
+    remove_cache_file(cache);
+    wcore_disk_cache_close(cache);
+
+    cache = wcore_disk_cache_open(dir, "driver=mesa 2");
+    assert_false(wcore_disk_cache_get(cache, "max_version", &value));
+    wcore_disk_cache_close(cache);
+}
+
+/// A file whose key line differs, as after a hash collision, is ignored.
+static void
+test_wcore_disk_cache_key_mismatch(void **state) {
+    struct wcore_disk_cache *cache;
+    int32_t value;
+    FILE *f;
+
+    cache = wcore_disk_cache_open(dir, "driver=mesa 1");
+    f = fopen(cache->path, "w");
+    assert_non_null(f);
+    fputs("waffle capability cache 1\nkey driver=other\nmax_version 46\n", f);
+    fclose(f);
+    wcore_disk_cache_close(cache);
+
+    cache = wcore_disk_cache_open(dir, "driver=mesa 1");
+    assert_false(wcore_disk_cache_get(cache, "max_version", &value));
+    remove_cache_file(cache);
+    wcore_disk_cache_close(cache);
+}
+
+static void
+test_wcore_disk_cache_corrupt_file(void **state) {
+    struct wcore_disk_cache *cache;
+    int32_t value;
+    FILE *f;
+
+    cache = wcore_disk_cache_open(dir, "driver=mesa 1");
+    f = fopen(cache->path, "w");
+    assert_non_null(f);
+    fputs("waffle capability cache 1\nkey driver=mesa 1\nmax_version\n", f);
+    fclose(f);
+    wcore_disk_cache_close(cache);
+
+    cache = wcore_disk_cache_open(dir, "driver=mesa 1");
+    assert_false(wcore_disk_cache_get(cache, "max_version", &value));
+    remove_cache_file(cache);
+    wcore_disk_cache_close(cache);
+}
+
+static void
+test_wcore_disk_cache_null(void **state) {
+    int32_t value;
+
+    assert_false(wcore_disk_cache_get(NULL, "max_version", &value));
+    wcore_disk_cache_set(NULL, "max_version", 46);
+    wcore_disk_cache_close(NULL);
+}
+
+static void
+test_wcore_disk_cache_default_dir(void **state) {
+    char *d;
+
+    setenv("XDG_CACHE_HOME", "/xdg", 1);
+    d = wcore_disk_cache_default_dir();
+    assert_string_equal(d, "/xdg/waffle");
+    free(d);
+
+    unsetenv("XDG_CACHE_HOME");
+    setenv("HOME", "/home/u", 1);
+    d = wcore_disk_cache_default_dir();
+    assert_string_equal(d, "/home/u/.cache/waffle");
+    free(d);
+}
+
+int
+main(void) {
+    const UnitTest tests[] = {
+        unit_test(test_wcore_disk_cache_roundtrip),
+        unit_test(test_wcore_disk_cache_other_key_misses),
+        unit_test(test_wcore_disk_cache_key_mismatch),
+        unit_test(test_wcore_disk_cache_corrupt_file),
+        unit_test(test_wcore_disk_cache_null),
+        unit_test(test_wcore_disk_cache_default_dir),
+    };
+    int ret;
+
+    if (!mkdtemp(dir))
+        return 1;
+
+    ret = run_tests(tests);
+    rmdir(dir);
+    return ret;
+}
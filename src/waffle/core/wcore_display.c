@@ -25,32 +25,30 @@
 
 #include <assert.h>
 #include <stdio.h>
+#include <string.h>
 
+#include "wcore_atomic.h"
+#include "wcore_disk_cache.h"
 #include "wcore_display.h"
-
-static mtx_t mutex;
-
-static void
-wcore_display_init_once(void)
-{
-    mtx_init(&mutex, mtx_plain);
-}
+#include "wcore_trace.h"
 
 bool
 wcore_display_init(struct wcore_display *self,
                    struct wcore_platform *platform)
 {
     static size_t id_counter = 0;
-    static once_flag flag = ONCE_FLAG_INIT;
 
     assert(self);
     assert(platform);
 
-    call_once(&flag, wcore_display_init_once);
-    mtx_lock(&mutex);
-    self->api.display_id = ++id_counter;
-    mtx_unlock(&mutex);
+    self->api.display_id = wcore_atomic_inc_size(&id_counter);
+    mtx_init(&self->registry.mutex, mtx_plain);
+    mtx_init(&self->max_version.mutex, mtx_plain);
+
+    for (int i = 0; i < WCORE_OBJECT_TYPE_COUNT; ++i)
+        wcore_slab_init(&self->slab[i]);
 
+    self->api.platform = platform;
     self->platform = platform;
 
     if (self->api.display_id == 0) {
@@ -60,3 +58,245 @@ wcore_display_init(struct wcore_display *self,
 
     return true;
 }
+
+bool
+wcore_display_teardown(struct wcore_display *self)
+{
+    assert(self);
+
+    // The display may be torn down after a failed, or absent, call to
+    // wcore_display_init(), or torn down twice on some error paths.
+    if (self->api.display_id) {
+        mtx_destroy(&self->registry.mutex);
+        mtx_destroy(&self->max_version.mutex);
+
+        for (int i = 0; i < WCORE_OBJECT_TYPE_COUNT; ++i)
+            wcore_slab_finish(&self->slab[i]);
+
+        wcore_ext_set_finish(&self->extensions);
+
+        wcore_disk_cache_close(self->disk_cache);
+        self->disk_cache = NULL;
+
+        self->api.display_id = 0;
+    }
+
+    return true;
+}
+
+static const char *const wcore_object_names[WCORE_OBJECT_TYPE_COUNT] = {
+    [WCORE_OBJECT_CONFIG] = "config",
+    [WCORE_OBJECT_CONTEXT] = "context",
+    [WCORE_OBJECT_WINDOW] = "window",
+};
+
+void
+wcore_display_register(struct wcore_display *self,
+                       enum wcore_object_type type,
+                       struct api_object *obj)
+{
+    mtx_lock(&self->registry.mutex);
+
+    obj->registry_prev = NULL;
+    obj->registry_next = self->registry.head[type];
+    if (obj->registry_next)
+        obj->registry_next->registry_prev = obj;
+    self->registry.head[type] = obj;
+    self->registry.count[type]++;
+
+    mtx_unlock(&self->registry.mutex);
+
+    wcore_trace_object(wcore_object_names[type], obj, true);
+}
+
+void
+wcore_display_unregister(struct wcore_display *self,
+                         enum wcore_object_type type,
+                         struct api_object *obj)
+{
+    mtx_lock(&self->registry.mutex);
+
+    if (obj->registry_prev)
+        obj->registry_prev->registry_next = obj->registry_next;
+    else
+        self->registry.head[type] = obj->registry_next;
+
+    if (obj->registry_next)
+        obj->registry_next->registry_prev = obj->registry_prev;
+
+    obj->registry_prev = NULL;
+    obj->registry_next = NULL;
+    self->registry.count[type]--;
+
+    mtx_unlock(&self->registry.mutex);
+
+    wcore_trace_object(wcore_object_names[type], obj, false);
+}
+
+struct api_object*
+wcore_display_unregister_all(struct wcore_display *self,
+                             enum wcore_object_type type)
+{
+    struct api_object *head;
+
+    mtx_lock(&self->registry.mutex);
+    head = self->registry.head[type];
+    self->registry.head[type] = NULL;
+    self->registry.count[type] = 0;
+    mtx_unlock(&self->registry.mutex);
+
+    for (struct api_object *obj = head; obj; obj = obj->registry_next)
+        wcore_trace_object(wcore_object_names[type], obj, false);
+
+    return head;
+}
+
+size_t
+wcore_display_count(struct wcore_display *self,
+                    enum wcore_object_type type)
+{
+    size_t count;
+
+    mtx_lock(&self->registry.mutex);
+    count = self->registry.count[type];
+    mtx_unlock(&self->registry.mutex);
+
+    return count;
+}
+
+void*
+wcore_display_alloc_object(struct wcore_display *self,
+                           enum wcore_object_type type,
+                           size_t size)
+{
+    return wcore_slab_alloc(&self->slab[type], size);
+}
+
+void
+wcore_display_get_alloc_stats(struct wcore_display *self,
+                              struct wcore_slab_stats *stats)
+{
+    memset(stats, 0, sizeof(*stats));
+
+    for (int i = 0; i < WCORE_OBJECT_TYPE_COUNT; ++i) {
+        struct wcore_slab_stats s;
+
+        wcore_slab_get_stats(&self->slab[i], &s);
+        stats->allocs += s.allocs;
+        stats->frees += s.frees;
+        stats->heap_allocs += s.heap_allocs;
+        stats->live += s.live;
+        stats->capacity += s.capacity;
+        stats->bytes += s.bytes;
+    }
+}
+
+static void
+wcore_display_max_version_name(char *name, size_t size,
+                               int32_t context_api,
+                               int32_t context_profile)
+{
+    snprintf(name, size, "max_version.%#x.%#x",
+             context_api, context_profile);
+}
+
+static void
+wcore_display_set_max_version_mem(struct wcore_display *self,
+                                  int32_t context_api,
+                                  int32_t context_profile,
+                                  int merged_version)
+{
+    const size_t max_entries = sizeof(self->max_version.entries) /
+                               sizeof(self->max_version.entries[0]);
+    size_t i;
+
+    mtx_lock(&self->max_version.mutex);
+
+    for (i = 0; i < self->max_version.count; ++i) {
+        if (self->max_version.entries[i].context_api == context_api &&
+            self->max_version.entries[i].context_profile == context_profile)
+            break;
+    }
+
+    // There are only six combinations of api and profile, so the table
+    // never fills.
+    if (i < max_entries) {
+        self->max_version.entries[i].context_api = context_api;
+        self->max_version.entries[i].context_profile = context_profile;
+        self->max_version.entries[i].merged_version = merged_version;
+        if (i == self->max_version.count)
+            self->max_version.count++;
+    }
+
+    mtx_unlock(&self->max_version.mutex);
+}
+
+bool
+wcore_display_get_max_version(struct wcore_display *self,
+                              int32_t context_api,
+                              int32_t context_profile,
+                              int *merged_version)
+{
+    bool found = false;
+
+    mtx_lock(&self->max_version.mutex);
+
+    for (size_t i = 0; i < self->max_version.count; ++i) {
+        if (self->max_version.entries[i].context_api == context_api &&
+            self->max_version.entries[i].context_profile == context_profile) {
+            *merged_version = self->max_version.entries[i].merged_version;
+            found = true;
+            break;
+        }
+    }
+
+    mtx_unlock(&self->max_version.mutex);
+
+    if (!found && self->disk_cache) {
+        char name[48];
+
+        wcore_display_max_version_name(name, sizeof(name),
+                                       context_api, context_profile);
+        int32_t value;
+        if (wcore_disk_cache_get(self->disk_cache, name, &value)) {
+            // Promote the entry so later lookups skip the disk cache.
+            wcore_display_set_max_version_mem(self, context_api,
+                                              context_profile, value);
+            *merged_version = value;
+            found = true;
+        }
+    }
+
+    return found;
+}
+
+void
+wcore_display_set_max_version(struct wcore_display *self,
+                              int32_t context_api,
+                              int32_t context_profile,
+                              int merged_version)
+{
+    wcore_display_set_max_version_mem(self, context_api, context_profile,
+                                      merged_version);
+
+    if (self->disk_cache) {
+        char name[48];
+
+        wcore_display_max_version_name(name, sizeof(name),
+                                       context_api, context_profile);
+        wcore_disk_cache_set(self->disk_cache, name, merged_version);
+    }
+}
+
+uint64_t
+wcore_round_trip_begin(void)
+{
+    return wcore_trace_now();
+}
+
+void
+wcore_round_trip_end(struct wcore_round_trips *round_trips, uint64_t begin)
+{
+    wcore_atomic_add_u64(&round_trips->count, 1);
+    wcore_atomic_add_u64(&round_trips->wait_ns, wcore_trace_now() - begin);
+}
@@ -26,24 +26,90 @@
 #pragma once
 
 #include <assert.h>
+#include <stdint.h>
 #include "c99_compat.h"
 #include "threads.h"
 
 #include "api_object.h"
 
+#include "wcore_ext_set.h"
+#include "wcore_slab.h"
 #include "wcore_util.h"
 
 #ifdef __cplusplus
 extern "C" {
 #endif
 
+struct wcore_disk_cache;
 struct wcore_display;
 struct wcore_platform;
 union waffle_native_display;
 
+/// @brief Blocking round trips to a display server.
+struct wcore_round_trips {
+    uint64_t count;
+
+    /// Total time spent waiting on them.
+    uint64_t wait_ns;
+};
+
+enum wcore_object_type {
+    WCORE_OBJECT_CONFIG,
+    WCORE_OBJECT_CONTEXT,
+    WCORE_OBJECT_WINDOW,
+    WCORE_OBJECT_TYPE_COUNT,
+};
+
 struct wcore_display {
     struct api_object api;
     struct wcore_platform *platform;
+
+    /// @brief Live configs, contexts and windows that belong to the display.
+    ///
+    /// The api layer registers each object after creating it and unregisters
+    /// it before destroying it, which lets waffle_display_destroy_all()
+    /// reclaim whatever the user leaked.
+    struct {
+        mtx_t mutex;
+        struct api_object *head[WCORE_OBJECT_TYPE_COUNT];
+        size_t count[WCORE_OBJECT_TYPE_COUNT];
+    } registry;
+
+    /// @brief Storage for the display's configs, contexts and windows.
+    ///
+    /// See wcore_display_alloc_object().
+    struct wcore_slab slab[WCORE_OBJECT_TYPE_COUNT];
+
+    /// @brief The display's EGL, GLX or WGL extensions.
+    ///
+    /// Filled by the backend when connecting. Empty on platforms that have
+    /// no extension string.
+    struct wcore_ext_set extensions;
+
+    /// @brief Round trips to the display server, counted by the backends.
+    ///
+    /// See wcore_round_trip_begin().
+    struct wcore_round_trips round_trips;
+
+    /// @brief Versions that WAFFLE_CONTEXT_VERSION_MAX resolved to.
+    ///
+    /// Keyed by context api and profile. See wcore_display_get_max_version().
+    struct {
+        mtx_t mutex;
+        size_t count;
+        struct {
+            int32_t context_api;
+            int32_t context_profile;
+            int merged_version;
+        } entries[8];
+    } max_version;
+
+    /// @brief Persistent capability cache, or null if disabled.
+    ///
+    /// Opened by the api layer after connecting when the platform was
+    /// initialized with WAFFLE_CAPABILITY_CACHE. Closed by
+    /// wcore_display_teardown().
+    struct wcore_disk_cache *disk_cache;
 };
 
 static inline struct waffle_display*
@@ -61,14 +127,80 @@ wcore_display_init(struct wcore_display *self,
                    struct wcore_platform *platform);
 
 
-static inline bool
-wcore_display_teardown(struct wcore_display *self)
+bool
+wcore_display_teardown(struct wcore_display *self);
+
+void
+wcore_display_register(struct wcore_display *self,
+                       enum wcore_object_type type,
+                       struct api_object *obj);
+
+void
+wcore_display_unregister(struct wcore_display *self,
+                         enum wcore_object_type type,
+                         struct api_object *obj);
+
+/// @brief Unlink and return all objects of @a type.
+///
+/// The objects remain linked to each other through `api_object::registry_next`.
+struct api_object*
+wcore_display_unregister_all(struct wcore_display *self,
+                             enum wcore_object_type type);
+
+size_t
+wcore_display_count(struct wcore_display *self,
+                    enum wcore_object_type type);
+
+/// @brief Allocate a zeroed config, context or window for the display.
+///
+/// Backends use this in place of wcore_calloc() so that creating and
+/// destroying objects at a steady rate does not reach malloc. Free the
+/// object with wcore_display_free_object(), which must happen before the
+/// display is torn down.
+void*
+wcore_display_alloc_object(struct wcore_display *self,
+                           enum wcore_object_type type,
+                           size_t size);
+
+static inline void
+wcore_display_free_object(void *obj)
 {
-    (void) self;
-    assert(self);
-    return true;
+    wcore_slab_free(obj);
 }
 
+/// @brief Sum the statistics of the display's object slabs.
+void
+wcore_display_get_alloc_stats(struct wcore_display *self,
+                              struct wcore_slab_stats *stats);
+
+/// @brief Look up the version that WAFFLE_CONTEXT_VERSION_MAX resolved to.
+///
+/// On success, @a merged_version is set to, for example, 45 for 4.5. Return
+/// false if the version has not yet been resolved for the api and profile,
+/// neither in this process nor, if the display has one, in its disk cache.
+bool
+wcore_display_get_max_version(struct wcore_display *self,
+                              int32_t context_api,
+                              int32_t context_profile,
+                              int *merged_version);
+
+void
+wcore_display_set_max_version(struct wcore_display *self,
+                              int32_t context_api,
+                              int32_t context_profile,
+                              int merged_version);
+
+/// @brief Begin a round trip to the display server. Return its start time.
+///
+/// Backends bracket each native call that waits on the server, such as
+/// xcb_request_check() or wl_display_roundtrip(), with this and
+/// wcore_round_trip_end(), which may be called from any thread.
+uint64_t
+wcore_round_trip_begin(void);
+
+void
+wcore_round_trip_end(struct wcore_round_trips *round_trips, uint64_t begin);
+
 #ifdef __cplusplus
 }
 #endif
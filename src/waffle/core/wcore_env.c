@@ -0,0 +1,108 @@
+// Copyright 2016 Intel Corporation
+//
+// All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+//
+// - Redistributions of source code must retain the above copyright notice, this
+//   list of conditions and the following disclaimer.
+//
+// - Redistributions in binary form must reproduce the above copyright notice,
+//   this list of conditions and the following disclaimer in the documentation
+//   and/or other materials provided with the distribution.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+// DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+// FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+// DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+// SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+// CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+// OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+// OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+#define _POSIX_C_SOURCE 200112 // glib feature macro for setenv()
+
+#include <stddef.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "threads.h"
+
+#include "wcore_env.h"
+
+#ifdef _WIN32
+#define setenv(name, value, overwrite) _putenv_s(name, value)
+#define unsetenv(name) _putenv_s(name, "")
+#endif
+
+/// At most this many distinct variables may be held at once.
+#define WCORE_ENV_MAX_HELD 4
+
+static once_flag wcore_env_once = ONCE_FLAG_INIT;
+
+/// Protects the table below and serializes setenv() and unsetenv().
+static mtx_t wcore_env_mutex;
+
+static struct {
+    const char *name;
+    size_t refs;
+} wcore_env_held[WCORE_ENV_MAX_HELD];
+
+static void
+wcore_env_init_once(void)
+{
+    mtx_init(&wcore_env_mutex, mtx_plain);
+}
+
+bool
+wcore_env_hold(const char *name, const char *value)
+{
+    size_t i, free_slot = WCORE_ENV_MAX_HELD;
+    bool ok = false;
+
+    call_once(&wcore_env_once, wcore_env_init_once);
+    mtx_lock(&wcore_env_mutex);
+
+    for (i = 0; i < WCORE_ENV_MAX_HELD; ++i) {
+        if (wcore_env_held[i].refs == 0) {
+            if (free_slot == WCORE_ENV_MAX_HELD)
+                free_slot = i;
+        } else if (strcmp(wcore_env_held[i].name, name) == 0) {
+            break;
+        }
+    }
+
+    if (i == WCORE_ENV_MAX_HELD)
+        i = free_slot;
+
+    if (i < WCORE_ENV_MAX_HELD && setenv(name, value, 1) == 0) {
+        wcore_env_held[i].name = name;
+        wcore_env_held[i].refs++;
+        ok = true;
+    }
+
+    mtx_unlock(&wcore_env_mutex);
+    return ok;
+}
+
+void
+wcore_env_release(const char *name)
+{
+    call_once(&wcore_env_once, wcore_env_init_once);
+    mtx_lock(&wcore_env_mutex);
+
+    for (size_t i = 0; i < WCORE_ENV_MAX_HELD; ++i) {
+        if (wcore_env_held[i].refs == 0 ||
+            strcmp(wcore_env_held[i].name, name) != 0)
+            continue;
+
+        if (--wcore_env_held[i].refs == 0)
+            unsetenv(name);
+        break;
+    }
+
+    mtx_unlock(&wcore_env_mutex);
+}
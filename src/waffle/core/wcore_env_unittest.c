@@ -0,0 +1,95 @@
+// Copyright 2016 Intel Corporation
+//
+// All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+//
+// - Redistributions of source code must retain the above copyright notice, this
+//   list of conditions and the following disclaimer.
+//
+// - Redistributions in binary form must reproduce the above copyright notice,
+//   this list of conditions and the following disclaimer in the documentation
+//   and/or other materials provided with the distribution.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+// DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+// FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+// DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+// SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+// CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+// OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+// OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+#define _POSIX_C_SOURCE 200112 // glib feature macro for setenv()
+
+#include <setjmp.h>
+#include <stdarg.h>
+#include <stddef.h>
+#include <stdlib.h>
+
+#include <cmocka.h>
+
+#include "wcore_env.h"
+
+static const char name[] = "WCORE_ENV_UNITTEST";
+
+static void
+setup(void **state) {
+    unsetenv(name);
+}
+
+static void
+teardown(void **state) {
+    unsetenv(name);
+}
+
+static void
+test_wcore_env_two_holders(void **state) {
+    // Two instances of the same platform.
+    assert_true(wcore_env_hold(name, "x11"));
+    assert_true(wcore_env_hold(name, "x11"));
+    assert_string_equal(getenv(name), "x11");
+
+    // Destroying the first must not unset it under the second.
+    wcore_env_release(name);
+    assert_string_equal(getenv(name), "x11");
+
+    wcore_env_release(name);
+    assert_null(getenv(name));
+}
+
+static void
+test_wcore_env_newest_value_wins(void **state) {
+    assert_true(wcore_env_hold(name, "x11"));
+    assert_true(wcore_env_hold(name, "wayland"));
+    assert_string_equal(getenv(name), "wayland");
+
+    wcore_env_release(name);
+    assert_string_equal(getenv(name), "wayland");
+
+    wcore_env_release(name);
+    assert_null(getenv(name));
+}
+
+static void
+test_wcore_env_release_unheld(void **state) {
+    setenv(name, "user", 1);
+
+    // Releasing a variable that waffle never held leaves it alone.
+    wcore_env_release(name);
+    assert_string_equal(getenv(name), "user");
+}
+
+int
+main(void) {
+    const UnitTest tests[] = {
+        unit_test_setup_teardown(test_wcore_env_two_holders, setup, teardown),
+        unit_test_setup_teardown(test_wcore_env_newest_value_wins, setup, teardown),
+        unit_test_setup_teardown(test_wcore_env_release_unheld, setup, teardown),
+    };
+
+    return run_tests(tests);
+}
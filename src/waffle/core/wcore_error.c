@@ -221,6 +221,32 @@ wcore_error_get_code(void)
     return wcore_tinfo_get()->error->code;
 }
 
+void
+wcore_error_save(struct wcore_error_saved *saved)
+{
+    struct wcore_error_tinfo *info = wcore_tinfo_get()->error;
+
+    if (saved->code != WAFFLE_NO_ERROR)
+        return;
+
+    saved->code = info->code != WAFFLE_NO_ERROR ? info->code
+                                                : WAFFLE_ERROR_UNKNOWN;
+    saved->message = info->message[0] ? strdup(info->message) : NULL;
+}
+
+void
+wcore_error_restore(struct wcore_error_saved *saved)
+{
+    if (saved->message)
+        wcore_errorf(saved->code, "%s", saved->message);
+    else
+        wcore_error(saved->code);
+
+    free(saved->message);
+    saved->message = NULL;
+    saved->code = WAFFLE_NO_ERROR;
+}
+
 const struct waffle_error_info*
 wcore_error_get_info(void)
 {
@@ -91,6 +91,25 @@ wcore_error_get_code(void);
 const struct waffle_error_info*
 wcore_error_get_info(void);
 
+/// @brief A copy of the calling thread's error.
+///
+/// Errors are thread-local and each new error replaces the last. A saved
+/// error survives both, so it can be emitted later or on another thread.
+struct wcore_error_saved {
+    enum waffle_error code;
+    char *message;
+};
+
+/// @brief Copy the calling thread's error into @a saved, if it is empty.
+///
+/// An empty @a saved is zeroed. Save WAFFLE_ERROR_UNKNOWN if no error is set.
+void
+wcore_error_save(struct wcore_error_saved *saved);
+
+/// @brief Emit the error in @a saved on the calling thread and empty @a saved.
+void
+wcore_error_restore(struct wcore_error_saved *saved);
+
 void
 _wcore_error_internal(const char *file, int line, const char *format, ...);
 
@@ -0,0 +1,147 @@
+// Copyright 2016 Intel Corporation
+//
+// All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+//
+// - Redistributions of source code must retain the above copyright notice, this
+//   list of conditions and the following disclaimer.
+//
+// - Redistributions in binary form must reproduce the above copyright notice,
+//   this list of conditions and the following disclaimer in the documentation
+//   and/or other materials provided with the distribution.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+// DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+// FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+// DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+// SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+// CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+// OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+// OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+#include <stdlib.h>
+#include <string.h>
+
+#include "wcore_error.h"
+#include "wcore_ext_set.h"
+
+struct wcore_ext_set_slot {
+    uint32_t hash;
+
+    /// Null if the slot is empty.
+    const char *name;
+};
+
+/// 32-bit FNV-1a.
+static uint32_t
+hash_name(const char *name, size_t len)
+{
+    uint32_t h = 2166136261u;
+
+    for (size_t i = 0; i < len; ++i) {
+        h ^= (unsigned char) name[i];
+        h *= 16777619u;
+    }
+
+    return h;
+}
+
+/// Return the slot that holds @a name, or the empty slot where it belongs.
+static struct wcore_ext_set_slot*
+find_slot(const struct wcore_ext_set *self, const char *name, size_t len,
+          uint32_t hash)
+{
+    for (size_t i = hash & self->mask; ; i = (i + 1) & self->mask) {
+        struct wcore_ext_set_slot *slot = &self->slots[i];
+
+        if (!slot->name)
+            return slot;
+
+        if (slot->hash == hash &&
+            strncmp(slot->name, name, len) == 0 &&
+            slot->name[len] == '\0')
+            return slot;
+    }
+}
+
+bool
+wcore_ext_set_init(struct wcore_ext_set *self, const char *extensions)
+{
+    size_t len = strlen(extensions);
+    size_t max_names = len / 2 + 1;
+    size_t num_slots = 16;
+    char *p;
+
+    memset(self, 0, sizeof(*self));
+
+    // Keep the load factor at or below 1/2. Each name takes at least one
+    // character plus a separator, which bounds the number of names.
+    while (num_slots < 2 * max_names)
+        num_slots *= 2;
+
+    self->names = malloc(len + 1);
+    self->slots = calloc(num_slots, sizeof(*self->slots));
+    if (!self->names || !self->slots) {
+        wcore_error(WAFFLE_ERROR_BAD_ALLOC);
+        wcore_ext_set_finish(self);
+        return false;
+    }
+
+    memcpy(self->names, extensions, len + 1);
+    self->mask = num_slots - 1;
+    self->heap_bytes = len + 1 + num_slots * sizeof(*self->slots);
+
+    p = self->names;
+    while (*p) {
+        struct wcore_ext_set_slot *slot;
+        size_t name_len;
+        uint32_t hash;
+
+        if (*p == ' ') {
+            *p++ = '\0';
+            continue;
+        }
+
+        name_len = strcspn(p, " ");
+        hash = hash_name(p, name_len);
+        slot = find_slot(self, p, name_len, hash);
+        if (!slot->name) {
+            slot->hash = hash;
+            slot->name = p;
+            self->count++;
+        }
+
+        p += name_len;
+        if (*p)
+            *p++ = '\0';
+    }
+
+    return true;
+}
+
+void
+wcore_ext_set_finish(struct wcore_ext_set *self)
+{
+    free(self->names);
+    free(self->slots);
+    memset(self, 0, sizeof(*self));
+}
+
+bool
+wcore_ext_set_has(const struct wcore_ext_set *self, const char *name)
+{
+    size_t len;
+
+    if (!self->slots || !name)
+        return false;
+
+    len = strlen(name);
+    if (len == 0)
+        return false;
+
+    return find_slot(self, name, len, hash_name(name, len))->name != NULL;
+}
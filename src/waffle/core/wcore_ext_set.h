@@ -0,0 +1,76 @@
+// Copyright 2016 Intel Corporation
+//
+// All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+//
+// - Redistributions of source code must retain the above copyright notice, this
+//   list of conditions and the following disclaimer.
+//
+// - Redistributions in binary form must reproduce the above copyright notice,
+//   this list of conditions and the following disclaimer in the documentation
+//   and/or other materials provided with the distribution.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+// DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+// FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+// DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+// SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+// CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+// OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+// OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+/// @file
+/// @brief Hashed set of extension names.
+///
+/// An extension string is parsed once into an open-addressed hash table, after
+/// which each membership test hashes the name and compares it against at most
+/// a few entries, instead of rescanning the string.
+
+#pragma once
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+struct wcore_ext_set_slot;
+
+/// A zeroed set is valid and empty.
+struct wcore_ext_set {
+    /// Copy of the extension string, with a null byte after each name.
+    char *names;
+
+    struct wcore_ext_set_slot *slots;
+
+    /// Number of slots minus 1. The number of slots is a power of 2.
+    size_t mask;
+
+    size_t count;
+
+    /// Bytes held from malloc.
+    size_t heap_bytes;
+};
+
+/// @brief Parse a space-separated extension string into @a self.
+///
+/// Emit WAFFLE_ERROR_BAD_ALLOC and return false on failure, in which case
+/// @a self is empty.
+bool
+wcore_ext_set_init(struct wcore_ext_set *self, const char *extensions);
+
+void
+wcore_ext_set_finish(struct wcore_ext_set *self);
+
+bool
+wcore_ext_set_has(const struct wcore_ext_set *self, const char *name);
+
+#ifdef __cplusplus
+}
+#endif
@@ -0,0 +1,126 @@
+// Copyright 2016 Intel Corporation
+//
+// All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+//
+// - Redistributions of source code must retain the above copyright notice, this
+//   list of conditions and the following disclaimer.
+//
+// - Redistributions in binary form must reproduce the above copyright notice,
+//   this list of conditions and the following disclaimer in the documentation
+//   and/or other materials provided with the distribution.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+// DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+// FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+// DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+// SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+// CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+// OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+// OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+#include <setjmp.h>
+#include <stdarg.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include <cmocka.h>
+
+#include "wcore_ext_set.h"
+
+static void
+test_wcore_ext_set_basic(void **state) {
+    struct wcore_ext_set set;
+
+    assert_true(wcore_ext_set_init(&set, "EGL_KHR_create_context "
+                                         "EGL_EXT_create_context_robustness"));
+    assert_int_equal(set.count, 2);
+    assert_true(wcore_ext_set_has(&set, "EGL_KHR_create_context"));
+    assert_true(wcore_ext_set_has(&set, "EGL_EXT_create_context_robustness"));
+    assert_false(wcore_ext_set_has(&set, "EGL_KHR_surfaceless_context"));
+    wcore_ext_set_finish(&set);
+}
+
+static void
+test_wcore_ext_set_prefix_does_not_match(void **state) {
+    struct wcore_ext_set set;
+
+    assert_true(wcore_ext_set_init(&set, "GLX_EXT_create_context_es2_profile"));
+    assert_false(wcore_ext_set_has(&set, "GLX_EXT_create_context"));
+    assert_false(wcore_ext_set_has(&set, "GLX_EXT_create_context_es2_profile_x"));
+    assert_true(wcore_ext_set_has(&set, "GLX_EXT_create_context_es2_profile"));
+    wcore_ext_set_finish(&set);
+}
+
+static void
+test_wcore_ext_set_extra_spaces_and_duplicates(void **state) {
+    struct wcore_ext_set set;
+
+    assert_true(wcore_ext_set_init(&set, "  GL_a   GL_b GL_a  "));
+    assert_int_equal(set.count, 2);
+    assert_true(wcore_ext_set_has(&set, "GL_a"));
+    assert_true(wcore_ext_set_has(&set, "GL_b"));
+    assert_false(wcore_ext_set_has(&set, ""));
+    assert_false(wcore_ext_set_has(&set, "GL_a GL_b"));
+    wcore_ext_set_finish(&set);
+}
+
+static void
+test_wcore_ext_set_empty(void **state) {
+    struct wcore_ext_set set;
+
+    memset(&set, 0, sizeof(set));
+    assert_false(wcore_ext_set_has(&set, "GL_a"));
+
+    assert_true(wcore_ext_set_init(&set, ""));
+    assert_int_equal(set.count, 0);
+    assert_false(wcore_ext_set_has(&set, "GL_a"));
+    assert_false(wcore_ext_set_has(&set, NULL));
+    wcore_ext_set_finish(&set);
+}
+
+static void
+test_wcore_ext_set_many(void **state) {
+    const int n = 400;
+    struct wcore_ext_set set;
+    char name[32];
+    char *s = malloc(n * sizeof(name));
+
+    assert_non_null(s);
+    s[0] = '\0';
+    for (int i = 0; i < n; ++i) {
+        snprintf(name, sizeof(name), "GL_ext_%d ", i);
+        strcat(s, name);
+    }
+
+    assert_true(wcore_ext_set_init(&set, s));
+    assert_int_equal(set.count, n);
+
+    for (int i = 0; i < n; ++i) {
+        snprintf(name, sizeof(name), "GL_ext_%d", i);
+        assert_true(wcore_ext_set_has(&set, name));
+    }
+
+    assert_false(wcore_ext_set_has(&set, "GL_ext_400"));
+    wcore_ext_set_finish(&set);
+    free(s);
+}
+
+int
+main(void) {
+    const UnitTest tests[] = {
+        unit_test(test_wcore_ext_set_basic),
+        unit_test(test_wcore_ext_set_prefix_does_not_match),
+        unit_test(test_wcore_ext_set_extra_spaces_and_duplicates),
+        unit_test(test_wcore_ext_set_empty),
+        unit_test(test_wcore_ext_set_many),
+    };
+
+    return run_tests(tests);
+}
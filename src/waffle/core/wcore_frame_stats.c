@@ -0,0 +1,276 @@
+// Copyright 2016 Intel Corporation
+//
+// All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+//
+// - Redistributions of source code must retain the above copyright notice, this
+//   list of conditions and the following disclaimer.
+//
+// - Redistributions in binary form must reproduce the above copyright notice,
+//   this list of conditions and the following disclaimer in the documentation
+//   and/or other materials provided with the distribution.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+// DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+// FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+// DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+// SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+// CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+// OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+// OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+#include <stdlib.h>
+#include <string.h>
+
+#include "threads.h"
+
+#include "wcore_atomic.h"
+#include "wcore_frame_stats.h"
+#include "wcore_tinfo.h"
+#include "wcore_trace.h"
+#include "wcore_util.h"
+#include "wcore_window.h"
+
+struct wcore_frame_stats {
+    /// Protects the members below. The swapping thread writes them, and any
+    /// thread may read them.
+    mtx_t mutex;
+
+    /// End of the last swap, or 0.
+    uint64_t last_swap_end;
+
+    uint64_t total_frames;
+
+    /// Index of the next frame to write.
+    uint32_t head;
+    uint32_t num_frames;
+    struct waffle_frame_timing frames[WAFFLE_FRAME_STATS_MAX_FRAMES];
+};
+
+uint64_t
+wcore_frame_stats_swap_begin(void)
+{
+    struct wcore_tinfo *tinfo = wcore_tinfo_get();
+
+    tinfo->in_swap = true;
+    tinfo->swap_blocked_ns = 0;
+    return wcore_trace_now();
+}
+
+static struct wcore_frame_stats*
+wcore_frame_stats_create(void)
+{
+    struct wcore_frame_stats *self = wcore_calloc(sizeof(*self));
+
+    if (!self)
+        return NULL;
+
+    if (mtx_init(&self->mutex, mtx_plain) != thrd_success) {
+        free(self);
+        return NULL;
+    }
+
+    return self;
+}
+
+static void
+wcore_frame_stats_record(struct wcore_window *window,
+                         uint64_t begin, uint64_t end, uint64_t blocked)
+{
+    struct wcore_frame_stats *self =
+        wcore_atomic_load_ptr((void**) &window->frame_stats);
+    struct waffle_frame_timing *frame;
+
+    if (!self) {
+        self = wcore_frame_stats_create();
+        // Without memory the frame goes unrecorded.
+        if (!self)
+            return;
+
+        // Another thread may have swapped the window concurrently.
+        if (!wcore_atomic_cas_ptr((void**) &window->frame_stats, NULL, self)) {
+            wcore_frame_stats_destroy(self);
+            self = wcore_atomic_load_ptr((void**) &window->frame_stats);
+        }
+    }
+
+    mtx_lock(&self->mutex);
+
+    frame = &self->frames[self->head];
+    frame->swap_ns = end - begin;
+    frame->interval_ns = self->last_swap_end ? end - self->last_swap_end : 0;
+    frame->blocked_ns = blocked;
+    frame->gpu_ns = 0;
+
+    self->last_swap_end = end;
+    self->total_frames++;
+    self->head = (self->head + 1) % WAFFLE_FRAME_STATS_MAX_FRAMES;
+    if (self->num_frames < WAFFLE_FRAME_STATS_MAX_FRAMES)
+        self->num_frames++;
+
+    mtx_unlock(&self->mutex);
+}
+
+void
+wcore_frame_stats_swap_end(struct wcore_window *windows[], int32_t count,
+                           uint64_t begin)
+{
+    struct wcore_tinfo *tinfo = wcore_tinfo_get();
+    uint64_t end = wcore_trace_now();
+
+    for (int32_t i = 0; i < count; ++i)
+        wcore_frame_stats_record(windows[i], begin, end, tinfo->swap_blocked_ns);
+
+    tinfo->in_swap = false;
+}
+
+uint64_t
+wcore_frame_stats_block_begin(void)
+{
+    if (!wcore_tinfo_get()->in_swap)
+        return 0;
+
+    return wcore_trace_now();
+}
+
+void
+wcore_frame_stats_block_end(uint64_t begin)
+{
+    if (begin)
+        wcore_tinfo_get()->swap_blocked_ns += wcore_trace_now() - begin;
+}
+
+void
+wcore_frame_stats_set_gpu(struct wcore_frame_stats *self,
+                          uint64_t frame, uint64_t gpu_ns)
+{
+    uint64_t age;
+
+    if (!self)
+        return;
+
+    mtx_lock(&self->mutex);
+
+    // Drop the time of a frame that has left the ring, or was never recorded.
+    age = self->total_frames - frame;
+    if (frame < self->total_frames && age <= self->num_frames) {
+        uint32_t i = (self->head + WAFFLE_FRAME_STATS_MAX_FRAMES - age) %
+                     WAFFLE_FRAME_STATS_MAX_FRAMES;
+        self->frames[i].gpu_ns = gpu_ns;
+    }
+
+    mtx_unlock(&self->mutex);
+}
+
+static int
+compare_u64(const void *a, const void *b)
+{
+    uint64_t x = *(const uint64_t*) a;
+    uint64_t y = *(const uint64_t*) b;
+
+    return x < y ? -1 : x > y;
+}
+
+/// Nearest-rank percentile of the @a n sorted values in @a v.
+static uint64_t
+percentile(const uint64_t *v, size_t n, unsigned p)
+{
+    size_t rank = (n * p + 99) / 100;
+
+    return v[rank ? rank - 1 : 0];
+}
+
+struct waffle_frame_percentiles
+wcore_frame_stats_percentiles(uint64_t *v, size_t n)
+{
+    struct waffle_frame_percentiles result = {0};
+
+    if (n == 0)
+        return result;
+
+    qsort(v, n, sizeof(*v), compare_u64);
+    result.p50_ns = percentile(v, n, 50);
+    result.p95_ns = percentile(v, n, 95);
+    result.p99_ns = percentile(v, n, 99);
+    result.max_ns = v[n - 1];
+    return result;
+}
+
+void
+wcore_frame_stats_get(struct wcore_frame_stats *self,
+                      struct waffle_frame_stats *out)
+{
+    uint64_t swap[WAFFLE_FRAME_STATS_MAX_FRAMES];
+    uint64_t interval[WAFFLE_FRAME_STATS_MAX_FRAMES];
+    uint64_t blocked[WAFFLE_FRAME_STATS_MAX_FRAMES];
+    uint64_t gpu[WAFFLE_FRAME_STATS_MAX_FRAMES];
+    uint64_t jitter = 0;
+    size_t num_intervals = 0;
+    size_t num_gpu = 0;
+    uint32_t first;
+
+    memset(out, 0, sizeof(*out));
+    if (!self)
+        return;
+
+    mtx_lock(&self->mutex);
+    out->total_frames = self->total_frames;
+    out->num_frames = self->num_frames;
+    first = (self->head + WAFFLE_FRAME_STATS_MAX_FRAMES - self->num_frames) %
+            WAFFLE_FRAME_STATS_MAX_FRAMES;
+    for (uint32_t i = 0; i < self->num_frames; ++i) {
+        out->frames[i] =
+            self->frames[(first + i) % WAFFLE_FRAME_STATS_MAX_FRAMES];
+    }
+    mtx_unlock(&self->mutex);
+
+    for (uint32_t i = 0; i < out->num_frames; ++i) {
+        const struct waffle_frame_timing *frame = &out->frames[i];
+
+        swap[i] = frame->swap_ns;
+        blocked[i] = frame->blocked_ns;
+
+        // Frames without a GPU time were not measured, or not yet harvested.
+        if (frame->gpu_ns)
+            gpu[num_gpu++] = frame->gpu_ns;
+
+        // The first swap of a window has no interval.
+        if (!frame->interval_ns)
+            continue;
+
+        if (num_intervals > 0) {
+            uint64_t prev = interval[num_intervals - 1];
+            jitter += frame->interval_ns > prev ? frame->interval_ns - prev
+                                                : prev - frame->interval_ns;
+        }
+        interval[num_intervals++] = frame->interval_ns;
+    }
+
+    if (num_intervals > 1)
+        out->interval_jitter_ns = jitter / (num_intervals - 1);
+
+    out->swap = wcore_frame_stats_percentiles(swap, out->num_frames);
+    out->interval = wcore_frame_stats_percentiles(interval, num_intervals);
+    out->blocked = wcore_frame_stats_percentiles(blocked, out->num_frames);
+    out->gpu = wcore_frame_stats_percentiles(gpu, num_gpu);
+}
+
+size_t
+wcore_frame_stats_heap_bytes(const struct wcore_frame_stats *self)
+{
+    return self ? sizeof(*self) : 0;
+}
+
+void
+wcore_frame_stats_destroy(struct wcore_frame_stats *self)
+{
+    if (!self)
+        return;
+
+    mtx_destroy(&self->mutex);
+    free(self);
+}
@@ -0,0 +1,99 @@
+// Copyright 2016 Intel Corporation
+//
+// All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+//
+// - Redistributions of source code must retain the above copyright notice, this
+//   list of conditions and the following disclaimer.
+//
+// - Redistributions in binary form must reproduce the above copyright notice,
+//   this list of conditions and the following disclaimer in the documentation
+//   and/or other materials provided with the distribution.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+// DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+// FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+// DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+// SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+// CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+// OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+// OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+/// @file
+/// @brief Per-window frame timing.
+///
+/// The api layer times each swap of a window and records, in a ring of the
+/// window's last WAFFLE_FRAME_STATS_MAX_FRAMES frames, the time spent in the
+/// swap, the interval since the previous swap, and the part of the swap that
+/// the backend spent blocked in the platform. Backends bracket their
+/// blocking points, such as a Wayland round trip, with
+/// wcore_frame_stats_block_begin() and wcore_frame_stats_block_end(), which
+/// accumulate into the calling thread's current swap.
+///
+/// The ring is allocated at the window's first swap.
+///
+/// The GPU time of a frame, measured by @ref wcore_gpu_timer, is known only
+/// some frames after its swap, and is filled in by
+/// wcore_frame_stats_set_gpu().
+
+#pragma once
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+#include "waffle.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+struct wcore_frame_stats;
+struct wcore_window;
+
+/// @brief Begin a swap on the calling thread. Return its start time.
+uint64_t
+wcore_frame_stats_swap_begin(void);
+
+/// @brief End the swap that began at @a begin, of all @a count windows.
+void
+wcore_frame_stats_swap_end(struct wcore_window *windows[], int32_t count,
+                           uint64_t begin);
+
+/// @brief Begin a blocking point. Return 0 if the thread is not swapping.
+uint64_t
+wcore_frame_stats_block_begin(void);
+
+void
+wcore_frame_stats_block_end(uint64_t begin);
+
+/// @brief Set the GPU time of the window's @a frame'th swap, counting from 0.
+///
+/// Do nothing if @a self is null or the frame is no longer in the ring.
+void
+wcore_frame_stats_set_gpu(struct wcore_frame_stats *self,
+                          uint64_t frame, uint64_t gpu_ns);
+
+/// @brief Fill @a out from @a self, which may be null.
+void
+wcore_frame_stats_get(struct wcore_frame_stats *self,
+                      struct waffle_frame_stats *out);
+
+/// @brief Return the percentiles of the @a n values in @a v, which it sorts.
+struct waffle_frame_percentiles
+wcore_frame_stats_percentiles(uint64_t *v, size_t n);
+
+/// @brief Bytes of heap held by @a self, which may be null.
+size_t
+wcore_frame_stats_heap_bytes(const struct wcore_frame_stats *self);
+
+void
+wcore_frame_stats_destroy(struct wcore_frame_stats *self);
+
+#ifdef __cplusplus
+}
+#endif
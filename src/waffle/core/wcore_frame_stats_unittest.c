@@ -0,0 +1,163 @@
+// Copyright 2016 Intel Corporation
+//
+// All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+//
+// - Redistributions of source code must retain the above copyright notice, this
+//   list of conditions and the following disclaimer.
+//
+// - Redistributions in binary form must reproduce the above copyright notice,
+//   this list of conditions and the following disclaimer in the documentation
+//   and/or other materials provided with the distribution.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+// DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+// FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+// DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+// SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+// CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+// OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+// OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+#include <setjmp.h>
+#include <stdarg.h>
+#include <stdint.h>
+#include <string.h>
+#include <time.h>
+
+#include <cmocka.h>
+
+#include "wcore_frame_stats.h"
+#include "wcore_window.h"
+
+static void
+sleep_ms(long ms)
+{
+    struct timespec ts = { .tv_sec = 0, .tv_nsec = ms * 1000 * 1000 };
+
+    nanosleep(&ts, NULL);
+}
+
+static void
+swap(struct wcore_window *window, long blocked_ms)
+{
+    uint64_t begin = wcore_frame_stats_swap_begin();
+
+    if (blocked_ms) {
+        uint64_t t0 = wcore_frame_stats_block_begin();
+
+        assert_int_not_equal(t0, 0);
+        sleep_ms(blocked_ms);
+        wcore_frame_stats_block_end(t0);
+    }
+
+    wcore_frame_stats_swap_end(&window, 1, begin);
+}
+
+static void
+test_wcore_frame_stats_percentiles(void **state) {
+    uint64_t v[100];
+    struct waffle_frame_percentiles p;
+
+    // Reversed, to check that the values are sorted.
+    for (int i = 0; i < 100; ++i)
+        v[i] = 100 - i;
+
+    p = wcore_frame_stats_percentiles(v, 100);
+    assert_int_equal(p.p50_ns, 50);
+    assert_int_equal(p.p95_ns, 95);
+    assert_int_equal(p.p99_ns, 99);
+    assert_int_equal(p.max_ns, 100);
+
+    v[0] = 7;
+    p = wcore_frame_stats_percentiles(v, 1);
+    assert_int_equal(p.p50_ns, 7);
+    assert_int_equal(p.p99_ns, 7);
+
+    p = wcore_frame_stats_percentiles(v, 0);
+    assert_int_equal(p.max_ns, 0);
+}
+
+static void
+test_wcore_frame_stats_record(void **state) {
+    struct wcore_window window;
+    struct waffle_frame_stats stats;
+
+    memset(&window, 0, sizeof(window));
+
+    swap(&window, 0);
+    swap(&window, 2);
+    swap(&window, 0);
+
+    wcore_frame_stats_get(window.frame_stats, &stats);
+    assert_int_equal(stats.total_frames, 3);
+    assert_int_equal(stats.num_frames, 3);
+
+    // The first swap has no interval.
+    assert_int_equal(stats.frames[0].interval_ns, 0);
+    assert_int_not_equal(stats.frames[1].interval_ns, 0);
+
+    assert_int_equal(stats.frames[0].blocked_ns, 0);
+    assert_true(stats.frames[1].blocked_ns >= 2 * 1000 * 1000);
+    assert_true(stats.frames[1].swap_ns >= stats.frames[1].blocked_ns);
+    assert_int_equal(stats.blocked.max_ns, stats.frames[1].blocked_ns);
+    assert_true(stats.interval.max_ns >= 2 * 1000 * 1000);
+
+    wcore_frame_stats_destroy(window.frame_stats);
+}
+
+static void
+test_wcore_frame_stats_wrap(void **state) {
+    struct wcore_window window;
+    struct waffle_frame_stats stats;
+
+    memset(&window, 0, sizeof(window));
+
+    for (int i = 0; i < WAFFLE_FRAME_STATS_MAX_FRAMES + 72; ++i)
+        swap(&window, 0);
+
+    wcore_frame_stats_get(window.frame_stats, &stats);
+    assert_int_equal(stats.total_frames, WAFFLE_FRAME_STATS_MAX_FRAMES + 72);
+    assert_int_equal(stats.num_frames, WAFFLE_FRAME_STATS_MAX_FRAMES);
+
+    // Only the window's first swap lacks an interval, and it was dropped.
+    for (int i = 0; i < WAFFLE_FRAME_STATS_MAX_FRAMES; ++i)
+        assert_int_not_equal(stats.frames[i].interval_ns, 0);
+
+    wcore_frame_stats_destroy(window.frame_stats);
+}
+
+static void
+test_wcore_frame_stats_block_outside_swap(void **state) {
+    assert_int_equal(wcore_frame_stats_block_begin(), 0);
+    wcore_frame_stats_block_end(0);
+}
+
+static void
+test_wcore_frame_stats_empty(void **state) {
+    struct waffle_frame_stats stats;
+
+    memset(&stats, 0xff, sizeof(stats));
+    wcore_frame_stats_get(NULL, &stats);
+    assert_int_equal(stats.total_frames, 0);
+    assert_int_equal(stats.num_frames, 0);
+    assert_int_equal(stats.swap.max_ns, 0);
+    assert_int_equal(stats.interval_jitter_ns, 0);
+}
+
+int
+main(void) {
+    const UnitTest tests[] = {
+        unit_test(test_wcore_frame_stats_percentiles),
+        unit_test(test_wcore_frame_stats_record),
+        unit_test(test_wcore_frame_stats_wrap),
+        unit_test(test_wcore_frame_stats_block_outside_swap),
+        unit_test(test_wcore_frame_stats_empty),
+    };
+
+    return run_tests(tests);
+}
@@ -0,0 +1,384 @@
+// Copyright 2016 Intel Corporation
+//
+// All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+//
+// - Redistributions of source code must retain the above copyright notice, this
+//   list of conditions and the following disclaimer.
+//
+// - Redistributions in binary form must reproduce the above copyright notice,
+//   this list of conditions and the following disclaimer in the documentation
+//   and/or other materials provided with the distribution.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+// DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+// FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+// DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+// SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+// CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+// OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+// OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+#include <stdlib.h>
+#include <string.h>
+
+#include "threads.h"
+
+#include "wcore_atomic.h"
+#include "wcore_block_pool.h"
+#include "wcore_error.h"
+#include "wcore_gl_stats.h"
+#include "wcore_tinfo.h"
+#include "wcore_trace.h"
+#include "wcore_util.h"
+
+#if defined(__x86_64__) && defined(__ELF__)
+#   define WCORE_GL_STATS_HAS_THUNKS 1
+#else
+#   define WCORE_GL_STATS_HAS_THUNKS 0
+#endif
+
+struct wcore_gl_stats_counters {
+    uint64_t calls;
+    uint64_t total_ns;
+    uint64_t max_ns;
+};
+
+struct wcore_gl_stats_block {
+    /// Owned by a wcore_tinfo. Only the owner writes the counters.
+    struct wcore_block_pool_link link;
+
+    struct wcore_gl_stats_counters counters[WCORE_GL_STATS_SLOTS];
+};
+
+DEFINE_CONTAINER_CAST_FUNC(wcore_gl_stats_block,
+                           struct wcore_gl_stats_block,
+                           struct wcore_block_pool_link,
+                           link)
+
+struct wcore_gl_stats_slot {
+    char *name;
+    void *proc;
+};
+
+static bool wcore_gl_stats_enabled;
+static struct wcore_block_pool wcore_gl_stats_pool;
+
+static once_flag wcore_gl_stats_once = ONCE_FLAG_INIT;
+
+/// Protects the members below it. Slots are never freed, because their
+/// thunks may be called at any time.
+static mtx_t wcore_gl_stats_mutex;
+static struct wcore_gl_stats_slot wcore_gl_stats_slots[WCORE_GL_STATS_SLOTS];
+static uint32_t wcore_gl_stats_num_slots;
+
+static void
+wcore_gl_stats_init_once(void)
+{
+    mtx_init(&wcore_gl_stats_mutex, mtx_plain);
+}
+
+#if WCORE_GL_STATS_HAS_THUNKS
+
+/// Size of each thunk in the table.
+#define WCORE_GL_THUNK_SIZE 16
+
+#define WCORE_GL_STATS_STR_(x) #x
+#define WCORE_GL_STATS_STR(x) WCORE_GL_STATS_STR_(x)
+
+extern const char wcore_gl_thunks[];
+
+// Only the assembly below calls these, so keep link-time optimization from
+// discarding them.
+__attribute__((used)) void*
+wcore_gl_thunk_begin(uint32_t slot, uint64_t *start);
+
+__attribute__((used)) void
+wcore_gl_thunk_end(uint32_t slot, uint64_t start);
+
+// Thunk i sets r11d to i, which no argument uses, and jumps to the body.
+// It starts with endbr64, spelled as bytes for older assemblers, so that it
+// is a valid target of indirect calls under IBT.
+//
+// The body follows the System V ABI. It saves the argument registers,
+// including al, the count of vector registers of variadic calls, and calls
+// wcore_gl_thunk_begin(). It then copies 16 quadwords of the caller's stack
+// arguments, more than any GL function takes, restores the registers and
+// calls the function. The copy may read past the caller's arguments, into
+// its own frame. Last it saves the return registers and calls
+// wcore_gl_thunk_end().
+//
+// The function is called, rather than jumped to with a patched return
+// address, so that the thunk keeps the stack balanced under shadow stacks,
+// and calls nest.
+__asm__(
+    "    .text\n"
+    "    .balign 16\n"
+    "    .globl wcore_gl_thunks\n"
+    "    .hidden wcore_gl_thunks\n"
+    "    .type wcore_gl_thunks, @function\n"
+    "wcore_gl_thunks:\n"
+    "    .set wcore_gl_thunk_index, 0\n"
+    "    .rept " WCORE_GL_STATS_STR(WCORE_GL_STATS_SLOTS) "\n"
+    "    .balign 16\n"
+    "    .byte 0xf3, 0x0f, 0x1e, 0xfa\n"
+    "    movl $wcore_gl_thunk_index, %r11d\n"
+    "    jmp wcore_gl_thunk_body\n"
+    "    .set wcore_gl_thunk_index, wcore_gl_thunk_index + 1\n"
+    "    .endr\n"
+    "    .size wcore_gl_thunks, . - wcore_gl_thunks\n"
+    "\n"
+    "    .balign 16\n"
+    "    .type wcore_gl_thunk_body, @function\n"
+    "wcore_gl_thunk_body:\n"
+    "    .cfi_startproc\n"
+    "    pushq %rbp\n"
+    "    .cfi_def_cfa_offset 16\n"
+    "    .cfi_offset %rbp, -16\n"
+    "    movq %rsp, %rbp\n"
+    "    .cfi_def_cfa_register %rbp\n"
+    "    pushq %r12\n"
+    "    pushq %r13\n"
+    "    .cfi_offset %r12, -24\n"
+    "    .cfi_offset %r13, -32\n"
+    // 0: stack arguments, 128: integer registers, 184: start time,
+    // 192: vector registers.
+    "    subq $320, %rsp\n"
+    "    movq %rdi, 128(%rsp)\n"
+    "    movq %rsi, 136(%rsp)\n"
+    "    movq %rdx, 144(%rsp)\n"
+    "    movq %rcx, 152(%rsp)\n"
+    "    movq %r8, 160(%rsp)\n"
+    "    movq %r9, 168(%rsp)\n"
+    "    movq %rax, 176(%rsp)\n"
+    "    movaps %xmm0, 192(%rsp)\n"
+    "    movaps %xmm1, 208(%rsp)\n"
+    "    movaps %xmm2, 224(%rsp)\n"
+    "    movaps %xmm3, 240(%rsp)\n"
+    "    movaps %xmm4, 256(%rsp)\n"
+    "    movaps %xmm5, 272(%rsp)\n"
+    "    movaps %xmm6, 288(%rsp)\n"
+    "    movaps %xmm7, 304(%rsp)\n"
+    "    movl %r11d, %r13d\n"
+    "    movl %r11d, %edi\n"
+    "    leaq 184(%rsp), %rsi\n"
+    "    call wcore_gl_thunk_begin\n"
+    "    movq %rax, %r12\n"
+    "    leaq 16(%rbp), %rsi\n"
+    "    movq %rsp, %rdi\n"
+    "    movl $16, %ecx\n"
+    "    rep movsq\n"
+    "    movq 128(%rsp), %rdi\n"
+    "    movq 136(%rsp), %rsi\n"
+    "    movq 144(%rsp), %rdx\n"
+    "    movq 152(%rsp), %rcx\n"
+    "    movq 160(%rsp), %r8\n"
+    "    movq 168(%rsp), %r9\n"
+    "    movq 176(%rsp), %rax\n"
+    "    movaps 192(%rsp), %xmm0\n"
+    "    movaps 208(%rsp), %xmm1\n"
+    "    movaps 224(%rsp), %xmm2\n"
+    "    movaps 240(%rsp), %xmm3\n"
+    "    movaps 256(%rsp), %xmm4\n"
+    "    movaps 272(%rsp), %xmm5\n"
+    "    movaps 288(%rsp), %xmm6\n"
+    "    movaps 304(%rsp), %xmm7\n"
+    "    call *%r12\n"
+    "    movq %rax, 128(%rsp)\n"
+    "    movq %rdx, 136(%rsp)\n"
+    "    movaps %xmm0, 192(%rsp)\n"
+    "    movaps %xmm1, 208(%rsp)\n"
+    "    movl %r13d, %edi\n"
+    "    movq 184(%rsp), %rsi\n"
+    "    call wcore_gl_thunk_end\n"
+    "    movq 128(%rsp), %rax\n"
+    "    movq 136(%rsp), %rdx\n"
+    "    movaps 192(%rsp), %xmm0\n"
+    "    movaps 208(%rsp), %xmm1\n"
+    "    addq $320, %rsp\n"
+    "    popq %r13\n"
+    "    popq %r12\n"
+    "    popq %rbp\n"
+    "    .cfi_def_cfa %rsp, 8\n"
+    "    ret\n"
+    "    .cfi_endproc\n"
+    "    .size wcore_gl_thunk_body, . - wcore_gl_thunk_body\n"
+);
+
+static inline void
+bump(uint64_t *p, uint64_t v)
+{
+    wcore_atomic_store_u64_relaxed(p, wcore_atomic_load_u64_relaxed(p) + v);
+}
+
+void*
+wcore_gl_thunk_begin(uint32_t slot, uint64_t *start)
+{
+    *start = wcore_atomic_load_bool(&wcore_gl_stats_enabled)
+           ? wcore_trace_now() : 0;
+
+    // The slot was filled before its thunk was returned.
+    return wcore_gl_stats_slots[slot].proc;
+}
+
+void
+wcore_gl_thunk_end(uint32_t slot, uint64_t start)
+{
+    struct wcore_tinfo *tinfo;
+    struct wcore_gl_stats_counters *c;
+    uint64_t ns;
+
+    if (!start)
+        return;
+
+    ns = wcore_trace_now() - start;
+
+    tinfo = wcore_tinfo_get();
+    if (!tinfo->gl_stats) {
+        tinfo->gl_stats = wcore_gl_stats_block(
+            wcore_block_pool_acquire(&wcore_gl_stats_pool,
+                                     sizeof(struct wcore_gl_stats_block),
+                                     tinfo));
+        // Without memory the call goes uncounted.
+        if (!tinfo->gl_stats)
+            return;
+    }
+
+    c = &tinfo->gl_stats->counters[slot];
+    bump(&c->calls, 1);
+    bump(&c->total_ns, ns);
+    if (ns > wcore_atomic_load_u64_relaxed(&c->max_ns))
+        wcore_atomic_store_u64_relaxed(&c->max_ns, ns);
+}
+
+#endif // WCORE_GL_STATS_HAS_THUNKS
+
+bool
+wcore_gl_stats_enable(bool enable)
+{
+    if (enable && !WCORE_GL_STATS_HAS_THUNKS) {
+        wcore_errorf(WAFFLE_ERROR_BUILT_WITHOUT_SUPPORT,
+                     "GL call stats need x86-64 ELF thunks");
+        return false;
+    }
+
+    wcore_atomic_store_bool(&wcore_gl_stats_enabled, enable);
+    return true;
+}
+
+void*
+wcore_gl_stats_wrap(const char *name, void *proc)
+{
+#if WCORE_GL_STATS_HAS_THUNKS
+    uint32_t i;
+
+    if (!proc || !name || !wcore_atomic_load_bool(&wcore_gl_stats_enabled))
+        return proc;
+
+    call_once(&wcore_gl_stats_once, wcore_gl_stats_init_once);
+    mtx_lock(&wcore_gl_stats_mutex);
+
+    for (i = 0; i < wcore_gl_stats_num_slots; ++i) {
+        struct wcore_gl_stats_slot *s = &wcore_gl_stats_slots[i];
+
+        if (s->proc == proc && strcmp(s->name, name) == 0)
+            break;
+    }
+
+    if (i == wcore_gl_stats_num_slots) {
+        char *copy = i < WCORE_GL_STATS_SLOTS ? strdup(name) : NULL;
+
+        if (!copy) {
+            mtx_unlock(&wcore_gl_stats_mutex);
+            return proc;
+        }
+
+        wcore_gl_stats_slots[i].name = copy;
+        wcore_gl_stats_slots[i].proc = proc;
+        wcore_gl_stats_num_slots++;
+    }
+
+    mtx_unlock(&wcore_gl_stats_mutex);
+    return (void*) (wcore_gl_thunks + i * WCORE_GL_THUNK_SIZE);
+#else
+    (void) name;
+    return proc;
+#endif
+}
+
+void
+wcore_gl_stats_release_block(struct wcore_gl_stats_block *block)
+{
+    if (block)
+        wcore_block_pool_release(&block->link);
+}
+
+static int
+compare_total_ns(const void *a, const void *b)
+{
+    const struct waffle_gl_call_stats *x = a;
+    const struct waffle_gl_call_stats *y = b;
+
+    return (x->total_ns < y->total_ns) - (x->total_ns > y->total_ns);
+}
+
+size_t
+wcore_gl_stats_snapshot(struct waffle_gl_call_stats *entries,
+                        size_t max_entries)
+{
+    struct waffle_gl_call_stats *all;
+    size_t n = 0;
+
+    call_once(&wcore_gl_stats_once, wcore_gl_stats_init_once);
+    mtx_lock(&wcore_gl_stats_mutex);
+
+    all = calloc(wcore_gl_stats_num_slots + 1, sizeof(*all));
+    if (!all) {
+        mtx_unlock(&wcore_gl_stats_mutex);
+        wcore_error(WAFFLE_ERROR_BAD_ALLOC);
+        return 0;
+    }
+
+    for (uint32_t i = 0; i < wcore_gl_stats_num_slots; ++i) {
+        const char *name = wcore_gl_stats_slots[i].name;
+        struct waffle_gl_call_stats *e = NULL;
+
+        // A name looked up in several libraries has a slot for each.
+        for (size_t j = 0; j < n; ++j) {
+            if (strcmp(all[j].name, name) == 0) {
+                e = &all[j];
+                break;
+            }
+        }
+
+        if (!e) {
+            e = &all[n++];
+            e->name = name;
+        }
+
+        for (struct wcore_block_pool_link *link =
+                 wcore_block_pool_first(&wcore_gl_stats_pool);
+             link; link = link->next) {
+            struct wcore_gl_stats_counters *c =
+                &wcore_gl_stats_block(link)->counters[i];
+            uint64_t max_ns = wcore_atomic_load_u64_relaxed(&c->max_ns);
+
+            e->calls += wcore_atomic_load_u64_relaxed(&c->calls);
+            e->total_ns += wcore_atomic_load_u64_relaxed(&c->total_ns);
+            if (max_ns > e->max_ns)
+                e->max_ns = max_ns;
+        }
+    }
+
+    mtx_unlock(&wcore_gl_stats_mutex);
+
+    qsort(all, n, sizeof(*all), compare_total_ns);
+    if (max_entries)
+        memcpy(entries, all, (n < max_entries ? n : max_entries) * sizeof(*all));
+    free(all);
+
+    return n;
+}
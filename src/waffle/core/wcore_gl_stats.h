@@ -0,0 +1,94 @@
+// Copyright 2016 Intel Corporation
+//
+// All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+//
+// - Redistributions of source code must retain the above copyright notice, this
+//   list of conditions and the following disclaimer.
+//
+// - Redistributions in binary form must reproduce the above copyright notice,
+//   this list of conditions and the following disclaimer in the documentation
+//   and/or other materials provided with the distribution.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+// DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+// FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+// DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+// SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+// CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+// OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+// OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+/// @file
+/// @brief Call counts and times of GL functions, through wrapped proc
+/// addresses.
+///
+/// When enabled with waffle_gl_stats_enable(), waffle_get_proc_address() and
+/// waffle_dl_sym() return, instead of the GL function, a thunk that counts
+/// the call, times it and forwards it. The time is that which the calling
+/// thread spends in the GL function, the CPU side of the call.
+///
+/// A GL function may have any signature, so the thunks are written in
+/// assembly. They are a fixed table of WCORE_GL_STATS_SLOTS entries, in the
+/// library's text, each of which loads its index and jumps to a common body.
+/// The body saves the argument registers, copies a fixed window of stack
+/// arguments, and calls the function looked up for its index. Each pair of
+/// name and function gets one slot for the life of the process. When the
+/// slots run out, the function itself is returned.
+///
+/// The thunks exist only for x86-64 ELF targets. Elsewhere enabling the
+/// stats fails with WAFFLE_ERROR_BUILT_WITHOUT_SUPPORT.
+///
+/// Each thread records into its own block of counters, as in wcore_stats.h.
+/// A snapshot sums the blocks and merges the slots of each name.
+
+#pragma once
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+#include "waffle.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+struct wcore_gl_stats_block;
+
+/// Number of thunks.
+#define WCORE_GL_STATS_SLOTS 1024
+
+/// @brief Enable or disable the stats.
+///
+/// Thunks already returned keep forwarding, but count only while the stats
+/// are enabled. Return false if the target has no thunks.
+bool
+wcore_gl_stats_enable(bool enable);
+
+/// @brief Return the thunk of the function @a proc, named @a name.
+///
+/// Return @a proc itself if the stats are disabled, @a proc is null, or no
+/// slot is free.
+void*
+wcore_gl_stats_wrap(const char *name, void *proc);
+
+/// @brief Sum the counters of all threads, by function name, into
+/// @a entries, ordered by total time, highest first.
+///
+/// Fill at most @a max_entries entries and return the number of names.
+/// Emit WAFFLE_ERROR_BAD_ALLOC and return 0 on failure.
+size_t
+wcore_gl_stats_snapshot(struct waffle_gl_call_stats *entries,
+                        size_t max_entries);
+
+/// @brief Return the calling thread's block to the pool. Called at thread exit.
+void
+wcore_gl_stats_release_block(struct wcore_gl_stats_block *block);
+
+#ifdef __cplusplus
+}
+#endif
@@ -0,0 +1,196 @@
+// Copyright 2016 Intel Corporation
+//
+// All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+//
+// - Redistributions of source code must retain the above copyright notice, this
+//   list of conditions and the following disclaimer.
+//
+// - Redistributions in binary form must reproduce the above copyright notice,
+//   this list of conditions and the following disclaimer in the documentation
+//   and/or other materials provided with the distribution.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+// DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+// FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+// DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+// SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+// CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+// OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+// OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+#include <setjmp.h>
+#include <stdarg.h>
+#include <stdint.h>
+#include <string.h>
+
+#include <cmocka.h>
+
+#include "threads.h"
+
+#include "wcore_error.h"
+#include "wcore_gl_stats.h"
+
+#if defined(__x86_64__) && defined(__ELF__)
+
+// More integer and vector arguments than fit in registers, so that some are
+// passed on the stack.
+typedef double (*many_args_func)(int a, int b, int c, int d, int e, int f,
+                                 int g, int h, double x0, double x1,
+                                 double x2, double x3, double x4, double x5,
+                                 double x6, double x7, double x8, double x9);
+
+static double
+many_args(int a, int b, int c, int d, int e, int f, int g, int h,
+          double x0, double x1, double x2, double x3, double x4, double x5,
+          double x6, double x7, double x8, double x9)
+{
+    return a + 2 * b + 3 * c + 4 * d + 5 * e + 6 * f + 7 * g + 8 * h
+         + x0 + 2 * x1 + 3 * x2 + 4 * x3 + 5 * x4 + 6 * x5 + 7 * x6
+         + 8 * x7 + 9 * x8 + 10 * x9;
+}
+
+typedef const char *(*pointer_func)(const char *s, unsigned long n);
+
+static const char*
+pointer(const char *s, unsigned long n)
+{
+    return s + n;
+}
+
+static const struct waffle_gl_call_stats*
+find(const struct waffle_gl_call_stats *entries, size_t n, const char *name)
+{
+    for (size_t i = 0; i < n; ++i) {
+        if (strcmp(entries[i].name, name) == 0)
+            return &entries[i];
+    }
+
+    return NULL;
+}
+
+static struct waffle_gl_call_stats entries[WCORE_GL_STATS_SLOTS];
+
+static void
+test_wcore_gl_stats_disabled(void **state) {
+    void *proc = (void*) pointer;
+
+    assert_true(wcore_gl_stats_enable(false));
+    assert_true(wcore_gl_stats_wrap("glDisabled", proc) == proc);
+}
+
+static void
+test_wcore_gl_stats_forward(void **state) {
+    many_args_func f;
+    pointer_func g;
+    const struct waffle_gl_call_stats *e;
+    const char *s = "abcdef";
+    size_t n;
+
+    assert_true(wcore_gl_stats_enable(true));
+
+    f = (many_args_func) wcore_gl_stats_wrap("glManyArgs", (void*) many_args);
+    g = (pointer_func) wcore_gl_stats_wrap("glPointer", (void*) pointer);
+    assert_true(f != many_args);
+    assert_true(g != pointer);
+
+    // The same function under the same name has a single thunk.
+    assert_true(wcore_gl_stats_wrap("glPointer", (void*) pointer) ==
+                (void*) g);
+
+    for (int i = 0; i < 3; ++i) {
+        double expect = many_args(1, 2, 3, 4, 5, 6, 7, i,
+                                  0.5, 1.5, 2.5, 3.5, 4.5, 5.5,
+                                  6.5, 7.5, 8.5, 9.5);
+
+        assert_true(f(1, 2, 3, 4, 5, 6, 7, i,
+                      0.5, 1.5, 2.5, 3.5, 4.5, 5.5,
+                      6.5, 7.5, 8.5, 9.5) == expect);
+    }
+    assert_true(g(s, 4) == s + 4);
+
+    n = wcore_gl_stats_snapshot(entries, WCORE_GL_STATS_SLOTS);
+    e = find(entries, n, "glManyArgs");
+    assert_non_null(e);
+    assert_int_equal(e->calls, 3);
+    assert_true(e->max_ns <= e->total_ns);
+    e = find(entries, n, "glPointer");
+    assert_non_null(e);
+    assert_int_equal(e->calls, 1);
+
+    // Entries are ordered by total time.
+    for (size_t i = 1; i < n; ++i)
+        assert_true(entries[i - 1].total_ns >= entries[i].total_ns);
+
+    // Thunks keep forwarding once the stats are disabled, uncounted.
+    assert_true(wcore_gl_stats_enable(false));
+    assert_true(g(s, 2) == s + 2);
+    n = wcore_gl_stats_snapshot(entries, WCORE_GL_STATS_SLOTS);
+    assert_int_equal(find(entries, n, "glPointer")->calls, 1);
+}
+
+static int
+call_in_thread(void *arg)
+{
+    pointer_func g = (pointer_func) arg;
+
+    for (int i = 0; i < 5; ++i)
+        g("x", 0);
+
+    return 0;
+}
+
+static void
+test_wcore_gl_stats_threads(void **state) {
+    pointer_func g;
+    thrd_t thread;
+    size_t n;
+
+    assert_true(wcore_gl_stats_enable(true));
+    g = (pointer_func) wcore_gl_stats_wrap("glThreaded", (void*) pointer);
+
+    g("x", 0);
+    assert_int_equal(thrd_create(&thread, call_in_thread, (void*) g),
+                     thrd_success);
+    thrd_join(thread, NULL);
+
+    // The counts of both threads are merged.
+    n = wcore_gl_stats_snapshot(entries, WCORE_GL_STATS_SLOTS);
+    assert_int_equal(find(entries, n, "glThreaded")->calls, 6);
+
+    assert_true(wcore_gl_stats_enable(false));
+}
+
+int
+main(void) {
+    const UnitTest tests[] = {
+        unit_test(test_wcore_gl_stats_disabled),
+        unit_test(test_wcore_gl_stats_forward),
+        unit_test(test_wcore_gl_stats_threads),
+    };
+
+    return run_tests(tests);
+}
+
+#else
+
+static void
+test_wcore_gl_stats_unsupported(void **state) {
+    assert_false(wcore_gl_stats_enable(true));
+    assert_int_equal(wcore_error_get_code(),
+                     WAFFLE_ERROR_BUILT_WITHOUT_SUPPORT);
+}
+
+int
+main(void) {
+    const UnitTest tests[] = {
+        unit_test(test_wcore_gl_stats_unsupported),
+    };
+
+    return run_tests(tests);
+}
+
+#endif
@@ -0,0 +1,287 @@
+// Copyright 2016 Intel Corporation
+//
+// All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+//
+// - Redistributions of source code must retain the above copyright notice, this
+//   list of conditions and the following disclaimer.
+//
+// - Redistributions in binary form must reproduce the above copyright notice,
+//   this list of conditions and the following disclaimer in the documentation
+//   and/or other materials provided with the distribution.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+// DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+// FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+// DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+// SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+// CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+// OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+// OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+#include <stdlib.h>
+#include <string.h>
+
+#include "wcore_atomic.h"
+#include "wcore_context.h"
+#include "wcore_display.h"
+#include "wcore_frame_stats.h"
+#include "wcore_gpu_timer.h"
+#include "wcore_tinfo.h"
+#include "wcore_util.h"
+#include "wcore_window.h"
+
+#define GL_QUERY_RESULT             0x8866
+#define GL_QUERY_RESULT_AVAILABLE   0x8867
+#define GL_TIMESTAMP                0x8E28
+#define GL_GPU_DISJOINT_EXT         0x8FBB
+
+struct wcore_gpu_timer*
+wcore_gpu_timer_create(void)
+{
+    return wcore_calloc(sizeof(struct wcore_gpu_timer));
+}
+
+/// Return true if the bound context is current in the calling thread.
+static bool
+context_is_current(const struct wcore_gpu_timer *self)
+{
+    struct wcore_context *ctx = wcore_tinfo_get()->current_context;
+
+    return self->supported && ctx && ctx->serial == self->context_serial;
+}
+
+/// Push the queries of the timer onto the list of the context they belong
+/// to, which is not current in the calling thread. The registry lock keeps
+/// the context from being destroyed meanwhile. If it already was, its
+/// queries went with it.
+static void
+retire(struct wcore_gpu_timer *self, struct wcore_display *dpy)
+{
+    struct wcore_gpu_timer_retired *node;
+    struct api_object *obj;
+
+    mtx_lock(&dpy->registry.mutex);
+
+    for (obj = dpy->registry.head[WCORE_OBJECT_CONTEXT]; obj;
+         obj = obj->registry_next) {
+        struct wcore_context *ctx = container_of(obj, struct wcore_context,
+                                                 api);
+
+        if (ctx->serial != self->context_serial)
+            continue;
+
+        node = malloc(sizeof(*node));
+        if (!node)
+            break;
+
+        node->delete_queries = self->gl.delete_queries;
+        memcpy(node->queries, self->queries, sizeof(node->queries));
+
+        do {
+            node->next = wcore_atomic_load_ptr((void**) &ctx->retired_queries);
+        } while (!wcore_atomic_cas_ptr((void**) &ctx->retired_queries,
+                                       node->next, node));
+        break;
+    }
+
+    mtx_unlock(&dpy->registry.mutex);
+}
+
+/// Delete the queries of the timer, or retire them if their context is not
+/// current.
+static void
+release(struct wcore_gpu_timer *self, struct wcore_window *window)
+{
+    if (!self->supported)
+        return;
+
+    if (context_is_current(self))
+        self->gl.delete_queries(WCORE_GPU_TIMER_QUERIES, self->queries);
+    else
+        retire(self, window->display);
+}
+
+void
+wcore_gpu_timer_destroy(struct wcore_window *window)
+{
+    struct wcore_gpu_timer *self = window->gpu_timer;
+
+    if (!self)
+        return;
+
+    release(self, window);
+    free(self);
+    window->gpu_timer = NULL;
+}
+
+bool
+wcore_gpu_timer_is_bound(const struct wcore_gpu_timer *self, size_t serial)
+{
+    return self->context_serial == serial;
+}
+
+void
+wcore_gpu_timer_bind(struct wcore_window *window, size_t serial,
+                     const struct wcore_gpu_timer_gl *gl)
+{
+    struct wcore_gpu_timer *self = window->gpu_timer;
+    uint64_t frames = self->frames;
+
+    release(self, window);
+    memset(self, 0, sizeof(*self));
+    self->context_serial = serial;
+    self->frames = frames;
+
+    if (!gl)
+        return;
+
+    self->gl = *gl;
+    self->gl.gen_queries(WCORE_GPU_TIMER_QUERIES, self->queries);
+    self->supported = true;
+}
+
+void
+wcore_gpu_timer_delete_retired(struct wcore_context *ctx)
+{
+    struct wcore_gpu_timer_retired *list, *next;
+
+    do {
+        list = wcore_atomic_load_ptr((void**) &ctx->retired_queries);
+        if (!list)
+            return;
+    } while (!wcore_atomic_cas_ptr((void**) &ctx->retired_queries,
+                                   list, NULL));
+
+    for (; list; list = next) {
+        next = list->next;
+        list->delete_queries(WCORE_GPU_TIMER_QUERIES, list->queries);
+        free(list);
+    }
+}
+
+void
+wcore_gpu_timer_free_retired(struct wcore_gpu_timer_retired *list)
+{
+    struct wcore_gpu_timer_retired *next;
+
+    for (; list; list = next) {
+        next = list->next;
+        free(list);
+    }
+}
+
+/// Return true if @a window is drawn by the bound context in the calling
+/// thread.
+static bool
+is_current(const struct wcore_gpu_timer *self, struct wcore_window *window)
+{
+    return context_is_current(self) &&
+           wcore_tinfo_get()->current_window == window;
+}
+
+static void
+place(struct wcore_gpu_timer *self, bool ends_frame, uint64_t frame)
+{
+    struct wcore_gpu_timer_mark *mark;
+    uint32_t i;
+
+    if (self->count == WCORE_GPU_TIMER_QUERIES) {
+        // The GPU is too many frames behind. Rather than wait for it, give
+        // up on this timestamp.
+        self->dropped = true;
+        return;
+    }
+
+    i = (self->first + self->count) % WCORE_GPU_TIMER_QUERIES;
+    self->gl.query_counter(self->queries[i], GL_TIMESTAMP);
+
+    mark = &self->marks[i];
+    mark->frame = frame;
+    mark->ends_frame = ends_frame && !self->dropped;
+    self->dropped = false;
+    self->count++;
+}
+
+/// Read the timestamps that are available, oldest first, and fill in the
+/// GPU time of the frames they end.
+static void
+harvest(struct wcore_gpu_timer *self, struct wcore_window *window)
+{
+    int disjoint = 0;
+
+    if (self->gl.get_integerv)
+        self->gl.get_integerv(GL_GPU_DISJOINT_EXT, &disjoint);
+
+    // The timestamps in flight may have been taken across the disjoint
+    // operation. Discard them, and start over with the next one placed.
+    if (disjoint) {
+        for (uint32_t n = 0; n < self->count; ++n) {
+            uint32_t i = (self->first + n) % WCORE_GPU_TIMER_QUERIES;
+            self->marks[i].ends_frame = false;
+        }
+        self->dropped = true;
+    }
+
+    while (self->count > 0) {
+        const struct wcore_gpu_timer_mark *mark = &self->marks[self->first];
+        unsigned int query = self->queries[self->first];
+        int available = 0;
+        uint64_t timestamp = 0;
+
+        self->gl.get_query_objectiv(query, GL_QUERY_RESULT_AVAILABLE,
+                                    &available);
+        if (!available)
+            break;
+
+        self->gl.get_query_objectui64v(query, GL_QUERY_RESULT, &timestamp);
+
+        if (mark->ends_frame && self->has_last &&
+            timestamp > self->last_timestamp) {
+            wcore_frame_stats_set_gpu(
+                wcore_atomic_load_ptr((void**) &window->frame_stats),
+                mark->frame, timestamp - self->last_timestamp);
+        }
+
+        self->last_timestamp = timestamp;
+        self->has_last = true;
+        self->first = (self->first + 1) % WCORE_GPU_TIMER_QUERIES;
+        self->count--;
+    }
+}
+
+void
+wcore_gpu_timer_make_current(struct wcore_window *window)
+{
+    struct wcore_gpu_timer *self = window->gpu_timer;
+
+    if (!self || !is_current(self, window))
+        return;
+
+    place(self, false, 0);
+}
+
+void
+wcore_gpu_timer_swap(struct wcore_window *window)
+{
+    struct wcore_gpu_timer *self = window->gpu_timer;
+    uint64_t frame;
+
+    if (!self)
+        return;
+
+    frame = self->frames++;
+
+    // The frame was not drawn by the bound context, or not in this thread.
+    if (!is_current(self, window)) {
+        self->dropped = true;
+        return;
+    }
+
+    harvest(self, window);
+    place(self, true, frame);
+}
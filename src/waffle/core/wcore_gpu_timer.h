@@ -0,0 +1,169 @@
+// Copyright 2016 Intel Corporation
+//
+// All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+//
+// - Redistributions of source code must retain the above copyright notice, this
+//   list of conditions and the following disclaimer.
+//
+// - Redistributions in binary form must reproduce the above copyright notice,
+//   this list of conditions and the following disclaimer in the documentation
+//   and/or other materials provided with the distribution.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+// DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+// FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+// DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+// SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+// CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+// OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+// OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+/// @file
+/// @brief GPU time of each frame of a window, measured with timer queries.
+///
+/// A window created with WAFFLE_WINDOW_GPU_TIMING owns a timer. When the
+/// window is made current, the api layer binds the timer to the context with
+/// wcore_gpu_timer_bind() and places a timestamp query, which marks the start
+/// of the first frame. Each swap of the window places another one, which
+/// ends the frame and starts the next. The GPU time of a frame is the
+/// difference of its two timestamps.
+///
+/// Timestamps, rather than GL_TIME_ELAPSED queries, are used because only
+/// one elapsed query may be active at a time, and the application may be
+/// using it.
+///
+/// Results are read without blocking at later swaps, once the GPU has
+/// reached them, and filled into the window's frame stats. Frames whose
+/// queries could not be placed, or whose results the GPU reports as
+/// disjoint, are left without a GPU time.
+///
+/// Query objects belong to a context. When the window is made current with
+/// another context, the timer starts over with new queries. Those of the
+/// previous context are deleted at once if it is current in the calling
+/// thread. Otherwise they are retired to it, and deleted the next time it is
+/// made current, or freed with it.
+
+#pragma once
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+struct wcore_context;
+struct wcore_window;
+
+/// Number of timestamp queries a timer has in flight at most.
+#define WCORE_GPU_TIMER_QUERIES 8
+
+/// @brief The GL functions used by a timer.
+///
+/// They are those of GL_ARB_timer_query, or of GL_EXT_disjoint_timer_query
+/// under OpenGL ES.
+struct wcore_gpu_timer_gl {
+    void (*gen_queries)(int n, unsigned int *ids);
+    void (*delete_queries)(int n, const unsigned int *ids);
+    void (*query_counter)(unsigned int id, unsigned int target);
+    void (*get_query_objectiv)(unsigned int id, unsigned int pname,
+                               int *params);
+    void (*get_query_objectui64v)(unsigned int id, unsigned int pname,
+                                  uint64_t *params);
+
+    /// Null unless the context reports GL_GPU_DISJOINT_EXT.
+    void (*get_integerv)(unsigned int pname, int *data);
+};
+
+struct wcore_gpu_timer {
+    struct wcore_gpu_timer_gl gl;
+
+    /// Serial of the context the queries belong to, or 0.
+    size_t context_serial;
+
+    /// False if the bound context does not support timer queries.
+    bool supported;
+
+    unsigned int queries[WCORE_GPU_TIMER_QUERIES];
+
+    /// Queries in flight, oldest first, starting at index @a first.
+    struct wcore_gpu_timer_mark {
+        /// The frame the timestamp ends, if @a ends_frame.
+        uint64_t frame;
+        bool ends_frame;
+    } marks[WCORE_GPU_TIMER_QUERIES];
+    uint32_t first;
+    uint32_t count;
+
+    /// The last timestamp read, if @a has_last.
+    uint64_t last_timestamp;
+    bool has_last;
+
+    /// True if a timestamp was dropped since the last one placed, so that
+    /// the next one cannot end a frame.
+    bool dropped;
+
+    /// Swaps of the window, which numbers its frames.
+    uint64_t frames;
+};
+
+/// @brief Queries of a timer that left their context while it was not
+/// current.
+struct wcore_gpu_timer_retired {
+    struct wcore_gpu_timer_retired *next;
+    void (*delete_queries)(int n, const unsigned int *ids);
+    unsigned int queries[WCORE_GPU_TIMER_QUERIES];
+};
+
+struct wcore_gpu_timer*
+wcore_gpu_timer_create(void);
+
+/// @brief Free the timer of @a window, if any.
+///
+/// Its queries are deleted if their context is current, and retired to it
+/// otherwise.
+void
+wcore_gpu_timer_destroy(struct wcore_window *window);
+
+/// @brief Return true if the timer is bound to the context of @a serial.
+bool
+wcore_gpu_timer_is_bound(const struct wcore_gpu_timer *self, size_t serial);
+
+/// @brief Bind the timer of @a window to the context of @a serial, current
+/// in the calling thread.
+///
+/// If @a gl is null, the context does not support timer queries and the
+/// timer is idle until bound to another one.
+void
+wcore_gpu_timer_bind(struct wcore_window *window, size_t serial,
+                     const struct wcore_gpu_timer_gl *gl);
+
+/// @brief Delete the queries retired to @a ctx, just made current in the
+/// calling thread.
+void
+wcore_gpu_timer_delete_retired(struct wcore_context *ctx);
+
+/// @brief Free a list of retired queries without deleting them, because
+/// their context is gone.
+void
+wcore_gpu_timer_free_retired(struct wcore_gpu_timer_retired *list);
+
+/// @brief Mark the start of a frame of @a window, just made current.
+void
+wcore_gpu_timer_make_current(struct wcore_window *window);
+
+/// @brief Mark the end of a frame of @a window, which is about to be swapped.
+///
+/// First harvest the results that are available.
+void
+wcore_gpu_timer_swap(struct wcore_window *window);
+
+#ifdef __cplusplus
+}
+#endif
@@ -0,0 +1,350 @@
+// Copyright 2016 Intel Corporation
+//
+// All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+//
+// - Redistributions of source code must retain the above copyright notice, this
+//   list of conditions and the following disclaimer.
+//
+// - Redistributions in binary form must reproduce the above copyright notice,
+//   this list of conditions and the following disclaimer in the documentation
+//   and/or other materials provided with the distribution.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+// DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+// FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+// DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+// SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+// CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+// OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+// OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+#include <setjmp.h>
+#include <stdarg.h>
+#include <stdint.h>
+#include <string.h>
+
+#include <cmocka.h>
+
+#include "wcore_context.h"
+#include "wcore_display.h"
+#include "wcore_frame_stats.h"
+#include "wcore_gpu_timer.h"
+#include "wcore_platform.h"
+#include "wcore_tinfo.h"
+#include "wcore_window.h"
+
+#define GL_QUERY_RESULT             0x8866
+#define GL_QUERY_RESULT_AVAILABLE   0x8867
+#define GL_TIMESTAMP                0x8E28
+#define GL_GPU_DISJOINT_EXT         0x8FBB
+
+#define MAX_QUERIES 64
+
+// A fake GPU, whose clock the tests set, and which completes its queries
+// only when told to.
+static struct {
+    uint64_t clock;
+    int disjoint;
+    unsigned int num_queries;
+    unsigned int num_deleted;
+    struct {
+        uint64_t timestamp;
+        bool available;
+    } queries[MAX_QUERIES];
+} gpu;
+
+static void
+fake_gen_queries(int n, unsigned int *ids)
+{
+    for (int i = 0; i < n; ++i)
+        ids[i] = ++gpu.num_queries;
+}
+
+static void
+fake_delete_queries(int n, const unsigned int *ids)
+{
+    gpu.num_deleted += n;
+}
+
+static void
+fake_query_counter(unsigned int id, unsigned int target)
+{
+    assert_int_equal(target, GL_TIMESTAMP);
+    gpu.queries[id].timestamp = gpu.clock;
+    gpu.queries[id].available = false;
+}
+
+static void
+fake_get_query_objectiv(unsigned int id, unsigned int pname, int *params)
+{
+    assert_int_equal(pname, GL_QUERY_RESULT_AVAILABLE);
+    *params = gpu.queries[id].available;
+}
+
+static void
+fake_get_query_objectui64v(unsigned int id, unsigned int pname,
+                           uint64_t *params)
+{
+    assert_int_equal(pname, GL_QUERY_RESULT);
+    assert_true(gpu.queries[id].available);
+    *params = gpu.queries[id].timestamp;
+}
+
+static void
+fake_get_integerv(unsigned int pname, int *data)
+{
+    assert_int_equal(pname, GL_GPU_DISJOINT_EXT);
+    *data = gpu.disjoint;
+    gpu.disjoint = 0;
+}
+
+static const struct wcore_gpu_timer_gl fake_gl = {
+    .gen_queries = fake_gen_queries,
+    .delete_queries = fake_delete_queries,
+    .query_counter = fake_query_counter,
+    .get_query_objectiv = fake_get_query_objectiv,
+    .get_query_objectui64v = fake_get_query_objectui64v,
+    .get_integerv = fake_get_integerv,
+};
+
+static void
+gpu_finish(void)
+{
+    for (unsigned int i = 0; i < MAX_QUERIES; ++i)
+        gpu.queries[i].available = true;
+}
+
+static struct wcore_platform platform;
+static struct wcore_display dpy;
+static struct wcore_context ctx;
+static struct wcore_window window;
+
+static void
+setup(void **state) {
+    memset(&gpu, 0, sizeof(gpu));
+    memset(&dpy, 0, sizeof(dpy));
+    memset(&ctx, 0, sizeof(ctx));
+    memset(&window, 0, sizeof(window));
+
+    assert_true(wcore_display_init(&dpy, &platform));
+    ctx.display = &dpy;
+    ctx.serial = 1;
+    wcore_display_register(&dpy, WCORE_OBJECT_CONTEXT, &ctx.api);
+    window.display = &dpy;
+
+    wcore_tinfo_get()->current_context = &ctx;
+    wcore_tinfo_get()->current_window = &window;
+
+    window.gpu_timer = wcore_gpu_timer_create();
+    assert_non_null(window.gpu_timer);
+    wcore_gpu_timer_bind(&window, ctx.serial, &fake_gl);
+}
+
+static void
+teardown(void **state) {
+    wcore_gpu_timer_destroy(&window);
+    wcore_frame_stats_destroy(window.frame_stats);
+    wcore_display_unregister(&dpy, WCORE_OBJECT_CONTEXT, &ctx.api);
+    wcore_gpu_timer_free_retired(ctx.retired_queries);
+    wcore_display_teardown(&dpy);
+    wcore_tinfo_get()->current_context = NULL;
+    wcore_tinfo_get()->current_window = NULL;
+}
+
+/// Swap the window when the GPU clock reads @a clock.
+static void
+swap(uint64_t clock)
+{
+    struct wcore_window *windows[] = { &window };
+    uint64_t begin;
+
+    gpu.clock = clock;
+    wcore_gpu_timer_swap(&window);
+    begin = wcore_frame_stats_swap_begin();
+    wcore_frame_stats_swap_end(windows, 1, begin);
+}
+
+static void
+get_stats(struct waffle_frame_stats *stats)
+{
+    wcore_frame_stats_get(window.frame_stats, stats);
+}
+
+static void
+test_wcore_gpu_timer_frames(void **state) {
+    struct waffle_frame_stats stats;
+
+    gpu.clock = 1000;
+    wcore_gpu_timer_make_current(&window);
+
+    swap(3000);
+    swap(7000);
+
+    // Nothing is available yet.
+    get_stats(&stats);
+    assert_int_equal(stats.frames[0].gpu_ns, 0);
+    assert_int_equal(stats.gpu.max_ns, 0);
+
+    gpu_finish();
+    swap(8000);
+
+    get_stats(&stats);
+    assert_int_equal(stats.num_frames, 3);
+    assert_int_equal(stats.frames[0].gpu_ns, 2000);
+    assert_int_equal(stats.frames[1].gpu_ns, 4000);
+    assert_int_equal(stats.frames[2].gpu_ns, 0);
+    assert_int_equal(stats.gpu.p50_ns, 2000);
+    assert_int_equal(stats.gpu.max_ns, 4000);
+}
+
+static void
+test_wcore_gpu_timer_disjoint(void **state) {
+    struct waffle_frame_stats stats;
+
+    gpu.clock = 1000;
+    wcore_gpu_timer_make_current(&window);
+    swap(2000);
+    swap(3000);
+    gpu_finish();
+
+    gpu.disjoint = 1;
+    swap(5000);
+    gpu_finish();
+    swap(9000);
+    gpu_finish();
+    swap(10000);
+
+    // The frames in flight at the disjoint operation are discarded, and the
+    // timer starts over at the next swap.
+    get_stats(&stats);
+    assert_int_equal(stats.frames[0].gpu_ns, 0);
+    assert_int_equal(stats.frames[1].gpu_ns, 0);
+    assert_int_equal(stats.frames[2].gpu_ns, 0);
+    assert_int_equal(stats.frames[3].gpu_ns, 4000);
+}
+
+static void
+test_wcore_gpu_timer_not_current(void **state) {
+    struct wcore_window other;
+    struct waffle_frame_stats stats;
+
+    gpu.clock = 1000;
+    wcore_gpu_timer_make_current(&window);
+    swap(2000);
+
+    // The window is swapped while another is current.
+    wcore_tinfo_get()->current_window = &other;
+    swap(3000);
+    wcore_tinfo_get()->current_window = &window;
+
+    swap(4000);
+    swap(6000);
+    gpu_finish();
+    swap(7000);
+
+    // Frame 2 lacks its start, which frame 1 would have placed.
+    get_stats(&stats);
+    assert_int_equal(stats.frames[0].gpu_ns, 1000);
+    assert_int_equal(stats.frames[1].gpu_ns, 0);
+    assert_int_equal(stats.frames[2].gpu_ns, 0);
+    assert_int_equal(stats.frames[3].gpu_ns, 2000);
+}
+
+static void
+test_wcore_gpu_timer_gpu_behind(void **state) {
+    struct waffle_frame_stats stats;
+
+    gpu.clock = 0;
+    wcore_gpu_timer_make_current(&window);
+
+    // With the start, this fills all queries, then drops one frame.
+    for (int i = 1; i <= WCORE_GPU_TIMER_QUERIES; ++i)
+        swap(1000 * i);
+
+    gpu_finish();
+    swap(10000);
+    gpu_finish();
+    swap(11000);
+
+    get_stats(&stats);
+    for (int i = 0; i < WCORE_GPU_TIMER_QUERIES - 1; ++i)
+        assert_int_equal(stats.frames[i].gpu_ns, 1000);
+    assert_int_equal(stats.frames[WCORE_GPU_TIMER_QUERIES - 1].gpu_ns, 0);
+    assert_int_equal(stats.frames[WCORE_GPU_TIMER_QUERIES].gpu_ns, 0);
+}
+
+static void
+test_wcore_gpu_timer_unsupported(void **state) {
+    struct waffle_frame_stats stats;
+
+    wcore_gpu_timer_bind(&window, ctx.serial, NULL);
+    assert_int_equal(gpu.num_deleted, WCORE_GPU_TIMER_QUERIES);
+    wcore_gpu_timer_make_current(&window);
+    swap(1000);
+    swap(2000);
+
+    get_stats(&stats);
+    assert_int_equal(stats.num_frames, 2);
+    assert_int_equal(stats.gpu.max_ns, 0);
+}
+
+static void
+test_wcore_gpu_timer_rebind(void **state) {
+    struct wcore_context other = { .serial = 2 };
+
+    // The first context is no longer current, so its queries cannot be
+    // deleted yet.
+    wcore_tinfo_get()->current_context = &other;
+    wcore_gpu_timer_bind(&window, other.serial, &fake_gl);
+    assert_int_equal(gpu.num_queries, 2 * WCORE_GPU_TIMER_QUERIES);
+    assert_int_equal(gpu.num_deleted, 0);
+    assert_non_null(ctx.retired_queries);
+
+    wcore_tinfo_get()->current_context = &ctx;
+    wcore_gpu_timer_delete_retired(&ctx);
+    assert_int_equal(gpu.num_deleted, WCORE_GPU_TIMER_QUERIES);
+    assert_null(ctx.retired_queries);
+
+    // The other context was never registered, as if it were destroyed,
+    // which took its queries with it.
+    wcore_gpu_timer_bind(&window, ctx.serial, &fake_gl);
+    assert_int_equal(gpu.num_deleted, WCORE_GPU_TIMER_QUERIES);
+    assert_null(ctx.retired_queries);
+}
+
+static void
+test_wcore_gpu_timer_destroy(void **state) {
+    assert_true(wcore_gpu_timer_is_bound(window.gpu_timer, ctx.serial));
+    assert_false(wcore_gpu_timer_is_bound(window.gpu_timer, ctx.serial + 1));
+
+    wcore_gpu_timer_destroy(&window);
+    assert_int_equal(gpu.num_deleted, WCORE_GPU_TIMER_QUERIES);
+    assert_true(window.gpu_timer == NULL);
+}
+
+int
+main(void) {
+    const UnitTest tests[] = {
+        unit_test_setup_teardown(test_wcore_gpu_timer_frames,
+                                 setup, teardown),
+        unit_test_setup_teardown(test_wcore_gpu_timer_disjoint,
+                                 setup, teardown),
+        unit_test_setup_teardown(test_wcore_gpu_timer_not_current,
+                                 setup, teardown),
+        unit_test_setup_teardown(test_wcore_gpu_timer_gpu_behind,
+                                 setup, teardown),
+        unit_test_setup_teardown(test_wcore_gpu_timer_unsupported,
+                                 setup, teardown),
+        unit_test_setup_teardown(test_wcore_gpu_timer_rebind,
+                                 setup, teardown),
+        unit_test_setup_teardown(test_wcore_gpu_timer_destroy,
+                                 setup, teardown),
+    };
+
+    return run_tests(tests);
+}
@@ -0,0 +1,152 @@
+// Copyright 2016 Intel Corporation
+//
+// All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+//
+// - Redistributions of source code must retain the above copyright notice, this
+//   list of conditions and the following disclaimer.
+//
+// - Redistributions in binary form must reproduce the above copyright notice,
+//   this list of conditions and the following disclaimer in the documentation
+//   and/or other materials provided with the distribution.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+// DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+// FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+// DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+// SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+// CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+// OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+// OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+#include <string.h>
+
+#include "wcore_atomic.h"
+#include "wcore_config_attrs.h"
+#include "wcore_context.h"
+#include "wcore_display.h"
+#include "wcore_frame_stats.h"
+#include "wcore_gpu_timer.h"
+#include "wcore_memory.h"
+#include "wcore_window.h"
+
+/// Round @a bits up to a whole number of bytes that is a power of two, as
+/// drivers store 24-bit pixels in 32 bits.
+static uint32_t
+bytes_per_pixel(int32_t bits)
+{
+    uint32_t bytes = 1;
+
+    if (bits <= 0)
+        return 0;
+
+    while (8 * bytes < (uint32_t) bits)
+        bytes *= 2;
+
+    return bytes;
+}
+
+void
+wcore_memory_layout_init(struct wcore_memory_layout *self,
+                         const struct wcore_config_attrs *attrs)
+{
+    uint32_t samples = 1;
+    int32_t depth_stencil = 0;
+
+    if (attrs->sample_buffers && attrs->samples > 1)
+        samples = (uint32_t) attrs->samples;
+
+    if (attrs->depth_size > 0)
+        depth_stencil += attrs->depth_size;
+    if (attrs->stencil_size > 0)
+        depth_stencil += attrs->stencil_size;
+
+    // If the application did not care, assume 8-bit RGBA.
+    self->color_bytes = bytes_per_pixel(attrs->rgba_size > 0 ? attrs->rgba_size
+                                                             : 32);
+
+    // A multisampled window renders into a multisampled buffer and resolves
+    // into the single-sampled buffers that are swapped.
+    self->color_buffers = attrs->double_buffered ? 2 : 1;
+    if (samples > 1)
+        self->color_buffers += samples;
+
+    self->ancillary_bytes = samples * bytes_per_pixel(depth_stencil);
+    if (attrs->accum_buffer)
+        self->ancillary_bytes += 8;
+}
+
+uint64_t
+wcore_memory_estimate_buffers(const struct wcore_memory_layout *layout,
+                              int32_t width, int32_t height,
+                              uint64_t color_buffer_bytes)
+{
+    uint64_t pixels;
+
+    if (width <= 0 || height <= 0)
+        return 0;
+
+    pixels = (uint64_t) width * (uint64_t) height;
+    if (!color_buffer_bytes)
+        color_buffer_bytes = pixels * layout->color_bytes;
+
+    return layout->color_buffers * color_buffer_bytes +
+           pixels * layout->ancillary_bytes;
+}
+
+void
+wcore_memory_get_display_stats(struct wcore_display *dpy,
+                               struct waffle_memory_stats *stats)
+{
+    struct wcore_slab_stats slabs;
+    struct api_object *obj;
+
+    memset(stats, 0, sizeof(*stats));
+
+    wcore_display_get_alloc_stats(dpy, &slabs);
+    stats->heap_bytes += slabs.bytes;
+    stats->heap_bytes += dpy->extensions.heap_bytes;
+    stats->heap_bytes += wcore_atomic_load_u64_relaxed(&dpy->api.native_size);
+
+    // Objects are unregistered before they are destroyed, so those reached
+    // under the mutex stay alive.
+    mtx_lock(&dpy->registry.mutex);
+
+    for (int type = 0; type < WCORE_OBJECT_TYPE_COUNT; ++type) {
+        for (obj = dpy->registry.head[type]; obj; obj = obj->registry_next) {
+            stats->heap_bytes +=
+                wcore_atomic_load_u64_relaxed(&obj->native_size);
+        }
+    }
+
+    for (obj = dpy->registry.head[WCORE_OBJECT_CONTEXT]; obj;
+         obj = obj->registry_next) {
+        struct wcore_context *ctx = container_of(obj, struct wcore_context,
+                                                 api);
+        struct wcore_ext_set *set =
+            wcore_atomic_load_ptr((void**) &ctx->extensions);
+
+        if (set)
+            stats->heap_bytes += sizeof(*set) + set->heap_bytes;
+    }
+
+    for (obj = dpy->registry.head[WCORE_OBJECT_WINDOW]; obj;
+         obj = obj->registry_next) {
+        struct wcore_window *window = container_of(obj, struct wcore_window,
+                                                   api);
+
+        stats->heap_bytes += wcore_frame_stats_heap_bytes(
+            wcore_atomic_load_ptr((void**) &window->frame_stats));
+        if (window->gpu_timer)
+            stats->heap_bytes += sizeof(*window->gpu_timer);
+
+        stats->buffer_bytes +=
+            wcore_atomic_load_u64_relaxed(&window->buffer_bytes);
+    }
+
+    mtx_unlock(&dpy->registry.mutex);
+}
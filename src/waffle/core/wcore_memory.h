@@ -0,0 +1,82 @@
+// Copyright 2016 Intel Corporation
+//
+// All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+//
+// - Redistributions of source code must retain the above copyright notice, this
+//   list of conditions and the following disclaimer.
+//
+// - Redistributions in binary form must reproduce the above copyright notice,
+//   this list of conditions and the following disclaimer in the documentation
+//   and/or other materials provided with the distribution.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+// DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+// FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+// DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+// SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+// CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+// OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+// OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+/// @file
+/// @brief Memory attributable to a display.
+///
+/// Two kinds are reported by waffle_display_get_memory_stats(). The first is
+/// waffle's own heap: the slabs of the display's objects, the native unions
+/// it caches, and per-object state such as extension sets and frame stats.
+/// The second is an estimate of the native buffers of the display's windows,
+/// which the driver allocates and waffle cannot see. The estimate is computed
+/// from the window's size and its config's color, depth and stencil sizes,
+/// unless the backend knows the real size of its color buffers, as GBM does.
+
+#pragma once
+
+#include <stdint.h>
+
+#include "waffle.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+struct wcore_config_attrs;
+struct wcore_display;
+
+/// @brief Per-pixel factors of a window's buffer estimate, from its config.
+struct wcore_memory_layout {
+    /// Bytes per pixel of a color buffer.
+    uint32_t color_bytes;
+
+    /// Number of color buffers, counting each sample of a multisampled one.
+    uint32_t color_buffers;
+
+    /// Bytes per pixel of the depth, stencil and accumulation buffers.
+    uint32_t ancillary_bytes;
+};
+
+void
+wcore_memory_layout_init(struct wcore_memory_layout *self,
+                         const struct wcore_config_attrs *attrs);
+
+/// @brief Estimate the memory of a window's native buffers.
+///
+/// If @a color_buffer_bytes is 0, the size of a color buffer is derived from
+/// @a layout. Return 0 if the size is not positive, as for a fullscreen
+/// window, whose size waffle does not know.
+uint64_t
+wcore_memory_estimate_buffers(const struct wcore_memory_layout *layout,
+                              int32_t width, int32_t height,
+                              uint64_t color_buffer_bytes);
+
+void
+wcore_memory_get_display_stats(struct wcore_display *dpy,
+                               struct waffle_memory_stats *stats);
+
+#ifdef __cplusplus
+}
+#endif
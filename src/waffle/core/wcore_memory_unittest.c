@@ -0,0 +1,174 @@
+// Copyright 2016 Intel Corporation
+//
+// All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+//
+// - Redistributions of source code must retain the above copyright notice, this
+//   list of conditions and the following disclaimer.
+//
+// - Redistributions in binary form must reproduce the above copyright notice,
+//   this list of conditions and the following disclaimer in the documentation
+//   and/or other materials provided with the distribution.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+// DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+// FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+// DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+// SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+// CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+// OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+// OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+#include <setjmp.h>
+#include <stdarg.h>
+#include <stdint.h>
+#include <string.h>
+
+#include <cmocka.h>
+
+#include "wcore_config_attrs.h"
+#include "wcore_display.h"
+#include "wcore_memory.h"
+#include "wcore_window.h"
+
+static void
+init_attrs(struct wcore_config_attrs *attrs)
+{
+    memset(attrs, 0, sizeof(*attrs));
+    attrs->red_size = 8;
+    attrs->green_size = 8;
+    attrs->blue_size = 8;
+    attrs->alpha_size = 8;
+    attrs->rgb_size = 24;
+    attrs->rgba_size = 32;
+    attrs->depth_size = 24;
+    attrs->stencil_size = 8;
+    attrs->double_buffered = true;
+}
+
+static void
+test_wcore_memory_estimate(void **state) {
+    struct wcore_config_attrs attrs;
+    struct wcore_memory_layout layout;
+
+    init_attrs(&attrs);
+    wcore_memory_layout_init(&layout, &attrs);
+    assert_int_equal(layout.color_bytes, 4);
+    assert_int_equal(layout.color_buffers, 2);
+    assert_int_equal(layout.ancillary_bytes, 4);
+
+    // Two color buffers and a depth-stencil buffer, 4 bytes per pixel each.
+    assert_int_equal(wcore_memory_estimate_buffers(&layout, 100, 50, 0),
+                     3 * 4 * 100 * 50);
+
+    // The backend knows the size of its color buffers.
+    assert_int_equal(wcore_memory_estimate_buffers(&layout, 100, 50, 25600),
+                     2 * 25600 + 4 * 100 * 50);
+
+    // The size of a fullscreen window is unknown.
+    assert_int_equal(wcore_memory_estimate_buffers(&layout, -1, -1, 0), 0);
+}
+
+static void
+test_wcore_memory_estimate_formats(void **state) {
+    struct wcore_config_attrs attrs;
+    struct wcore_memory_layout layout;
+
+    // 24-bit color is stored in 32 bits. Without depth or stencil there is
+    // no ancillary buffer.
+    init_attrs(&attrs);
+    attrs.alpha_size = 0;
+    attrs.rgba_size = 24;
+    attrs.depth_size = 0;
+    attrs.stencil_size = 0;
+    attrs.double_buffered = false;
+    wcore_memory_layout_init(&layout, &attrs);
+    assert_int_equal(layout.color_bytes, 4);
+    assert_int_equal(layout.color_buffers, 1);
+    assert_int_equal(layout.ancillary_bytes, 0);
+
+    // RGB565 with a 16-bit depth buffer.
+    attrs.rgba_size = 16;
+    attrs.depth_size = 16;
+    wcore_memory_layout_init(&layout, &attrs);
+    assert_int_equal(layout.color_bytes, 2);
+    assert_int_equal(layout.ancillary_bytes, 2);
+
+    // Unspecified color sizes count as 8-bit RGBA.
+    attrs.rgba_size = 0;
+    wcore_memory_layout_init(&layout, &attrs);
+    assert_int_equal(layout.color_bytes, 4);
+}
+
+static void
+test_wcore_memory_estimate_multisample(void **state) {
+    struct wcore_config_attrs attrs;
+    struct wcore_memory_layout layout;
+
+    init_attrs(&attrs);
+    attrs.sample_buffers = true;
+    attrs.samples = 4;
+    attrs.accum_buffer = true;
+    wcore_memory_layout_init(&layout, &attrs);
+
+    // The multisampled buffer resolves into the two swapped ones.
+    assert_int_equal(layout.color_buffers, 2 + 4);
+    assert_int_equal(layout.ancillary_bytes, 4 * 4 + 8);
+}
+
+static void
+test_wcore_memory_display_stats(void **state) {
+    struct wcore_display dpy;
+    struct wcore_config_attrs attrs;
+    struct wcore_config config;
+    struct wcore_window *window;
+    struct waffle_memory_stats stats;
+    int platform;
+
+    memset(&dpy, 0, sizeof(dpy));
+    assert_true(wcore_display_init(&dpy, (struct wcore_platform*) &platform));
+
+    wcore_memory_get_display_stats(&dpy, &stats);
+    assert_int_equal(stats.heap_bytes, 0);
+    assert_int_equal(stats.buffer_bytes, 0);
+
+    init_attrs(&attrs);
+    memset(&config, 0, sizeof(config));
+    config.attrs = attrs;
+    config.display = &dpy;
+
+    window = wcore_display_alloc_object(&dpy, WCORE_OBJECT_WINDOW,
+                                        sizeof(*window));
+    assert_non_null(window);
+    wcore_window_init(window, &config);
+    window->buffer_bytes = 1000;
+    wcore_display_register(&dpy, WCORE_OBJECT_WINDOW, &window->api);
+
+    wcore_memory_get_display_stats(&dpy, &stats);
+    assert_true(stats.heap_bytes >= sizeof(*window));
+    assert_int_equal(stats.buffer_bytes, 1000);
+
+    wcore_display_unregister(&dpy, WCORE_OBJECT_WINDOW, &window->api);
+    wcore_memory_get_display_stats(&dpy, &stats);
+    assert_int_equal(stats.buffer_bytes, 0);
+
+    wcore_window_teardown(window);
+    wcore_display_free_object(window);
+    wcore_display_teardown(&dpy);
+}
+
+int
+main(void) {
+    const UnitTest tests[] = {
+        unit_test(test_wcore_memory_estimate),
+        unit_test(test_wcore_memory_estimate_formats),
+        unit_test(test_wcore_memory_estimate_multisample),
+        unit_test(test_wcore_memory_display_stats),
+    };
+
+    return run_tests(tests);
+}
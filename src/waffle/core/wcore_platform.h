@@ -27,6 +27,7 @@
 
 #include <assert.h>
 #include <stdbool.h>
+#include <stddef.h>
 #include <stdint.h>
 #include "c99_compat.h"
 
@@ -36,6 +37,7 @@ struct wcore_context;
 struct wcore_display;
 struct wcore_platform;
 struct wcore_window;
+struct waffle_instance;
 
 struct wcore_platform_vtbl {
     bool
@@ -64,6 +66,13 @@ struct wcore_platform_vtbl {
             int32_t waffle_dl,
             const char *symbol);
 
+    /// @brief Load the libraries whose loading WAFFLE_FAST_START deferred.
+    ///
+    /// WAFFLE_PLATFORM_AUTO calls it to reject a candidate that cannot load
+    /// before trying the next. May be null if create always loads them.
+    bool
+    (*load)(struct wcore_platform *self);
+
     struct wcore_display_vtbl {
         struct wcore_display*
         (*connect)(struct wcore_platform *platform,
@@ -80,6 +89,33 @@ struct wcore_platform_vtbl {
         /// May be null.
         union waffle_native_display*
         (*get_native)(struct wcore_display *display);
+
+        /// Size of the union that get_native returns, for memory accounting.
+        /// See WCORE_NATIVE_UNION_SIZE().
+        size_t native_size;
+
+        /// @brief Bracket the bulk teardown in waffle_display_destroy_all().
+        ///
+        /// Between the two calls, the backend may defer and batch the native
+        /// calls made by the destroy functions. Both may be null.
+        void
+        (*begin_teardown)(struct wcore_display *display);
+
+        bool
+        (*end_teardown)(struct wcore_display *display);
+
+        /// @brief Describe the display's device and driver build.
+        ///
+        /// Write to @a buf a string that changes whenever the driver does. It
+        /// keys the capability cache (see WAFFLE_CAPABILITY_CACHE). Return
+        /// false if no such string is available.
+        ///
+        /// May be null, in which case the display's capabilities are not
+        /// cached on disk.
+        bool
+        (*get_driver_id)(struct wcore_display *display,
+                         char *buf,
+                         size_t size);
     } display;
 
     struct wcore_config_vtbl {
@@ -94,6 +130,10 @@ struct wcore_platform_vtbl {
         /// May be null.
         union waffle_native_config*
         (*get_native)(struct wcore_config *config);
+
+        /// Size of the union that get_native returns, for memory accounting.
+        /// See WCORE_NATIVE_UNION_SIZE().
+        size_t native_size;
     } config;
 
     struct wcore_context_vtbl {
@@ -108,6 +148,24 @@ struct wcore_platform_vtbl {
         /// May be null.
         union waffle_native_context*
         (*get_native)(struct wcore_context *ctx);
+
+        /// Size of the union that get_native returns, for memory accounting.
+        /// See WCORE_NATIVE_UNION_SIZE().
+        size_t native_size;
+
+        /// @brief Create @a count contexts from one config.
+        ///
+        /// The first context shares with @a share_ctx, which may be null.
+        /// The others share with the first. On failure, create none, set
+        /// every element of @a out to null and return false.
+        ///
+        /// May be null, in which case the api layer calls create() in a loop.
+        bool
+        (*create_many)(struct wcore_platform *platform,
+                       struct wcore_config *config,
+                       struct wcore_context *share_ctx,
+                       int32_t count,
+                       struct wcore_context *out[]);
     } context;
 
     struct wcore_window_vtbl {
@@ -134,13 +192,78 @@ struct wcore_platform_vtbl {
         /// May be null.
         union waffle_native_window*
         (*get_native)(struct wcore_window *window);
+
+        /// Size of the union that get_native returns, for memory accounting.
+        /// See WCORE_NATIVE_UNION_SIZE().
+        size_t native_size;
+
+        /// @brief Swap several windows that belong to the same display.
+        ///
+        /// Set each element of @a results and return true if all are true.
+        /// Backends implement this to wait on the display connection once
+        /// for the whole batch rather than once per window.
+        ///
+        /// May be null, in which case the api layer calls swap_buffers() for
+        /// each window.
+        bool
+        (*swap_buffers_many)(struct wcore_window *windows[],
+                             int32_t count,
+                             bool results[]);
     } window;
 };
 
 struct wcore_platform {
     const struct wcore_platform_vtbl *vtbl;
+
+    /// The WAFFLE_PLATFORM_* value the platform was created for. Set by the
+    /// api layer after creation, as is @a reason.
+    int32_t waffle_platform;
+
+    /// Why waffle_init() chose the platform. Static storage.
+    const char *reason;
+
+    /// Set by the api layer from the attribute WAFFLE_CAPABILITY_CACHE.
+    bool capability_cache;
+
+    /// Set by the api layer if the instance holds a reference to the trace
+    /// file named by WAFFLE_TRACE.
+    bool trace_writer;
 };
 
+// In a single-platform build (see the CMake option waffle_single_platform),
+// WAFFLE_SINGLE_PLATFORM_VTBL names the vtbl of the only platform, and
+// WCORE_PLATFORM_VTBL_LINKAGE gives it external linkage. Every call through
+// wcore_vtbl() then has a constant target, which the compiler turns into a
+// direct call and, with link-time optimization, can inline.
+#ifdef WAFFLE_SINGLE_PLATFORM_VTBL
+#   define WCORE_PLATFORM_VTBL_LINKAGE
+extern const struct wcore_platform_vtbl WAFFLE_SINGLE_PLATFORM_VTBL;
+#else
+#   define WCORE_PLATFORM_VTBL_LINKAGE static
+#endif
+
+/// @brief The vtbl through which to dispatch calls on @a self.
+static inline const struct wcore_platform_vtbl*
+wcore_vtbl(const struct wcore_platform *self)
+{
+#ifdef WAFFLE_SINGLE_PLATFORM_VTBL
+    (void) self;
+    return &WAFFLE_SINGLE_PLATFORM_VTBL;
+#else
+    return self->vtbl;
+#endif
+}
+
+static inline struct waffle_instance*
+waffle_instance(struct wcore_platform *platform) {
+    return (struct waffle_instance*) platform;
+}
+
+static inline struct wcore_platform*
+wcore_platform(struct waffle_instance *instance) {
+    return (struct wcore_platform*) instance;
+}
+
 static inline bool
 wcore_platform_init(struct wcore_platform *self)
 {
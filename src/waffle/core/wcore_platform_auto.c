@@ -0,0 +1,86 @@
+// Copyright 2016 Intel Corporation
+//
+// All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+//
+// - Redistributions of source code must retain the above copyright notice, this
+//   list of conditions and the following disclaimer.
+//
+// - Redistributions in binary form must reproduce the above copyright notice,
+//   this list of conditions and the following disclaimer in the documentation
+//   and/or other materials provided with the distribution.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+// DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+// FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+// DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+// SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+// CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+// OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+// OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+#include "waffle.h"
+
+#include "wcore_platform_auto.h"
+
+size_t
+wcore_platform_auto_rank(const struct wcore_platform_probe *probe,
+                         struct wcore_platform_candidate out[])
+{
+    const bool headless = !probe->wayland_socket && !probe->x11_display;
+    const bool gbm = probe->built_gbm && probe->drm_device &&
+                     probe->lib_egl && probe->lib_gbm;
+    size_t n = 0;
+
+    if (headless) {
+        if (gbm) {
+            out[n].platform = WAFFLE_PLATFORM_GBM;
+            out[n].reason = "no display server is present, and a DRM device, "
+                            "libEGL and libgbm are";
+            ++n;
+        }
+
+        return n;
+    }
+
+    if (probe->built_wayland && probe->wayland_socket &&
+        probe->lib_egl && probe->lib_wayland_egl) {
+        out[n].platform = WAFFLE_PLATFORM_WAYLAND;
+        out[n].reason = "a Wayland socket, libEGL and libwayland-egl "
+                        "are present";
+        ++n;
+    }
+
+    if (probe->built_x11_egl && probe->x11_display && probe->lib_egl) {
+        out[n].platform = WAFFLE_PLATFORM_X11_EGL;
+        out[n].reason = n ? "the Wayland platform failed, and an X11 display "
+                            "and libEGL are present"
+                          : "an X11 display and libEGL are present, and "
+                            "Wayland is not usable";
+        ++n;
+    }
+
+    if (probe->built_glx && probe->x11_display && probe->lib_gl) {
+        out[n].platform = WAFFLE_PLATFORM_GLX;
+        out[n].reason = n ? "the EGL platforms failed, and an X11 display "
+                            "and libGL are present"
+                          : "an X11 display and libGL are present, and "
+                            "the EGL platforms are not usable";
+        ++n;
+    }
+
+    if (gbm) {
+        out[n].platform = WAFFLE_PLATFORM_GBM;
+        out[n].reason = n ? "the display platforms failed, and a DRM device, "
+                            "libEGL and libgbm are present"
+                          : "no display platform is usable, and a DRM device, "
+                            "libEGL and libgbm are present";
+        ++n;
+    }
+
+    return n;
+}
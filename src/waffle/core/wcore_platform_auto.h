@@ -0,0 +1,95 @@
+// Copyright 2016 Intel Corporation
+//
+// All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+//
+// - Redistributions of source code must retain the above copyright notice, this
+//   list of conditions and the following disclaimer.
+//
+// - Redistributions in binary form must reproduce the above copyright notice,
+//   this list of conditions and the following disclaimer in the documentation
+//   and/or other materials provided with the distribution.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+// DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+// FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+// DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+// SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+// CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+// OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+// OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+/// @file
+/// @brief Ranking of candidate platforms for WAFFLE_PLATFORM_AUTO.
+///
+/// The probing that fills struct wcore_platform_probe is platform specific
+/// (see linux_platform_probe()). The ranking here is not, so that it can be
+/// tested without a display server.
+
+#pragma once
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/// Maximum number of candidates returned by wcore_platform_auto_rank().
+#define WCORE_PLATFORM_AUTO_MAX 4
+
+/// @brief Results of cheap checks for the presence of each platform.
+///
+/// None of the checks loads a library or connects to a server.
+struct wcore_platform_probe {
+    /// Which platforms this build of waffle supports.
+    bool built_gbm;
+    bool built_wayland;
+    bool built_x11_egl;
+    bool built_glx;
+
+    /// A Wayland socket exists.
+    bool wayland_socket;
+
+    /// DISPLAY is set and, for a local display, its socket exists.
+    bool x11_display;
+
+    /// A DRM device that GBM could open exists and is accessible.
+    bool drm_device;
+
+    /// The libraries each platform loads are installed.
+    bool lib_egl;
+    bool lib_gl;
+    bool lib_gbm;
+    bool lib_wayland_egl;
+};
+
+struct wcore_platform_candidate {
+    /// A WAFFLE_PLATFORM_* value.
+    int32_t platform;
+
+    /// Why the platform was ranked where it was. Static storage.
+    const char *reason;
+};
+
+/// @brief Order the usable platforms by expected overhead, cheapest first.
+///
+/// If no display server is present, the job is headless and GBM, which needs
+/// no server, comes first. Otherwise the display platforms come first, since
+/// windows on GBM are never shown, and among them Wayland precedes X11/EGL,
+/// which precedes GLX. GBM then follows as a fallback.
+///
+/// Write at most WCORE_PLATFORM_AUTO_MAX candidates to @a out and return
+/// their number.
+size_t
+wcore_platform_auto_rank(const struct wcore_platform_probe *probe,
+                         struct wcore_platform_candidate out[]);
+
+#ifdef __cplusplus
+}
+#endif
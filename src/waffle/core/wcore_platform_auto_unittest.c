@@ -0,0 +1,133 @@
+// Copyright 2016 Intel Corporation
+//
+// All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+//
+// - Redistributions of source code must retain the above copyright notice, this
+//   list of conditions and the following disclaimer.
+//
+// - Redistributions in binary form must reproduce the above copyright notice,
+//   this list of conditions and the following disclaimer in the documentation
+//   and/or other materials provided with the distribution.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+// DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+// FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+// DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+// SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+// CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+// OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+// OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+#include <setjmp.h>
+#include <stdarg.h>
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include <cmocka.h>
+
+#include "waffle.h"
+#include "wcore_platform_auto.h"
+
+/// Every platform built and every library present.
+static void
+probe_init(struct wcore_platform_probe *probe)
+{
+    memset(probe, 0, sizeof(*probe));
+    probe->built_gbm = true;
+    probe->built_wayland = true;
+    probe->built_x11_egl = true;
+    probe->built_glx = true;
+    probe->lib_egl = true;
+    probe->lib_gl = true;
+    probe->lib_gbm = true;
+    probe->lib_wayland_egl = true;
+}
+
+static void
+test_wcore_platform_auto_headless_prefers_gbm(void **state) {
+    struct wcore_platform_probe probe;
+    struct wcore_platform_candidate out[WCORE_PLATFORM_AUTO_MAX];
+
+    probe_init(&probe);
+    probe.drm_device = true;
+
+    assert_int_equal(wcore_platform_auto_rank(&probe, out), 1);
+    assert_int_equal(out[0].platform, WAFFLE_PLATFORM_GBM);
+    assert_non_null(out[0].reason);
+}
+
+static void
+test_wcore_platform_auto_headless_without_drm(void **state) {
+    struct wcore_platform_probe probe;
+    struct wcore_platform_candidate out[WCORE_PLATFORM_AUTO_MAX];
+
+    probe_init(&probe);
+
+    assert_int_equal(wcore_platform_auto_rank(&probe, out), 0);
+}
+
+static void
+test_wcore_platform_auto_display_order(void **state) {
+    struct wcore_platform_probe probe;
+    struct wcore_platform_candidate out[WCORE_PLATFORM_AUTO_MAX];
+
+    probe_init(&probe);
+    probe.wayland_socket = true;
+    probe.x11_display = true;
+    probe.drm_device = true;
+
+    assert_int_equal(wcore_platform_auto_rank(&probe, out), 4);
+    assert_int_equal(out[0].platform, WAFFLE_PLATFORM_WAYLAND);
+    assert_int_equal(out[1].platform, WAFFLE_PLATFORM_X11_EGL);
+    assert_int_equal(out[2].platform, WAFFLE_PLATFORM_GLX);
+    assert_int_equal(out[3].platform, WAFFLE_PLATFORM_GBM);
+}
+
+static void
+test_wcore_platform_auto_x11_without_egl(void **state) {
+    struct wcore_platform_probe probe;
+    struct wcore_platform_candidate out[WCORE_PLATFORM_AUTO_MAX];
+
+    probe_init(&probe);
+    probe.x11_display = true;
+    probe.drm_device = true;
+    probe.lib_egl = false;
+
+    // GBM needs libEGL too.
+    assert_int_equal(wcore_platform_auto_rank(&probe, out), 1);
+    assert_int_equal(out[0].platform, WAFFLE_PLATFORM_GLX);
+}
+
+static void
+test_wcore_platform_auto_skips_unbuilt(void **state) {
+    struct wcore_platform_probe probe;
+    struct wcore_platform_candidate out[WCORE_PLATFORM_AUTO_MAX];
+
+    probe_init(&probe);
+    probe.wayland_socket = true;
+    probe.x11_display = true;
+    probe.built_wayland = false;
+    probe.built_x11_egl = false;
+
+    assert_int_equal(wcore_platform_auto_rank(&probe, out), 1);
+    assert_int_equal(out[0].platform, WAFFLE_PLATFORM_GLX);
+}
+
+int
+main(void) {
+    const UnitTest tests[] = {
+        unit_test(test_wcore_platform_auto_headless_prefers_gbm),
+        unit_test(test_wcore_platform_auto_headless_without_drm),
+        unit_test(test_wcore_platform_auto_display_order),
+        unit_test(test_wcore_platform_auto_x11_without_egl),
+        unit_test(test_wcore_platform_auto_skips_unbuilt),
+    };
+
+    return run_tests(tests);
+}
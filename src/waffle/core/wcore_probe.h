@@ -0,0 +1,48 @@
+// Copyright 2016 Intel Corporation
+//
+// All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+//
+// - Redistributions of source code must retain the above copyright notice, this
+//   list of conditions and the following disclaimer.
+//
+// - Redistributions in binary form must reproduce the above copyright notice,
+//   this list of conditions and the following disclaimer in the documentation
+//   and/or other materials provided with the distribution.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+// DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+// FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+// DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+// SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+// CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+// OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+// OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+/// @file
+/// @brief Static probes for bpftrace, perf and SystemTap.
+///
+/// When <sys/sdt.h> is available, WCORE_PROBE() emits a USDT probe in the
+/// provider "waffle": a single nop in the code, plus an ELF note that tells
+/// a tracer where to find the arguments. Attaching a tracer patches the nop;
+/// otherwise it costs nothing. Without <sys/sdt.h>, WCORE_PROBE() expands to
+/// nothing.
+///
+/// Probes come in pairs named <point>_entry and <point>_return. Each takes
+/// between 1 and 4 integer or pointer arguments. For example:
+///
+///     bpftrace -e 'usdt:libwaffle-1.so:waffle:make_current_entry { ... }'
+
+#pragma once
+
+#ifdef WAFFLE_HAS_SDT
+#include <sys/sdt.h>
+
+#define WCORE_PROBE(name, ...) STAP_PROBEV(waffle, name, __VA_ARGS__)
+#else
+#define WCORE_PROBE(name, ...) ((void) 0)
+#endif
@@ -0,0 +1,202 @@
+// Copyright 2016 Intel Corporation
+//
+// All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+//
+// - Redistributions of source code must retain the above copyright notice, this
+//   list of conditions and the following disclaimer.
+//
+// - Redistributions in binary form must reproduce the above copyright notice,
+//   this list of conditions and the following disclaimer in the documentation
+//   and/or other materials provided with the distribution.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+// DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+// FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+// DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+// SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+// CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+// OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+// OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+#include <stdlib.h>
+#include <string.h>
+
+#include "wcore_error.h"
+#include "wcore_slab.h"
+
+/// The first chunk holds this many objects. Each later chunk is twice as
+/// large as the previous one, up to WCORE_SLAB_MAX_CHUNK_SLOTS.
+#define WCORE_SLAB_MIN_CHUNK_SLOTS 4
+#define WCORE_SLAB_MAX_CHUNK_SLOTS 64
+
+/// Precedes every object. The union pads the header so that the object that
+/// follows it is suitably aligned for any type.
+union wcore_slab_header {
+    struct {
+        struct wcore_slab *slab;
+
+        /// Next free slot, while the slot is on the free list.
+        union wcore_slab_header *next_free;
+
+        /// If the object was too large for the slab and came from malloc,
+        /// the size of its block. Otherwise 0.
+        size_t heap_size;
+    } h;
+
+    long double align_ld;
+    long long align_ll;
+    void *align_ptr;
+};
+
+struct wcore_slab_chunk {
+    struct wcore_slab_chunk *next;
+    union wcore_slab_header slots[];
+};
+
+void
+wcore_slab_init(struct wcore_slab *self)
+{
+    memset(self, 0, sizeof(*self));
+    mtx_init(&self->mutex, mtx_plain);
+    self->next_chunk_slots = WCORE_SLAB_MIN_CHUNK_SLOTS;
+}
+
+void
+wcore_slab_finish(struct wcore_slab *self)
+{
+    struct wcore_slab_chunk *chunk, *next;
+
+    for (chunk = self->chunks; chunk; chunk = next) {
+        next = chunk->next;
+        free(chunk);
+    }
+
+    self->chunks = NULL;
+    self->free_list = NULL;
+    mtx_destroy(&self->mutex);
+}
+
+static union wcore_slab_header*
+wcore_slab_slot(struct wcore_slab *self,
+                struct wcore_slab_chunk *chunk,
+                size_t i)
+{
+    return (union wcore_slab_header*)
+        ((char*) chunk->slots + i * self->slot_size);
+}
+
+/// Called with the mutex held.
+static bool
+wcore_slab_grow(struct wcore_slab *self)
+{
+    size_t num_slots = self->next_chunk_slots;
+    struct wcore_slab_chunk *chunk;
+
+    chunk = malloc(sizeof(*chunk) + num_slots * self->slot_size);
+    if (!chunk)
+        return false;
+
+    self->stats.heap_allocs++;
+    self->stats.capacity += num_slots;
+    self->stats.bytes += sizeof(*chunk) + num_slots * self->slot_size;
+
+    chunk->next = self->chunks;
+    self->chunks = chunk;
+
+    for (size_t i = num_slots; i-- > 0; ) {
+        union wcore_slab_header *slot = wcore_slab_slot(self, chunk, i);
+        slot->h.slab = self;
+        slot->h.heap_size = 0;
+        slot->h.next_free = self->free_list;
+        self->free_list = slot;
+    }
+
+    if (self->next_chunk_slots < WCORE_SLAB_MAX_CHUNK_SLOTS)
+        self->next_chunk_slots *= 2;
+
+    return true;
+}
+
+void*
+wcore_slab_alloc(struct wcore_slab *self, size_t size)
+{
+    const size_t unit = sizeof(union wcore_slab_header);
+    union wcore_slab_header *slot = NULL;
+
+    mtx_lock(&self->mutex);
+
+    if (self->object_size == 0) {
+        self->object_size = size;
+        self->slot_size = unit + (size + unit - 1) / unit * unit;
+    }
+
+    if (size > self->object_size) {
+        slot = malloc(unit + size);
+        if (slot) {
+            self->stats.heap_allocs++;
+            self->stats.bytes += unit + size;
+            slot->h.slab = self;
+            slot->h.heap_size = unit + size;
+        }
+    } else if (self->free_list || wcore_slab_grow(self)) {
+        slot = self->free_list;
+        self->free_list = slot->h.next_free;
+    }
+
+    if (slot) {
+        self->stats.allocs++;
+        self->stats.live++;
+    }
+
+    mtx_unlock(&self->mutex);
+
+    if (!slot) {
+        wcore_error(WAFFLE_ERROR_BAD_ALLOC);
+        return NULL;
+    }
+
+    memset(slot + 1, 0, size);
+    return slot + 1;
+}
+
+void
+wcore_slab_free(void *p)
+{
+    union wcore_slab_header *slot;
+    struct wcore_slab *self;
+
+    if (!p)
+        return;
+
+    slot = (union wcore_slab_header*) p - 1;
+    self = slot->h.slab;
+
+    mtx_lock(&self->mutex);
+
+    self->stats.frees++;
+    self->stats.live--;
+
+    if (slot->h.heap_size) {
+        self->stats.bytes -= slot->h.heap_size;
+        free(slot);
+    } else {
+        slot->h.next_free = self->free_list;
+        self->free_list = slot;
+    }
+
+    mtx_unlock(&self->mutex);
+}
+
+void
+wcore_slab_get_stats(struct wcore_slab *self,
+                     struct wcore_slab_stats *stats)
+{
+    mtx_lock(&self->mutex);
+    *stats = self->stats;
+    mtx_unlock(&self->mutex);
+}
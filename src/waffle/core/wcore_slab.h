@@ -0,0 +1,110 @@
+// Copyright 2016 Intel Corporation
+//
+// All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+//
+// - Redistributions of source code must retain the above copyright notice, this
+//   list of conditions and the following disclaimer.
+//
+// - Redistributions in binary form must reproduce the above copyright notice,
+//   this list of conditions and the following disclaimer in the documentation
+//   and/or other materials provided with the distribution.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+// DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+// FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+// DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+// SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+// CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+// OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+// OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+/// @file
+/// @brief Fixed-size object allocator.
+///
+/// A slab hands out zeroed objects from large chunks and recycles freed
+/// objects through a free list, so that create/destroy churn does not reach
+/// malloc once the slab has grown to its working size.
+///
+/// The object size is fixed by the first call to wcore_slab_alloc(). A larger
+/// request falls back to the heap. Each object is preceded by a small header
+/// that records its slab, so wcore_slab_free() needs no other argument.
+
+#pragma once
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+#include "threads.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+struct wcore_slab_chunk;
+union wcore_slab_header;
+
+struct wcore_slab_stats {
+    /// Number of objects handed out.
+    uint64_t allocs;
+
+    /// Number of objects returned.
+    uint64_t frees;
+
+    /// Number of calls to malloc made by the slab, for chunks and for
+    /// oversized objects.
+    uint64_t heap_allocs;
+
+    /// Number of objects currently allocated.
+    size_t live;
+
+    /// Number of objects that fit in the chunks allocated so far.
+    size_t capacity;
+
+    /// Bytes currently held from malloc, for chunks and oversized objects.
+    size_t bytes;
+};
+
+struct wcore_slab {
+    mtx_t mutex;
+    size_t object_size;
+    size_t slot_size;
+    size_t next_chunk_slots;
+    struct wcore_slab_chunk *chunks;
+    union wcore_slab_header *free_list;
+    struct wcore_slab_stats stats;
+};
+
+void
+wcore_slab_init(struct wcore_slab *self);
+
+/// @brief Release all chunks.
+///
+/// Any object still allocated from the slab becomes invalid.
+void
+wcore_slab_finish(struct wcore_slab *self);
+
+/// @brief Allocate a zeroed object of @a size bytes.
+///
+/// Emit WAFFLE_ERROR_BAD_ALLOC and return null on failure.
+void*
+wcore_slab_alloc(struct wcore_slab *self, size_t size);
+
+/// @brief Return an object to the slab that allocated it.
+///
+/// @a p may be null.
+void
+wcore_slab_free(void *p);
+
+void
+wcore_slab_get_stats(struct wcore_slab *self,
+                     struct wcore_slab_stats *stats);
+
+#ifdef __cplusplus
+}
+#endif
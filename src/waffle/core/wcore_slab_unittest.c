@@ -0,0 +1,186 @@
+// Copyright 2016 Intel Corporation
+//
+// All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+//
+// - Redistributions of source code must retain the above copyright notice, this
+//   list of conditions and the following disclaimer.
+//
+// - Redistributions in binary form must reproduce the above copyright notice,
+//   this list of conditions and the following disclaimer in the documentation
+//   and/or other materials provided with the distribution.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+// DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+// FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+// DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+// SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+// CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+// OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+// OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+#include <setjmp.h>
+#include <stdarg.h>
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include <cmocka.h>
+
+#include "wcore_slab.h"
+
+struct thing {
+    int64_t a;
+    double b;
+    char c[13];
+};
+
+static void
+test_wcore_slab_alloc_is_zeroed(void **state) {
+    struct wcore_slab slab;
+    struct thing *t;
+
+    wcore_slab_init(&slab);
+
+    t = wcore_slab_alloc(&slab, sizeof(*t));
+    assert_non_null(t);
+    memset(t, 0xff, sizeof(*t));
+    wcore_slab_free(t);
+
+    t = wcore_slab_alloc(&slab, sizeof(*t));
+    assert_non_null(t);
+    assert_int_equal(t->a, 0);
+    assert_int_equal(t->c[12], 0);
+    wcore_slab_free(t);
+
+    wcore_slab_finish(&slab);
+}
+
+static void
+test_wcore_slab_alignment(void **state) {
+    struct wcore_slab slab;
+    void *p[10];
+
+    wcore_slab_init(&slab);
+
+    for (int i = 0; i < 10; ++i) {
+        p[i] = wcore_slab_alloc(&slab, 3);
+        assert_non_null(p[i]);
+        assert_int_equal((uintptr_t) p[i] % sizeof(long double), 0);
+    }
+
+    for (int i = 0; i < 10; ++i)
+        wcore_slab_free(p[i]);
+
+    wcore_slab_finish(&slab);
+}
+
+static void
+test_wcore_slab_reuse_without_heap(void **state) {
+    struct wcore_slab slab;
+    struct wcore_slab_stats stats;
+    struct thing *t[4];
+
+    wcore_slab_init(&slab);
+
+    for (int i = 0; i < 4; ++i)
+        t[i] = wcore_slab_alloc(&slab, sizeof(struct thing));
+    for (int i = 0; i < 4; ++i)
+        wcore_slab_free(t[i]);
+
+    wcore_slab_get_stats(&slab, &stats);
+    const uint64_t heap_allocs = stats.heap_allocs;
+
+    for (int n = 0; n < 100; ++n) {
+        for (int i = 0; i < 4; ++i)
+            t[i] = wcore_slab_alloc(&slab, sizeof(struct thing));
+        for (int i = 0; i < 4; ++i)
+            wcore_slab_free(t[i]);
+    }
+
+    wcore_slab_get_stats(&slab, &stats);
+    assert_int_equal(stats.heap_allocs, heap_allocs);
+    assert_int_equal(stats.allocs, 404);
+    assert_int_equal(stats.frees, 404);
+    assert_int_equal(stats.live, 0);
+
+    wcore_slab_finish(&slab);
+}
+
+static void
+test_wcore_slab_grows(void **state) {
+    struct wcore_slab slab;
+    struct wcore_slab_stats stats;
+    struct thing *t[100];
+
+    wcore_slab_init(&slab);
+
+    for (int i = 0; i < 100; ++i) {
+        t[i] = wcore_slab_alloc(&slab, sizeof(struct thing));
+        assert_non_null(t[i]);
+        t[i]->a = i;
+    }
+
+    for (int i = 0; i < 100; ++i)
+        assert_int_equal(t[i]->a, i);
+
+    wcore_slab_get_stats(&slab, &stats);
+    assert_int_equal(stats.live, 100);
+    assert_true(stats.capacity >= 100);
+    assert_true(stats.bytes >= 100 * sizeof(struct thing));
+
+    for (int i = 0; i < 100; ++i)
+        wcore_slab_free(t[i]);
+
+    wcore_slab_finish(&slab);
+}
+
+static void
+test_wcore_slab_oversized_uses_heap(void **state) {
+    struct wcore_slab slab;
+    struct wcore_slab_stats stats;
+    void *small, *big;
+
+    wcore_slab_init(&slab);
+
+    small = wcore_slab_alloc(&slab, 8);
+    wcore_slab_get_stats(&slab, &stats);
+    const uint64_t heap_allocs = stats.heap_allocs;
+    const size_t bytes = stats.bytes;
+
+    big = wcore_slab_alloc(&slab, 4096);
+    assert_non_null(big);
+    memset(big, 1, 4096);
+
+    wcore_slab_get_stats(&slab, &stats);
+    assert_int_equal(stats.heap_allocs, heap_allocs + 1);
+    assert_int_equal(stats.live, 2);
+    assert_true(stats.bytes > bytes + 4096);
+
+    wcore_slab_free(big);
+    wcore_slab_free(small);
+    wcore_slab_free(NULL);
+
+    wcore_slab_get_stats(&slab, &stats);
+    assert_int_equal(stats.live, 0);
+    assert_int_equal(stats.bytes, bytes);
+
+    wcore_slab_finish(&slab);
+}
+
+int
+main(void) {
+    const UnitTest tests[] = {
+        unit_test(test_wcore_slab_alloc_is_zeroed),
+        unit_test(test_wcore_slab_alignment),
+        unit_test(test_wcore_slab_reuse_without_heap),
+        unit_test(test_wcore_slab_grows),
+        unit_test(test_wcore_slab_oversized_uses_heap),
+    };
+
+    return run_tests(tests);
+}
@@ -0,0 +1,218 @@
+// Copyright 2016 Intel Corporation
+//
+// All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+//
+// - Redistributions of source code must retain the above copyright notice, this
+//   list of conditions and the following disclaimer.
+//
+// - Redistributions in binary form must reproduce the above copyright notice,
+//   this list of conditions and the following disclaimer in the documentation
+//   and/or other materials provided with the distribution.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+// DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+// FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+// DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+// SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+// CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+// OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+// OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "wcore_atomic.h"
+#include "wcore_block_pool.h"
+#include "wcore_error.h"
+#include "wcore_stats.h"
+#include "wcore_tinfo.h"
+#include "wcore_trace.h"
+#include "wcore_util.h"
+
+struct wcore_stats_counters {
+    uint64_t calls;
+    uint64_t total_ns;
+    uint64_t max_ns;
+    uint64_t histogram[WAFFLE_STATS_NUM_BUCKETS];
+};
+
+struct wcore_stats_block {
+    /// Owned by a wcore_tinfo. Only the owner writes the counters.
+    struct wcore_block_pool_link link;
+
+    struct wcore_stats_counters counters[WCORE_STATS_NUM_CALLS];
+};
+
+DEFINE_CONTAINER_CAST_FUNC(wcore_stats_block,
+                           struct wcore_stats_block,
+                           struct wcore_block_pool_link,
+                           link)
+
+static const char *const wcore_stats_names[WCORE_STATS_NUM_CALLS] = {
+    [WCORE_STATS_DISPLAY_CONNECT]              = "waffle_display_connect",
+    [WCORE_STATS_DISPLAY_DISCONNECT]           = "waffle_display_disconnect",
+    [WCORE_STATS_DISPLAY_DESTROY_ALL]          = "waffle_display_destroy_all",
+    [WCORE_STATS_DISPLAY_SUPPORTS_CONTEXT_API] = "waffle_display_supports_context_api",
+    [WCORE_STATS_CONFIG_CHOOSE]                = "waffle_config_choose",
+    [WCORE_STATS_CONFIG_DESTROY]               = "waffle_config_destroy",
+    [WCORE_STATS_CONTEXT_CREATE]               = "waffle_context_create",
+    [WCORE_STATS_CONTEXT_CREATE_MANY]          = "waffle_context_create_many",
+    [WCORE_STATS_CONTEXT_DESTROY]              = "waffle_context_destroy",
+    [WCORE_STATS_WINDOW_CREATE]                = "waffle_window_create",
+    [WCORE_STATS_WINDOW_DESTROY]               = "waffle_window_destroy",
+    [WCORE_STATS_WINDOW_SHOW]                  = "waffle_window_show",
+    [WCORE_STATS_WINDOW_RESIZE]                = "waffle_window_resize",
+    [WCORE_STATS_WINDOW_SWAP_BUFFERS]          = "waffle_window_swap_buffers",
+    [WCORE_STATS_WINDOW_SWAP_BUFFERS_MANY]     = "waffle_window_swap_buffers_many",
+    [WCORE_STATS_MAKE_CURRENT]                 = "waffle_make_current",
+    [WCORE_STATS_GET_PROC_ADDRESS]             = "waffle_get_proc_address",
+    [WCORE_STATS_DL_CAN_OPEN]                  = "waffle_dl_can_open",
+    [WCORE_STATS_DL_SYM]                       = "waffle_dl_sym",
+};
+
+static struct wcore_block_pool wcore_stats_pool;
+
+void
+wcore_stats_enable(bool enable)
+{
+    wcore_trace_set_flags(WCORE_TRACE_STATS, enable);
+}
+
+const char*
+wcore_stats_call_name(enum wcore_stats_call call)
+{
+    return wcore_stats_names[call];
+}
+
+unsigned
+wcore_stats_bucket(uint64_t ns)
+{
+    unsigned bucket = 0;
+
+    while (ns >>= 1)
+        ++bucket;
+
+    if (bucket >= WAFFLE_STATS_NUM_BUCKETS)
+        bucket = WAFFLE_STATS_NUM_BUCKETS - 1;
+
+    return bucket;
+}
+
+void
+wcore_stats_release_block(struct wcore_stats_block *block)
+{
+    if (block)
+        wcore_block_pool_release(&block->link);
+}
+
+static inline void
+bump(uint64_t *p, uint64_t v)
+{
+    wcore_atomic_store_u64_relaxed(p, wcore_atomic_load_u64_relaxed(p) + v);
+}
+
+void
+wcore_stats_record(enum wcore_stats_call call, uint64_t ns)
+{
+    struct wcore_tinfo *tinfo = wcore_tinfo_get();
+    struct wcore_stats_counters *c;
+
+    if (!tinfo->stats) {
+        tinfo->stats = wcore_stats_block(
+            wcore_block_pool_acquire(&wcore_stats_pool,
+                                     sizeof(struct wcore_stats_block),
+                                     tinfo));
+        // Without memory the call goes uncounted.
+        if (!tinfo->stats)
+            return;
+    }
+
+    c = &tinfo->stats->counters[call];
+    bump(&c->calls, 1);
+    bump(&c->total_ns, ns);
+    bump(&c->histogram[wcore_stats_bucket(ns)], 1);
+    if (ns > wcore_atomic_load_u64_relaxed(&c->max_ns))
+        wcore_atomic_store_u64_relaxed(&c->max_ns, ns);
+}
+
+size_t
+wcore_stats_snapshot(struct waffle_stats_entry *entries, size_t max_entries)
+{
+    size_t n = max_entries < WCORE_STATS_NUM_CALLS
+               ? max_entries : WCORE_STATS_NUM_CALLS;
+
+    if (n == 0)
+        return WCORE_STATS_NUM_CALLS;
+
+    memset(entries, 0, n * sizeof(*entries));
+
+    for (size_t i = 0; i < n; ++i)
+        entries[i].name = wcore_stats_names[i];
+
+    for (struct wcore_block_pool_link *link =
+             wcore_block_pool_first(&wcore_stats_pool);
+         link; link = link->next) {
+        struct wcore_stats_block *block = wcore_stats_block(link);
+
+        for (size_t i = 0; i < n; ++i) {
+            struct wcore_stats_counters *c = &block->counters[i];
+            uint64_t max_ns = wcore_atomic_load_u64_relaxed(&c->max_ns);
+
+            entries[i].calls += wcore_atomic_load_u64_relaxed(&c->calls);
+            entries[i].total_ns += wcore_atomic_load_u64_relaxed(&c->total_ns);
+            if (max_ns > entries[i].max_ns)
+                entries[i].max_ns = max_ns;
+            for (size_t j = 0; j < WAFFLE_STATS_NUM_BUCKETS; ++j)
+                entries[i].histogram[j] +=
+                    wcore_atomic_load_u64_relaxed(&c->histogram[j]);
+        }
+    }
+
+    return WCORE_STATS_NUM_CALLS;
+}
+
+char*
+wcore_stats_to_json(void)
+{
+    struct waffle_stats_entry entries[WCORE_STATS_NUM_CALLS];
+    // Each number takes at most 20 digits plus a separator.
+    const size_t entry_size = 128 + (3 + WAFFLE_STATS_NUM_BUCKETS) * 22;
+    const size_t size = 32 + WCORE_STATS_NUM_CALLS * entry_size;
+    char *json, *p;
+
+    json = malloc(size);
+    if (!json) {
+        wcore_error(WAFFLE_ERROR_BAD_ALLOC);
+        return NULL;
+    }
+
+    wcore_stats_snapshot(entries, WCORE_STATS_NUM_CALLS);
+
+    p = json;
+    p += sprintf(p, "{\"calls\": [");
+    for (size_t i = 0; i < WCORE_STATS_NUM_CALLS; ++i) {
+        const struct waffle_stats_entry *e = &entries[i];
+
+        p += sprintf(p, "%s\n  {\"name\": \"%s\", \"count\": %llu, "
+                     "\"total_ns\": %llu, \"max_ns\": %llu, "
+                     "\"histogram\": [",
+                     i ? "," : "", e->name,
+                     (unsigned long long) e->calls,
+                     (unsigned long long) e->total_ns,
+                     (unsigned long long) e->max_ns);
+        for (size_t j = 0; j < WAFFLE_STATS_NUM_BUCKETS; ++j) {
+            p += sprintf(p, "%s%llu", j ? ", " : "",
+                         (unsigned long long) e->histogram[j]);
+        }
+        p += sprintf(p, "]}");
+    }
+    sprintf(p, "\n]}\n");
+
+    return json;
+}
@@ -0,0 +1,113 @@
+// Copyright 2016 Intel Corporation
+//
+// All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+//
+// - Redistributions of source code must retain the above copyright notice, this
+//   list of conditions and the following disclaimer.
+//
+// - Redistributions in binary form must reproduce the above copyright notice,
+//   this list of conditions and the following disclaimer in the documentation
+//   and/or other materials provided with the distribution.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+// DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+// FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+// DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+// SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+// CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+// OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+// OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+/// @file
+/// @brief Call statistics.
+///
+/// When enabled with waffle_stats_enable(), the api layer times its calls
+/// into the platform, with the brackets of wcore_trace.h, and records, per
+/// call, the count, total and maximum duration, and a histogram of durations
+/// in power-of-two nanosecond buckets.
+///
+/// Each thread records into its own block of counters, which only it writes,
+/// so recording takes no lock and no locked instruction. A snapshot sums the
+/// blocks of all threads. When a thread exits, its block is kept, counts
+/// intact, for reuse by the next new thread.
+
+#pragma once
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+#include "waffle.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+struct wcore_stats_block;
+
+enum wcore_stats_call {
+    WCORE_STATS_DISPLAY_CONNECT,
+    WCORE_STATS_DISPLAY_DISCONNECT,
+    WCORE_STATS_DISPLAY_DESTROY_ALL,
+    WCORE_STATS_DISPLAY_SUPPORTS_CONTEXT_API,
+    WCORE_STATS_CONFIG_CHOOSE,
+    WCORE_STATS_CONFIG_DESTROY,
+    WCORE_STATS_CONTEXT_CREATE,
+    WCORE_STATS_CONTEXT_CREATE_MANY,
+    WCORE_STATS_CONTEXT_DESTROY,
+    WCORE_STATS_WINDOW_CREATE,
+    WCORE_STATS_WINDOW_DESTROY,
+    WCORE_STATS_WINDOW_SHOW,
+    WCORE_STATS_WINDOW_RESIZE,
+    WCORE_STATS_WINDOW_SWAP_BUFFERS,
+    WCORE_STATS_WINDOW_SWAP_BUFFERS_MANY,
+    WCORE_STATS_MAKE_CURRENT,
+    WCORE_STATS_GET_PROC_ADDRESS,
+    WCORE_STATS_DL_CAN_OPEN,
+    WCORE_STATS_DL_SYM,
+    WCORE_STATS_NUM_CALLS,
+};
+
+void
+wcore_stats_enable(bool enable);
+
+/// @brief Return the name of @a call, such as "waffle_make_current".
+const char*
+wcore_stats_call_name(enum wcore_stats_call call);
+
+/// @brief Record a call that took @a ns nanoseconds.
+void
+wcore_stats_record(enum wcore_stats_call call, uint64_t ns);
+
+/// @brief Return the histogram bucket of a duration of @a ns nanoseconds.
+///
+/// Bucket 0 holds durations below 2 ns. Bucket i, for i > 0, holds
+/// durations in [2^i, 2^(i+1)) ns. The last bucket also holds all longer
+/// durations.
+unsigned
+wcore_stats_bucket(uint64_t ns);
+
+/// @brief Sum the counters of all threads into @a entries.
+///
+/// Fill at most @a max_entries entries and return WCORE_STATS_NUM_CALLS.
+size_t
+wcore_stats_snapshot(struct waffle_stats_entry *entries, size_t max_entries);
+
+/// @brief Format a snapshot as JSON. Free the result with free().
+///
+/// Emit WAFFLE_ERROR_BAD_ALLOC and return null on failure.
+char*
+wcore_stats_to_json(void);
+
+/// @brief Return the calling thread's block to the pool. Called at thread exit.
+void
+wcore_stats_release_block(struct wcore_stats_block *block);
+
+#ifdef __cplusplus
+}
+#endif
@@ -0,0 +1,160 @@
+// Copyright 2016 Intel Corporation
+//
+// All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+//
+// - Redistributions of source code must retain the above copyright notice, this
+//   list of conditions and the following disclaimer.
+//
+// - Redistributions in binary form must reproduce the above copyright notice,
+//   this list of conditions and the following disclaimer in the documentation
+//   and/or other materials provided with the distribution.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+// DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+// FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+// DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+// SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+// CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+// OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+// OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+#include <setjmp.h>
+#include <stdarg.h>
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include <cmocka.h>
+
+#include "threads.h"
+
+#include "wcore_stats.h"
+#include "wcore_trace.h"
+
+static uint64_t
+calls_of(enum wcore_stats_call call)
+{
+    struct waffle_stats_entry entries[WCORE_STATS_NUM_CALLS];
+
+    wcore_stats_snapshot(entries, WCORE_STATS_NUM_CALLS);
+    return entries[call].calls;
+}
+
+static void
+test_wcore_stats_bucket(void **state) {
+    assert_int_equal(wcore_stats_bucket(0), 0);
+    assert_int_equal(wcore_stats_bucket(1), 0);
+    assert_int_equal(wcore_stats_bucket(2), 1);
+    assert_int_equal(wcore_stats_bucket(3), 1);
+    assert_int_equal(wcore_stats_bucket(1024), 10);
+    assert_int_equal(wcore_stats_bucket(2047), 10);
+    assert_int_equal(wcore_stats_bucket(UINT64_MAX),
+                     WAFFLE_STATS_NUM_BUCKETS - 1);
+}
+
+static void
+test_wcore_stats_record(void **state) {
+    struct waffle_stats_entry before[WCORE_STATS_NUM_CALLS];
+    struct waffle_stats_entry after[WCORE_STATS_NUM_CALLS];
+    const struct waffle_stats_entry *b = &before[WCORE_STATS_CONFIG_CHOOSE];
+    const struct waffle_stats_entry *a = &after[WCORE_STATS_CONFIG_CHOOSE];
+
+    wcore_stats_snapshot(before, WCORE_STATS_NUM_CALLS);
+    wcore_stats_record(WCORE_STATS_CONFIG_CHOOSE, 100);
+    wcore_stats_record(WCORE_STATS_CONFIG_CHOOSE, 5000);
+    wcore_stats_snapshot(after, WCORE_STATS_NUM_CALLS);
+
+    assert_string_equal(a->name, "waffle_config_choose");
+    assert_int_equal(a->calls - b->calls, 2);
+    assert_int_equal(a->total_ns - b->total_ns, 5100);
+    assert_true(a->max_ns >= 5000);
+    assert_int_equal(a->histogram[6] - b->histogram[6], 1);
+    assert_int_equal(a->histogram[12] - b->histogram[12], 1);
+}
+
+static void
+test_wcore_stats_disabled(void **state) {
+    uint64_t n = calls_of(WCORE_STATS_MAKE_CURRENT);
+
+    wcore_stats_enable(false);
+    wcore_trace_end(WCORE_STATS_MAKE_CURRENT, NULL,
+                    wcore_trace_begin(WCORE_STATS_MAKE_CURRENT, NULL));
+    assert_int_equal(calls_of(WCORE_STATS_MAKE_CURRENT), n);
+
+    wcore_stats_enable(true);
+    wcore_trace_end(WCORE_STATS_MAKE_CURRENT, NULL,
+                    wcore_trace_begin(WCORE_STATS_MAKE_CURRENT, NULL));
+    assert_int_equal(calls_of(WCORE_STATS_MAKE_CURRENT), n + 1);
+    wcore_stats_enable(false);
+}
+
+#define NUM_THREADS 8
+#define CALLS_PER_THREAD 1000
+
+static int
+record_many(void *arg)
+{
+    for (int i = 0; i < CALLS_PER_THREAD; ++i)
+        wcore_stats_record(WCORE_STATS_WINDOW_SWAP_BUFFERS, i);
+    return 0;
+}
+
+static void
+test_wcore_stats_threads(void **state) {
+    uint64_t n = calls_of(WCORE_STATS_WINDOW_SWAP_BUFFERS);
+    thrd_t threads[NUM_THREADS];
+
+    // Run two waves, so the second reuses the blocks of the first.
+    for (int wave = 0; wave < 2; ++wave) {
+        for (int i = 0; i < NUM_THREADS; ++i)
+            assert_int_equal(thrd_create(&threads[i], record_many, NULL),
+                             thrd_success);
+        for (int i = 0; i < NUM_THREADS; ++i)
+            thrd_join(threads[i], NULL);
+    }
+
+    assert_int_equal(calls_of(WCORE_STATS_WINDOW_SWAP_BUFFERS),
+                     n + 2 * NUM_THREADS * CALLS_PER_THREAD);
+}
+
+static void
+test_wcore_stats_snapshot_short(void **state) {
+    struct waffle_stats_entry entries[2];
+
+    assert_int_equal(wcore_stats_snapshot(NULL, 0), WCORE_STATS_NUM_CALLS);
+    assert_int_equal(wcore_stats_snapshot(entries, 2), WCORE_STATS_NUM_CALLS);
+    assert_string_equal(entries[0].name, "waffle_display_connect");
+}
+
+static void
+test_wcore_stats_json(void **state) {
+    char *json;
+
+    wcore_stats_record(WCORE_STATS_DL_SYM, 3);
+
+    json = wcore_stats_to_json();
+    assert_non_null(json);
+    assert_true(strncmp(json, "{\"calls\": [", 11) == 0);
+    assert_non_null(strstr(json, "\"name\": \"waffle_dl_sym\""));
+    assert_non_null(strstr(json, "\"histogram\": ["));
+    free(json);
+}
+
+int
+main(void) {
+    const UnitTest tests[] = {
+        unit_test(test_wcore_stats_bucket),
+        unit_test(test_wcore_stats_record),
+        unit_test(test_wcore_stats_disabled),
+        unit_test(test_wcore_stats_threads),
+        unit_test(test_wcore_stats_snapshot_short),
+        unit_test(test_wcore_stats_json),
+    };
+
+    return run_tests(tests);
+}
@@ -31,7 +31,10 @@
 #include "threads.h"
 
 #include "wcore_error.h"
+#include "wcore_gl_stats.h"
+#include "wcore_stats.h"
 #include "wcore_tinfo.h"
+#include "wcore_trace_writer.h"
 
 static once_flag wcore_tinfo_once = ONCE_FLAG_INIT;
 static tss_t wcore_tinfo_key;
@@ -77,6 +80,12 @@ wcore_tinfo_key_dtor(void *args)
         return;
 
     wcore_error_tinfo_destroy(tinfo->error);
+    wcore_stats_release_block(tinfo->stats);
+    tinfo->stats = NULL;
+    wcore_gl_stats_release_block(tinfo->gl_stats);
+    tinfo->gl_stats = NULL;
+    wcore_trace_writer_release_ring(tinfo->trace_ring);
+    tinfo->trace_ring = NULL;
 
 #ifndef WAFFLE_HAS_TLS
     free(tinfo);
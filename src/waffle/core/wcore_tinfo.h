@@ -25,13 +25,48 @@
 
 #pragma once
 
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+struct wcore_context;
 struct wcore_error_tinfo;
+struct wcore_gl_stats_block;
+struct wcore_stats_block;
+struct wcore_trace_ring;
+struct wcore_window;
 
 /// @brief Thread-local info for all of Waffle.
 struct wcore_tinfo {
     /// @brief Info for @ref wcore_error.
     struct wcore_error_tinfo *error;
 
+    /// @brief Display of the context made current by waffle_make_current().
+    ///
+    /// Zero if no context is current.
+    size_t current_display_id;
+
+    /// @brief Context made current by waffle_make_current(), or null.
+    struct wcore_context *current_context;
+
+    /// @brief Window made current by waffle_make_current(), or null.
+    struct wcore_window *current_window;
+
+    /// @brief The thread's call statistics. Null until it records a call.
+    struct wcore_stats_block *stats;
+
+    /// @brief The thread's GL call statistics. Null until it records a call.
+    struct wcore_gl_stats_block *gl_stats;
+
+    /// @brief The thread's ring of trace events. Null until it traces one.
+    struct wcore_trace_ring *trace_ring;
+
+    /// @brief True while the thread is in waffle_window_swap_buffers().
+    bool in_swap;
+
+    /// @brief Time the current swap has spent blocked in the platform.
+    uint64_t swap_blocked_ns;
+
     bool is_init;
 };
 
@@ -0,0 +1,189 @@
+// Copyright 2016 Intel Corporation
+//
+// All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+//
+// - Redistributions of source code must retain the above copyright notice, this
+//   list of conditions and the following disclaimer.
+//
+// - Redistributions in binary form must reproduce the above copyright notice,
+//   this list of conditions and the following disclaimer in the documentation
+//   and/or other materials provided with the distribution.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+// DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+// FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+// DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+// SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+// CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+// OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+// OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+#ifdef _WIN32
+#include <windows.h>
+#else
+#include <time.h>
+#endif
+
+#include "wcore_trace.h"
+#include "wcore_util.h"
+
+struct wcore_trace_callbacks {
+    void (*begin)(const struct waffle_trace_event *event, void *user_data);
+    void (*end)(const struct waffle_trace_event *event, void *user_data);
+    void *user_data;
+};
+
+uint32_t wcore_trace_flags;
+
+/// Replaced, never modified, so that a thread that loaded it can keep
+/// using it.
+static struct wcore_trace_callbacks *wcore_trace_callbacks;
+
+uint64_t
+wcore_trace_now(void)
+{
+    uint64_t ns;
+
+#ifdef _WIN32
+    static LARGE_INTEGER freq;
+    LARGE_INTEGER count;
+
+    if (!freq.QuadPart)
+        QueryPerformanceFrequency(&freq);
+    QueryPerformanceCounter(&count);
+    ns = (uint64_t) (count.QuadPart * 1000000000.0 / freq.QuadPart);
+#else
+    struct timespec ts;
+
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    ns = (uint64_t) ts.tv_sec * 1000000000u + (uint64_t) ts.tv_nsec;
+#endif
+
+    // Zero means "not traced" to wcore_trace_end().
+    return ns ? ns : 1;
+}
+
+void
+wcore_trace_set_flags(uint32_t flags, bool enable)
+{
+    if (enable)
+        wcore_atomic_or_u32(&wcore_trace_flags, flags);
+    else
+        wcore_atomic_and_u32(&wcore_trace_flags, ~flags);
+}
+
+bool
+wcore_trace_set_callbacks(
+        void (*begin)(const struct waffle_trace_event *event, void *user_data),
+        void (*end)(const struct waffle_trace_event *event, void *user_data),
+        void *user_data)
+{
+    struct wcore_trace_callbacks *cb = NULL, *old;
+
+    if (begin || end) {
+        cb = wcore_malloc(sizeof(*cb));
+        if (!cb)
+            return false;
+
+        cb->begin = begin;
+        cb->end = end;
+        cb->user_data = user_data;
+    } else {
+        wcore_trace_set_flags(WCORE_TRACE_CALLBACKS, false);
+    }
+
+    do {
+        old = wcore_atomic_load_ptr((void**) &wcore_trace_callbacks);
+    } while (!wcore_atomic_cas_ptr((void**) &wcore_trace_callbacks, old, cb));
+
+    // The old callbacks are leaked rather than freed, because another thread
+    // may be calling through them. Applications set callbacks once or a few
+    // times, so the leak is bounded in practice.
+    (void) old;
+
+    if (cb)
+        wcore_trace_set_flags(WCORE_TRACE_CALLBACKS, true);
+
+    return true;
+}
+
+static void
+emit(bool is_end, const char *name, bool native, const void *object,
+     uint64_t now, uint64_t begin)
+{
+    const struct wcore_trace_callbacks *cb =
+        wcore_atomic_load_ptr((void**) &wcore_trace_callbacks);
+    void (*fn)(const struct waffle_trace_event *, void *);
+    struct waffle_trace_event event = {
+        .name = name,
+        .object = object,
+        .timestamp_ns = now,
+        .duration_ns = is_end ? now - begin : 0,
+        .native = native,
+    };
+
+    if (!cb)
+        return;
+
+    fn = is_end ? cb->end : cb->begin;
+    if (fn)
+        fn(&event, cb->user_data);
+}
+
+uint64_t
+wcore_trace_begin_slow(enum wcore_stats_call call, const void *object)
+{
+    uint64_t now = wcore_trace_now();
+
+    if (wcore_atomic_load_u32_relaxed(&wcore_trace_flags) &
+        WCORE_TRACE_CALLBACKS)
+        emit(false, wcore_stats_call_name(call), false, object, now, 0);
+
+    return now;
+}
+
+void
+wcore_trace_end_slow(enum wcore_stats_call call, const void *object,
+                     uint64_t begin)
+{
+    uint64_t now = wcore_trace_now();
+    uint32_t flags = wcore_atomic_load_u32_relaxed(&wcore_trace_flags);
+
+    if (flags & WCORE_TRACE_STATS)
+        wcore_stats_record(call, now > begin ? now - begin : 0);
+    if (flags & WCORE_TRACE_CALLBACKS)
+        emit(true, wcore_stats_call_name(call), false, object, now, begin);
+    if (flags & WCORE_TRACE_WRITER)
+        wcore_trace_writer_complete(wcore_stats_call_name(call), false,
+                                    object, begin, now);
+}
+
+uint64_t
+wcore_trace_native_begin_slow(const char *name, const void *object)
+{
+    uint64_t now = wcore_trace_now();
+
+    if (wcore_atomic_load_u32_relaxed(&wcore_trace_flags) &
+        WCORE_TRACE_CALLBACKS)
+        emit(false, name, true, object, now, 0);
+
+    return now;
+}
+
+void
+wcore_trace_native_end_slow(const char *name, const void *object,
+                            uint64_t begin)
+{
+    uint64_t now = wcore_trace_now();
+    uint32_t flags = wcore_atomic_load_u32_relaxed(&wcore_trace_flags);
+
+    if (flags & WCORE_TRACE_CALLBACKS)
+        emit(true, name, true, object, now, begin);
+    if (flags & WCORE_TRACE_WRITER)
+        wcore_trace_writer_complete(name, true, object, begin, now);
+}
@@ -0,0 +1,170 @@
+// Copyright 2016 Intel Corporation
+//
+// All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+//
+// - Redistributions of source code must retain the above copyright notice, this
+//   list of conditions and the following disclaimer.
+//
+// - Redistributions in binary form must reproduce the above copyright notice,
+//   this list of conditions and the following disclaimer in the documentation
+//   and/or other materials provided with the distribution.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+// DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+// FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+// DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+// SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+// CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+// OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+// OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+/// @file
+/// @brief Instrumentation of platform and native calls.
+///
+/// The api layer brackets each call into the platform vtbl with
+/// wcore_trace_begin() and wcore_trace_end(). The backends bracket the native
+/// calls most likely to stall, such as eglMakeCurrent() or
+/// wl_display_roundtrip(), with wcore_trace_native_begin() and
+/// wcore_trace_native_end(). The brackets feed the call statistics of
+/// wcore_stats.h, the callbacks set with waffle_set_trace_callbacks(), and
+/// the trace file of wcore_trace_writer.h.
+///
+/// All consumers are gated by the single word wcore_trace_flags, so when
+/// none is enabled a bracket costs one load and one branch.
+
+#pragma once
+
+#include <stdbool.h>
+#include <stdint.h>
+
+#include "waffle.h"
+
+#include "wcore_atomic.h"
+#include "wcore_stats.h"
+#include "wcore_trace_writer.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/// Bits of wcore_trace_flags.
+#define WCORE_TRACE_STATS       0x1u
+#define WCORE_TRACE_CALLBACKS   0x2u
+#define WCORE_TRACE_WRITER      0x4u
+
+/// Consumers of native calls, which are not counted in the statistics.
+#define WCORE_TRACE_NATIVE      (WCORE_TRACE_CALLBACKS | WCORE_TRACE_WRITER)
+
+extern uint32_t wcore_trace_flags;
+
+/// @brief Return CLOCK_MONOTONIC in nanoseconds. Never returns 0.
+uint64_t
+wcore_trace_now(void);
+
+/// @brief Enable or disable the consumers in @a flags.
+void
+wcore_trace_set_flags(uint32_t flags, bool enable);
+
+/// @brief Set the application's callbacks. Both null unsets them.
+///
+/// Emit WAFFLE_ERROR_BAD_ALLOC and return false on failure.
+bool
+wcore_trace_set_callbacks(
+        void (*begin)(const struct waffle_trace_event *event, void *user_data),
+        void (*end)(const struct waffle_trace_event *event, void *user_data),
+        void *user_data);
+
+uint64_t
+wcore_trace_begin_slow(enum wcore_stats_call call, const void *object);
+
+void
+wcore_trace_end_slow(enum wcore_stats_call call, const void *object,
+                     uint64_t begin);
+
+uint64_t
+wcore_trace_native_begin_slow(const char *name, const void *object);
+
+void
+wcore_trace_native_end_slow(const char *name, const void *object,
+                            uint64_t begin);
+
+/// @brief Begin a call into the platform on @a object, a waffle object.
+///
+/// Return the time the call began, or 0 if nothing is enabled. Pass the
+/// result to wcore_trace_end().
+static inline uint64_t
+wcore_trace_begin(enum wcore_stats_call call, const void *object)
+{
+    if (!wcore_atomic_load_u32_relaxed(&wcore_trace_flags))
+        return 0;
+
+    return wcore_trace_begin_slow(call, object);
+}
+
+static inline void
+wcore_trace_end(enum wcore_stats_call call, const void *object,
+                uint64_t begin)
+{
+    if (begin)
+        wcore_trace_end_slow(call, object, begin);
+}
+
+/// @brief Begin native call @a name on @a object, a native handle.
+///
+/// Return the time the call began, or 0 if nothing is enabled. Pass the
+/// result to wcore_trace_native_end().
+static inline uint64_t
+wcore_trace_native_begin(const char *name, const void *object)
+{
+    if (!(wcore_atomic_load_u32_relaxed(&wcore_trace_flags) &
+          WCORE_TRACE_NATIVE))
+        return 0;
+
+    return wcore_trace_native_begin_slow(name, object);
+}
+
+static inline void
+wcore_trace_native_end(const char *name, const void *object, uint64_t begin)
+{
+    if (begin)
+        wcore_trace_native_end_slow(name, object, begin);
+}
+
+/// @brief Mark the creation or destruction of @a object, a display, context
+/// or window, for the lifetime tracks of the trace file.
+static inline void
+wcore_trace_object(const char *kind, const void *object, bool alive)
+{
+    if (wcore_atomic_load_u32_relaxed(&wcore_trace_flags) & WCORE_TRACE_WRITER)
+        wcore_trace_writer_span(kind, object, alive, wcore_trace_now());
+}
+
+/// @brief Mark a swap of @a window, for its frame track in the trace file.
+///
+/// A frame spans two consecutive swaps. @a last_swap holds the time of the
+/// previous swap, or 0.
+static inline void
+wcore_trace_frame(const void *window, uint64_t *last_swap)
+{
+    uint64_t now;
+
+    if (!(wcore_atomic_load_u32_relaxed(&wcore_trace_flags) &
+          WCORE_TRACE_WRITER))
+        return;
+
+    now = wcore_trace_now();
+    if (*last_swap) {
+        wcore_trace_writer_span("frame", window, true, *last_swap);
+        wcore_trace_writer_span("frame", window, false, now);
+    }
+    *last_swap = now;
+}
+
+#ifdef __cplusplus
+}
+#endif
@@ -0,0 +1,158 @@
+// Copyright 2016 Intel Corporation
+//
+// All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+//
+// - Redistributions of source code must retain the above copyright notice, this
+//   list of conditions and the following disclaimer.
+//
+// - Redistributions in binary form must reproduce the above copyright notice,
+//   this list of conditions and the following disclaimer in the documentation
+//   and/or other materials provided with the distribution.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+// DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+// FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+// DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+// SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+// CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+// OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+// OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+#include <setjmp.h>
+#include <stdarg.h>
+#include <stdint.h>
+#include <string.h>
+
+#include <cmocka.h>
+
+#include "wcore_trace.h"
+
+#define MAX_EVENTS 8
+
+struct recorder {
+    struct waffle_trace_event events[MAX_EVENTS];
+    bool is_end[MAX_EVENTS];
+    int n;
+};
+
+static void
+record(const struct waffle_trace_event *event, void *user_data, bool is_end)
+{
+    struct recorder *r = user_data;
+
+    assert_true(r->n < MAX_EVENTS);
+    r->events[r->n] = *event;
+    r->is_end[r->n] = is_end;
+    r->n++;
+}
+
+static void
+on_begin(const struct waffle_trace_event *event, void *user_data)
+{
+    record(event, user_data, false);
+}
+
+static void
+on_end(const struct waffle_trace_event *event, void *user_data)
+{
+    record(event, user_data, true);
+}
+
+static void
+test_wcore_trace_disabled(void **state) {
+    assert_int_equal(wcore_trace_begin(WCORE_STATS_MAKE_CURRENT, NULL), 0);
+    assert_int_equal(wcore_trace_native_begin("eglMakeCurrent", NULL), 0);
+}
+
+static void
+test_wcore_trace_callbacks(void **state) {
+    struct recorder r = { .n = 0 };
+    int object;
+    uint64_t t0;
+
+    assert_true(wcore_trace_set_callbacks(on_begin, on_end, &r));
+
+    t0 = wcore_trace_begin(WCORE_STATS_MAKE_CURRENT, &object);
+    assert_int_not_equal(t0, 0);
+    wcore_trace_end(WCORE_STATS_MAKE_CURRENT, &object, t0);
+
+    assert_int_equal(r.n, 2);
+    assert_false(r.is_end[0]);
+    assert_true(r.is_end[1]);
+    assert_string_equal(r.events[0].name, "waffle_make_current");
+    assert_string_equal(r.events[1].name, "waffle_make_current");
+    assert_true(r.events[0].object == &object);
+    assert_true(r.events[1].object == &object);
+    assert_false(r.events[0].native);
+    assert_int_equal(r.events[0].duration_ns, 0);
+    assert_true(r.events[1].timestamp_ns >= r.events[0].timestamp_ns);
+    assert_int_equal(r.events[1].duration_ns,
+                     r.events[1].timestamp_ns - t0);
+
+    assert_true(wcore_trace_set_callbacks(NULL, NULL, NULL));
+}
+
+static void
+test_wcore_trace_native(void **state) {
+    struct recorder r = { .n = 0 };
+    uint64_t t0;
+
+    assert_true(wcore_trace_set_callbacks(on_begin, on_end, &r));
+
+    t0 = wcore_trace_native_begin("eglSwapBuffers", &r);
+    wcore_trace_native_end("eglSwapBuffers", &r, t0);
+
+    assert_int_equal(r.n, 2);
+    assert_string_equal(r.events[0].name, "eglSwapBuffers");
+    assert_true(r.events[0].native);
+    assert_true(r.events[1].native);
+
+    assert_true(wcore_trace_set_callbacks(NULL, NULL, NULL));
+}
+
+static void
+test_wcore_trace_unset(void **state) {
+    struct recorder r = { .n = 0 };
+    uint64_t t0;
+
+    assert_true(wcore_trace_set_callbacks(on_begin, NULL, &r));
+    assert_true(wcore_trace_set_callbacks(NULL, NULL, NULL));
+
+    t0 = wcore_trace_begin(WCORE_STATS_WINDOW_SWAP_BUFFERS, NULL);
+    wcore_trace_end(WCORE_STATS_WINDOW_SWAP_BUFFERS, NULL, t0);
+    assert_int_equal(t0, 0);
+    assert_int_equal(r.n, 0);
+}
+
+static void
+test_wcore_trace_begin_only(void **state) {
+    struct recorder r = { .n = 0 };
+    uint64_t t0;
+
+    assert_true(wcore_trace_set_callbacks(on_begin, NULL, &r));
+
+    t0 = wcore_trace_begin(WCORE_STATS_WINDOW_SWAP_BUFFERS, NULL);
+    wcore_trace_end(WCORE_STATS_WINDOW_SWAP_BUFFERS, NULL, t0);
+    assert_int_equal(r.n, 1);
+    assert_false(r.is_end[0]);
+
+    assert_true(wcore_trace_set_callbacks(NULL, NULL, NULL));
+}
+
+int
+main(void) {
+    const UnitTest tests[] = {
+        unit_test(test_wcore_trace_disabled),
+        unit_test(test_wcore_trace_callbacks),
+        unit_test(test_wcore_trace_native),
+        unit_test(test_wcore_trace_unset),
+        unit_test(test_wcore_trace_begin_only),
+    };
+
+    return run_tests(tests);
+}
@@ -0,0 +1,355 @@
+// Copyright 2016 Intel Corporation
+//
+// All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+//
+// - Redistributions of source code must retain the above copyright notice, this
+//   list of conditions and the following disclaimer.
+//
+// - Redistributions in binary form must reproduce the above copyright notice,
+//   this list of conditions and the following disclaimer in the documentation
+//   and/or other materials provided with the distribution.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+// DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+// FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+// DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+// SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+// CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+// OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+// OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+#include <inttypes.h>
+#include <stdio.h>
+#include <stdlib.h>
+
+#ifdef _WIN32
+#include <windows.h>
+#else
+#include <unistd.h>
+#endif
+
+#include "threads.h"
+
+#include "wcore_atomic.h"
+#include "wcore_block_pool.h"
+#include "wcore_tinfo.h"
+#include "wcore_trace.h"
+#include "wcore_trace_writer.h"
+#include "wcore_util.h"
+
+/// Must be a power of two.
+#define WCORE_TRACE_RING_SIZE 4096u
+
+enum wcore_trace_kind {
+    WCORE_TRACE_KIND_CALL,
+    WCORE_TRACE_KIND_NATIVE,
+    WCORE_TRACE_KIND_SPAN_BEGIN,
+    WCORE_TRACE_KIND_SPAN_END,
+};
+
+struct wcore_trace_record {
+    /// Static storage.
+    const char *name;
+    const void *object;
+    uint64_t timestamp;
+    uint64_t duration;
+    uint32_t tid;
+    enum wcore_trace_kind kind;
+};
+
+struct wcore_trace_ring {
+    /// Owned by a wcore_tinfo. Only the owner pushes records.
+    struct wcore_block_pool_link link;
+    uint32_t tid;
+
+    /// Written by the owner. Records in [tail, head) are ready.
+    uint64_t head;
+
+    /// Written by the thread that drains the ring, with the writer's mutex
+    /// held.
+    uint64_t tail;
+
+    /// Records dropped because the ring was full. Written by the owner.
+    uint64_t dropped;
+    uint64_t dropped_reported;
+
+    struct wcore_trace_record records[WCORE_TRACE_RING_SIZE];
+};
+
+DEFINE_CONTAINER_CAST_FUNC(wcore_trace_ring,
+                           struct wcore_trace_ring,
+                           struct wcore_block_pool_link,
+                           link)
+
+static once_flag wcore_trace_writer_once = ONCE_FLAG_INIT;
+
+/// Protects the members below it and the draining of the rings.
+static mtx_t wcore_trace_writer_mutex;
+static FILE *wcore_trace_writer_file;
+static size_t wcore_trace_writer_refs;
+static bool wcore_trace_writer_first_event;
+static bool wcore_trace_writer_has_thread;
+static thrd_t wcore_trace_writer_thread;
+
+static bool wcore_trace_writer_stop;
+static size_t wcore_trace_writer_next_tid;
+static struct wcore_block_pool wcore_trace_rings;
+
+static void
+wcore_trace_writer_init_once(void)
+{
+    mtx_init(&wcore_trace_writer_mutex, mtx_plain);
+}
+
+static unsigned long
+wcore_trace_writer_pid(void)
+{
+#ifdef _WIN32
+    return GetCurrentProcessId();
+#else
+    return (unsigned long) getpid();
+#endif
+}
+
+/// Write the common members of an event, up to "args".
+static void
+wcore_trace_writer_begin_event(FILE *f, const char *name, const char *cat,
+                               char phase, uint64_t timestamp, uint32_t tid)
+{
+    fprintf(f, "%s{\"name\": \"%s\", \"cat\": \"%s\", \"ph\": \"%c\", "
+            "\"ts\": %" PRIu64 ".%03u, \"pid\": %lu, \"tid\": %" PRIu32,
+            wcore_trace_writer_first_event ? "" : ",\n",
+            name, cat, phase,
+            timestamp / 1000, (unsigned) (timestamp % 1000),
+            wcore_trace_writer_pid(), tid);
+    wcore_trace_writer_first_event = false;
+}
+
+static void
+wcore_trace_writer_write(FILE *f, const struct wcore_trace_record *r)
+{
+    switch (r->kind) {
+        case WCORE_TRACE_KIND_CALL:
+        case WCORE_TRACE_KIND_NATIVE:
+            wcore_trace_writer_begin_event(
+                f, r->name, r->kind == WCORE_TRACE_KIND_CALL ? "waffle" : "native",
+                'X', r->timestamp, r->tid);
+            fprintf(f, ", \"dur\": %" PRIu64 ".%03u, \"args\": "
+                    "{\"object\": \"%p\"}}",
+                    r->duration / 1000, (unsigned) (r->duration % 1000),
+                    r->object);
+            break;
+        case WCORE_TRACE_KIND_SPAN_BEGIN:
+        case WCORE_TRACE_KIND_SPAN_END:
+            wcore_trace_writer_begin_event(
+                f, r->name, "span",
+                r->kind == WCORE_TRACE_KIND_SPAN_BEGIN ? 'b' : 'e',
+                r->timestamp, r->tid);
+            fprintf(f, ", \"id\": \"%p\"}", r->object);
+            break;
+    }
+}
+
+/// Write the ready records of all rings. Call with the mutex held.
+static void
+wcore_trace_writer_drain(void)
+{
+    FILE *f = wcore_trace_writer_file;
+
+    for (struct wcore_block_pool_link *link =
+            wcore_block_pool_first(&wcore_trace_rings);
+         link; link = link->next) {
+        struct wcore_trace_ring *ring = wcore_trace_ring(link);
+        uint64_t head = wcore_atomic_load_u64_acquire(&ring->head);
+        uint64_t tail = ring->tail;
+        uint64_t dropped;
+
+        for (; tail != head; ++tail) {
+            wcore_trace_writer_write(
+                f, &ring->records[tail & (WCORE_TRACE_RING_SIZE - 1)]);
+        }
+
+        wcore_atomic_store_u64_release(&ring->tail, tail);
+
+        dropped = wcore_atomic_load_u64_relaxed(&ring->dropped);
+        if (dropped != ring->dropped_reported) {
+            wcore_trace_writer_begin_event(f, "waffle_trace_dropped",
+                                           "waffle", 'i', wcore_trace_now(),
+                                           ring->tid);
+            fprintf(f, ", \"s\": \"t\", \"args\": {\"count\": %" PRIu64 "}}",
+                    dropped - ring->dropped_reported);
+            ring->dropped_reported = dropped;
+        }
+    }
+
+    fflush(f);
+}
+
+static int
+wcore_trace_writer_thread_main(void *arg)
+{
+    // The shim's cnd_timedwait() ignores its timeout, so poll.
+    const xtime period = { .sec = 0, .nsec = 100 * 1000 * 1000 };
+
+    (void) arg;
+
+    while (!wcore_atomic_load_bool(&wcore_trace_writer_stop)) {
+        thrd_sleep(&period);
+
+        mtx_lock(&wcore_trace_writer_mutex);
+        wcore_trace_writer_drain();
+        mtx_unlock(&wcore_trace_writer_mutex);
+    }
+
+    return 0;
+}
+
+bool
+wcore_trace_writer_acquire(const char *path)
+{
+    bool ok = true;
+
+    call_once(&wcore_trace_writer_once, wcore_trace_writer_init_once);
+    mtx_lock(&wcore_trace_writer_mutex);
+
+    if (wcore_trace_writer_refs > 0) {
+        wcore_trace_writer_refs++;
+        goto done;
+    }
+
+    // The file stays open once opened, so that a second waffle_init()
+    // continues the same array.
+    if (!wcore_trace_writer_file) {
+        wcore_trace_writer_file = fopen(path, "w");
+        if (!wcore_trace_writer_file) {
+            ok = false;
+            goto done;
+        }
+
+        fputs("[\n", wcore_trace_writer_file);
+        wcore_trace_writer_first_event = true;
+    }
+
+    wcore_trace_writer_refs = 1;
+    wcore_atomic_store_bool(&wcore_trace_writer_stop, false);
+
+    // Without the thread, the rings are drained only at release, and drop
+    // what does not fit.
+    wcore_trace_writer_has_thread =
+        thrd_create(&wcore_trace_writer_thread,
+                    wcore_trace_writer_thread_main, NULL) == thrd_success;
+
+    wcore_trace_set_flags(WCORE_TRACE_WRITER, true);
+
+done:
+    mtx_unlock(&wcore_trace_writer_mutex);
+    return ok;
+}
+
+void
+wcore_trace_writer_release(void)
+{
+    bool has_thread;
+
+    mtx_lock(&wcore_trace_writer_mutex);
+
+    if (wcore_trace_writer_refs == 0 || --wcore_trace_writer_refs > 0) {
+        mtx_unlock(&wcore_trace_writer_mutex);
+        return;
+    }
+
+    wcore_trace_set_flags(WCORE_TRACE_WRITER, false);
+    wcore_atomic_store_bool(&wcore_trace_writer_stop, true);
+    has_thread = wcore_trace_writer_has_thread;
+    wcore_trace_writer_has_thread = false;
+    mtx_unlock(&wcore_trace_writer_mutex);
+
+    if (has_thread)
+        thrd_join(wcore_trace_writer_thread, NULL);
+
+    mtx_lock(&wcore_trace_writer_mutex);
+    wcore_trace_writer_drain();
+    mtx_unlock(&wcore_trace_writer_mutex);
+}
+
+/// Claim a free ring for the calling thread, or allocate one.
+static struct wcore_trace_ring*
+wcore_trace_writer_acquire_ring(void *owner)
+{
+    struct wcore_trace_ring *ring;
+
+    ring = wcore_trace_ring(
+        wcore_block_pool_acquire(&wcore_trace_rings, sizeof(*ring), owner));
+    if (!ring)
+        return NULL;
+
+    ring->tid = (uint32_t) wcore_atomic_inc_size(&wcore_trace_writer_next_tid);
+    return ring;
+}
+
+void
+wcore_trace_writer_release_ring(struct wcore_trace_ring *ring)
+{
+    if (ring)
+        wcore_block_pool_release(&ring->link);
+}
+
+static void
+wcore_trace_writer_push(struct wcore_trace_record *r)
+{
+    struct wcore_tinfo *tinfo = wcore_tinfo_get();
+    struct wcore_trace_ring *ring = tinfo->trace_ring;
+    uint64_t head;
+
+    if (!ring) {
+        ring = tinfo->trace_ring = wcore_trace_writer_acquire_ring(tinfo);
+        // Without memory the event is lost.
+        if (!ring)
+            return;
+    }
+
+    head = ring->head;
+    if (head - wcore_atomic_load_u64_acquire(&ring->tail) >=
+        WCORE_TRACE_RING_SIZE) {
+        wcore_atomic_store_u64_relaxed(&ring->dropped, ring->dropped + 1);
+        return;
+    }
+
+    r->tid = ring->tid;
+    ring->records[head & (WCORE_TRACE_RING_SIZE - 1)] = *r;
+    wcore_atomic_store_u64_release(&ring->head, head + 1);
+}
+
+void
+wcore_trace_writer_complete(const char *name, bool native,
+                            const void *object, uint64_t begin, uint64_t end)
+{
+    struct wcore_trace_record r = {
+        .name = name,
+        .object = object,
+        .timestamp = begin,
+        .duration = end > begin ? end - begin : 0,
+        .kind = native ? WCORE_TRACE_KIND_NATIVE : WCORE_TRACE_KIND_CALL,
+    };
+
+    wcore_trace_writer_push(&r);
+}
+
+void
+wcore_trace_writer_span(const char *name, const void *object, bool begin,
+                        uint64_t timestamp)
+{
+    struct wcore_trace_record r = {
+        .name = name,
+        .object = object,
+        .timestamp = timestamp,
+        .kind = begin ? WCORE_TRACE_KIND_SPAN_BEGIN : WCORE_TRACE_KIND_SPAN_END,
+    };
+
+    wcore_trace_writer_push(&r);
+}
@@ -0,0 +1,78 @@
+// Copyright 2016 Intel Corporation
+//
+// All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+//
+// - Redistributions of source code must retain the above copyright notice, this
+//   list of conditions and the following disclaimer.
+//
+// - Redistributions in binary form must reproduce the above copyright notice,
+//   this list of conditions and the following disclaimer in the documentation
+//   and/or other materials provided with the distribution.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+// DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+// FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+// DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+// SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+// CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+// OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+// OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+/// @file
+/// @brief Trace file in the Chrome trace-event format.
+///
+/// When the environment variable WAFFLE_TRACE names a file, the api layer
+/// opens this writer while a waffle instance exists. Each thread appends the
+/// events of wcore_trace.h to its own ring buffer, without a lock. A
+/// background thread drains the rings into the file periodically, and the
+/// destruction of the last instance drains them once more.
+///
+/// The file is a JSON array of trace events, which chrome://tracing and
+/// Perfetto load. The closing bracket is omitted, as the format allows, so
+/// that events can be appended if waffle is initialized again.
+
+#pragma once
+
+#include <stdbool.h>
+#include <stdint.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+struct wcore_trace_ring;
+
+/// @brief Open the trace file @a path if not yet open, and take a reference.
+///
+/// Return false, and leave tracing disabled, if the file cannot be opened.
+bool
+wcore_trace_writer_acquire(const char *path);
+
+/// @brief Drop a reference. The last one flushes the file.
+void
+wcore_trace_writer_release(void);
+
+/// @brief Append a call that ran from @a begin to @a end.
+void
+wcore_trace_writer_complete(const char *name, bool native,
+                            const void *object, uint64_t begin, uint64_t end);
+
+/// @brief Append the begin or end of the span @a name of @a object.
+///
+/// Spans of the same name and object form one track.
+void
+wcore_trace_writer_span(const char *name, const void *object, bool begin,
+                        uint64_t timestamp);
+
+/// @brief Return the calling thread's ring to the pool. Called at thread exit.
+void
+wcore_trace_writer_release_ring(struct wcore_trace_ring *ring);
+
+#ifdef __cplusplus
+}
+#endif
@@ -0,0 +1,140 @@
+// Copyright 2016 Intel Corporation
+//
+// All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+//
+// - Redistributions of source code must retain the above copyright notice, this
+//   list of conditions and the following disclaimer.
+//
+// - Redistributions in binary form must reproduce the above copyright notice,
+//   this list of conditions and the following disclaimer in the documentation
+//   and/or other materials provided with the distribution.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+// DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+// FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+// DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+// SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+// CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+// OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+// OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+#include <setjmp.h>
+#include <stdarg.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+
+#include <cmocka.h>
+
+#include "wcore_trace.h"
+#include "wcore_trace_writer.h"
+
+static char path[] = "/tmp/wcore_trace_writer_unittest.XXXXXX";
+
+static char*
+read_trace(void)
+{
+    FILE *f = fopen(path, "r");
+    static char buf[1 << 16];
+    size_t n;
+
+    assert_non_null(f);
+    n = fread(buf, 1, sizeof(buf) - 1, f);
+    buf[n] = '\0';
+    fclose(f);
+    return buf;
+}
+
+static void
+test_wcore_trace_writer_bad_path(void **state) {
+    assert_false(wcore_trace_writer_acquire("/nonexistent/dir/trace.json"));
+    assert_false(wcore_trace_flags & WCORE_TRACE_WRITER);
+}
+
+static void
+test_wcore_trace_writer_events(void **state) {
+    int window;
+    uint64_t last_swap = 0;
+    uint64_t t0;
+    char *trace;
+
+    assert_true(wcore_trace_writer_acquire(path));
+    assert_true(wcore_trace_flags & WCORE_TRACE_WRITER);
+
+    wcore_trace_object("window", &window, true);
+
+    t0 = wcore_trace_begin(WCORE_STATS_WINDOW_SWAP_BUFFERS, &window);
+    wcore_trace_end(WCORE_STATS_WINDOW_SWAP_BUFFERS, &window, t0);
+    wcore_trace_frame(&window, &last_swap);
+    assert_int_not_equal(last_swap, 0);
+
+    t0 = wcore_trace_native_begin("eglSwapBuffers", &window);
+    wcore_trace_native_end("eglSwapBuffers", &window, t0);
+    wcore_trace_frame(&window, &last_swap);
+
+    wcore_trace_object("window", &window, false);
+    wcore_trace_writer_release();
+    assert_false(wcore_trace_flags & WCORE_TRACE_WRITER);
+
+    trace = read_trace();
+    assert_true(strncmp(trace, "[\n{", 3) == 0);
+    assert_non_null(strstr(trace,
+        "{\"name\": \"waffle_window_swap_buffers\", \"cat\": \"waffle\", "
+        "\"ph\": \"X\""));
+    assert_non_null(strstr(trace,
+        "{\"name\": \"eglSwapBuffers\", \"cat\": \"native\", \"ph\": \"X\""));
+    assert_non_null(strstr(trace,
+        "{\"name\": \"window\", \"cat\": \"span\", \"ph\": \"b\""));
+    assert_non_null(strstr(trace,
+        "{\"name\": \"window\", \"cat\": \"span\", \"ph\": \"e\""));
+    assert_non_null(strstr(trace,
+        "{\"name\": \"frame\", \"cat\": \"span\", \"ph\": \"b\""));
+    assert_non_null(strstr(trace,
+        "{\"name\": \"frame\", \"cat\": \"span\", \"ph\": \"e\""));
+}
+
+static void
+test_wcore_trace_writer_reacquire(void **state) {
+    char *trace;
+
+    // A second acquisition appends to the same array.
+    assert_true(wcore_trace_writer_acquire(path));
+    assert_true(wcore_trace_writer_acquire(path));
+    wcore_trace_native_end("wl_display_roundtrip", NULL,
+                           wcore_trace_native_begin("wl_display_roundtrip",
+                                                    NULL));
+    wcore_trace_writer_release();
+    assert_true(wcore_trace_flags & WCORE_TRACE_WRITER);
+    wcore_trace_writer_release();
+    assert_false(wcore_trace_flags & WCORE_TRACE_WRITER);
+
+    trace = read_trace();
+    assert_null(strstr(trace + 1, "["));
+    assert_non_null(strstr(trace, "},\n{\"name\": \"wl_display_roundtrip\""));
+}
+
+int
+main(void) {
+    const UnitTest tests[] = {
+        unit_test(test_wcore_trace_writer_bad_path),
+        unit_test(test_wcore_trace_writer_events),
+        unit_test(test_wcore_trace_writer_reacquire),
+    };
+    int fd, ret;
+
+    fd = mkstemp(path);
+    if (fd < 0)
+        return 1;
+    close(fd);
+
+    ret = run_tests(tests);
+    remove(path);
+    return ret;
+}
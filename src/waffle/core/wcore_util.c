@@ -85,12 +85,18 @@ wcore_enum_to_string(int32_t e)
         CASE(WAFFLE_PLATFORM_GBM);
         CASE(WAFFLE_PLATFORM_WGL);
         CASE(WAFFLE_PLATFORM_NACL);
+        CASE(WAFFLE_PLATFORM_AUTO);
+        CASE(WAFFLE_FAST_START);
+        CASE(WAFFLE_FAST_START_LAZY);
+        CASE(WAFFLE_FAST_START_PREFETCH);
+        CASE(WAFFLE_CAPABILITY_CACHE);
         CASE(WAFFLE_CONTEXT_API);
         CASE(WAFFLE_CONTEXT_OPENGL);
         CASE(WAFFLE_CONTEXT_OPENGL_ES1);
         CASE(WAFFLE_CONTEXT_OPENGL_ES2);
         CASE(WAFFLE_CONTEXT_OPENGL_ES3);
         CASE(WAFFLE_CONTEXT_MAJOR_VERSION);
+        CASE(WAFFLE_CONTEXT_VERSION_MAX);
         CASE(WAFFLE_CONTEXT_MINOR_VERSION);
         CASE(WAFFLE_CONTEXT_PROFILE);
         CASE(WAFFLE_CONTEXT_CORE_PROFILE);
@@ -98,6 +104,7 @@ wcore_enum_to_string(int32_t e)
         CASE(WAFFLE_CONTEXT_FORWARD_COMPATIBLE);
         CASE(WAFFLE_CONTEXT_DEBUG);
         CASE(WAFFLE_CONTEXT_ROBUST_ACCESS);
+        CASE(WAFFLE_CONTEXT_DEBUG_STATS);
         CASE(WAFFLE_RED_SIZE);
         CASE(WAFFLE_GREEN_SIZE);
         CASE(WAFFLE_BLUE_SIZE);
@@ -115,6 +122,7 @@ wcore_enum_to_string(int32_t e)
         CASE(WAFFLE_WINDOW_WIDTH);
         CASE(WAFFLE_WINDOW_HEIGHT);
         CASE(WAFFLE_WINDOW_FULLSCREEN);
+        CASE(WAFFLE_WINDOW_GPU_TIMING);
 
         default: return NULL;
 
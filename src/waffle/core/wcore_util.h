@@ -109,6 +109,12 @@ wcore_calloc(size_t size);
                 union_var->union_member = (void*) (union_var + 1);      \
         } while (0)
 
+/// @brief Size of a native union created by WCORE_CREATE_NATIVE_UNION().
+///
+/// For example, `WCORE_NATIVE_UNION_SIZE(union waffle_native_display, glx)`.
+#define WCORE_NATIVE_UNION_SIZE(union_type, union_member)               \
+        (sizeof(union_type) + sizeof(*((union_type*) 0)->union_member))
+
 const char*
 wcore_enum_to_string(int32_t e);
 
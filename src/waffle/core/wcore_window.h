@@ -25,7 +25,12 @@
 
 #pragma once
 
+#include <stdint.h>
+
 #include "wcore_config.h"
+#include "wcore_frame_stats.h"
+#include "wcore_gpu_timer.h"
+#include "wcore_memory.h"
 #include "wcore_util.h"
 
 struct wcore_window;
@@ -34,6 +39,21 @@ union waffle_native_window;
 struct wcore_window {
     struct api_object api;
     struct wcore_display *display;
+
+    /// Time of the last swap, for the frame track of the trace file.
+    uint64_t trace_last_swap;
+
+    /// Timing of the last swaps. Null until the first swap.
+    struct wcore_frame_stats *frame_stats;
+
+    /// Null unless the window was created with WAFFLE_WINDOW_GPU_TIMING.
+    struct wcore_gpu_timer *gpu_timer;
+
+    /// Estimated memory of the window's native buffers. Set by the api layer
+    /// from the window's size, or by the backend if it knows better.
+    uint64_t buffer_bytes;
+
+    struct wcore_memory_layout memory_layout;
 };
 
 static inline struct waffle_window*
@@ -54,7 +74,13 @@ wcore_window_init(struct wcore_window *self,
     assert(config);
 
     self->api.display_id = config->display->api.display_id;
+    self->api.platform = config->display->api.platform;
     self->display = config->display;
+    self->trace_last_swap = 0;
+    self->frame_stats = NULL;
+    self->gpu_timer = NULL;
+    self->buffer_bytes = 0;
+    wcore_memory_layout_init(&self->memory_layout, &config->attrs);
 
     return true;
 }
@@ -62,7 +88,9 @@ wcore_window_init(struct wcore_window *self,
 static inline bool
 wcore_window_teardown(struct wcore_window *self)
 {
-    (void) self;
     assert(self);
+    wcore_frame_stats_destroy(self->frame_stats);
+    self->frame_stats = NULL;
+    wcore_gpu_timer_destroy(self);
     return true;
 }
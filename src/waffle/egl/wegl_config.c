@@ -27,8 +27,10 @@
 #include <EGL/eglext.h>
 
 #include "wcore_config_attrs.h"
+#include "wcore_display.h"
 #include "wcore_error.h"
 #include "wcore_platform.h"
+#include "wcore_trace.h"
 
 #include "wegl_config.h"
 #include "wegl_display.h"
@@ -93,7 +95,7 @@ check_context_attrs(struct wegl_display *dpy,
                 return false;
             }
 
-            if (!plat->vtbl->dl_can_open(plat, WAFFLE_DL_OPENGL)) {
+            if (!wcore_vtbl(plat)->dl_can_open(plat, WAFFLE_DL_OPENGL)) {
                 wcore_errorf(WAFFLE_ERROR_UNSUPPORTED_ON_PLATFORM,
                              "failed to open the OpenGL library");
                 return false;
@@ -102,7 +104,7 @@ check_context_attrs(struct wegl_display *dpy,
             return true;
 
         case WAFFLE_CONTEXT_OPENGL_ES1:
-            if (!plat->vtbl->dl_can_open(plat, WAFFLE_DL_OPENGL_ES1)) {
+            if (!wcore_vtbl(plat)->dl_can_open(plat, WAFFLE_DL_OPENGL_ES1)) {
                 wcore_errorf(WAFFLE_ERROR_UNSUPPORTED_ON_PLATFORM,
                              "failed to open the OpenGL ES1 library");
                 return false;
@@ -111,7 +113,7 @@ check_context_attrs(struct wegl_display *dpy,
             return true;
 
         case WAFFLE_CONTEXT_OPENGL_ES2:
-            if (!plat->vtbl->dl_can_open(plat, WAFFLE_DL_OPENGL_ES2)) {
+            if (!wcore_vtbl(plat)->dl_can_open(plat, WAFFLE_DL_OPENGL_ES2)) {
                 wcore_errorf(WAFFLE_ERROR_UNSUPPORTED_ON_PLATFORM,
                              "failed to open the OpenGL ES2 library");
                 return false;
@@ -127,7 +129,7 @@ check_context_attrs(struct wegl_display *dpy,
                 return false;
             }
 
-            if (!plat->vtbl->dl_can_open(plat, WAFFLE_DL_OPENGL_ES3)) {
+            if (!wcore_vtbl(plat)->dl_can_open(plat, WAFFLE_DL_OPENGL_ES3)) {
                 wcore_errorf(WAFFLE_ERROR_UNSUPPORTED_ON_PLATFORM,
                              "failed to open the OpenGL ES3 library");
                 return false;
@@ -207,8 +209,10 @@ choose_real_config(struct wegl_display *dpy,
     }
 
     EGLint num_configs = 0;
+    uint64_t t0 = wcore_trace_native_begin("eglChooseConfig", dpy->egl);
     ok &= plat->eglChooseConfig(dpy->egl,
                                 attrib_list, &config, 1, &num_configs);
+    wcore_trace_native_end("eglChooseConfig", dpy->egl, t0);
     if (!ok) {
         wegl_emit_error(plat, "eglChooseConfig");
         return NULL;
@@ -233,7 +237,8 @@ wegl_config_choose(struct wcore_platform *wc_plat,
 
     (void) wc_plat;
 
-    config = wcore_calloc(sizeof(*config));
+    config = wcore_display_alloc_object(wc_dpy, WCORE_OBJECT_CONFIG,
+                                        sizeof(*config));
     if (!config)
         return NULL;
 
@@ -265,6 +270,6 @@ wegl_config_destroy(struct wcore_config *wc_config)
         return true;
 
     result &= wcore_config_teardown(wc_config);
-    free(config);
+    wcore_display_free_object(config);
     return result;
 }
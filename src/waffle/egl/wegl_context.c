@@ -23,10 +23,18 @@
 // OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
 // OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
 
+#include <string.h>
+
 #include <EGL/egl.h>
 #include <EGL/eglext.h>
 
+#include "threads.h"
+
+#include "wcore_atomic.h"
+
+#include "wcore_display.h"
 #include "wcore_error.h"
+#include "wcore_trace.h"
 
 #include "wegl_config.h"
 #include "wegl_context.h"
@@ -60,16 +68,14 @@ bind_api(struct wegl_platform *plat, int32_t waffle_context_api)
     return ok;
 }
 
-static EGLContext
-create_real_context(struct wegl_config *config,
-                    EGLContext share_ctx)
-
+/// Fill the eglCreateContext attribute list, which must hold 64 entries, for
+/// contexts of @a config.
+static bool
+get_context_attrib_list(struct wegl_config *config, EGLint attrib_list[])
 {
     struct wegl_display *dpy = wegl_display(config->wcore.display);
-    struct wegl_platform *plat = wegl_platform(dpy->wcore.platform);
     struct wcore_config_attrs *attrs = &config->wcore.attrs;
     int32_t waffle_context_api = attrs->context_api;
-    EGLint attrib_list[64];
     EGLint context_flags = 0;
     int i = 0;
 
@@ -114,7 +120,7 @@ create_real_context(struct wegl_config *config,
                     default:
                         wcore_error_internal("attrs->context_profile has bad value %#x",
                                              attrs->context_profile);
-                        return EGL_NO_CONTEXT;
+                        return false;
                 }
             }
             break;
@@ -142,7 +148,7 @@ create_real_context(struct wegl_config *config,
         default:
             wcore_error_internal("waffle_context_api has bad value %#x",
                                  waffle_context_api);
-            return EGL_NO_CONTEXT;
+            return false;
     }
 
     if (context_flags != 0) {
@@ -151,12 +157,28 @@ create_real_context(struct wegl_config *config,
     }
 
     attrib_list[i++] = EGL_NONE;
+    return true;
+}
+
+static EGLContext
+create_real_context(struct wegl_config *config,
+                    EGLContext share_ctx)
+
+{
+    struct wegl_display *dpy = wegl_display(config->wcore.display);
+    struct wegl_platform *plat = wegl_platform(dpy->wcore.platform);
+    EGLint attrib_list[64];
+
+    if (!get_context_attrib_list(config, attrib_list))
+        return EGL_NO_CONTEXT;
 
-    if (!bind_api(plat, waffle_context_api))
+    if (!bind_api(plat, config->wcore.attrs.context_api))
         return EGL_NO_CONTEXT;
 
+    uint64_t t0 = wcore_trace_native_begin("eglCreateContext", dpy->egl);
     EGLContext ctx = plat->eglCreateContext(dpy->egl, config->egl,
                                             share_ctx, attrib_list);
+    wcore_trace_native_end("eglCreateContext", dpy->egl, t0);
     if (!ctx)
         wegl_emit_error(plat, "eglCreateContext");
 
@@ -199,7 +221,8 @@ wegl_context_create(struct wcore_platform *wc_plat,
 
     (void) wc_plat;
 
-    ctx = wcore_calloc(sizeof(*ctx));
+    ctx = wcore_display_alloc_object(wc_config->display, WCORE_OBJECT_CONTEXT,
+                                     sizeof(*ctx));
     if (!ctx)
         return NULL;
 
@@ -211,6 +234,194 @@ wegl_context_create(struct wcore_platform *wc_plat,
     return &ctx->wcore;
 }
 
+/// Most threads that wegl_context_create_many() uses, including the caller's.
+#define WEGL_CREATE_MANY_MAX_THREADS 4
+
+/// @brief Work shared by the threads of wegl_context_create_many().
+struct wegl_context_batch {
+    struct wegl_config *config;
+    const EGLint *attrib_list;
+    EGLContext share_ctx;
+
+    struct wcore_context **out;
+    size_t count;
+
+    /// Index, plus 1, of the last context claimed by a thread.
+    size_t claimed;
+
+    /// Set by the first thread that fails. Access atomically, so that the
+    /// other threads can stop claiming contexts without taking @a mutex,
+    /// which protects @a error.
+    bool failed;
+    mtx_t mutex;
+    struct wcore_error_saved error;
+};
+
+/// Create one context with a prebuilt attribute list. The calling thread
+/// must have bound the context's API.
+static struct wegl_context*
+create_context_from_attribs(struct wegl_config *config,
+                            EGLContext share_ctx,
+                            const EGLint *attrib_list)
+{
+    struct wegl_display *dpy = wegl_display(config->wcore.display);
+    struct wegl_platform *plat = wegl_platform(dpy->wcore.platform);
+    struct wegl_context *ctx;
+
+    ctx = wcore_display_alloc_object(&dpy->wcore, WCORE_OBJECT_CONTEXT,
+                                     sizeof(*ctx));
+    if (!ctx)
+        return NULL;
+
+    if (!wcore_context_init(&ctx->wcore, &config->wcore))
+        goto fail;
+
+    uint64_t t0 = wcore_trace_native_begin("eglCreateContext", dpy->egl);
+    ctx->egl = plat->eglCreateContext(dpy->egl, config->egl, share_ctx,
+                                      attrib_list);
+    wcore_trace_native_end("eglCreateContext", dpy->egl, t0);
+    if (!ctx->egl) {
+        wegl_emit_error(plat, "eglCreateContext");
+        goto fail;
+    }
+
+    return ctx;
+
+fail:
+    wegl_context_destroy(&ctx->wcore);
+    return NULL;
+}
+
+/// Save the calling thread's error in @a batch, unless another thread
+/// already failed.
+static void
+batch_fail(struct wegl_context_batch *batch)
+{
+    mtx_lock(&batch->mutex);
+    wcore_error_save(&batch->error);
+    mtx_unlock(&batch->mutex);
+    wcore_atomic_store_bool(&batch->failed, true);
+}
+
+/// Claim and create contexts until none remain or a thread fails.
+static void
+batch_run(struct wegl_context_batch *batch)
+{
+    struct wegl_platform *plat =
+        wegl_platform(batch->config->wcore.display->platform);
+
+    // The API binding is per thread.
+    if (!bind_api(plat, batch->config->wcore.attrs.context_api)) {
+        batch_fail(batch);
+        return;
+    }
+
+    while (!wcore_atomic_load_bool(&batch->failed)) {
+        size_t i = wcore_atomic_inc_size(&batch->claimed) - 1;
+        struct wegl_context *ctx;
+
+        if (i >= batch->count)
+            break;
+
+        ctx = create_context_from_attribs(batch->config, batch->share_ctx,
+                                          batch->attrib_list);
+        if (!ctx) {
+            batch_fail(batch);
+            break;
+        }
+
+        batch->out[i] = &ctx->wcore;
+    }
+}
+
+static int
+batch_thread_main(void *arg)
+{
+    struct wegl_context_batch *batch = arg;
+    struct wegl_platform *plat =
+        wegl_platform(batch->config->wcore.display->platform);
+
+    batch_run(batch);
+
+    if (plat->eglReleaseThread)
+        plat->eglReleaseThread();
+
+    return 0;
+}
+
+bool
+wegl_context_create_many(struct wcore_platform *wc_plat,
+                         struct wcore_config *wc_config,
+                         struct wcore_context *wc_share_ctx,
+                         int32_t count,
+                         struct wcore_context *out[])
+{
+    struct wegl_platform *plat = wegl_platform(wc_plat);
+    struct wegl_config *config = wegl_config(wc_config);
+    struct wegl_context *share_ctx = wegl_context(wc_share_ctx);
+    struct wegl_context *root;
+    struct wegl_context_batch batch;
+    thrd_t threads[WEGL_CREATE_MANY_MAX_THREADS - 1];
+    int num_threads = 0;
+    EGLint attrib_list[64];
+
+    memset(out, 0, count * sizeof(out[0]));
+
+    // Build the attribute list once for all contexts.
+    if (!get_context_attrib_list(config, attrib_list))
+        return false;
+
+    if (!bind_api(plat, wc_config->attrs.context_api))
+        return false;
+
+    root = create_context_from_attribs(config,
+                                       share_ctx ? share_ctx->egl
+                                                 : EGL_NO_CONTEXT,
+                                       attrib_list);
+    if (!root)
+        return false;
+
+    out[0] = &root->wcore;
+
+    memset(&batch, 0, sizeof(batch));
+    batch.config = config;
+    batch.attrib_list = attrib_list;
+    batch.share_ctx = root->egl;
+    batch.out = out + 1;
+    batch.count = count - 1;
+    mtx_init(&batch.mutex, mtx_plain);
+
+    // EGL requires eglCreateContext to be thread safe, so spread the
+    // remaining contexts across threads. If a thread cannot be started, then
+    // the others, and the caller, do its share.
+    while (num_threads < WEGL_CREATE_MANY_MAX_THREADS - 1 &&
+           (size_t) num_threads + 1 < batch.count) {
+        if (thrd_create(&threads[num_threads], batch_thread_main,
+                        &batch) != thrd_success)
+            break;
+        ++num_threads;
+    }
+
+    batch_run(&batch);
+
+    for (int i = 0; i < num_threads; ++i)
+        thrd_join(threads[i], NULL);
+
+    mtx_destroy(&batch.mutex);
+
+    if (batch.failed) {
+        for (int32_t i = count - 1; i >= 0; --i) {
+            wegl_context_destroy(out[i]);
+            out[i] = NULL;
+        }
+
+        wcore_error_restore(&batch.error);
+        return false;
+    }
+
+    return true;
+}
+
 bool
 wegl_context_teardown(struct wegl_context *ctx)
 {
@@ -241,7 +452,7 @@ wegl_context_destroy(struct wcore_context *wc_ctx)
     if (wc_ctx) {
         struct wegl_context *ctx = wegl_context(wc_ctx);
         result = wegl_context_teardown(ctx);
-        free(ctx);
+        wcore_display_free_object(ctx);
     }
     return result;
 }
@@ -58,3 +58,14 @@ wegl_context_create(struct wcore_platform *wc_plat,
 
 bool
 wegl_context_destroy(struct wcore_context *wc_ctx);
+
+/// @brief Create @a count contexts; see wcore_context_vtbl::create_many.
+///
+/// The attribute list is built and the API bound once. All contexts after
+/// the first share with the first and are created on several threads.
+bool
+wegl_context_create_many(struct wcore_platform *wc_plat,
+                         struct wcore_config *wc_config,
+                         struct wcore_context *wc_share_ctx,
+                         int32_t count,
+                         struct wcore_context *out[]);
@@ -24,9 +24,13 @@
 // OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
 
 #include <assert.h>
+#include <inttypes.h>
+#include <stdio.h>
 
+#include "linux_driver_id.h"
 #include "wcore_error.h"
 #include "wcore_platform.h"
+#include "wcore_trace.h"
 
 #include "wegl_display.h"
 #include "wegl_imports.h"
@@ -44,13 +48,11 @@ get_extensions(struct wegl_display *dpy)
         return false;
     }
 
-    // waffle_is_extension_in_string() resets the error state. That's ok,
-    // however, because if we've reached this point then no error should be
-    // pending emission.
-    assert(wcore_error_get_code() == 0);
+    if (!wcore_ext_set_init(&dpy->wcore.extensions, extensions))
+        return false;
 
-    dpy->EXT_create_context_robustness = waffle_is_extension_in_string(extensions, "EGL_EXT_create_context_robustness");
-    dpy->KHR_create_context = waffle_is_extension_in_string(extensions, "EGL_KHR_create_context");
+    dpy->EXT_create_context_robustness = wcore_ext_set_has(&dpy->wcore.extensions, "EGL_EXT_create_context_robustness");
+    dpy->KHR_create_context = wcore_ext_set_has(&dpy->wcore.extensions, "EGL_KHR_create_context");
 
     return true;
 }
@@ -65,18 +67,31 @@ wegl_display_init(struct wegl_display *dpy,
     struct wegl_platform *plat = wegl_platform(wc_plat);
     bool ok;
     EGLint major, minor;
+    uint64_t t0;
 
     ok = wcore_display_init(&dpy->wcore, wc_plat);
     if (!ok)
         goto fail;
 
-    dpy->egl = plat->eglGetDisplay((EGLNativeDisplayType) native_display);
-    if (!dpy->egl) {
-        wegl_emit_error(plat, "eglGetDisplay");
-        goto fail;
+    if (plat->eglGetPlatformDisplayEXT) {
+        dpy->egl = plat->eglGetPlatformDisplayEXT(plat->egl_platform,
+                                                  (void*) native_display,
+                                                  NULL);
+        if (!dpy->egl) {
+            wegl_emit_error(plat, "eglGetPlatformDisplayEXT");
+            goto fail;
+        }
+    } else {
+        dpy->egl = plat->eglGetDisplay((EGLNativeDisplayType) native_display);
+        if (!dpy->egl) {
+            wegl_emit_error(plat, "eglGetDisplay");
+            goto fail;
+        }
     }
 
+    t0 = wcore_trace_native_begin("eglInitialize", dpy->egl);
     ok = plat->eglInitialize(dpy->egl, &major, &minor);
+    wcore_trace_native_end("eglInitialize", dpy->egl, t0);
     if (!ok) {
         wegl_emit_error(plat, "eglInitialize");
         goto fail;
@@ -105,6 +120,7 @@ wegl_display_teardown(struct wegl_display *dpy)
             wegl_emit_error(plat, "eglTerminate");
     }
 
+    ok &= wcore_display_teardown(&dpy->wcore);
     return ok;
 }
 
@@ -138,5 +154,24 @@ wegl_display_supports_context_api(struct wcore_display *wc_dpy,
             return false;
     }
 
-    return wc_plat->vtbl->dl_can_open(wc_plat, waffle_dl);
+    return wcore_vtbl(wc_plat)->dl_can_open(wc_plat, waffle_dl);
+}
+
+bool
+wegl_display_get_driver_id(struct wcore_display *wc_dpy,
+                           char *buf,
+                           size_t size)
+{
+    struct wegl_display *dpy = wegl_display(wc_dpy);
+    struct wegl_platform *plat = wegl_platform(dpy->wcore.platform);
+    const char *vendor = plat->eglQueryString(dpy->egl, EGL_VENDOR);
+    const char *version = plat->eglQueryString(dpy->egl, EGL_VERSION);
+    int len;
+
+    if (!vendor || !version)
+        return false;
+
+    len = snprintf(buf, size, "%s %s build=%016" PRIx64,
+                   vendor, version, linux_driver_build_hash());
+    return len > 0 && (size_t) len < size;
 }
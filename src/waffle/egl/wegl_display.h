@@ -26,6 +26,7 @@
 #pragma once
 
 #include <stdbool.h>
+#include <stddef.h>
 #include <stdint.h>
 
 #include <EGL/egl.h>
@@ -37,6 +38,7 @@ struct wcore_display;
 struct wegl_display {
     struct wcore_display wcore;
     EGLDisplay egl;
+
     bool EXT_create_context_robustness;
     bool KHR_create_context;
 };
@@ -57,3 +59,10 @@ wegl_display_teardown(struct wegl_display *dpy);
 bool
 wegl_display_supports_context_api(struct wcore_display *wc_dpy,
                                   int32_t waffle_context_api);
+
+/// @brief Describe the display by EGL_VENDOR, EGL_VERSION and the build of
+/// the loaded driver libraries.
+bool
+wegl_display_get_driver_id(struct wcore_display *wc_dpy,
+                           char *buf,
+                           size_t size);
@@ -25,6 +25,9 @@
 
 #include <dlfcn.h>
 
+#include "waffle.h"
+
+#include "wcore_atomic.h"
 #include "wcore_error.h"
 #include "wegl_platform.h"
 
@@ -41,6 +44,8 @@ wegl_platform_teardown(struct wegl_platform *self)
     bool ok = true;
     int error = 0;
 
+    wegl_platform_wait_prefetch(self);
+
     if (self->eglHandle) {
         error = dlclose(self->eglHandle);
         if (error) {
@@ -51,25 +56,53 @@ wegl_platform_teardown(struct wegl_platform *self)
         }
     }
 
+    mtx_destroy(&self->load_mutex);
     ok &= wcore_platform_teardown(&self->wcore);
     return ok;
 }
-bool
-wegl_platform_init(struct wegl_platform *self)
+
+/// Resolve eglGetPlatformDisplayEXT if libEGL supports EGL_EXT_platform_base.
+///
+/// With it, each platform instance asks for its display explicitly and no
+/// longer relies on the process-wide EGL_PLATFORM environment variable.
+/// This is what allows instances of different EGL platforms to coexist.
+static void
+wegl_platform_init_platform_base(struct wegl_platform *self)
 {
-    bool ok;
+    const char *client_extensions;
 
-    ok = wcore_platform_init(&self->wcore);
-    if (!ok)
-        goto error;
+    if (!self->egl_platform)
+        return;
+
+    // Querying EGL_NO_DISPLAY fails with EGL_BAD_DISPLAY if EGL 1.5 and
+    // EGL_EXT_client_extensions are both unsupported. That's ok.
+    client_extensions = self->eglQueryString(EGL_NO_DISPLAY, EGL_EXTENSIONS);
+    if (!client_extensions) {
+        self->eglGetError();
+        return;
+    }
+
+    if (!waffle_is_extension_in_string(client_extensions,
+                                       "EGL_EXT_platform_base"))
+        return;
+
+    self->eglGetPlatformDisplayEXT = (__typeof__(self->eglGetPlatformDisplayEXT))
+        self->eglGetProcAddress("eglGetPlatformDisplayEXT");
+}
+
+/// Load libEGL and resolve its symbols. On failure, unload it again so that
+/// a later call starts over.
+static bool
+wegl_platform_load_egl(struct wegl_platform *self)
+{
+    bool ok = true;
 
     self->eglHandle = dlopen(libEGL_filename, RTLD_LAZY | RTLD_LOCAL);
     if (!self->eglHandle) {
         wcore_errorf(WAFFLE_ERROR_FATAL,
                      "dlopen(\"%s\") failed: %s",
                      libEGL_filename, dlerror());
-        ok = false;
-        goto error;
+        return false;
     }
 
 #define OPTIONAL_EGL_SYMBOL(function)                                  \
@@ -103,6 +136,7 @@ wegl_platform_init(struct wegl_platform *self)
 
     // context
     RETRIEVE_EGL_SYMBOL(eglBindAPI);
+    OPTIONAL_EGL_SYMBOL(eglReleaseThread);
     RETRIEVE_EGL_SYMBOL(eglCreateContext);
     RETRIEVE_EGL_SYMBOL(eglDestroyContext);
 
@@ -115,8 +149,86 @@ wegl_platform_init(struct wegl_platform *self)
 #undef OPTIONAL_EGL_SYMBOL
 #undef RETRIEVE_EGL_SYMBOL
 
+    wegl_platform_init_platform_base(self);
+    return true;
+
 error:
-    // On failure the caller of wegl_platform_init will trigger it's own
-    // destruction which will execute wegl_platform_teardown.
+    dlclose(self->eglHandle);
+    self->eglHandle = NULL;
+    return ok;
+}
+
+bool
+wegl_platform_load(struct wegl_platform *self)
+{
+    bool ok = true;
+
+    if (wcore_atomic_load_bool(&self->loaded))
+        return true;
+
+    mtx_lock(&self->load_mutex);
+
+    if (!self->loaded) {
+        if (!self->eglHandle)
+            ok = wegl_platform_load_egl(self);
+
+        if (ok && self->load_native)
+            ok = self->load_native(self);
+
+        if (ok)
+            wcore_atomic_store_bool(&self->loaded, true);
+    }
+
+    mtx_unlock(&self->load_mutex);
     return ok;
 }
+
+static int
+wegl_platform_prefetch_main(void *arg)
+{
+    struct wegl_platform *self = arg;
+
+    // If this fails, the first wegl_platform_load() from an application
+    // thread tries again and reports the error there.
+    wegl_platform_load(self);
+    return 0;
+}
+
+void
+wegl_platform_wait_prefetch(struct wegl_platform *self)
+{
+    if (self->has_prefetch_thread) {
+        thrd_join(self->prefetch_thread, NULL);
+        self->has_prefetch_thread = false;
+    }
+}
+
+bool
+wegl_platform_init(struct wegl_platform *self, EGLenum egl_platform,
+                   int32_t fast_start)
+{
+    bool ok;
+
+    ok = wcore_platform_init(&self->wcore);
+    if (!ok)
+        return false;
+
+    mtx_init(&self->load_mutex, mtx_plain);
+    self->egl_platform = egl_platform;
+
+    switch (fast_start) {
+        case WAFFLE_FAST_START_LAZY:
+            return true;
+        case WAFFLE_FAST_START_PREFETCH:
+            // If no thread can be started, the load happens on first use.
+            self->has_prefetch_thread =
+                thrd_create(&self->prefetch_thread,
+                            wegl_platform_prefetch_main,
+                            self) == thrd_success;
+            return true;
+        default:
+            // On failure the caller of wegl_platform_init will trigger it's
+            // own destruction which will execute wegl_platform_teardown.
+            return wegl_platform_load(self);
+    }
+}
@@ -28,12 +28,49 @@
 #include <EGL/egl.h>
 #include <EGL/eglext.h>
 
+#include "threads.h"
+
 #include "wcore_platform.h"
 #include "wcore_util.h"
 
+#ifndef EGL_PLATFORM_X11_EXT
+#define EGL_PLATFORM_X11_EXT 0x31D5
+#endif
+
+#ifndef EGL_PLATFORM_GBM_MESA
+#define EGL_PLATFORM_GBM_MESA 0x31D7
+#endif
+
+#ifndef EGL_PLATFORM_WAYLAND_EXT
+#define EGL_PLATFORM_WAYLAND_EXT 0x31D8
+#endif
+
 struct wegl_platform {
     struct wcore_platform wcore;
 
+    /// @brief Native platform passed to eglGetPlatformDisplayEXT.
+    ///
+    /// Zero if the platform has no EGL_EXT_platform_base token.
+    EGLenum egl_platform;
+
+    /// @brief Load the derived platform's own libraries. May be null.
+    ///
+    /// Called by wegl_platform_load() after libEGL is loaded. If it fails,
+    /// the next wegl_platform_load() calls it again, so it must skip the work
+    /// it already did.
+    bool (*load_native)(struct wegl_platform *self);
+
+    /// @brief Set once wegl_platform_load() succeeds. Access atomically.
+    bool loaded;
+
+    /// Serializes wegl_platform_load().
+    mtx_t load_mutex;
+
+    /// Runs wegl_platform_load() if WAFFLE_FAST_START_PREFETCH was given.
+    thrd_t prefetch_thread;
+    bool has_prefetch_thread;
+
+
     // EGL function pointers
     void *eglHandle;
 
@@ -56,6 +93,7 @@ struct wegl_platform {
 
     // context
     EGLBoolean (*eglBindAPI)(EGLenum api);
+    EGLBoolean (*eglReleaseThread)(void);
     EGLContext (*eglCreateContext)(EGLDisplay dpy, EGLConfig config,
                                    EGLContext share_context,
                                    const EGLint *attrib_list);
@@ -70,6 +108,12 @@ struct wegl_platform {
     EGLBoolean (*eglDestroySurface)(EGLDisplay dpy, EGLSurface surface);
     EGLBoolean (*eglSwapBuffers)(EGLDisplay dpy, EGLSurface surface);
 
+    // Optional. Non-null only if the EGL client extension string advertises
+    // EGL_EXT_platform_base.
+    EGLDisplay (*eglGetPlatformDisplayEXT)(EGLenum platform,
+                                           void *native_display,
+                                           const EGLint *attrib_list);
+
     EGLImageKHR (*eglCreateImageKHR) (EGLDisplay dpy, EGLContext ctx, EGLenum target, EGLClientBuffer buffer, const EGLint *attrib_list);
     EGLBoolean (*eglDestroyImageKHR)(EGLDisplay dpy, EGLImageKHR image);
 };
@@ -82,5 +126,32 @@ DEFINE_CONTAINER_CAST_FUNC(wegl_platform,
 bool
 wegl_platform_teardown(struct wegl_platform *self);
 
+/// @brief Initialize the platform.
+///
+/// @a fast_start is the value of WAFFLE_FAST_START. If it is WAFFLE_NONE,
+/// load the libraries now. Otherwise defer that to wegl_platform_load(), and
+/// for WAFFLE_FAST_START_PREFETCH start it on a background thread. Set
+/// load_native beforehand.
+///
+/// Neither load_native nor anything else that wegl_platform_load() calls may
+/// call setenv(), which races with getenv() in the application's threads. A
+/// derived platform that sets EGL_PLATFORM for eglGetDisplay(), when
+/// eglGetPlatformDisplayEXT is missing, does so in its create function: after
+/// this call when loading eagerly, and before it, without knowing whether it
+/// is needed, when @a fast_start defers the load. EGL reads the variable only
+/// in eglGetDisplay().
 bool
-wegl_platform_init(struct wegl_platform *self);
+wegl_platform_init(struct wegl_platform *self, EGLenum egl_platform,
+                   int32_t fast_start);
+
+/// @brief Load libEGL and the native libraries, if not yet done.
+///
+/// Call before the first use of any function pointer. Thread safe.
+bool
+wegl_platform_load(struct wegl_platform *self);
+
+/// @brief Wait for the background load, if any, to finish.
+///
+/// Derived platforms call this before tearing down what load_native set up.
+void
+wegl_platform_wait_prefetch(struct wegl_platform *self);
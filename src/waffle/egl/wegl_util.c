@@ -24,6 +24,7 @@
 // OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
 
 #include "wcore_error.h"
+#include "wcore_trace.h"
 
 #include "wegl_context.h"
 #include "wegl_display.h"
@@ -77,14 +78,16 @@ wegl_make_current(struct wcore_platform *wc_plat,
 {
     struct wegl_platform *plat = wegl_platform(wc_plat);
     EGLSurface surface = wc_window ? wegl_window(wc_window)->egl : NULL;
+    EGLContext ctx = wc_ctx ? wegl_context(wc_ctx)->egl : NULL;
+    uint64_t t0;
     bool ok;
 
+    t0 = wcore_trace_native_begin("eglMakeCurrent", ctx);
     ok = plat->eglMakeCurrent(wegl_display(wc_dpy)->egl,
                               surface,
                               surface,
-                              wc_ctx
-                                  ? wegl_context(wc_ctx)->egl
-                                  : NULL);
+                              ctx);
+    wcore_trace_native_end("eglMakeCurrent", ctx, t0);
     if (!ok)
         wegl_emit_error(plat, "eglMakeCurrent");
 
@@ -95,5 +98,15 @@ void*
 wegl_get_proc_address(struct wcore_platform *wc_self, const char *name)
 {
     struct wegl_platform *self = wegl_platform(wc_self);
+
+    if (!wegl_platform_load(self))
+        return NULL;
+
     return self->eglGetProcAddress(name);
 }
+
+bool
+wegl_load(struct wcore_platform *wc_self)
+{
+    return wegl_platform_load(wegl_platform(wc_self));
+}
@@ -48,3 +48,6 @@ wegl_make_current(struct wcore_platform *wc_plat,
 
 void*
 wegl_get_proc_address(struct wcore_platform *wc_self, const char *name);
+
+bool
+wegl_load(struct wcore_platform *wc_self);
@@ -23,6 +23,8 @@
 // OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
 // OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
 
+#include "wcore_trace.h"
+
 #include "wegl_config.h"
 #include "wegl_display.h"
 #include "wegl_imports.h"
@@ -100,7 +102,9 @@ wegl_window_swap_buffers(struct wcore_window *wc_window)
     struct wegl_display *dpy = wegl_display(window->wcore.display);
     struct wegl_platform *plat = wegl_platform(dpy->wcore.platform);
 
+    uint64_t t0 = wcore_trace_native_begin("eglSwapBuffers", window->egl);
     bool ok = plat->eglSwapBuffers(dpy->egl, window->egl);
+    wcore_trace_native_end("eglSwapBuffers", window->egl, t0);
     if (!ok)
         wegl_emit_error(plat, "eglSwapBuffers");
 
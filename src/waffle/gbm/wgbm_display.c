@@ -25,8 +25,10 @@
 
 #define _GNU_SOURCE
 
-#include <dlfcn.h>
+#include <inttypes.h>
+#include <stdio.h>
 #include <stdlib.h>
+#include <string.h>
 #include <unistd.h>
 
 #include <libudev.h>
@@ -61,6 +63,7 @@ wgbm_display_destroy(struct wcore_display *wc_self)
         close(fd);
     }
 
+    mtx_destroy(&self->mutex);
     free(self);
     return ok;
 }
@@ -124,10 +127,15 @@ wgbm_display_connect(struct wcore_platform *wc_plat,
     bool ok = true;
     int fd;
 
+    if (!wegl_platform_load(&plat->wegl))
+        return NULL;
+
     self = wcore_calloc(sizeof(*self));
     if (self == NULL)
         return NULL;
 
+    mtx_init(&self->mutex, mtx_plain);
+
     if (name == NULL) {
         name = getenv("WAFFLE_GBM_DEVICE");
     }
@@ -147,7 +155,6 @@ wgbm_display_connect(struct wcore_platform *wc_plat,
         }
     }
 
-    dlopen("libglapi.so.0", RTLD_LAZY | RTLD_GLOBAL);
     self->gbm_device = plat->gbm_create_device(fd);
     if (!self->gbm_device) {
         wcore_errorf(WAFFLE_ERROR_UNKNOWN, "gbm_create_device failed");
@@ -187,3 +194,29 @@ wgbm_display_get_native(struct wcore_display *wc_self)
 
     return n_dpy;
 }
+
+bool
+wgbm_display_get_driver_id(struct wcore_display *wc_self,
+                           char *buf,
+                           size_t size)
+{
+    struct wgbm_display *self = wgbm_display(wc_self);
+    struct wgbm_platform *plat =
+        wgbm_platform(wegl_platform(wc_self->platform));
+    struct stat st;
+    size_t len;
+    int n;
+
+    if (!wegl_display_get_driver_id(wc_self, buf, size))
+        return false;
+
+    // Distinguish the devices of a multi-GPU system, which may share a
+    // driver but not capabilities.
+    if (fstat(plat->gbm_device_get_fd(self->gbm_device), &st) != 0)
+        return false;
+
+    len = strlen(buf);
+    n = snprintf(buf + len, size - len, " rdev=%" PRIx64,
+                 (uint64_t) st.st_rdev);
+    return n > 0 && (size_t) n < size - len;
+}
@@ -26,8 +26,11 @@
 #pragma once
 
 #include <stdbool.h>
+#include <stddef.h>
 #include <stdint.h>
 
+#include "threads.h"
+
 #include "waffle_gbm.h"
 
 #include "wegl_display.h"
@@ -37,6 +40,13 @@ struct gbm_device;
 
 struct wgbm_display {
     struct gbm_device *gbm_device;
+
+    /// @brief Serializes gbm_surface_create() and gbm_surface_destroy().
+    ///
+    /// libgbm does not lock the gbm_device, so surfaces on the same device
+    /// must not be created or destroyed concurrently.
+    mtx_t mutex;
+
     struct wegl_display wegl;
 };
 
@@ -62,6 +72,11 @@ wgbm_display_destroy(struct wcore_display *wc_self);
 union waffle_native_display*
 wgbm_display_get_native(struct wcore_display *wc_self);
 
+bool
+wgbm_display_get_driver_id(struct wcore_display *wc_self,
+                           char *buf,
+                           size_t size);
+
 void
 wgbm_display_fill_native(struct wgbm_display *self,
                          struct waffle_gbm_display *n_dpy);
@@ -23,11 +23,10 @@
 // OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
 // OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
 
-#define _POSIX_C_SOURCE 200112 // glib feature macro for unsetenv()
-
 #include <stdlib.h>
 #include <dlfcn.h>
 
+#include "wcore_env.h"
 #include "wcore_error.h"
 
 #include "linux_platform.h"
@@ -43,8 +42,9 @@
 #include "wgbm_window.h"
 
 static const char *libgbm_filename = "libgbm.so.1";
+static const char *libglapi_filename = "libglapi.so.0";
 
-static const struct wcore_platform_vtbl wgbm_platform_vtbl;
+WCORE_PLATFORM_VTBL_LINKAGE const struct wcore_platform_vtbl wgbm_platform_vtbl;
 
 bool
 wgbm_platform_teardown(struct wgbm_platform *self)
@@ -55,7 +55,10 @@ wgbm_platform_teardown(struct wgbm_platform *self)
     if (!self)
         return true;
 
-    unsetenv("EGL_PLATFORM");
+    wegl_platform_wait_prefetch(&self->wegl);
+
+    if (self->set_egl_platform_env)
+        wcore_env_release("EGL_PLATFORM");
 
     if (self->linux)
         ok &= linux_platform_destroy(self->linux);
@@ -70,6 +73,9 @@ wgbm_platform_teardown(struct wgbm_platform *self)
         }
     }
 
+    if (self->glapiHandle)
+        dlclose(self->glapiHandle);
+
     ok &= wegl_platform_teardown(&self->wegl);
     return ok;
 }
@@ -87,21 +93,19 @@ wgbm_platform_destroy(struct wcore_platform *wc_self)
     return ok;
 }
 
-bool
-wgbm_platform_init(struct wgbm_platform *self)
+static bool
+wgbm_platform_load_native(struct wegl_platform *wegl)
 {
-    bool ok = true;
+    struct wgbm_platform *self = wgbm_platform(wegl);
 
-    ok = wegl_platform_init(&self->wegl);
-    if (!ok)
-        goto error;
-
-    self->gbmHandle = dlopen(libgbm_filename, RTLD_LAZY | RTLD_LOCAL);
     if (!self->gbmHandle) {
-        wcore_errorf(WAFFLE_ERROR_FATAL,
-                     "dlopen(\"%s\") failed: %s",
-                     libgbm_filename, dlerror());
-        goto error;
+        self->gbmHandle = dlopen(libgbm_filename, RTLD_LAZY | RTLD_LOCAL);
+        if (!self->gbmHandle) {
+            wcore_errorf(WAFFLE_ERROR_FATAL,
+                         "dlopen(\"%s\") failed: %s",
+                         libgbm_filename, dlerror());
+            return false;
+        }
     }
 
 #define RETRIEVE_GBM_SYMBOL(type, function, args)                                  \
@@ -110,18 +114,41 @@ wgbm_platform_init(struct wgbm_platform *self)
         wcore_errorf(WAFFLE_ERROR_FATAL,                             \
                      "dlsym(\"%s\", \"" #function "\") failed: %s",    \
                      libgbm_filename, dlerror());                      \
-        goto error;                                                    \
+        return false;                                                  \
     }
 
     GBM_FUNCTIONS(RETRIEVE_GBM_SYMBOL);
 #undef RETRIEVE_GBM_SYMBOL
 
+    if (!self->glapiHandle)
+        self->glapiHandle = dlopen(libglapi_filename, RTLD_LAZY | RTLD_GLOBAL);
+
+    return true;
+}
+
+bool
+wgbm_platform_init(struct wgbm_platform *self, int32_t fast_start)
+{
+    bool ok = true;
+
+    self->wegl.load_native = wgbm_platform_load_native;
+
+    // Libraries loaded later, by the prefetch thread or on first use, must
+    // not change the environment. See wegl_platform_init().
+    if (fast_start != WAFFLE_NONE)
+        self->set_egl_platform_env = wcore_env_hold("EGL_PLATFORM", "drm");
+
+    ok = wegl_platform_init(&self->wegl, EGL_PLATFORM_GBM_MESA, fast_start);
+    if (!ok)
+        goto error;
+
+    if (!self->wegl.eglGetPlatformDisplayEXT && !self->set_egl_platform_env)
+        self->set_egl_platform_env = wcore_env_hold("EGL_PLATFORM", "drm");
+
     self->linux = linux_platform_create();
     if (!self->linux)
         goto error;
 
-    setenv("EGL_PLATFORM", "drm", true);
-
     self->wegl.wcore.vtbl = &wgbm_platform_vtbl;
     return true;
 
@@ -131,13 +158,13 @@ error:
 }
 
 struct wcore_platform*
-wgbm_platform_create(void)
+wgbm_platform_create(int32_t fast_start)
 {
     struct wgbm_platform *self = wcore_calloc(sizeof(*self));
     if (self == NULL)
         return NULL;
 
-    if (wgbm_platform_init(self))
+    if (wgbm_platform_init(self, fast_start))
         return &self->wegl.wcore;
 
     wgbm_platform_destroy(&self->wegl.wcore);
@@ -178,31 +205,40 @@ wgbm_context_get_native(struct wcore_context *wc_ctx)
     return n_ctx;
 }
 
-static const struct wcore_platform_vtbl wgbm_platform_vtbl = {
+WCORE_PLATFORM_VTBL_LINKAGE const struct wcore_platform_vtbl wgbm_platform_vtbl = {
     .destroy = wgbm_platform_destroy,
 
     .make_current = wegl_make_current,
     .get_proc_address = wegl_get_proc_address,
     .dl_can_open = wgbm_dl_can_open,
     .dl_sym = wgbm_dl_sym,
+    .load = wegl_load,
 
     .display = {
         .connect = wgbm_display_connect,
         .destroy = wgbm_display_destroy,
         .supports_context_api = wegl_display_supports_context_api,
         .get_native = wgbm_display_get_native,
+        .native_size = WCORE_NATIVE_UNION_SIZE(union waffle_native_display,
+                                              gbm),
+        .get_driver_id = wgbm_display_get_driver_id,
     },
 
     .config = {
         .choose = wgbm_config_choose,
         .destroy = wegl_config_destroy,
         .get_native = wgbm_config_get_native,
+        .native_size = WCORE_NATIVE_UNION_SIZE(union waffle_native_config,
+                                              gbm),
     },
 
     .context = {
         .create = wegl_context_create,
         .destroy = wegl_context_destroy,
         .get_native = wgbm_context_get_native,
+        .native_size = WCORE_NATIVE_UNION_SIZE(union waffle_native_context,
+                                              gbm),
+        .create_many = wegl_context_create_many,
     },
 
     .window = {
@@ -211,5 +247,7 @@ static const struct wcore_platform_vtbl wgbm_platform_vtbl = {
         .show = wgbm_window_show,
         .swap_buffers = wgbm_window_swap_buffers,
         .get_native = wgbm_window_get_native,
+        .native_size = WCORE_NATIVE_UNION_SIZE(union waffle_native_window,
+                                              gbm),
     },
 };
@@ -58,9 +58,15 @@ struct wgbm_platform {
     struct wegl_platform wegl;
     struct linux_platform *linux;
 
+    /// True if this platform holds EGL_PLATFORM. See wcore_env_hold().
+    bool set_egl_platform_env;
+
     // GBM function pointers
     void *gbmHandle;
 
+    /// Mesa's GBM backend needs libglapi's symbols to be global. May be null.
+    void *glapiHandle;
+
 #define DECLARE(type, function, args) type (*function) args;
     GBM_FUNCTIONS(DECLARE)
 #undef DECLARE
@@ -72,13 +78,13 @@ DEFINE_CONTAINER_CAST_FUNC(wgbm_platform,
                            wegl)
 
 bool
-wgbm_platform_init(struct wgbm_platform *self);
+wgbm_platform_init(struct wgbm_platform *self, int32_t fast_start);
 
 bool
 wgbm_platform_teardown(struct wgbm_platform *self);
 
 struct wcore_platform*
-wgbm_platform_create(void);
+wgbm_platform_create(int32_t fast_start);
 
 bool
 wgbm_platform_destroy(struct wcore_platform *wc_self);
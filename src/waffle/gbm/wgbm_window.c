@@ -30,8 +30,13 @@
 
 #include "waffle_gbm.h"
 
+#include "wcore_atomic.h"
 #include "wcore_attrib_list.h"
 #include "wcore_error.h"
+#include "wcore_frame_stats.h"
+#include "wcore_memory.h"
+#include "wcore_probe.h"
+#include "wcore_trace.h"
 
 #include "wegl_config.h"
 
@@ -46,14 +51,23 @@ wgbm_window_destroy(struct wcore_window *wc_self)
     struct wcore_platform *wc_plat = wc_self->display->platform;
     struct wgbm_platform *plat = wgbm_platform(wegl_platform(wc_plat));
     struct wgbm_window *self = wgbm_window(wc_self);
+    struct wgbm_display *dpy;
     bool ok = true;
 
     if (!self)
         return ok;
 
+    dpy = wgbm_display(wc_self->display);
+
     ok &= wegl_window_teardown(&self->wegl);
-    plat->gbm_surface_destroy(self->gbm_surface);
-    free(self);
+
+    if (self->gbm_surface) {
+        mtx_lock(&dpy->mutex);
+        plat->gbm_surface_destroy(self->gbm_surface);
+        mtx_unlock(&dpy->mutex);
+    }
+
+    wcore_display_free_object(self);
     return ok;
 }
 
@@ -81,16 +95,19 @@ wgbm_window_create(struct wcore_platform *wc_plat,
         return NULL;
     }
 
-    self = wcore_calloc(sizeof(*self));
+    self = wcore_display_alloc_object(wc_config->display, WCORE_OBJECT_WINDOW,
+                                      sizeof(*self));
     if (self == NULL)
         return NULL;
 
     gbm_format = wgbm_config_get_gbm_format(wc_plat, wc_config->display,
                                             wc_config);
     assert(gbm_format != 0);
+    mtx_lock(&dpy->mutex);
     self->gbm_surface = plat->gbm_surface_create(dpy->gbm_device,
                                                  width, height, gbm_format,
                                                  GBM_BO_USE_RENDERING);
+    mtx_unlock(&dpy->mutex);
     if (!self->gbm_surface) {
         wcore_errorf(WAFFLE_ERROR_UNKNOWN,
                      "gbm_surface_create failed");
@@ -127,11 +144,30 @@ wgbm_window_swap_buffers(struct wcore_window *wc_self)
         return false;
 
     struct wgbm_window *self = wgbm_window(wc_self);
+    uint64_t blocked = wcore_frame_stats_block_begin();
+    WCORE_PROBE(gbm_lock_front_buffer_entry, self->gbm_surface);
+    uint64_t t0 = wcore_trace_native_begin("gbm_surface_lock_front_buffer",
+                                           self->gbm_surface);
     struct gbm_bo *bo = plat->gbm_surface_lock_front_buffer(self->gbm_surface);
-    if (!bo)
+    wcore_trace_native_end("gbm_surface_lock_front_buffer",
+                           self->gbm_surface, t0);
+    WCORE_PROBE(gbm_lock_front_buffer_return, self->gbm_surface, bo);
+    if (!bo) {
+        wcore_frame_stats_block_end(blocked);
         return false;
+    }
+
+    // All buffers of the surface are laid out like the one just locked,
+    // which gives the real size of the color buffers.
+    uint32_t height = plat->gbm_bo_get_height(bo);
+    wcore_atomic_store_u64_relaxed(&wc_self->buffer_bytes,
+        wcore_memory_estimate_buffers(&wc_self->memory_layout,
+                                      plat->gbm_bo_get_width(bo), height,
+                                      (uint64_t) plat->gbm_bo_get_stride(bo) *
+                                      height));
 
     plat->gbm_surface_release_buffer(self->gbm_surface, bo);
+    wcore_frame_stats_block_end(blocked);
     return true;
 }
 
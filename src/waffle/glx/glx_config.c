@@ -29,6 +29,7 @@
 #include "linux_platform.h"
 
 #include "wcore_config_attrs.h"
+#include "wcore_display.h"
 #include "wcore_error.h"
 
 #include "glx_config.h"
@@ -45,7 +46,7 @@ glx_config_destroy(struct wcore_config *wc_self)
         return ok;
 
     ok &= wcore_config_teardown(wc_self);
-    free(glx_config(wc_self));
+    wcore_display_free_object(glx_config(wc_self));
     return ok;
 }
 
@@ -188,7 +189,8 @@ glx_config_choose(struct wcore_platform *wc_plat,
     if (!glx_config_check_context_attrs(dpy, attrs))
         return NULL;
 
-    self = wcore_calloc(sizeof(*self));
+    self = wcore_display_alloc_object(wc_dpy, WCORE_OBJECT_CONFIG,
+                                      sizeof(*self));
     if (self == NULL)
         return NULL;
 
@@ -229,11 +231,14 @@ glx_config_choose(struct wcore_platform *wc_plat,
         0,
     };
 
-    // Set glx_fbconfig.
+    // Set glx_fbconfig. Count the call as a round trip: depending on the
+    // implementation, it may query the server for its configs.
+    uint64_t t0 = wcore_round_trip_begin();
     configs = wrapped_glXChooseFBConfig(plat, dpy->x11.xlib,
                                         dpy->x11.screen,
                                         attrib_list,
                                         &num_configs);
+    wcore_round_trip_end(&dpy->wcore.round_trips, t0);
     if (!configs || num_configs == 0) {
         wcore_errorf(WAFFLE_ERROR_UNKNOWN,
                      "glXChooseFBConfig returned no matching configs");
@@ -41,6 +41,7 @@
 #include <stdlib.h>
 
 #include "wcore_error.h"
+#include "wcore_trace.h"
 
 #include "glx_config.h"
 #include "glx_context.h"
@@ -67,7 +68,7 @@ glx_context_destroy(struct wcore_context *wc_self)
         wrapped_glXDestroyContext(platform, dpy->x11.xlib, self->glx);
 
     ok &= wcore_context_teardown(wc_self);
-    free(self);
+    wcore_display_free_object(self);
     return ok;
 }
 
@@ -172,6 +173,7 @@ glx_context_create_native(struct glx_config *config,
     GLXContext real_share_ctx = share_ctx ? share_ctx->glx : NULL;
     struct glx_display *dpy = glx_display(config->wcore.display);
     struct glx_platform *platform = glx_platform(dpy->wcore.platform);
+    uint64_t t0;
 
     if (dpy->ARB_create_context) {
         bool ok;
@@ -183,12 +185,16 @@ glx_context_create_native(struct glx_config *config,
         if (!ok)
             return NULL;
 
+        t0 = wcore_trace_native_begin("glXCreateContextAttribsARB",
+                                      dpy->x11.xlib);
         ctx = wrapped_glXCreateContextAttribsARB(platform,
                                                  dpy->x11.xlib,
                                                  config->glx_fbconfig,
                                                  real_share_ctx,
                                                  true /*direct?*/,
                                                  attrib_list);
+        wcore_trace_native_end("glXCreateContextAttribsARB",
+                               dpy->x11.xlib, t0);
         if (!ctx) {
             wcore_errorf(WAFFLE_ERROR_UNKNOWN,
                          "glXCreateContextAttribsARB failed");
@@ -196,12 +202,15 @@ glx_context_create_native(struct glx_config *config,
         }
     }
     else {
+        t0 = wcore_trace_native_begin("glXCreateNewContext",
+                                      dpy->x11.xlib);
         ctx = wrapped_glXCreateNewContext(platform,
                                           dpy->x11.xlib,
                                           config->glx_fbconfig,
                                           GLX_RGBA_TYPE,
                                           real_share_ctx,
                                           true /*direct?*/);
+        wcore_trace_native_end("glXCreateNewContext", dpy->x11.xlib, t0);
         if (!ctx) {
             wcore_errorf(WAFFLE_ERROR_UNKNOWN, "glXCreateContext failed");
             return NULL;
@@ -221,7 +230,8 @@ glx_context_create(struct wcore_platform *wc_plat,
     struct glx_context *share_ctx = glx_context(wc_share_ctx);
     bool ok = true;
 
-    self = wcore_calloc(sizeof(*self));
+    self = wcore_display_alloc_object(wc_config->display, WCORE_OBJECT_CONTEXT,
+                                      sizeof(*self));
     if (self == NULL)
         return NULL;
 
@@ -23,10 +23,13 @@
 // OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
 // OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
 
+#include <inttypes.h>
+#include <stdio.h>
 #include <stdlib.h>
 
 #include "wcore_error.h"
 
+#include "linux_driver_id.h"
 #include "linux_platform.h"
 
 #include "glx_display.h"
@@ -61,10 +64,13 @@ glx_display_set_extensions(struct glx_display *self)
         return false;
     }
 
-    self->ARB_create_context                     = waffle_is_extension_in_string(s, "GLX_ARB_create_context");
-    self->ARB_create_context_profile             = waffle_is_extension_in_string(s, "GLX_ARB_create_context_profile");
-    self->ARB_create_context_robustness          = waffle_is_extension_in_string(s, "GLX_ARB_create_context_robustness");
-    self->EXT_create_context_es_profile          = waffle_is_extension_in_string(s, "GLX_EXT_create_context_es_profile");
+    if (!wcore_ext_set_init(&self->wcore.extensions, s))
+        return false;
+
+    self->ARB_create_context                     = wcore_ext_set_has(&self->wcore.extensions, "GLX_ARB_create_context");
+    self->ARB_create_context_profile             = wcore_ext_set_has(&self->wcore.extensions, "GLX_ARB_create_context_profile");
+    self->ARB_create_context_robustness          = wcore_ext_set_has(&self->wcore.extensions, "GLX_ARB_create_context_robustness");
+    self->EXT_create_context_es_profile          = wcore_ext_set_has(&self->wcore.extensions, "GLX_EXT_create_context_es_profile");
 
     // The GLX_EXT_create_context_es2_profile spec, version 4 2012/03/28,
     // states that GLX_EXT_create_context_es_profile is an alias of
@@ -77,7 +83,7 @@ glx_display_set_extensions(struct glx_display *self)
     else {
         // Assume that GLX does not implement version 3 of the extension, in
         // which case the ES contexts GLX is capable of creating is ES2.
-        self->EXT_create_context_es2_profile = waffle_is_extension_in_string(s, "GLX_EXT_create_context_es2_profile");
+        self->EXT_create_context_es2_profile = wcore_ext_set_has(&self->wcore.extensions, "GLX_EXT_create_context_es2_profile");
     }
 
     return true;
@@ -98,7 +104,7 @@ glx_display_connect(struct wcore_platform *wc_plat,
     if (!ok)
         goto error;
 
-    ok = x11_display_init(&self->x11, name);
+    ok = x11_display_init(&self->x11, name, &self->wcore.round_trips);
     if (!ok)
         goto error;
 
@@ -149,3 +155,46 @@ glx_display_get_native(struct wcore_display *wc_self)
 
     return n_dpy;
 }
+
+bool
+glx_display_get_driver_id(struct wcore_display *wc_self,
+                          char *buf,
+                          size_t size)
+{
+    struct glx_display *self = glx_display(wc_self);
+    struct glx_platform *platform = glx_platform(wc_self->platform);
+    const char *server_vendor, *server_version;
+    const char *client_vendor, *client_version;
+    int len;
+
+    server_vendor = wrapped_glXQueryServerString(platform, self->x11.xlib,
+                                                 self->x11.screen,
+                                                 GLX_VENDOR);
+    server_version = wrapped_glXQueryServerString(platform, self->x11.xlib,
+                                                  self->x11.screen,
+                                                  GLX_VERSION);
+    client_vendor = wrapped_glXGetClientString(platform, self->x11.xlib,
+                                               GLX_VENDOR);
+    client_version = wrapped_glXGetClientString(platform, self->x11.xlib,
+                                                GLX_VERSION);
+    if (!server_vendor || !server_version || !client_vendor || !client_version)
+        return false;
+
+    len = snprintf(buf, size, "server=%s %s client=%s %s build=%016" PRIx64,
+                   server_vendor, server_version,
+                   client_vendor, client_version,
+                   linux_driver_build_hash());
+    return len > 0 && (size_t) len < size;
+}
+
+void
+glx_display_begin_teardown(struct wcore_display *wc_self)
+{
+    x11_display_begin_teardown(&glx_display(wc_self)->x11);
+}
+
+bool
+glx_display_end_teardown(struct wcore_display *wc_self)
+{
+    return x11_display_end_teardown(&glx_display(wc_self)->x11);
+}
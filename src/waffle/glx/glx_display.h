@@ -26,6 +26,7 @@
 #pragma once
 
 #include <stdbool.h>
+#include <stddef.h>
 #include <stdint.h>
 
 #include <GL/glx.h>
@@ -69,3 +70,14 @@ glx_display_supports_context_api(struct wcore_display *wc_self,
 
 union waffle_native_display*
 glx_display_get_native(struct wcore_display *wc_self);
+
+bool
+glx_display_get_driver_id(struct wcore_display *wc_self,
+                          char *buf,
+                          size_t size);
+
+void
+glx_display_begin_teardown(struct wcore_display *wc_self);
+
+bool
+glx_display_end_teardown(struct wcore_display *wc_self);
@@ -27,6 +27,7 @@
 #include <dlfcn.h>
 
 #include "wcore_error.h"
+#include "wcore_trace.h"
 
 #include "linux_platform.h"
 
@@ -39,7 +40,7 @@
 
 static const char *libGL_filename = "libGL.so.1";
 
-static const struct wcore_platform_vtbl glx_platform_vtbl;
+WCORE_PLATFORM_VTBL_LINKAGE const struct wcore_platform_vtbl glx_platform_vtbl;
 
 static bool
 glx_platform_destroy(struct wcore_platform *wc_self)
@@ -105,6 +106,8 @@ glx_platform_create(void)
     RETRIEVE_GLX_SYMBOL(glXMakeCurrent);
 
     RETRIEVE_GLX_SYMBOL(glXQueryExtensionsString);
+    RETRIEVE_GLX_SYMBOL(glXQueryServerString);
+    RETRIEVE_GLX_SYMBOL(glXGetClientString);
     RETRIEVE_GLX_SYMBOL(glXGetProcAddress);
 
     RETRIEVE_GLX_SYMBOL(glXGetVisualFromFBConfig);
@@ -138,9 +141,12 @@ glx_platform_make_current(struct wcore_platform *wc_self,
     Display *dpy = glx_display(wc_dpy)->x11.xlib;
     GLXDrawable win = wc_window ? glx_window(wc_window)->x11.xcb : 0;
     GLXContext ctx = wc_ctx ? glx_context(wc_ctx)->glx : NULL;
+    uint64_t t0;
     bool ok;
 
+    t0 = wcore_trace_native_begin("glXMakeCurrent", ctx);
     ok = wrapped_glXMakeCurrent(self, dpy, win, ctx);
+    wcore_trace_native_end("glXMakeCurrent", ctx, t0);
     if (!ok) {
         wcore_errorf(WAFFLE_ERROR_UNKNOWN, "glXMakeCurrent failed");
     }
@@ -174,7 +180,7 @@ glx_platform_dl_sym(struct wcore_platform *wc_self,
                                               name);
 }
 
-static const struct wcore_platform_vtbl glx_platform_vtbl = {
+WCORE_PLATFORM_VTBL_LINKAGE const struct wcore_platform_vtbl glx_platform_vtbl = {
     .destroy = glx_platform_destroy,
 
     .make_current = glx_platform_make_current,
@@ -187,18 +193,27 @@ static const struct wcore_platform_vtbl glx_platform_vtbl = {
         .destroy = glx_display_destroy,
         .supports_context_api = glx_display_supports_context_api,
         .get_native = glx_display_get_native,
+        .native_size = WCORE_NATIVE_UNION_SIZE(union waffle_native_display,
+                                              glx),
+        .get_driver_id = glx_display_get_driver_id,
+        .begin_teardown = glx_display_begin_teardown,
+        .end_teardown = glx_display_end_teardown,
     },
 
     .config = {
         .choose = glx_config_choose,
         .destroy = glx_config_destroy,
         .get_native = glx_config_get_native,
+        .native_size = WCORE_NATIVE_UNION_SIZE(union waffle_native_config,
+                                              glx),
     },
 
     .context = {
         .create = glx_context_create,
         .destroy = glx_context_destroy,
         .get_native = glx_context_get_native,
+        .native_size = WCORE_NATIVE_UNION_SIZE(union waffle_native_context,
+                                              glx),
     },
 
     .window = {
@@ -208,5 +223,7 @@ static const struct wcore_platform_vtbl glx_platform_vtbl = {
         .resize = glx_window_resize,
         .swap_buffers = glx_window_swap_buffers,
         .get_native = glx_window_get_native,
+        .native_size = WCORE_NATIVE_UNION_SIZE(union waffle_native_window,
+                                              glx),
     },
 };
@@ -29,6 +29,7 @@
 
 #include "wcore_attrib_list.h"
 #include "wcore_error.h"
+#include "wcore_trace.h"
 
 #include "glx_config.h"
 #include "glx_display.h"
@@ -46,7 +47,7 @@ glx_window_destroy(struct wcore_window *wc_self)
 
     ok &= x11_window_teardown(&self->x11);
     ok &= wcore_window_teardown(wc_self);
-    free(self);
+    wcore_display_free_object(self);
     return ok;
 }
 
@@ -72,7 +73,8 @@ glx_window_create(struct wcore_platform *wc_plat,
         return NULL;
     }
 
-    self = wcore_calloc(sizeof(*self));
+    self = wcore_display_alloc_object(wc_config->display, WCORE_OBJECT_WINDOW,
+                                      sizeof(*self));
     if (self == NULL)
         return NULL;
 
@@ -115,7 +117,12 @@ glx_window_swap_buffers(struct wcore_window *wc_self)
     struct glx_display *dpy = glx_display(wc_self->display);
     struct glx_platform *plat = glx_platform(wc_self->display->platform);
 
+    const void *object = (const void*) (uintptr_t) self->x11.xcb;
+    uint64_t t0;
+
+    t0 = wcore_trace_native_begin("glXSwapBuffers", object);
     wrapped_glXSwapBuffers(plat, dpy->x11.xlib, self->x11.xcb);
+    wcore_trace_native_end("glXSwapBuffers", object, t0);
 
     return true;
 }
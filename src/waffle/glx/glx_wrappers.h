@@ -131,6 +131,26 @@ wrapped_glXQueryExtensionsString(struct glx_platform *platform,
     return s;
 }
 
+static inline const char*
+wrapped_glXQueryServerString(struct glx_platform *platform,
+                             Display *dpy, int screen, int name)
+{
+    X11_SAVE_ERROR_HANDLER
+    const char *s = platform->glXQueryServerString(dpy, screen, name);
+    X11_RESTORE_ERROR_HANDLER
+    return s;
+}
+
+static inline const char*
+wrapped_glXGetClientString(struct glx_platform *platform,
+                           Display *dpy, int name)
+{
+    X11_SAVE_ERROR_HANDLER
+    const char *s = platform->glXGetClientString(dpy, name);
+    X11_RESTORE_ERROR_HANDLER
+    return s;
+}
+
 static inline void
 wrapped_glXSwapBuffers(struct glx_platform *platform,
                        Display *dpy, GLXDrawable drawable)
@@ -0,0 +1,168 @@
+// Copyright 2016 Intel Corporation
+//
+// All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+//
+// - Redistributions of source code must retain the above copyright notice, this
+//   list of conditions and the following disclaimer.
+//
+// - Redistributions in binary form must reproduce the above copyright notice,
+//   this list of conditions and the following disclaimer in the documentation
+//   and/or other materials provided with the distribution.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+// DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+// FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+// DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+// SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+// CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+// OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+// OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+#define _GNU_SOURCE // dl_iterate_phdr()
+
+#include <link.h>
+#include <stdbool.h>
+#include <stddef.h>
+#include <string.h>
+#include <sys/stat.h>
+
+#include "linux_driver_id.h"
+
+#ifndef NT_GNU_BUILD_ID
+#define NT_GNU_BUILD_ID 3
+#endif
+
+/// Prefixes of the file names of the vendor libraries that libglvnd binds,
+/// such as libEGL_mesa.so.0 or libGLX_nvidia.so.0.
+static const char *vendor_prefixes[] = {
+    "libEGL_",
+    "libGLX_",
+};
+
+/// Substrings of the file names of driver modules.
+///
+/// The dispatch libraries, such as libEGL.so, libGLESv2.so, libGLX.so and
+/// libGLdispatch.so, are not drivers. Which of them the process has loaded
+/// depends on what the application happened to open, so hashing them would
+/// change the key between otherwise identical runs.
+static const char *driver_patterns[] = {
+    "_dri.so",
+    "libgallium",
+    "libnvidia-",
+    "libmali",
+};
+
+#define FNV_OFFSET_BASIS 14695981039346656037ull
+
+/// 64-bit FNV-1a, continued from @a h.
+static uint64_t
+hash_bytes(uint64_t h, const void *data, size_t size)
+{
+    const unsigned char *p = data;
+
+    for (size_t i = 0; i < size; ++i) {
+        h ^= p[i];
+        h *= 1099511628211ull;
+    }
+
+    return h;
+}
+
+static bool
+is_driver(const char *path)
+{
+    const size_t num_prefixes = sizeof(vendor_prefixes) /
+                                sizeof(vendor_prefixes[0]);
+    const size_t num_patterns = sizeof(driver_patterns) /
+                                sizeof(driver_patterns[0]);
+    const char *base = strrchr(path, '/');
+
+    base = base ? base + 1 : path;
+
+    for (size_t i = 0; i < num_prefixes; ++i) {
+        if (strncmp(base, vendor_prefixes[i], strlen(vendor_prefixes[i])) == 0)
+            return true;
+    }
+
+    for (size_t i = 0; i < num_patterns; ++i) {
+        if (strstr(base, driver_patterns[i]))
+            return true;
+    }
+
+    return false;
+}
+
+/// Hash the object's build-id note into @a h. Return false if it has none.
+static bool
+hash_build_id(const struct dl_phdr_info *info, uint64_t *h)
+{
+    for (int i = 0; i < info->dlpi_phnum; ++i) {
+        const ElfW(Phdr) *phdr = &info->dlpi_phdr[i];
+        const char *p, *end;
+
+        if (phdr->p_type != PT_NOTE)
+            continue;
+
+        p = (const char*) (info->dlpi_addr + phdr->p_vaddr);
+        end = p + phdr->p_memsz;
+
+        while (p + sizeof(ElfW(Nhdr)) <= end) {
+            const ElfW(Nhdr) *note = (const ElfW(Nhdr)*) p;
+            const char *name = p + sizeof(*note);
+            const char *desc = name + ((note->n_namesz + 3) & ~3u);
+
+            if (desc + note->n_descsz > end)
+                break;
+
+            if (note->n_type == NT_GNU_BUILD_ID && note->n_namesz == 4 &&
+                memcmp(name, "GNU", 4) == 0) {
+                *h = hash_bytes(*h, desc, note->n_descsz);
+                return true;
+            }
+
+            p = desc + ((note->n_descsz + 3) & ~3u);
+        }
+    }
+
+    return false;
+}
+
+/// Add the object's hash to @a data. Adding makes the result independent of
+/// the order in which the application happened to load the libraries.
+static int
+hash_object(struct dl_phdr_info *info, size_t size, void *data)
+{
+    uint64_t *sum = data;
+    uint64_t h = FNV_OFFSET_BASIS;
+    struct stat st;
+
+    (void) size;
+
+    if (!info->dlpi_name || !is_driver(info->dlpi_name))
+        return 0;
+
+    if (!hash_build_id(info, &h)) {
+        h = hash_bytes(h, info->dlpi_name, strlen(info->dlpi_name));
+        if (stat(info->dlpi_name, &st) == 0) {
+            h = hash_bytes(h, &st.st_size, sizeof(st.st_size));
+            h = hash_bytes(h, &st.st_mtime, sizeof(st.st_mtime));
+        }
+    }
+
+    *sum += h;
+    return 0;
+}
+
+uint64_t
+linux_driver_build_hash(void)
+{
+    uint64_t h = 0;
+
+    dl_iterate_phdr(hash_object, &h);
+    return h;
+}
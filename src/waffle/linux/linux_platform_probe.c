@@ -0,0 +1,222 @@
+// Copyright 2016 Intel Corporation
+//
+// All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+//
+// - Redistributions of source code must retain the above copyright notice, this
+//   list of conditions and the following disclaimer.
+//
+// - Redistributions in binary form must reproduce the above copyright notice,
+//   this list of conditions and the following disclaimer in the documentation
+//   and/or other materials provided with the distribution.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+// DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+// FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+// DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+// SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+// CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+// OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+// OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+#define _GNU_SOURCE // memmem(), RTLD_NOLOAD
+
+#include <dirent.h>
+#include <dlfcn.h>
+#include <stdbool.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include <sys/stat.h>
+
+#include "wcore_platform_auto.h"
+
+#include "linux_platform_probe.h"
+
+/// The dynamic linker's cache of installed libraries, read whole.
+struct ld_cache {
+    char *data;
+    size_t size;
+};
+
+static void
+ld_cache_read(struct ld_cache *cache)
+{
+    FILE *f;
+    long size;
+
+    cache->data = NULL;
+    cache->size = 0;
+
+    f = fopen("/etc/ld.so.cache", "rb");
+    if (!f)
+        return;
+
+    if (fseek(f, 0, SEEK_END) != 0 || (size = ftell(f)) <= 0 ||
+        fseek(f, 0, SEEK_SET) != 0)
+        goto done;
+
+    cache->data = malloc(size);
+    if (!cache->data)
+        goto done;
+
+    if (fread(cache->data, 1, size, f) != (size_t) size) {
+        free(cache->data);
+        cache->data = NULL;
+        goto done;
+    }
+
+    cache->size = size;
+
+done:
+    fclose(f);
+}
+
+static bool
+is_socket(const char *path)
+{
+    struct stat st;
+    return stat(path, &st) == 0 && S_ISSOCK(st.st_mode);
+}
+
+/// Check whether dlopen() would find library @a name, without loading it.
+///
+/// If the answer is unknown, assume it would. Creating the platform then
+/// fails and the next candidate is tried.
+static bool
+library_is_present(const char *name, const struct ld_cache *cache)
+{
+    const char *ld_path = getenv("LD_LIBRARY_PATH");
+    void *handle;
+
+    handle = dlopen(name, RTLD_LAZY | RTLD_NOLOAD);
+    if (handle) {
+        dlclose(handle);
+        return true;
+    }
+
+    while (ld_path && *ld_path) {
+        const char *end = strchr(ld_path, ':');
+        size_t len = end ? (size_t) (end - ld_path) : strlen(ld_path);
+        char path[4096];
+
+        if (len > 0 && len < sizeof(path) - strlen(name) - 2) {
+            snprintf(path, sizeof(path), "%.*s/%s", (int) len, ld_path, name);
+            if (access(path, R_OK) == 0)
+                return true;
+        }
+
+        ld_path = end ? end + 1 : NULL;
+    }
+
+    if (!cache->data)
+        return true;
+
+    // The cache's string table holds each library's name and full path,
+    // both null-terminated.
+    return memmem(cache->data, cache->size, name, strlen(name) + 1) != NULL;
+}
+
+static bool
+probe_wayland_socket(void)
+{
+    const char *name = getenv("WAYLAND_DISPLAY");
+    const char *dir = getenv("XDG_RUNTIME_DIR");
+    char path[4096];
+
+    // The compositor passed a connected socket.
+    if (getenv("WAYLAND_SOCKET"))
+        return true;
+
+    if (!name)
+        name = "wayland-0";
+
+    if (name[0] == '/')
+        return is_socket(name);
+
+    if (!dir)
+        return false;
+
+    snprintf(path, sizeof(path), "%s/%s", dir, name);
+    return is_socket(path);
+}
+
+static bool
+probe_x11_display(void)
+{
+    const char *display = getenv("DISPLAY");
+    const char *colon;
+    char path[64];
+    int number;
+
+    if (!display || !display[0])
+        return false;
+
+    // A socket path, as used by XQuartz.
+    if (display[0] == '/')
+        return is_socket(display);
+
+    colon = strrchr(display, ':');
+    if (!colon || sscanf(colon + 1, "%d", &number) != 1)
+        return false;
+
+    // A remote display cannot be checked without connecting to it.
+    if (colon != display && strncmp(display, "unix:", 5) != 0)
+        return true;
+
+    snprintf(path, sizeof(path), "/tmp/.X11-unix/X%d", number);
+    return is_socket(path);
+}
+
+/// Mirror the devices that wgbm_display_connect() would try.
+static bool
+probe_drm_device(void)
+{
+    const char *name = getenv("WAFFLE_GBM_DEVICE");
+    struct dirent *entry;
+    bool found = false;
+    DIR *dir;
+
+    if (name)
+        return access(name, R_OK | W_OK) == 0;
+
+    dir = opendir("/dev/dri");
+    if (!dir)
+        return false;
+
+    while (!found && (entry = readdir(dir))) {
+        char path[300];
+
+        if (strncmp(entry->d_name, "renderD", 7) != 0 &&
+            strncmp(entry->d_name, "card", 4) != 0)
+            continue;
+
+        snprintf(path, sizeof(path), "/dev/dri/%s", entry->d_name);
+        found = access(path, R_OK | W_OK) == 0;
+    }
+
+    closedir(dir);
+    return found;
+}
+
+void
+linux_platform_probe(struct wcore_platform_probe *probe)
+{
+    struct ld_cache cache;
+
+    probe->wayland_socket = probe_wayland_socket();
+    probe->x11_display = probe_x11_display();
+    probe->drm_device = probe_drm_device();
+
+    ld_cache_read(&cache);
+    probe->lib_egl = library_is_present("libEGL.so.1", &cache);
+    probe->lib_gl = library_is_present("libGL.so.1", &cache);
+    probe->lib_gbm = library_is_present("libgbm.so.1", &cache);
+    probe->lib_wayland_egl = library_is_present("libwayland-egl.so.1", &cache);
+    free(cache.data);
+}
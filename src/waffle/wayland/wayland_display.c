@@ -35,6 +35,9 @@
 
 #include "wcore_error.h"
 #include "wcore_display.h"
+#include "wcore_frame_stats.h"
+#include "wcore_probe.h"
+#include "wcore_trace.h"
 
 #include "wegl_display.h"
 
@@ -55,6 +58,7 @@ wayland_display_destroy(struct wcore_display *wc_self)
     if (self->wl_display)
         wl_display_disconnect(self->wl_display);
 
+    mtx_destroy(&self->mutex);
     free(self);
     return ok;
 }
@@ -98,10 +102,15 @@ wayland_display_connect(struct wcore_platform *wc_plat,
     bool ok = true;
     int error = 0;
 
+    if (!wegl_platform_load(wegl_platform(wc_plat)))
+        return NULL;
+
     self = wcore_calloc(sizeof(*self));
     if (self == NULL)
         return NULL;
 
+    mtx_init(&self->mutex, mtx_plain);
+
     self->wl_display = wl_display_connect(name);
     if (!self->wl_display) {
         wcore_errorf(WAFFLE_ERROR_UNKNOWN, "wl_display_connect failed");
@@ -181,7 +190,23 @@ wayland_display_get_native(struct wcore_display *wc_self)
 bool
 wayland_display_sync(struct wayland_display *dpy)
 {
-    if (wl_display_roundtrip(dpy->wl_display) == -1) {
+    uint64_t blocked = wcore_frame_stats_block_begin();
+    uint64_t round_trip;
+    uint64_t t0;
+    int ret;
+
+    mtx_lock(&dpy->mutex);
+    WCORE_PROBE(wayland_round_trip_entry, dpy->wl_display);
+    t0 = wcore_trace_native_begin("wl_display_roundtrip", dpy->wl_display);
+    round_trip = wcore_round_trip_begin();
+    ret = wl_display_roundtrip(dpy->wl_display);
+    wcore_round_trip_end(&dpy->wegl.wcore.round_trips, round_trip);
+    wcore_trace_native_end("wl_display_roundtrip", dpy->wl_display, t0);
+    WCORE_PROBE(wayland_round_trip_return, dpy->wl_display, ret);
+    mtx_unlock(&dpy->mutex);
+    wcore_frame_stats_block_end(blocked);
+
+    if (ret == -1) {
         wcore_error_errno("error on wl_display");
         return false;
     }
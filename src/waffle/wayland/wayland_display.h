@@ -28,6 +28,8 @@
 #include <stdbool.h>
 #include <stdint.h>
 
+#include "threads.h"
+
 #include "wcore_display.h"
 #include "wcore_util.h"
 
@@ -46,6 +48,12 @@ struct wayland_display {
     struct wl_compositor *wl_compositor;
     struct wl_shell *wl_shell;
 
+    /// @brief Serializes wayland_display_sync().
+    ///
+    /// wl_display_roundtrip() dispatches the default event queue, which must
+    /// not be dispatched from several threads at once.
+    mtx_t mutex;
+
     struct wegl_display wegl;
 };
 
@@ -24,13 +24,13 @@
 // OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
 
 #define WL_EGL_PLATFORM 1
-#define _POSIX_C_SOURCE 200112 // glib feature macro for unsetenv()
 
 #include <stdlib.h>
 #include <dlfcn.h>
 
 #include "waffle_wayland.h"
 
+#include "wcore_env.h"
 #include "wcore_error.h"
 
 #include "linux_platform.h"
@@ -47,7 +47,7 @@
 
 static const char *libwl_egl_filename = "libwayland-egl.so.1";
 
-static const struct wcore_platform_vtbl wayland_platform_vtbl;
+WCORE_PLATFORM_VTBL_LINKAGE const struct wcore_platform_vtbl wayland_platform_vtbl;
 
 static bool
 wayland_platform_destroy(struct wcore_platform *wc_self)
@@ -59,7 +59,10 @@ wayland_platform_destroy(struct wcore_platform *wc_self)
     if (!self)
         return true;
 
-    unsetenv("EGL_PLATFORM");
+    wegl_platform_wait_prefetch(&self->wegl);
+
+    if (self->set_egl_platform_env)
+        wcore_env_release("EGL_PLATFORM");
 
     if (self->linux)
         ok &= linux_platform_destroy(self->linux);
@@ -80,30 +83,19 @@ wayland_platform_destroy(struct wcore_platform *wc_self)
     return ok;
 }
 
-struct wcore_platform*
-wayland_platform_create(void)
+static bool
+wayland_platform_load_native(struct wegl_platform *wegl)
 {
-    struct wayland_platform *self;
-    bool ok = true;
+    struct wayland_platform *self = wayland_platform(wegl);
 
-    self = wcore_calloc(sizeof(*self));
-    if (self == NULL)
-        return NULL;
-
-    ok = wegl_platform_init(&self->wegl);
-    if (!ok)
-        goto error;
-
-    ok = wayland_wrapper_init();
-    if (!ok)
-        goto error;
-
-    self->dl_wl_egl = dlopen(libwl_egl_filename, RTLD_LAZY | RTLD_LOCAL);
     if (!self->dl_wl_egl) {
-        wcore_errorf(WAFFLE_ERROR_FATAL,
-                     "dlopen(\"%s\") failed: %s",
-                     libwl_egl_filename, dlerror());
-        goto error;
+        self->dl_wl_egl = dlopen(libwl_egl_filename, RTLD_LAZY | RTLD_LOCAL);
+        if (!self->dl_wl_egl) {
+            wcore_errorf(WAFFLE_ERROR_FATAL,
+                         "dlopen(\"%s\") failed: %s",
+                         libwl_egl_filename, dlerror());
+            return false;
+        }
     }
 
 #define RETRIEVE_WL_EGL_SYMBOL(function)                                  \
@@ -112,7 +104,7 @@ wayland_platform_create(void)
         wcore_errorf(WAFFLE_ERROR_FATAL,                             \
                      "dlsym(\"%s\", \"" #function "\") failed: %s",    \
                      libwl_egl_filename, dlerror());                      \
-        goto error;                                                    \
+        return false;                                                  \
     }
 
     RETRIEVE_WL_EGL_SYMBOL(wl_egl_window_create);
@@ -121,12 +113,45 @@ wayland_platform_create(void)
 
 #undef RETRIEVE_WL_EGL_SYMBOL
 
+    return true;
+}
+
+struct wcore_platform*
+wayland_platform_create(int32_t fast_start)
+{
+    struct wayland_platform *self;
+    bool ok = true;
+
+    self = wcore_calloc(sizeof(*self));
+    if (self == NULL)
+        return NULL;
+
+    // Initialize the wrapper first so that wayland_platform_destroy() never
+    // drops a reference that this platform did not take.
+    ok = wayland_wrapper_init();
+    if (!ok) {
+        free(self);
+        return NULL;
+    }
+
+    self->wegl.load_native = wayland_platform_load_native;
+
+    // Libraries loaded later, by the prefetch thread or on first use, must
+    // not change the environment. See wegl_platform_init().
+    if (fast_start != WAFFLE_NONE)
+        self->set_egl_platform_env = wcore_env_hold("EGL_PLATFORM", "wayland");
+
+    ok = wegl_platform_init(&self->wegl, EGL_PLATFORM_WAYLAND_EXT, fast_start);
+    if (!ok)
+        goto error;
+
+    if (!self->wegl.eglGetPlatformDisplayEXT && !self->set_egl_platform_env)
+        self->set_egl_platform_env = wcore_env_hold("EGL_PLATFORM", "wayland");
+
     self->linux = linux_platform_create();
     if (!self->linux)
         goto error;
 
-    setenv("EGL_PLATFORM", "wayland", true);
-
     self->wegl.wcore.vtbl = &wayland_platform_vtbl;
     return &self->wegl.wcore;
 
@@ -186,31 +211,40 @@ wayland_context_get_native(struct wcore_context *wc_ctx)
     return n_ctx;
 }
 
-static const struct wcore_platform_vtbl wayland_platform_vtbl = {
+WCORE_PLATFORM_VTBL_LINKAGE const struct wcore_platform_vtbl wayland_platform_vtbl = {
     .destroy = wayland_platform_destroy,
 
     .make_current = wegl_make_current,
     .get_proc_address = wegl_get_proc_address,
     .dl_can_open = wayland_dl_can_open,
     .dl_sym = wayland_dl_sym,
+    .load = wegl_load,
 
     .display = {
         .connect = wayland_display_connect,
         .destroy = wayland_display_destroy,
         .supports_context_api = wegl_display_supports_context_api,
         .get_native = wayland_display_get_native,
+        .native_size = WCORE_NATIVE_UNION_SIZE(union waffle_native_display,
+                                              wayland),
+        .get_driver_id = wegl_display_get_driver_id,
     },
 
     .config = {
         .choose = wegl_config_choose,
         .destroy = wegl_config_destroy,
         .get_native = wayland_config_get_native,
+        .native_size = WCORE_NATIVE_UNION_SIZE(union waffle_native_config,
+                                              wayland),
     },
 
     .context = {
         .create = wegl_context_create,
         .destroy = wegl_context_destroy,
         .get_native = wayland_context_get_native,
+        .native_size = WCORE_NATIVE_UNION_SIZE(union waffle_native_context,
+                                              wayland),
+        .create_many = wegl_context_create_many,
     },
 
     .window = {
@@ -220,5 +254,8 @@ static const struct wcore_platform_vtbl wayland_platform_vtbl = {
         .swap_buffers = wayland_window_swap_buffers,
         .resize = wayland_window_resize,
         .get_native = wayland_window_get_native,
+        .native_size = WCORE_NATIVE_UNION_SIZE(union waffle_native_window,
+                                              wayland),
+        .swap_buffers_many = wayland_window_swap_buffers_many,
     },
 };
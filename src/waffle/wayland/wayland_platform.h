@@ -43,6 +43,9 @@ struct wayland_platform {
     struct wegl_platform wegl;
     struct linux_platform *linux;
 
+    /// True if this platform holds EGL_PLATFORM. See wcore_env_hold().
+    bool set_egl_platform_env;
+
 
     void *dl_wl_egl;
 
@@ -66,4 +69,4 @@ DEFINE_CONTAINER_CAST_FUNC(wayland_platform,
                            wegl)
 
 struct wcore_platform*
-wayland_platform_create(void);
+wayland_platform_create(int32_t fast_start);
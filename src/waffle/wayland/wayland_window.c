@@ -66,7 +66,7 @@ wayland_window_destroy(struct wcore_window *wc_self)
     if (self->wl_surface)
         wl_surface_destroy(self->wl_surface);
 
-    free(self);
+    wcore_display_free_object(self);
     return ok;
 }
 
@@ -122,7 +122,8 @@ wayland_window_create(struct wcore_platform *wc_plat,
         return NULL;
     }
 
-    self = wcore_calloc(sizeof(*self));
+    self = wcore_display_alloc_object(wc_config->display, WCORE_OBJECT_WINDOW,
+                                      sizeof(*self));
     if (self == NULL)
         return NULL;
 
@@ -211,6 +212,39 @@ wayland_window_swap_buffers(struct wcore_window *wc_self)
     return true;
 }
 
+bool
+wayland_window_swap_buffers_many(struct wcore_window *windows[],
+                                 int32_t count,
+                                 bool results[])
+{
+    struct wayland_display *dpy = wayland_display(windows[0]->display);
+    struct wcore_error_saved error = {0};
+    bool ok = true;
+
+    for (int32_t i = 0; i < count; ++i) {
+        results[i] = wegl_window_swap_buffers(windows[i]);
+        if (!results[i]) {
+            wcore_error_save(&error);
+            ok = false;
+        }
+    }
+
+    // One round trip for the whole batch. If a swap failed, its error, the
+    // first, is the one reported.
+    if (!wayland_display_sync(dpy)) {
+        for (int32_t i = 0; i < count; ++i)
+            results[i] = false;
+        if (!ok)
+            wcore_error_restore(&error);
+        return false;
+    }
+
+    if (!ok)
+        wcore_error_restore(&error);
+
+    return ok;
+}
+
 bool
 wayland_window_resize(struct wcore_window *wc_self,
                       int32_t width, int32_t height)
@@ -72,6 +72,11 @@ wayland_window_show(struct wcore_window *wc_self);
 bool
 wayland_window_swap_buffers(struct wcore_window *wc_self);
 
+bool
+wayland_window_swap_buffers_many(struct wcore_window *windows[],
+                                 int32_t count,
+                                 bool results[]);
+
 bool
 wayland_window_resize(struct wcore_window *wc_self,
                       int32_t width, int32_t height);
@@ -41,6 +41,8 @@
 #include <stdbool.h>
 #include <dlfcn.h>
 
+#include "threads.h"
+
 #include "wcore_error.h"
 
 #include "wayland_wrapper.h"
@@ -48,10 +50,25 @@
 // dlopen handle for libwayland-client.so.0
 static void *dl_wl_client;
 
+// The wrappers are process-global, but each wayland platform instance calls
+// wayland_wrapper_init(). Only the last teardown closes the library.
+static int dl_wl_client_refcount;
+
+// Protects dl_wl_client and dl_wl_client_refcount, because instances may be
+// created and destroyed concurrently.
+static once_flag dl_wl_client_once = ONCE_FLAG_INIT;
+static mtx_t dl_wl_client_mutex;
+
+static void
+wayland_wrapper_init_once(void)
+{
+    mtx_init(&dl_wl_client_mutex, mtx_plain);
+}
+
 static const char *libwl_client_filename = "libwayland-client.so.0";
 
-bool
-wayland_wrapper_teardown(void)
+static bool
+wayland_wrapper_unload(void)
 {
     bool ok = true;
     int error;
@@ -64,13 +81,27 @@ wayland_wrapper_teardown(void)
                          "dlclose(\"%s\") failed: %s",
                          libwl_client_filename, dlerror());
         }
+        dl_wl_client = NULL;
     }
 
     return ok;
 }
 
 bool
-wayland_wrapper_init(void)
+wayland_wrapper_teardown(void)
+{
+    bool ok = true;
+
+    mtx_lock(&dl_wl_client_mutex);
+    if (dl_wl_client_refcount > 0 && --dl_wl_client_refcount == 0)
+        ok = wayland_wrapper_unload();
+    mtx_unlock(&dl_wl_client_mutex);
+
+    return ok;
+}
+
+static bool
+wayland_wrapper_load(void)
 {
     bool ok = true;
 
@@ -109,7 +140,27 @@ wayland_wrapper_init(void)
 #undef RETRIEVE_WL_CLIENT_SYMBOL
 
 error:
-    // On failure the caller of wayland_wrapper_init will trigger it's own
-    // destruction which will execute wayland_wrapper_teardown.
+    return ok;
+}
+
+/// On failure, no reference is taken and wayland_wrapper_teardown() must not
+/// be called.
+bool
+wayland_wrapper_init(void)
+{
+    bool ok = true;
+
+    call_once(&dl_wl_client_once, wayland_wrapper_init_once);
+
+    mtx_lock(&dl_wl_client_mutex);
+    if (dl_wl_client_refcount == 0) {
+        ok = wayland_wrapper_load();
+        if (!ok)
+            wayland_wrapper_unload();
+    }
+    if (ok)
+        ++dl_wl_client_refcount;
+    mtx_unlock(&dl_wl_client_mutex);
+
     return ok;
 }
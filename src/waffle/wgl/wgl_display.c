@@ -151,10 +151,13 @@ wgl_display_set_extensions(struct wgl_display *dpy)
         return false;
     }
 
-    dpy->ARB_create_context                     = waffle_is_extension_in_string(extensions, "WGL_ARB_create_context");
-    dpy->ARB_create_context_profile             = waffle_is_extension_in_string(extensions, "WGL_ARB_create_context_profile");
-    dpy->ARB_create_context_robustness          = waffle_is_extension_in_string(extensions, "WGL_ARB_create_context_robustness");
-    dpy->EXT_create_context_es_profile          = waffle_is_extension_in_string(extensions, "WGL_EXT_create_context_es_profile");
+    if (!wcore_ext_set_init(&dpy->wcore.extensions, extensions))
+        return false;
+
+    dpy->ARB_create_context                     = wcore_ext_set_has(&dpy->wcore.extensions, "WGL_ARB_create_context");
+    dpy->ARB_create_context_profile             = wcore_ext_set_has(&dpy->wcore.extensions, "WGL_ARB_create_context_profile");
+    dpy->ARB_create_context_robustness          = wcore_ext_set_has(&dpy->wcore.extensions, "WGL_ARB_create_context_robustness");
+    dpy->EXT_create_context_es_profile          = wcore_ext_set_has(&dpy->wcore.extensions, "WGL_EXT_create_context_es_profile");
 
     // The WGL_EXT_create_context_es2_profile spec, version 5 2012/04/06,
     // states that WGL_EXT_create_context_es_profile is an alias of
@@ -167,10 +170,10 @@ wgl_display_set_extensions(struct wgl_display *dpy)
     else {
         // Assume that WGL does not implement version 3 of the extension, in
         // which case the ES contexts WGL is capable of creating is ES2.
-        dpy->EXT_create_context_es2_profile = waffle_is_extension_in_string(extensions, "WGL_EXT_create_context_es2_profile");
+        dpy->EXT_create_context_es2_profile = wcore_ext_set_has(&dpy->wcore.extensions, "WGL_EXT_create_context_es2_profile");
     }
 
-    dpy->ARB_pixel_format = waffle_is_extension_in_string(extensions, "WGL_ARB_pixel_format");
+    dpy->ARB_pixel_format = wcore_ext_set_has(&dpy->wcore.extensions, "WGL_ARB_pixel_format");
 
     return true;
 }
@@ -25,15 +25,32 @@
 
 #include <assert.h>
 
+#include "threads.h"
+
 #include "wcore_error.h"
 
 #include "x11_display.h"
 #include "x11_wrappers.h"
 
+static once_flag x11_init_threads_once = ONCE_FLAG_INIT;
+
+static void
+x11_init_threads(void)
+{
+    // Xlib is thread-safe only if XInitThreads() is called before any other
+    // Xlib call that opens a display. Without it, concurrent use of two
+    // different Displays can still corrupt Xlib's global state.
+    XInitThreads();
+}
+
 bool
-x11_display_init(struct x11_display *self, const char *name)
+x11_display_init(struct x11_display *self, const char *name,
+                 struct wcore_round_trips *round_trips)
 {
     assert(self);
+    assert(round_trips);
+
+    call_once(&x11_init_threads_once, x11_init_threads);
 
     self->xlib = wrapped_XOpenDisplay(name);
     if (!self->xlib) {
@@ -49,6 +66,7 @@ x11_display_init(struct x11_display *self, const char *name)
     }
 
     self->screen = DefaultScreen(self->xlib);
+    self->round_trips = round_trips;
 
     return true;
 }
@@ -69,3 +87,22 @@ x11_display_teardown(struct x11_display *self)
 
     return !error;
 }
+
+void
+x11_display_begin_teardown(struct x11_display *self)
+{
+    self->in_bulk_teardown = true;
+}
+
+bool
+x11_display_end_teardown(struct x11_display *self)
+{
+    self->in_bulk_teardown = false;
+
+    if (xcb_flush(self->xcb) <= 0) {
+        wcore_errorf(WAFFLE_ERROR_UNKNOWN, "xcb_flush() failed");
+        return false;
+    }
+
+    return true;
+}
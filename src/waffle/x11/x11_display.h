@@ -29,14 +29,30 @@
 
 #include <X11/Xlib-xcb.h>
 
+struct wcore_round_trips;
+
 struct x11_display {
     Display *xlib;
     xcb_connection_t *xcb;
     int screen;
+
+    /// @brief Counters of the wcore_display that owns the connection.
+    struct wcore_round_trips *round_trips;
+
+    /// @brief If set, x11_window_teardown() issues unchecked requests and
+    /// defers the flush to x11_display_end_teardown().
+    bool in_bulk_teardown;
 };
 
 bool
-x11_display_init(struct x11_display *self, const char *name);
+x11_display_init(struct x11_display *self, const char *name,
+                 struct wcore_round_trips *round_trips);
 
 bool
 x11_display_teardown(struct x11_display *self);
+
+void
+x11_display_begin_teardown(struct x11_display *self);
+
+bool
+x11_display_end_teardown(struct x11_display *self);
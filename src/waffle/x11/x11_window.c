@@ -25,11 +25,30 @@
 
 #include <assert.h>
 
+#include "wcore_display.h"
 #include "wcore_error.h"
+#include "wcore_probe.h"
 
 #include "x11_display.h"
 #include "x11_window.h"
 
+/// Wait for the reply to a checked request: a round trip to the server.
+static xcb_generic_error_t*
+x11_window_request_check(struct x11_display *dpy, xcb_void_cookie_t cookie)
+{
+    xcb_generic_error_t *error;
+    uint64_t t0;
+
+    WCORE_PROBE(x11_round_trip_entry, dpy->xcb, cookie.sequence);
+    t0 = wcore_round_trip_begin();
+    error = xcb_request_check(dpy->xcb, cookie);
+    wcore_round_trip_end(dpy->round_trips, t0);
+    WCORE_PROBE(x11_round_trip_return, dpy->xcb,
+                error ? error->error_code : 0);
+
+    return error;
+}
+
 static uint8_t
 x11_winddow_get_depth(xcb_connection_t *conn,
                       const xcb_screen_t *screen,
@@ -140,14 +159,14 @@ x11_window_init(struct x11_window *self,
 
     // Check errors.
     xcb_generic_error_t *error;
-    error = xcb_request_check(conn, colormap_cookie);
+    error = x11_window_request_check(dpy, colormap_cookie);
     if (error) {
         wcore_errorf(WAFFLE_ERROR_UNKNOWN,
                      "xcb_create_colormap() failed on visual_id=0x%x with "
                      "error=0x%x\n", visual_id, error->error_code);
         goto error;
     }
-    error = xcb_request_check(conn, create_cookie);
+    error = x11_window_request_check(dpy, create_cookie);
     if (error) {
         wcore_errorf(WAFFLE_ERROR_UNKNOWN,
                      "xcb_create_window_checked() failed: error=0x%x",
@@ -183,8 +202,14 @@ x11_window_teardown(struct x11_window *self)
     if (!self->xcb)
         return true;
 
+    // Avoid a round trip per window. Errors are dropped.
+    if (self->display->in_bulk_teardown) {
+        xcb_destroy_window(self->display->xcb, self->xcb);
+        return true;
+    }
+
     cookie = xcb_destroy_window_checked(self->display->xcb, self->xcb);
-    error = xcb_request_check(self->display->xcb, cookie);
+    error = x11_window_request_check(self->display, cookie);
 
     if (error) {
         wcore_errorf(WAFFLE_ERROR_UNKNOWN,
@@ -204,7 +229,7 @@ x11_window_show(struct x11_window *self)
     assert(self);
 
     cookie = xcb_map_window_checked(self->display->xcb, self->xcb);
-    error = xcb_request_check(self->display->xcb, cookie);
+    error = x11_window_request_check(self->display, cookie);
 
     if (error) {
         wcore_errorf(WAFFLE_ERROR_UNKNOWN,
@@ -226,7 +251,7 @@ x11_window_resize(struct x11_window *self, int32_t width, int32_t height)
         XCB_CONFIG_WINDOW_WIDTH | XCB_CONFIG_WINDOW_HEIGHT,
         (uint32_t[]){width, height});
 
-    error = xcb_request_check(self->display->xcb, cookie);
+    error = x11_window_request_check(self->display, cookie);
     if (error) {
         wcore_errorf(WAFFLE_ERROR_UNKNOWN,
                      "xcb_configure_window() failed to resize width, "
@@ -0,0 +1,61 @@
+// Copyright 2016 Intel Corporation
+//
+// All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+//
+// - Redistributions of source code must retain the above copyright notice, this
+//   list of conditions and the following disclaimer.
+//
+// - Redistributions in binary form must reproduce the above copyright notice,
+//   this list of conditions and the following disclaimer in the documentation
+//   and/or other materials provided with the distribution.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+// DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+// FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+// DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+// SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+// CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+// OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+// OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+#include "threads.h"
+
+#include "x11_wrappers.h"
+
+static once_flag x11_error_handler_once = ONCE_FLAG_INIT;
+static mtx_t x11_error_handler_mutex;
+
+// Protected by x11_error_handler_mutex.
+static int x11_error_handler_depth;
+static int (*x11_error_handler_saved)(Display*, XErrorEvent*);
+
+static void
+x11_error_handler_init_once(void)
+{
+    mtx_init(&x11_error_handler_mutex, mtx_plain);
+}
+
+void
+x11_error_handler_push(void)
+{
+    call_once(&x11_error_handler_once, x11_error_handler_init_once);
+
+    mtx_lock(&x11_error_handler_mutex);
+    if (x11_error_handler_depth++ == 0)
+        x11_error_handler_saved = XSetErrorHandler(x11_dummy_error_handler);
+    mtx_unlock(&x11_error_handler_mutex);
+}
+
+void
+x11_error_handler_pop(void)
+{
+    mtx_lock(&x11_error_handler_mutex);
+    if (--x11_error_handler_depth == 0)
+        XSetErrorHandler(x11_error_handler_saved);
+    mtx_unlock(&x11_error_handler_mutex);
+}
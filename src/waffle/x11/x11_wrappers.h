@@ -38,12 +38,15 @@
 
 #include <X11/Xlib-xcb.h>
 
+// The Xlib error handler is process-global. When several threads call
+// wrappers at once, the first to enter installs the dummy handler and the last
+// to leave restores the user's handler. A naive save/restore pair per call
+// could instead restore the dummy handler and lose the user's.
 #define X11_SAVE_ERROR_HANDLER \
-    int (*old_handler)(Display*, XErrorEvent*) = \
-        XSetErrorHandler(x11_dummy_error_handler);
+    x11_error_handler_push();
 
 #define X11_RESTORE_ERROR_HANDLER \
-        XSetErrorHandler(old_handler);
+    x11_error_handler_pop();
 
 static inline int
 x11_dummy_error_handler(Display *dpy, XErrorEvent *err)
@@ -51,6 +54,12 @@ x11_dummy_error_handler(Display *dpy, XErrorEvent *err)
     return 0;
 }
 
+void
+x11_error_handler_push(void);
+
+void
+x11_error_handler_pop(void);
+
 static inline Display*
 wrapped_XOpenDisplay(const char *name)
 {
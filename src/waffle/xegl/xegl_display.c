@@ -54,11 +54,15 @@ xegl_display_connect(
     struct xegl_display *self;
     bool ok = true;
 
+    if (!wegl_platform_load(wegl_platform(wc_plat)))
+        return NULL;
+
     self = wcore_calloc(sizeof(*self));
     if (self == NULL)
         return NULL;
 
-    ok = x11_display_init(&self->x11, name);
+    ok = x11_display_init(&self->x11, name,
+                          &self->wegl.wcore.round_trips);
     if (!ok)
         goto error;
 
@@ -94,3 +98,15 @@ xegl_display_get_native(struct wcore_display *wc_self)
     xegl_display_fill_native(self, n_dpy->x11_egl);
     return n_dpy;
 }
+
+void
+xegl_display_begin_teardown(struct wcore_display *wc_self)
+{
+    x11_display_begin_teardown(&xegl_display(wc_self)->x11);
+}
+
+bool
+xegl_display_end_teardown(struct wcore_display *wc_self)
+{
+    return x11_display_end_teardown(&xegl_display(wc_self)->x11);
+}
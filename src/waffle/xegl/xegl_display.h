@@ -66,3 +66,9 @@ xegl_display_fill_native(struct xegl_display *self,
 
 union waffle_native_display*
 xegl_display_get_native(struct wcore_display *wc_self);
+
+void
+xegl_display_begin_teardown(struct wcore_display *wc_self);
+
+bool
+xegl_display_end_teardown(struct wcore_display *wc_self);
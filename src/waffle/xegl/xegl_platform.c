@@ -23,10 +23,9 @@
 // OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
 // OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
 
-#define _POSIX_C_SOURCE 200112 // glib feature macro for unsetenv()
-
 #include <stdlib.h>
 
+#include "wcore_env.h"
 #include "wcore_error.h"
 
 #include "wegl_config.h"
@@ -40,7 +39,7 @@
 #include "xegl_platform.h"
 #include "xegl_window.h"
 
-static const struct wcore_platform_vtbl xegl_platform_vtbl;
+WCORE_PLATFORM_VTBL_LINKAGE const struct wcore_platform_vtbl xegl_platform_vtbl;
 
 static bool
 xegl_platform_destroy(struct wcore_platform *wc_self)
@@ -51,7 +50,10 @@ xegl_platform_destroy(struct wcore_platform *wc_self)
     if (!self)
         return true;
 
-    unsetenv("EGL_PLATFORM");
+    wegl_platform_wait_prefetch(&self->wegl);
+
+    if (self->set_egl_platform_env)
+        wcore_env_release("EGL_PLATFORM");
 
     if (self->linux)
         ok &= linux_platform_destroy(self->linux);
@@ -62,7 +64,7 @@ xegl_platform_destroy(struct wcore_platform *wc_self)
 }
 
 struct wcore_platform*
-xegl_platform_create(void)
+xegl_platform_create(int32_t fast_start)
 {
     struct xegl_platform *self;
     bool ok = true;
@@ -71,16 +73,22 @@ xegl_platform_create(void)
     if (self == NULL)
         return NULL;
 
-    ok = wegl_platform_init(&self->wegl);
+    // Libraries loaded later, by the prefetch thread or on first use, must
+    // not change the environment. See wegl_platform_init().
+    if (fast_start != WAFFLE_NONE)
+        self->set_egl_platform_env = wcore_env_hold("EGL_PLATFORM", "x11");
+
+    ok = wegl_platform_init(&self->wegl, EGL_PLATFORM_X11_EXT, fast_start);
     if (!ok)
         goto error;
 
+    if (!self->wegl.eglGetPlatformDisplayEXT && !self->set_egl_platform_env)
+        self->set_egl_platform_env = wcore_env_hold("EGL_PLATFORM", "x11");
+
     self->linux = linux_platform_create();
     if (!self->linux)
         goto error;
 
-    setenv("EGL_PLATFORM", "x11", true);
-
     self->wegl.wcore.vtbl = &xegl_platform_vtbl;
     return &self->wegl.wcore;
 
@@ -140,31 +148,42 @@ xegl_context_get_native(struct wcore_context *wc_ctx)
     return n_ctx;
 }
 
-static const struct wcore_platform_vtbl xegl_platform_vtbl = {
+WCORE_PLATFORM_VTBL_LINKAGE const struct wcore_platform_vtbl xegl_platform_vtbl = {
     .destroy = xegl_platform_destroy,
 
     .make_current = wegl_make_current,
     .get_proc_address = wegl_get_proc_address,
     .dl_can_open = xegl_dl_can_open,
     .dl_sym = xegl_dl_sym,
+    .load = wegl_load,
 
     .display = {
         .connect = xegl_display_connect,
         .destroy = xegl_display_destroy,
         .supports_context_api = wegl_display_supports_context_api,
         .get_native = xegl_display_get_native,
+        .native_size = WCORE_NATIVE_UNION_SIZE(union waffle_native_display,
+                                              x11_egl),
+        .begin_teardown = xegl_display_begin_teardown,
+        .end_teardown = xegl_display_end_teardown,
+        .get_driver_id = wegl_display_get_driver_id,
     },
 
     .config = {
         .choose = wegl_config_choose,
         .destroy = wegl_config_destroy,
         .get_native = xegl_config_get_native,
+        .native_size = WCORE_NATIVE_UNION_SIZE(union waffle_native_config,
+                                              x11_egl),
     },
 
     .context = {
         .create = wegl_context_create,
         .destroy = wegl_context_destroy,
         .get_native = xegl_context_get_native,
+        .native_size = WCORE_NATIVE_UNION_SIZE(union waffle_native_context,
+                                              x11_egl),
+        .create_many = wegl_context_create_many,
     },
 
     .window = {
@@ -174,5 +193,7 @@ static const struct wcore_platform_vtbl xegl_platform_vtbl = {
         .resize = xegl_window_resize,
         .swap_buffers = wegl_window_swap_buffers,
         .get_native = xegl_window_get_native,
+        .native_size = WCORE_NATIVE_UNION_SIZE(union waffle_native_window,
+                                              x11_egl),
     },
 };
@@ -39,6 +39,9 @@ struct linux_platform;
 struct xegl_platform {
     struct wegl_platform wegl;
     struct linux_platform *linux;
+
+    /// True if this platform holds EGL_PLATFORM. See wcore_env_hold().
+    bool set_egl_platform_env;
 };
 
 DEFINE_CONTAINER_CAST_FUNC(xegl_platform,
@@ -47,4 +50,4 @@ DEFINE_CONTAINER_CAST_FUNC(xegl_platform,
                            wegl)
 
 struct wcore_platform*
-xegl_platform_create(void);
+xegl_platform_create(int32_t fast_start);
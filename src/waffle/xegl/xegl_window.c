@@ -49,7 +49,7 @@ xegl_window_destroy(struct wcore_window *wc_self)
 
     ok &= wegl_window_teardown(&self->wegl);
     ok &= x11_window_teardown(&self->x11);
-    free(self);
+    wcore_display_free_object(self);
     return ok;
 }
 
@@ -77,7 +77,8 @@ xegl_window_create(struct wcore_platform *wc_plat,
         return NULL;
     }
 
-    self = wcore_calloc(sizeof(*self));
+    self = wcore_display_alloc_object(wc_config->display, WCORE_OBJECT_WINDOW,
+                                      sizeof(*self));
     if (self == NULL)
         return NULL;
 
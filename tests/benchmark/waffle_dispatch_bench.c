@@ -0,0 +1,216 @@
+// Copyright 2016 Intel Corporation
+//
+// All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+//
+// - Redistributions of source code must retain the above copyright notice, this
+//   list of conditions and the following disclaimer.
+//
+// - Redistributions in binary form must reproduce the above copyright notice,
+//   this list of conditions and the following disclaimer in the documentation
+//   and/or other materials provided with the distribution.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+// DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+// FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+// DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+// SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+// CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+// OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+// OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+/// @file
+/// @brief Measure the cost of dispatching waffle API calls.
+///
+/// Each test calls one cheap entry point in a tight loop and reports the time
+/// per call. Build waffle once normally and once with
+/// -Dwaffle_single_platform=<platform>, then run this program against each
+/// build to see what the indirect platform dispatch costs.
+
+#define _POSIX_C_SOURCE 200112L
+
+#include <getopt.h>
+#include <stdbool.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+#include "waffle.h"
+
+#define ARRAY_SIZE(a) (sizeof(a) / sizeof(a[0]))
+
+static const char *usage_message =
+    "Usage:\n"
+    "    waffle_dispatch_bench -p <platform> [Options]\n"
+    "\n"
+    "Options:\n"
+    "    -p <platform>\n"
+    "        One of: gbm, glx, wayland or x11_egl\n"
+    "    -n <iterations>\n"
+    "        Calls per test (default 10000000)\n"
+    ;
+
+struct enum_map {
+    int32_t i;
+    const char *s;
+};
+
+static const struct enum_map platform_map[] = {
+    {WAFFLE_PLATFORM_GBM,       "gbm"},
+    {WAFFLE_PLATFORM_GLX,       "glx"},
+    {WAFFLE_PLATFORM_WAYLAND,   "wayland"},
+    {WAFFLE_PLATFORM_X11_EGL,   "x11_egl"},
+};
+
+static struct waffle_display *dpy;
+static struct waffle_config *config;
+static struct waffle_context *ctx;
+static struct waffle_window *window;
+
+static double
+now_seconds(void)
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec + ts.tv_nsec * 1e-9;
+}
+
+static bool
+call_supports_context_api(void)
+{
+    return waffle_display_supports_context_api(dpy, WAFFLE_CONTEXT_OPENGL_ES2);
+}
+
+static bool
+call_make_current(void)
+{
+    // The context is already current, so the driver has little to do.
+    return waffle_make_current(dpy, window, ctx);
+}
+
+static bool
+call_get_native_cached(void)
+{
+    return waffle_window_get_native_cached(window) != NULL;
+}
+
+struct test {
+    const char *name;
+    bool (*call)(void);
+};
+
+static const struct test tests[] = {
+    {"waffle_display_supports_context_api", call_supports_context_api},
+    {"waffle_make_current",                 call_make_current},
+    {"waffle_window_get_native_cached",     call_get_native_cached},
+};
+
+static void
+usage_error(void)
+{
+    fprintf(stderr, "%s", usage_message);
+    exit(EXIT_FAILURE);
+}
+
+static void
+fail(const char *func)
+{
+    fprintf(stderr, "waffle_dispatch_bench: %s failed: %s\n", func,
+            waffle_error_to_string(waffle_error_get_code()));
+    exit(EXIT_FAILURE);
+}
+
+int
+main(int argc, char **argv)
+{
+    int32_t platform = 0;
+    long iterations = 10000000;
+    int c;
+
+    while ((c = getopt(argc, argv, "p:n:h")) != -1) {
+        switch (c) {
+            case 'p':
+                for (size_t i = 0; i < ARRAY_SIZE(platform_map); ++i) {
+                    if (strcmp(platform_map[i].s, optarg) == 0)
+                        platform = platform_map[i].i;
+                }
+                if (!platform)
+                    usage_error();
+                break;
+            case 'n':
+                iterations = atol(optarg);
+                break;
+            case 'h':
+            default:
+                usage_error();
+        }
+    }
+
+    if (!platform || iterations < 1)
+        usage_error();
+
+    const int32_t init_attrib_list[] = {
+        WAFFLE_PLATFORM, platform,
+        0,
+    };
+
+    const int32_t config_attrib_list[] = {
+        WAFFLE_CONTEXT_API, WAFFLE_CONTEXT_OPENGL_ES2,
+        0,
+    };
+
+    if (!waffle_init(init_attrib_list))
+        fail("waffle_init");
+
+    dpy = waffle_display_connect(NULL);
+    if (!dpy)
+        fail("waffle_display_connect");
+
+    config = waffle_config_choose(dpy, config_attrib_list);
+    if (!config)
+        fail("waffle_config_choose");
+
+    ctx = waffle_context_create(config, NULL);
+    if (!ctx)
+        fail("waffle_context_create");
+
+    window = waffle_window_create(config, 64, 64);
+    if (!window)
+        fail("waffle_window_create");
+
+    if (!waffle_make_current(dpy, window, ctx))
+        fail("waffle_make_current");
+
+    printf("%-40s %12s\n", "entry point", "ns/call");
+
+    for (size_t t = 0; t < ARRAY_SIZE(tests); ++t) {
+        double start, elapsed;
+
+        // Warm up caches and any lazily initialized state.
+        for (long i = 0; i < iterations / 100 + 1; ++i)
+            tests[t].call();
+
+        start = now_seconds();
+        for (long i = 0; i < iterations; ++i) {
+            if (!tests[t].call())
+                fail(tests[t].name);
+        }
+        elapsed = now_seconds() - start;
+
+        printf("%-40s %12.2f\n", tests[t].name, elapsed * 1e9 / iterations);
+    }
+
+    waffle_make_current(dpy, NULL, NULL);
+    waffle_window_destroy(window);
+    waffle_context_destroy(ctx);
+    waffle_config_destroy(config);
+    waffle_display_disconnect(dpy);
+    waffle_teardown();
+    return EXIT_SUCCESS;
+}
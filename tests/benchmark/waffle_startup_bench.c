@@ -0,0 +1,286 @@
+// Copyright 2016 Intel Corporation
+//
+// All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+//
+// - Redistributions of source code must retain the above copyright notice, this
+//   list of conditions and the following disclaimer.
+//
+// - Redistributions in binary form must reproduce the above copyright notice,
+//   this list of conditions and the following disclaimer in the documentation
+//   and/or other materials provided with the distribution.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+// DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+// FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+// DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+// SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+// CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+// OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+// OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+/// @file
+/// @brief Measure the startup cost of short-lived waffle processes.
+///
+/// For each value of WAFFLE_FAST_START, the program forks a child per run.
+/// The child calls waffle_init(), busy-waits to stand in for the
+/// application's own initialization, then connects a display and chooses a
+/// config. The program reports the median time of each step and of the whole
+/// sequence. Forking keeps every run cold: the parent never loads libEGL.
+
+#define _POSIX_C_SOURCE 200112L
+
+#include <getopt.h>
+#include <stdbool.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <unistd.h>
+#include <sys/wait.h>
+
+#include "waffle.h"
+
+#define ARRAY_SIZE(a) (sizeof(a) / sizeof(a[0]))
+
+static const char *usage_message =
+    "Usage:\n"
+    "    waffle_startup_bench -p <platform> [Options]\n"
+    "\n"
+    "Options:\n"
+    "    -p <platform>\n"
+    "        One of: gbm, wayland or x11_egl\n"
+    "    -w <milliseconds>\n"
+    "        Application work between waffle_init and waffle_display_connect\n"
+    "        (default 20)\n"
+    "    -n <runs>\n"
+    "        Runs per mode (default 20)\n"
+    ;
+
+struct enum_map {
+    int32_t i;
+    const char *s;
+};
+
+static const struct enum_map platform_map[] = {
+    {WAFFLE_PLATFORM_GBM,       "gbm"},
+    {WAFFLE_PLATFORM_WAYLAND,   "wayland"},
+    {WAFFLE_PLATFORM_X11_EGL,   "x11_egl"},
+};
+
+static const struct enum_map mode_map[] = {
+    {WAFFLE_NONE,                   "none"},
+    {WAFFLE_FAST_START_LAZY,        "lazy"},
+    {WAFFLE_FAST_START_PREFETCH,    "prefetch"},
+};
+
+/// Times of one run, in milliseconds.
+struct run_times {
+    double init;
+    double connect;
+    double total;
+};
+
+static double
+now_ms(void)
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec * 1e3 + ts.tv_nsec * 1e-6;
+}
+
+static void
+busy_wait_ms(double ms)
+{
+    double end = now_ms() + ms;
+
+    while (now_ms() < end)
+        ;
+}
+
+static void
+usage_error(void)
+{
+    fprintf(stderr, "%s", usage_message);
+    exit(EXIT_FAILURE);
+}
+
+static void
+fail(const char *func)
+{
+    fprintf(stderr, "waffle_startup_bench: %s failed: %s\n", func,
+            waffle_error_to_string(waffle_error_get_code()));
+    exit(EXIT_FAILURE);
+}
+
+/// Run in the child. Write the times to @a fd.
+static void
+run_once(int32_t platform, int32_t mode, double work_ms, int fd)
+{
+    struct waffle_display *dpy;
+    struct waffle_config *config;
+    struct run_times times;
+    double t0, t1, t2, t3;
+
+    const int32_t init_attrib_list[] = {
+        WAFFLE_PLATFORM, platform,
+        WAFFLE_FAST_START, mode,
+        0,
+    };
+
+    const int32_t config_attrib_list[] = {
+        WAFFLE_CONTEXT_API, WAFFLE_CONTEXT_OPENGL_ES2,
+        0,
+    };
+
+    t0 = now_ms();
+    if (!waffle_init(init_attrib_list))
+        fail("waffle_init");
+    t1 = now_ms();
+
+    busy_wait_ms(work_ms);
+
+    t2 = now_ms();
+    dpy = waffle_display_connect(NULL);
+    if (!dpy)
+        fail("waffle_display_connect");
+
+    config = waffle_config_choose(dpy, config_attrib_list);
+    if (!config)
+        fail("waffle_config_choose");
+    t3 = now_ms();
+
+    times.init = t1 - t0;
+    times.connect = t3 - t2;
+    times.total = t3 - t0;
+
+    if (write(fd, &times, sizeof(times)) != sizeof(times))
+        exit(EXIT_FAILURE);
+
+    waffle_config_destroy(config);
+    waffle_display_disconnect(dpy);
+    waffle_teardown();
+}
+
+static bool
+run_forked(int32_t platform, int32_t mode, double work_ms,
+           struct run_times *times)
+{
+    int fds[2];
+    int status;
+    pid_t pid;
+    bool ok;
+
+    if (pipe(fds) != 0)
+        return false;
+
+    pid = fork();
+    if (pid < 0) {
+        close(fds[0]);
+        close(fds[1]);
+        return false;
+    }
+
+    if (pid == 0) {
+        close(fds[0]);
+        run_once(platform, mode, work_ms, fds[1]);
+        _exit(EXIT_SUCCESS);
+    }
+
+    close(fds[1]);
+    ok = read(fds[0], times, sizeof(*times)) == sizeof(*times);
+    close(fds[0]);
+
+    if (waitpid(pid, &status, 0) != pid ||
+        !WIFEXITED(status) || WEXITSTATUS(status) != EXIT_SUCCESS)
+        ok = false;
+
+    return ok;
+}
+
+static int
+compare_double(const void *a, const void *b)
+{
+    double x = *(const double*) a;
+    double y = *(const double*) b;
+    return (x > y) - (x < y);
+}
+
+static double
+median(double *v, int n)
+{
+    qsort(v, n, sizeof(v[0]), compare_double);
+    return n % 2 ? v[n / 2] : (v[n / 2 - 1] + v[n / 2]) / 2;
+}
+
+int
+main(int argc, char **argv)
+{
+    int32_t platform = 0;
+    double work_ms = 20;
+    int runs = 20;
+    int c;
+
+    while ((c = getopt(argc, argv, "p:w:n:h")) != -1) {
+        switch (c) {
+            case 'p':
+                for (size_t i = 0; i < ARRAY_SIZE(platform_map); ++i) {
+                    if (strcmp(platform_map[i].s, optarg) == 0)
+                        platform = platform_map[i].i;
+                }
+                if (!platform)
+                    usage_error();
+                break;
+            case 'w':
+                work_ms = atof(optarg);
+                break;
+            case 'n':
+                runs = atoi(optarg);
+                break;
+            case 'h':
+            default:
+                usage_error();
+        }
+    }
+
+    if (!platform || runs < 1 || work_ms < 0)
+        usage_error();
+
+    double *init = calloc(runs, sizeof(double));
+    double *connect = calloc(runs, sizeof(double));
+    double *total = calloc(runs, sizeof(double));
+    if (!init || !connect || !total)
+        return EXIT_FAILURE;
+
+    printf("%-10s %12s %12s %12s\n",
+           "mode", "init ms", "connect ms", "total ms");
+
+    for (size_t m = 0; m < ARRAY_SIZE(mode_map); ++m) {
+        for (int i = 0; i < runs; ++i) {
+            struct run_times times;
+
+            if (!run_forked(platform, mode_map[m].i, work_ms, &times)) {
+                fprintf(stderr, "waffle_startup_bench: run failed\n");
+                return EXIT_FAILURE;
+            }
+
+            init[i] = times.init;
+            connect[i] = times.connect;
+            total[i] = times.total;
+        }
+
+        printf("%-10s %12.3f %12.3f %12.3f\n", mode_map[m].s,
+               median(init, runs), median(connect, runs),
+               median(total, runs));
+    }
+
+    free(init);
+    free(connect);
+    free(total);
+    return EXIT_SUCCESS;
+}
@@ -0,0 +1,333 @@
+// Copyright 2016 Intel Corporation
+//
+// All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+//
+// - Redistributions of source code must retain the above copyright notice, this
+//   list of conditions and the following disclaimer.
+//
+// - Redistributions in binary form must reproduce the above copyright notice,
+//   this list of conditions and the following disclaimer in the documentation
+//   and/or other materials provided with the distribution.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+// DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+// FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+// DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+// SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+// CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+// OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+// OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+/// @file
+/// @brief Stress waffle object creation across threads and report scaling.
+///
+/// For each thread count 1, 2, 4, ... up to the requested maximum, every
+/// thread repeatedly creates and destroys waffle objects. The program prints
+/// the aggregate throughput and the speedup over a single thread.
+
+#define _POSIX_C_SOURCE 200112L
+
+#include <getopt.h>
+#include <stdbool.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+#include "threads.h"
+#include "waffle.h"
+
+#define ARRAY_SIZE(a) (sizeof(a) / sizeof(a[0]))
+
+static const char *usage_message =
+    "Usage:\n"
+    "    waffle_stress_bench -p <platform> [Options]\n"
+    "\n"
+    "Options:\n"
+    "    -p <platform>\n"
+    "        One of: gbm, glx, wayland or x11_egl\n"
+    "    -a <api>\n"
+    "        One of: gl (default), gles1, gles2 or gles3\n"
+    "    -m <mode>\n"
+    "        display: each iteration connects a display, chooses a config\n"
+    "                 and creates a context (default)\n"
+    "        context: threads share one display and config, and each\n"
+    "                 iteration creates a context\n"
+    "    -t <threads>\n"
+    "        Maximum number of threads (default 8)\n"
+    "    -n <iterations>\n"
+    "        Iterations per thread (default 50)\n"
+    ;
+
+struct enum_map {
+    int32_t i;
+    const char *s;
+};
+
+static const struct enum_map platform_map[] = {
+    {WAFFLE_PLATFORM_GBM,       "gbm"},
+    {WAFFLE_PLATFORM_GLX,       "glx"},
+    {WAFFLE_PLATFORM_WAYLAND,   "wayland"},
+    {WAFFLE_PLATFORM_X11_EGL,   "x11_egl"},
+};
+
+static const struct enum_map api_map[] = {
+    {WAFFLE_CONTEXT_OPENGL,     "gl"},
+    {WAFFLE_CONTEXT_OPENGL_ES1, "gles1"},
+    {WAFFLE_CONTEXT_OPENGL_ES2, "gles2"},
+    {WAFFLE_CONTEXT_OPENGL_ES3, "gles3"},
+};
+
+static bool
+enum_map_lookup(const struct enum_map *map, size_t n,
+                const char *s, int32_t *i)
+{
+    for (size_t k = 0; k < n; ++k) {
+        if (strcmp(map[k].s, s) == 0) {
+            *i = map[k].i;
+            return true;
+        }
+    }
+    return false;
+}
+
+struct options {
+    int32_t platform;
+    int32_t context_api;
+    bool shared_display;
+    int max_threads;
+    int iterations;
+};
+
+static struct options opts = {
+    .context_api = WAFFLE_CONTEXT_OPENGL,
+    .max_threads = 8,
+    .iterations = 50,
+};
+
+// Used only in "context" mode.
+static struct waffle_display *shared_dpy;
+static struct waffle_config *shared_config;
+
+struct worker {
+    thrd_t thread;
+    int failures;
+};
+
+static double
+now_seconds(void)
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec + ts.tv_nsec * 1e-9;
+}
+
+static struct waffle_config*
+choose_config(struct waffle_display *dpy)
+{
+    const int32_t attrib_list[] = {
+        WAFFLE_CONTEXT_API, opts.context_api,
+        WAFFLE_RED_SIZE,    8,
+        WAFFLE_GREEN_SIZE,  8,
+        WAFFLE_BLUE_SIZE,   8,
+        0,
+    };
+
+    return waffle_config_choose(dpy, attrib_list);
+}
+
+static bool
+iterate_display(void)
+{
+    struct waffle_display *dpy;
+    struct waffle_config *config = NULL;
+    struct waffle_context *ctx = NULL;
+    bool ok = false;
+
+    dpy = waffle_display_connect(NULL);
+    if (!dpy)
+        return false;
+
+    config = choose_config(dpy);
+    if (!config)
+        goto out;
+
+    ctx = waffle_context_create(config, NULL);
+    if (!ctx)
+        goto out;
+
+    ok = true;
+
+out:
+    if (ctx)
+        ok &= waffle_context_destroy(ctx);
+    if (config)
+        ok &= waffle_config_destroy(config);
+    ok &= waffle_display_disconnect(dpy);
+    return ok;
+}
+
+static bool
+iterate_context(void)
+{
+    struct waffle_context *ctx;
+
+    ctx = waffle_context_create(shared_config, NULL);
+    if (!ctx)
+        return false;
+
+    return waffle_context_destroy(ctx);
+}
+
+static int
+worker_main(void *arg)
+{
+    struct worker *w = arg;
+
+    for (int i = 0; i < opts.iterations; ++i) {
+        bool ok = opts.shared_display ? iterate_context() : iterate_display();
+        if (!ok)
+            w->failures++;
+    }
+
+    return 0;
+}
+
+static bool
+run(int nthreads, double *ops_per_sec, int *failures)
+{
+    struct worker *workers = calloc(nthreads, sizeof(*workers));
+    double start, elapsed;
+
+    if (!workers)
+        return false;
+
+    start = now_seconds();
+
+    for (int i = 0; i < nthreads; ++i) {
+        if (thrd_create(&workers[i].thread, worker_main, &workers[i])
+                != thrd_success) {
+            fprintf(stderr, "waffle_stress_bench: thrd_create failed\n");
+            nthreads = i;
+            break;
+        }
+    }
+
+    *failures = 0;
+    for (int i = 0; i < nthreads; ++i) {
+        thrd_join(workers[i].thread, NULL);
+        *failures += workers[i].failures;
+    }
+
+    elapsed = now_seconds() - start;
+    *ops_per_sec = (double) nthreads * opts.iterations / elapsed;
+
+    free(workers);
+    return true;
+}
+
+static void
+usage_error(void)
+{
+    fprintf(stderr, "%s", usage_message);
+    exit(EXIT_FAILURE);
+}
+
+int
+main(int argc, char **argv)
+{
+    double base = 0.0;
+    int c;
+
+    while ((c = getopt(argc, argv, "p:a:m:t:n:h")) != -1) {
+        switch (c) {
+            case 'p':
+                if (!enum_map_lookup(platform_map, ARRAY_SIZE(platform_map),
+                                     optarg, &opts.platform))
+                    usage_error();
+                break;
+            case 'a':
+                if (!enum_map_lookup(api_map, ARRAY_SIZE(api_map),
+                                     optarg, &opts.context_api))
+                    usage_error();
+                break;
+            case 'm':
+                if (strcmp(optarg, "display") == 0)
+                    opts.shared_display = false;
+                else if (strcmp(optarg, "context") == 0)
+                    opts.shared_display = true;
+                else
+                    usage_error();
+                break;
+            case 't':
+                opts.max_threads = atoi(optarg);
+                break;
+            case 'n':
+                opts.iterations = atoi(optarg);
+                break;
+            case 'h':
+            default:
+                usage_error();
+        }
+    }
+
+    if (!opts.platform || opts.max_threads < 1 || opts.iterations < 1)
+        usage_error();
+
+    const int32_t init_attrib_list[] = {
+        WAFFLE_PLATFORM, opts.platform,
+        0,
+    };
+
+    if (!waffle_init(init_attrib_list)) {
+        fprintf(stderr, "waffle_stress_bench: waffle_init failed: %s\n",
+                waffle_error_to_string(waffle_error_get_code()));
+        return EXIT_FAILURE;
+    }
+
+    if (opts.shared_display) {
+        shared_dpy = waffle_display_connect(NULL);
+        if (!shared_dpy) {
+            fprintf(stderr, "waffle_stress_bench: "
+                    "waffle_display_connect failed\n");
+            return EXIT_FAILURE;
+        }
+
+        shared_config = choose_config(shared_dpy);
+        if (!shared_config) {
+            fprintf(stderr, "waffle_stress_bench: "
+                    "waffle_config_choose failed\n");
+            return EXIT_FAILURE;
+        }
+    }
+
+    printf("%8s %12s %10s %10s\n", "threads", "ops/s", "speedup", "failures");
+
+    for (int n = 1; n <= opts.max_threads; n *= 2) {
+        double ops_per_sec;
+        int failures;
+
+        if (!run(n, &ops_per_sec, &failures))
+            return EXIT_FAILURE;
+
+        if (n == 1)
+            base = ops_per_sec;
+
+        printf("%8d %12.1f %10.2f %10d\n",
+               n, ops_per_sec, ops_per_sec / base, failures);
+    }
+
+    if (opts.shared_display) {
+        waffle_config_destroy(shared_config);
+        waffle_display_disconnect(shared_dpy);
+    }
+
+    waffle_teardown();
+    return EXIT_SUCCESS;
+}
@@ -281,7 +281,14 @@ gl_basic_draw__(struct gl_basic_draw_args__ args)
     }
 
     ASSERT_TRUE(window = waffle_window_create2(config, window_attrib_list));
+
+    // Showing a window takes at most one round trip to the display server.
+    struct waffle_round_trip_stats round_trips_before, round_trips_after;
+
+    ASSERT_TRUE(waffle_display_get_round_trip_stats(dpy, &round_trips_before));
     ASSERT_TRUE(waffle_window_show(window));
+    ASSERT_TRUE(waffle_display_get_round_trip_stats(dpy, &round_trips_after));
+    ASSERT_TRUE(round_trips_after.count - round_trips_before.count <= 1);
 
     ctx = waffle_context_create(config, NULL);
     if (!ctx) {
@@ -346,7 +353,12 @@ gl_basic_draw__(struct gl_basic_draw_args__ args)
     ASSERT_GL(glReadPixels(0, 0, WINDOW_WIDTH, WINDOW_HEIGHT,
                            GL_RGBA, GL_UNSIGNED_BYTE,
                            pixels));
+
+    // So does a swap.
+    ASSERT_TRUE(waffle_display_get_round_trip_stats(dpy, &round_trips_before));
     ASSERT_TRUE(waffle_window_swap_buffers(window));
+    ASSERT_TRUE(waffle_display_get_round_trip_stats(dpy, &round_trips_after));
+    ASSERT_TRUE(round_trips_after.count - round_trips_before.count <= 1);
 
     // Probe color buffer.
     //
@@ -370,6 +382,266 @@ gl_basic_draw__(struct gl_basic_draw_args__ args)
     ASSERT_TRUE(waffle_display_disconnect(dpy));
 }
 
+#if defined(WAFFLE_HAS_WAYLAND) || defined(WAFFLE_HAS_X11_EGL)
+/// Destroying one instance must not break another of the same platform.
+/// Both share the process-wide EGL_PLATFORM variable.
+static void
+gl_basic_two_instances(int32_t waffle_platform)
+{
+    const int32_t attrib_list[] = {
+        WAFFLE_PLATFORM, waffle_platform,
+        WAFFLE_FAST_START, WAFFLE_FAST_START_PREFETCH,
+        0,
+    };
+
+    struct waffle_instance *first = NULL;
+    struct waffle_instance *second = NULL;
+    struct waffle_display *dpy = NULL;
+
+    ASSERT_TRUE(first = waffle_instance_create(attrib_list));
+    ASSERT_TRUE(second = waffle_instance_create(attrib_list));
+    ASSERT_TRUE(waffle_instance_destroy(first));
+
+    ASSERT_TRUE(getenv("EGL_PLATFORM") != NULL);
+    ASSERT_TRUE(dpy = waffle_instance_display_connect(second, NULL));
+    ASSERT_TRUE(waffle_display_disconnect(dpy));
+    ASSERT_TRUE(waffle_instance_destroy(second));
+}
+#endif
+
+/// Choose an RGB config, or skip the test if the platform rejects the API.
+static struct waffle_config*
+gl_basic_config_choose(struct waffle_display *dpy, int32_t waffle_context_api)
+{
+    const int32_t config_attrib_list[] = {
+        WAFFLE_CONTEXT_API,     waffle_context_api,
+        WAFFLE_RED_SIZE,        8,
+        WAFFLE_GREEN_SIZE,      8,
+        WAFFLE_BLUE_SIZE,       8,
+        0,
+    };
+
+    struct waffle_config *config = waffle_config_choose(dpy, config_attrib_list);
+
+    if (!config) {
+        if (waffle_error_get_code() == WAFFLE_ERROR_UNSUPPORTED_ON_PLATFORM ||
+            waffle_error_get_code() == WAFFLE_ERROR_UNKNOWN) {
+            TEST_SKIP();
+        }
+        else {
+            TEST_FAIL();
+        }
+    }
+
+    return config;
+}
+
+enum {
+    // Enough contexts to spread over several creation threads.
+    NUM_MANY_CONTEXTS = 8,
+};
+
+static void
+gl_basic_context_create_many(int32_t waffle_context_api)
+{
+    struct waffle_display *dpy = NULL;
+    struct waffle_display *other_dpy = NULL;
+    struct waffle_config *config = NULL;
+    struct waffle_config *other_config = NULL;
+    struct waffle_context *other_ctx = NULL;
+    struct waffle_context *ctx[NUM_MANY_CONTEXTS];
+    size_t num_contexts, num_contexts_before;
+
+    ASSERT_TRUE(dpy = waffle_display_connect(NULL));
+    config = gl_basic_config_choose(dpy, waffle_context_api);
+    ASSERT_TRUE(waffle_display_get_live_counts(dpy, NULL, &num_contexts_before,
+                                               NULL));
+
+    // Bad parameters create nothing and leave the array alone.
+    memset(ctx, 0, sizeof(ctx));
+    ASSERT_TRUE(!waffle_context_create_many(config, NULL, 0, ctx));
+    ASSERT_TRUE(waffle_error_get_code() == WAFFLE_ERROR_BAD_PARAMETER);
+    ASSERT_TRUE(!waffle_context_create_many(config, NULL, NUM_MANY_CONTEXTS,
+                                            NULL));
+    ASSERT_TRUE(waffle_error_get_code() == WAFFLE_ERROR_BAD_PARAMETER);
+    ASSERT_TRUE(!waffle_context_create_many(NULL, NULL, NUM_MANY_CONTEXTS,
+                                            ctx));
+    ASSERT_TRUE(waffle_error_get_code() == WAFFLE_ERROR_BAD_PARAMETER);
+
+    // So does a shared context from another display.
+    ASSERT_TRUE(other_dpy = waffle_display_connect(NULL));
+    other_config = gl_basic_config_choose(other_dpy, waffle_context_api);
+    ASSERT_TRUE(other_ctx = waffle_context_create(other_config, NULL));
+    ASSERT_TRUE(!waffle_context_create_many(config, other_ctx,
+                                            NUM_MANY_CONTEXTS, ctx));
+    ASSERT_TRUE(waffle_error_get_code() == WAFFLE_ERROR_BAD_DISPLAY_MATCH);
+
+    for (int i = 0; i < NUM_MANY_CONTEXTS; ++i)
+        ASSERT_TRUE(ctx[i] == NULL);
+    ASSERT_TRUE(waffle_display_get_live_counts(dpy, NULL, &num_contexts,
+                                               NULL));
+    ASSERT_TRUE(num_contexts == num_contexts_before);
+
+    // The batch is all or nothing. If the native platform runs out of
+    // contexts part way, those already created are destroyed.
+    if (!waffle_context_create_many(config, NULL, NUM_MANY_CONTEXTS, ctx)) {
+        ASSERT_TRUE(waffle_error_get_code() != WAFFLE_NO_ERROR);
+        for (int i = 0; i < NUM_MANY_CONTEXTS; ++i)
+            ASSERT_TRUE(ctx[i] == NULL);
+        ASSERT_TRUE(waffle_display_get_live_counts(dpy, NULL, &num_contexts,
+                                                   NULL));
+        ASSERT_TRUE(num_contexts == num_contexts_before);
+        TEST_SKIP();
+    }
+
+    ASSERT_TRUE(waffle_display_get_live_counts(dpy, NULL, &num_contexts,
+                                               NULL));
+    ASSERT_TRUE(num_contexts == num_contexts_before + NUM_MANY_CONTEXTS);
+    for (int i = 0; i < NUM_MANY_CONTEXTS; ++i) {
+        ASSERT_TRUE(ctx[i] != NULL);
+        for (int j = 0; j < i; ++j)
+            ASSERT_TRUE(ctx[i] != ctx[j]);
+    }
+
+    // Teardown.
+    for (int i = 0; i < NUM_MANY_CONTEXTS; ++i)
+        ASSERT_TRUE(waffle_context_destroy(ctx[i]));
+    ASSERT_TRUE(waffle_display_get_live_counts(dpy, NULL, &num_contexts,
+                                               NULL));
+    ASSERT_TRUE(num_contexts == num_contexts_before);
+
+    ASSERT_TRUE(waffle_context_destroy(other_ctx));
+    ASSERT_TRUE(waffle_config_destroy(other_config));
+    ASSERT_TRUE(waffle_display_disconnect(other_dpy));
+    ASSERT_TRUE(waffle_config_destroy(config));
+    ASSERT_TRUE(waffle_display_disconnect(dpy));
+}
+
+enum {
+    // More windows than waffle swaps in one batch, so that the first display
+    // takes two batches.
+    NUM_SWAP_WINDOWS_A = 65,
+    NUM_SWAP_WINDOWS_B = 2,
+    NUM_SWAP_WINDOWS = NUM_SWAP_WINDOWS_A + NUM_SWAP_WINDOWS_B,
+};
+
+static uint64_t
+gl_basic_total_frames(struct waffle_window *window)
+{
+    static struct waffle_frame_stats stats;
+
+    ASSERT_TRUE(waffle_window_get_frame_stats(window, &stats));
+    return stats.total_frames;
+}
+
+static void
+gl_basic_window_swap_buffers_many(int32_t waffle_context_api)
+{
+    // Indices of the windows of the second display. They are interleaved with
+    // those of the first, whose batches waffle swaps first.
+    const int32_t index_b[NUM_SWAP_WINDOWS_B] = { 1, 40 };
+
+    const intptr_t window_attrib_list[] = {
+        WAFFLE_WINDOW_WIDTH,    WINDOW_WIDTH,
+        WAFFLE_WINDOW_HEIGHT,   WINDOW_HEIGHT,
+        0,
+    };
+
+    struct waffle_display *dpy_a = NULL;
+    struct waffle_display *dpy_b = NULL;
+    struct waffle_config *config_a = NULL;
+    struct waffle_config *config_b = NULL;
+    struct waffle_context *ctx = NULL;
+    struct waffle_window *windows[NUM_SWAP_WINDOWS];
+    bool on_b[NUM_SWAP_WINDOWS] = {false};
+    bool results[NUM_SWAP_WINDOWS];
+    uint64_t frames[NUM_SWAP_WINDOWS];
+    struct waffle_window *bad_windows[3];
+    enum waffle_error first_error = WAFFLE_NO_ERROR;
+    bool ok, all_ok = true;
+
+    ASSERT_TRUE(dpy_a = waffle_display_connect(NULL));
+    ASSERT_TRUE(dpy_b = waffle_display_connect(NULL));
+    config_a = gl_basic_config_choose(dpy_a, waffle_context_api);
+    config_b = gl_basic_config_choose(dpy_b, waffle_context_api);
+
+    for (int i = 0; i < NUM_SWAP_WINDOWS_B; ++i)
+        on_b[index_b[i]] = true;
+
+    for (int i = 0; i < NUM_SWAP_WINDOWS; ++i) {
+        ASSERT_TRUE(windows[i] = waffle_window_create2(
+                        on_b[i] ? config_b : config_a, window_attrib_list));
+        ASSERT_TRUE(waffle_window_show(windows[i]));
+    }
+
+    ctx = waffle_context_create(config_b, NULL);
+    if (!ctx) {
+        if (waffle_error_get_code() == WAFFLE_ERROR_UNSUPPORTED_ON_PLATFORM ||
+            waffle_error_get_code() == WAFFLE_ERROR_UNKNOWN) {
+            TEST_SKIP();
+        }
+        else {
+            TEST_FAIL();
+        }
+    }
+
+    // Some native platforms swap only the window that is current.
+    ASSERT_TRUE(waffle_make_current(dpy_b, windows[index_b[1]], ctx));
+
+    // An invalid window fails the call before any window is swapped.
+    for (int i = 0; i < NUM_SWAP_WINDOWS; ++i)
+        frames[i] = gl_basic_total_frames(windows[i]);
+
+    bad_windows[0] = windows[0];
+    bad_windows[1] = NULL;
+    bad_windows[2] = windows[index_b[0]];
+    ASSERT_TRUE(!waffle_window_swap_buffers_many(bad_windows, 3, results));
+    ASSERT_TRUE(waffle_error_get_code() == WAFFLE_ERROR_BAD_PARAMETER);
+    ASSERT_TRUE(!waffle_window_swap_buffers_many(windows, -1, results));
+    ASSERT_TRUE(waffle_error_get_code() == WAFFLE_ERROR_BAD_PARAMETER);
+    ASSERT_TRUE(waffle_window_swap_buffers_many(NULL, 0, NULL));
+
+    for (int i = 0; i < NUM_SWAP_WINDOWS; ++i)
+        ASSERT_TRUE(gl_basic_total_frames(windows[i]) == frames[i]);
+
+    // Every window is swapped exactly once.
+    ok = waffle_window_swap_buffers_many(windows, NUM_SWAP_WINDOWS, results);
+    if (!ok)
+        first_error = waffle_error_get_code();
+
+    for (int i = 0; i < NUM_SWAP_WINDOWS; ++i) {
+        ASSERT_TRUE(gl_basic_total_frames(windows[i]) == frames[i] + 1);
+        all_ok &= results[i];
+    }
+    ASSERT_TRUE(ok == all_ok);
+
+    // Each result is that of swapping its own window. The error reported is
+    // that of the first window to fail, and waffle swaps the first display,
+    // that of windows[0], before the second.
+    for (int pass = 0; pass < 2; ++pass) {
+        for (int i = 0; i < NUM_SWAP_WINDOWS; ++i) {
+            if (on_b[i] != (pass == 1))
+                continue;
+
+            ASSERT_TRUE(waffle_window_swap_buffers(windows[i]) == results[i]);
+            if (!results[i] && first_error != WAFFLE_NO_ERROR) {
+                ASSERT_TRUE(waffle_error_get_code() == first_error);
+                first_error = WAFFLE_NO_ERROR;
+            }
+        }
+    }
+
+    // Teardown.
+    ABORT_IF(!waffle_make_current(dpy_b, NULL, NULL));
+    for (int i = 0; i < NUM_SWAP_WINDOWS; ++i)
+        ASSERT_TRUE(waffle_window_destroy(windows[i]));
+    ASSERT_TRUE(waffle_context_destroy(ctx));
+    ASSERT_TRUE(waffle_config_destroy(config_b));
+    ASSERT_TRUE(waffle_config_destroy(config_a));
+    ASSERT_TRUE(waffle_display_disconnect(dpy_b));
+    ASSERT_TRUE(waffle_display_disconnect(dpy_a));
+}
+
 //
 // List of tests common to all platforms.
 //
@@ -385,6 +657,16 @@ TEST(gl_basic, all_gl_rgba)
                   .alpha=true);
 }
 
+TEST(gl_basic, all_gl_context_create_many)
+{
+    gl_basic_context_create_many(WAFFLE_CONTEXT_OPENGL);
+}
+
+TEST(gl_basic, all_gl_window_swap_buffers_many)
+{
+    gl_basic_window_swap_buffers_many(WAFFLE_CONTEXT_OPENGL);
+}
+
 TEST(gl_basic, all_gl10)
 {
     gl_basic_draw(.api=WAFFLE_CONTEXT_OPENGL,
@@ -808,6 +1090,8 @@ testsuite_cgl(void)
 
     TEST_RUN2(gl_basic, cgl_gl_rgb, all_gl_rgb);
     TEST_RUN2(gl_basic, cgl_gl_rgba, all_gl_rgba);
+    TEST_RUN2(gl_basic, cgl_gl_context_create_many, all_gl_context_create_many);
+    TEST_RUN2(gl_basic, cgl_gl_window_swap_buffers_many, all_gl_window_swap_buffers_many);
 
     TEST_RUN(gl_basic, cgl_gl_debug_is_unsupported);
     TEST_RUN(gl_basic, cgl_gl_fwdcompat_bad_attribute);
@@ -853,6 +1137,8 @@ testsuite_glx(void)
 
     TEST_RUN2(gl_basic, glx_gl_rgb, all_gl_rgb);
     TEST_RUN2(gl_basic, glx_gl_rgba, all_gl_rgb);
+    TEST_RUN2(gl_basic, glx_gl_context_create_many, all_gl_context_create_many);
+    TEST_RUN2(gl_basic, glx_gl_window_swap_buffers_many, all_gl_window_swap_buffers_many);
     TEST_RUN2(gl_basic, glx_gl_debug, all_but_cgl_gl_debug);
     TEST_RUN2(gl_basic, glx_gl_fwdcompat_bad_attribute, all_but_cgl_gl_fwdcompat_bad_attribute);
 
@@ -913,13 +1199,21 @@ TEST(gl_basic, wayland_init)
     gl_basic_init(WAFFLE_PLATFORM_WAYLAND);
 }
 
+TEST(gl_basic, wayland_two_instances)
+{
+    gl_basic_two_instances(WAFFLE_PLATFORM_WAYLAND);
+}
+
 static void
 testsuite_wayland(void)
 {
     TEST_RUN(gl_basic, wayland_init);
+    TEST_RUN(gl_basic, wayland_two_instances);
 
     TEST_RUN2(gl_basic, wayland_gl_rgb, all_gl_rgb);
     TEST_RUN2(gl_basic, wayland_gl_rgba, all_gl_rgba);
+    TEST_RUN2(gl_basic, wayland_gl_context_create_many, all_gl_context_create_many);
+    TEST_RUN2(gl_basic, wayland_gl_window_swap_buffers_many, all_gl_window_swap_buffers_many);
 
     TEST_RUN2(gl_basic, wayland_gl_debug, all_but_cgl_gl_debug);
     TEST_RUN2(gl_basic, wayland_gl_fwdcompat_bad_attribute, all_but_cgl_gl_fwdcompat_bad_attribute);
@@ -981,13 +1275,21 @@ TEST(gl_basic, x11_egl_init)
     gl_basic_init(WAFFLE_PLATFORM_X11_EGL);
 }
 
+TEST(gl_basic, x11_egl_two_instances)
+{
+    gl_basic_two_instances(WAFFLE_PLATFORM_X11_EGL);
+}
+
 static void
 testsuite_x11_egl(void)
 {
     TEST_RUN(gl_basic, x11_egl_init);
+    TEST_RUN(gl_basic, x11_egl_two_instances);
 
     TEST_RUN2(gl_basic, x11_egl_gl_rgb, all_gl_rgb);
     TEST_RUN2(gl_basic, x11_egl_gl_rgba, all_gl_rgba);
+    TEST_RUN2(gl_basic, x11_egl_gl_context_create_many, all_gl_context_create_many);
+    TEST_RUN2(gl_basic, x11_egl_gl_window_swap_buffers_many, all_gl_window_swap_buffers_many);
     TEST_RUN2(gl_basic, x11_egl_gl_debug, all_but_cgl_gl_debug);
     TEST_RUN2(gl_basic, x11_egl_gl_fwdcompat_bad_attribute, all_but_cgl_gl_fwdcompat_bad_attribute);
 
@@ -1055,6 +1357,8 @@ testsuite_wgl(void)
 
     TEST_RUN(gl_basic, all_gl_rgb);
     TEST_RUN(gl_basic, all_gl_rgba);
+    TEST_RUN(gl_basic, all_gl_context_create_many);
+    TEST_RUN(gl_basic, all_gl_window_swap_buffers_many);
     TEST_RUN(gl_basic, all_but_cgl_gl_debug);
     TEST_RUN(gl_basic, all_but_cgl_gl_fwdcompat_bad_attribute);
 